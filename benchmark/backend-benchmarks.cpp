@@ -0,0 +1,204 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <warabi/Backend.hpp>
+#include <benchmark/benchmark.h>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * Benchmarks of the backends, driven directly through the Backend,
+ * WritableRegion, and ReadableRegion interfaces (no RPC involved).
+ *
+ * Environment variables:
+ * - WARABI_BENCH_BACKENDS: comma-separated list of backends
+ *   (default "memory,abtio,pmdk");
+ * - WARABI_BENCH_DIR: directory of the abtio file (default /tmp);
+ * - WARABI_BENCH_PMEM_DIR: directory of the pmdk pool, typically a
+ *   tmpfs or fsdax mount (default /dev/shm);
+ * - WARABI_BENCH_PMEM_SIZE: size of the pmdk pool (default 1 GiB);
+ * - WARABI_BENCH_XSTREAMS: number of execution streams running the
+ *   ULTs of the parallel benchmarks (default 4).
+ */
+
+namespace tl = thallium;
+using json = nlohmann::json;
+using Segments = std::vector<std::pair<size_t, size_t>>;
+
+static std::string getEnv(const char* name, const std::string& defaultValue) {
+    auto value = std::getenv(name);
+    return value ? std::string{value} : defaultValue;
+}
+
+static json configFor(const std::string& backend) {
+    if(backend == "abtio") {
+        return json{
+            {"path", getEnv("WARABI_BENCH_DIR", "/tmp") + "/warabi-backend-bench.abtio"},
+            {"create_if_missing", true},
+            {"override_if_exists", true}
+        };
+    }
+    if(backend == "pmdk") {
+        return json{
+            {"path", getEnv("WARABI_BENCH_PMEM_DIR", "/dev/shm") + "/warabi-backend-bench.pmdk"},
+            {"create_if_missing_with_size",
+                std::stoull(getEnv("WARABI_BENCH_PMEM_SIZE", "1073741824"))},
+            {"override_if_exists", true}
+        };
+    }
+    return json::object();
+}
+
+static tl::pool* g_pool = nullptr;
+
+/* Create a region of the specified size, write it, and return its ID. */
+static warabi::RegionID makeRegion(warabi::Backend& target, size_t size) {
+    std::vector<char> data(size, 'a');
+    auto region = target.create(size).valueOrThrow();
+    region->write({{0, size}}, data.data(), false).check();
+    return region->getRegionID().valueOrThrow();
+}
+
+/* Create churn: create a region, then erase it. */
+static void CreateErase(benchmark::State& state, warabi::Backend* target) {
+    auto size = static_cast<size_t>(state.range(0));
+    for(auto _ : state) {
+        warabi::RegionID id;
+        {
+            auto region = target->create(size).valueOrThrow();
+            id = region->getRegionID().valueOrThrow();
+        }
+        target->erase(id).check();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+/* Write range(0) segments of 4 KiB, at a stride of 8 KiB. */
+static void StridedWrite(benchmark::State& state, warabi::Backend* target) {
+    const size_t segmentSize = 4096, stride = 8192;
+    auto numSegments = static_cast<size_t>(state.range(0));
+    auto id = makeRegion(*target, numSegments*stride);
+    Segments segments;
+    for(size_t i = 0; i < numSegments; ++i)
+        segments.emplace_back(i*stride, segmentSize);
+    std::vector<char> data(numSegments*segmentSize, 'b');
+    for(auto _ : state) {
+        auto region = target->write(id, false).valueOrThrow();
+        region->write(segments, data.data(), false).check();
+    }
+    state.SetBytesProcessed(state.iterations()*data.size());
+    target->erase(id).check();
+}
+
+/* range(0) ULTs each read 64 KiB chunks of a shared 16 MiB region. */
+static void ParallelRead(benchmark::State& state, warabi::Backend* target) {
+    const size_t regionSize = 16*1024*1024, chunkSize = 64*1024, readsPerULT = 64;
+    auto numULTs = static_cast<size_t>(state.range(0));
+    auto id = makeRegion(*target, regionSize);
+    std::vector<std::vector<char>> buffers(numULTs, std::vector<char>(chunkSize));
+    for(auto _ : state) {
+        std::vector<tl::managed<tl::thread>> ults;
+        for(size_t u = 0; u < numULTs; ++u) {
+            ults.push_back(g_pool->make_thread([&, u]() {
+                for(size_t i = 0; i < readsPerULT; ++i) {
+                    auto offset = ((u*readsPerULT + i)*chunkSize) % regionSize;
+                    auto region = target->read(id).valueOrThrow();
+                    region->read({{offset, chunkSize}}, buffers[u].data()).check();
+                }
+            }));
+        }
+        for(auto& ult : ults) ult->join();
+    }
+    state.SetItemsProcessed(state.iterations()*numULTs*readsPerULT);
+    state.SetBytesProcessed(state.iterations()*numULTs*readsPerULT*chunkSize);
+    target->erase(id).check();
+}
+
+/* Persist range(0) bytes that were just written (the write is not timed). */
+static void Persist(benchmark::State& state, warabi::Backend* target) {
+    auto size = static_cast<size_t>(state.range(0));
+    auto id = makeRegion(*target, size);
+    std::vector<char> data(size, 'c');
+    for(auto _ : state) {
+        auto region = target->write(id, true).valueOrThrow();
+        state.PauseTiming();
+        region->write({{0, size}}, data.data(), false).check();
+        state.ResumeTiming();
+        region->persist({{0, size}}).check();
+    }
+    state.SetBytesProcessed(state.iterations()*size);
+    target->erase(id).check();
+}
+
+/* Erase a region of range(0) bytes (its creation is not timed). */
+static void Erase(benchmark::State& state, warabi::Backend* target) {
+    auto size = static_cast<size_t>(state.range(0));
+    for(auto _ : state) {
+        state.PauseTiming();
+        auto id = makeRegion(*target, size);
+        state.ResumeTiming();
+        target->erase(id).check();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if(benchmark::ReportUnrecognizedArguments(argc, argv)) return 1;
+
+    tl::engine engine("na+sm", THALLIUM_SERVER_MODE);
+
+    auto pool = tl::pool::create(tl::pool::access::mpmc);
+    g_pool = &(*pool);
+    std::vector<tl::managed<tl::xstream>> xstreams;
+    auto numXstreams = std::stoi(getEnv("WARABI_BENCH_XSTREAMS", "4"));
+    for(int i = 0; i < std::max(numXstreams, 1); ++i)
+        xstreams.push_back(tl::xstream::create(tl::scheduler::predef::deflt, *pool));
+
+    std::vector<std::unique_ptr<warabi::Backend>> targets;
+    auto backends = getEnv("WARABI_BENCH_BACKENDS", "memory,abtio,pmdk");
+    size_t start = 0;
+    while(start <= backends.size()) {
+        auto end = backends.find(',', start);
+        if(end == std::string::npos) end = backends.size();
+        auto backend = backends.substr(start, end - start);
+        start = end + 1;
+        if(backend.empty()) continue;
+        auto target = warabi::TargetFactory::createTarget(backend, engine, configFor(backend));
+        if(!target.success()) {
+            std::cerr << "error: could not create " << backend << " target: "
+                      << target.error() << std::endl;
+            continue;
+        }
+        auto t = target.value().get();
+        targets.push_back(std::move(target.value()));
+
+        benchmark::RegisterBenchmark(fmt::format("{}/CreateErase", backend).c_str(), CreateErase, t)
+            ->Arg(4096)->Arg(65536)->Arg(1048576);
+        benchmark::RegisterBenchmark(fmt::format("{}/StridedWrite", backend).c_str(), StridedWrite, t)
+            ->Arg(1)->Arg(16)->Arg(64);
+        benchmark::RegisterBenchmark(fmt::format("{}/ParallelRead", backend).c_str(), ParallelRead, t)
+            ->Arg(1)->Arg(4)->Arg(16)->Arg(64)->UseRealTime();
+        benchmark::RegisterBenchmark(fmt::format("{}/Persist", backend).c_str(), Persist, t)
+            ->Arg(4096)->Arg(65536)->Arg(1048576);
+        benchmark::RegisterBenchmark(fmt::format("{}/Erase", backend).c_str(), Erase, t)
+            ->Arg(65536);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+
+    for(auto& t : targets) t->destroy();
+    targets.clear();
+    for(auto& x : xstreams) x->join();
+    xstreams.clear();
+    engine.finalize();
+    return 0;
+}
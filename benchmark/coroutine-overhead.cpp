@@ -0,0 +1,133 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/CompletionQueue.hpp>
+#include <warabi/Coroutines.hpp>
+#include <fmt/format.h>
+#include <tclap/CmdLine.h>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+namespace tl = thallium;
+
+static size_t g_num_ops = 100000;
+static size_t g_depth = 256;
+static size_t g_size = 64;
+
+static void parse_command_line(int argc, char** argv);
+
+template<typename F>
+static double opsPerSecond(size_t n, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    f();
+    auto t1 = std::chrono::steady_clock::now();
+    return n / std::chrono::duration<double>(t1 - t0).count();
+}
+
+/* Windows of depth requests, each window waited request by request. */
+static double benchmarkWait(const warabi::TargetHandle& th, const warabi::RegionID& region,
+                            const char* data) {
+    return opsPerSecond(g_num_ops, [&]() {
+        std::vector<warabi::AsyncRequest> reqs(g_depth);
+        for(size_t done = 0; done < g_num_ops; done += g_depth) {
+            size_t n = std::min(g_depth, g_num_ops - done);
+            for(size_t i = 0; i < n; ++i)
+                th.write(region, 0, data, g_size, false, &reqs[i]);
+            for(size_t i = 0; i < n; ++i)
+                reqs[i].wait();
+        }
+    });
+}
+
+/* A CompletionQueue keeping depth requests in flight, each completion
+ * callback issuing the next request. */
+static double benchmarkCallbacks(const warabi::TargetHandle& th, const warabi::RegionID& region,
+                                 const char* data) {
+    return opsPerSecond(g_num_ops, [&]() {
+        warabi::CompletionQueue queue;
+        size_t issued = 0;
+        std::function<void(const warabi::Completion&)> next =
+            [&](const warabi::Completion& c) {
+                c.check();
+                if(issued == g_num_ops) return;
+                issued += 1;
+                queue.push(th.writeAsync(region, 0, data, g_size), 0, next);
+            };
+        for(; issued < std::min(g_depth, g_num_ops); ++issued)
+            queue.push(th.writeAsync(region, 0, data, g_size), 0, next);
+        std::vector<warabi::Completion> completions;
+        while(queue.waitSome(&completions) != 0)
+            completions.clear();
+    });
+}
+
+/* depth coroutines, each awaiting its share of the requests in turn. */
+static warabi::coro::Task<> writer(const warabi::TargetHandle& th, const warabi::RegionID& region,
+                                   const char* data, size_t count) {
+    for(size_t i = 0; i < count; ++i)
+        co_await th.writeAsync(region, 0, data, g_size);
+}
+
+static double benchmarkCoroutines(const warabi::TargetHandle& th, const warabi::RegionID& region,
+                                  const char* data) {
+    return opsPerSecond(g_num_ops, [&]() {
+        warabi::coro::Scheduler scheduler;
+        for(size_t i = 0; i < g_depth; ++i) {
+            size_t count = g_num_ops/g_depth + (i < g_num_ops % g_depth ? 1 : 0);
+            scheduler.spawn(writer(th, region, data, count));
+        }
+        scheduler.run();
+    });
+}
+
+int main(int argc, char** argv) {
+    parse_command_line(argc, argv);
+
+    tl::engine engine("na+sm", THALLIUM_SERVER_MODE, true, 1);
+    {
+        warabi::Provider provider(engine, 42, R"({"target":{"type":"memory"}})");
+        warabi::Client client(engine);
+        auto th = client.makeTargetHandle(engine.self(), 42);
+        std::vector<char> data(g_size, 'x');
+        warabi::RegionID region;
+        th.create(&region, g_size);
+
+        auto wait       = benchmarkWait(th, region, data.data());
+        auto callbacks  = benchmarkCallbacks(th, region, data.data());
+        auto coroutines = benchmarkCoroutines(th, region, data.data());
+
+        std::cout << fmt::format(
+            "{{\"num_ops\":{},\"depth\":{},\"size\":{},\"ops_per_second\":"
+            "{{\"wait\":{:.0f},\"completion_queue\":{:.0f},\"coroutines\":{:.0f}}}}}",
+            g_num_ops, g_depth, g_size, wait, callbacks, coroutines) << std::endl;
+    }
+    engine.finalize();
+    return 0;
+}
+
+void parse_command_line(int argc, char** argv) {
+    try {
+        TCLAP::CmdLine cmd("Compares the styles of issuing overlapping operations", ' ', "0.1");
+        TCLAP::ValueArg<size_t> numOpsArg("n", "num-ops", "Number of operations (default 100000)", false, 100000, "int");
+        TCLAP::ValueArg<size_t> depthArg("d", "depth", "Operations in flight (default 256)", false, 256, "int");
+        TCLAP::ValueArg<size_t> sizeArg("s", "size", "Size of each write (default 64)", false, 64, "int");
+        cmd.add(numOpsArg);
+        cmd.add(depthArg);
+        cmd.add(sizeArg);
+        cmd.parse(argc, argv);
+        g_num_ops = numOpsArg.getValue();
+        g_depth = std::max<size_t>(depthArg.getValue(), 1);
+        g_size = sizeArg.getValue();
+    } catch(TCLAP::ArgException &e) {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        exit(-1);
+    }
+}
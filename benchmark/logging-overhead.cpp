@@ -0,0 +1,110 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include "Logging.hpp"
+#include "EventLog.hpp"
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <tclap/CmdLine.h>
+#include <chrono>
+#include <iostream>
+
+namespace tl = thallium;
+
+static size_t      g_num_ops = 1000000;
+static std::string g_log_level = "info";
+
+static void parse_command_line(int argc, char** argv);
+
+/* Logging function used by the provider before messages were
+ * checked against the log level prior to being formatted. */
+template<typename ... Args>
+static void legacyTrace(uint16_t provider_id, Args&&... args) {
+    auto msg = fmt::format(std::forward<Args>(args)...);
+    spdlog::trace("[warabi:{}] {}", provider_id, msg);
+}
+
+template<typename F>
+static double nsPerOp(size_t n, F&& f) {
+    auto t0 = std::chrono::steady_clock::now();
+    for(size_t i = 0; i < n; ++i) f(i);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count()/n;
+}
+
+/* Each op emits the two messages a handler emits per RPC. */
+static void benchmarkLoggingCalls(fmt::memory_buffer& out) {
+    warabi::EventLog eventLog{42, 65536, 64};
+    auto legacy = nsPerOp(g_num_ops, [](size_t i) {
+        legacyTrace(42, "Received write request {}", i);
+        legacyTrace(42, "Successfully executed write request");
+    });
+    auto checked = nsPerOp(g_num_ops, [](size_t i) {
+        warabi::log<spdlog::level::trace>(42, "Received write request {}", i);
+        warabi::log<spdlog::level::trace>(42, "Successfully executed write request");
+    });
+    auto binary = nsPerOp(g_num_ops, [&eventLog](size_t i) {
+        eventLog.record("Received write request {}", i);
+        eventLog.record("Successfully executed write request");
+    });
+    fmt::format_to(std::back_inserter(out),
+        "\"logging_calls_ns_per_op\":{{\"format_then_check\":{:.2f},"
+        "\"check_then_format\":{:.2f},\"binary_event_log\":{:.2f}}}",
+        legacy, checked, binary);
+}
+
+/* Small eager writes through the full client/provider stack. */
+static double benchmarkRPCs(tl::engine& engine, const std::string& config) {
+    warabi::Provider provider(engine, 42, config);
+    warabi::Client client(engine);
+    auto th = client.makeTargetHandle(engine.self(), 42);
+    char data[8] = {0};
+    warabi::RegionID region;
+    th.create(&region, sizeof(data));
+    return nsPerOp(g_num_ops, [&](size_t) {
+        th.write(region, 0, data, sizeof(data));
+    });
+}
+
+int main(int argc, char** argv) {
+    parse_command_line(argc, argv);
+    spdlog::set_level(spdlog::level::from_str(g_log_level));
+
+    fmt::memory_buffer out;
+    fmt::format_to(std::back_inserter(out),
+        "{{\"num_ops\":{},\"log_level\":\"{}\",\"compiled_log_level\":{},",
+        g_num_ops, g_log_level, WARABI_LOG_LEVEL);
+    benchmarkLoggingCalls(out);
+
+    tl::engine engine("na+sm", THALLIUM_SERVER_MODE);
+    auto text   = benchmarkRPCs(engine, R"({"target":{"type":"memory"}})");
+    auto binary = benchmarkRPCs(engine,
+        R"({"target":{"type":"memory"},"event_log":{"enabled":true}})");
+    engine.finalize();
+    fmt::format_to(std::back_inserter(out),
+        ",\"rpc_ns_per_op\":{{\"text_log\":{:.2f},\"binary_event_log\":{:.2f}}}}}",
+        text, binary);
+    std::cout << fmt::to_string(out) << std::endl;
+    return 0;
+}
+
+void parse_command_line(int argc, char** argv) {
+    try {
+        TCLAP::CmdLine cmd("Measures the per-RPC overhead of logging", ' ', "0.1");
+        TCLAP::ValueArg<size_t> numOpsArg("n", "num-ops", "Number of operations (default 1000000)", false, 1000000, "int");
+        TCLAP::ValueArg<std::string> logLevel("v","verbose", "Log level (trace, debug, info, warning, error, critical, off)", false, "info", "string");
+        cmd.add(numOpsArg);
+        cmd.add(logLevel);
+        cmd.parse(argc, argv);
+        g_num_ops = numOpsArg.getValue();
+        g_log_level = logLevel.getValue();
+    } catch(TCLAP::ArgException &e) {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        exit(-1);
+    }
+}
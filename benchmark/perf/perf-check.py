@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# (C) 2023 The University of Chicago
+#
+# See COPYRIGHT in top-level directory.
+"""
+Run the perf workloads with warabi-bench and compare their results
+against a baseline, or refresh the baseline with --update.
+
+The baseline is a JSON file of the following form:
+
+    {
+        "host": "...",
+        "tolerance": { "iops": 0.25, "latency_p50_us": 0.5 },
+        "workloads": {
+            "<name>": {
+                "iops": ..., "bandwidth_MiBps": ..., "latency_p50_us": ...,
+                "tolerance": { ... }  (optional, overrides the global one)
+            }
+        }
+    }
+
+A workload regresses if its IOPS drops below baseline * (1 - tolerance)
+or its median latency rises above baseline * (1 + tolerance). Each
+workload's best result over --repeat runs is used, which filters out
+most of the noise of short runs.
+
+Exit codes: 0 if no regression, 1 if there is a regression,
+2 if the baseline does not exist (the test then fails, since it was
+explicitly enabled and would otherwise never check anything).
+"""
+import argparse
+import json
+import os
+import socket
+import subprocess
+import sys
+import tempfile
+
+MISSING_BASELINE = 2
+DEFAULT_TOLERANCE = {"iops": 0.25, "latency_p50_us": 0.5}
+
+
+def run_workloads(bench, workloads, repeat):
+    best = {}
+    for i in range(repeat):
+        with tempfile.NamedTemporaryFile(suffix=".json") as output:
+            subprocess.run([bench, "-c", workloads, "-o", output.name], check=True)
+            results = json.load(open(output.name))
+        for w in results["workloads"]:
+            current = {
+                "iops": w["iops"],
+                "bandwidth_MiBps": w["bandwidth_MiBps"],
+                "latency_p50_us": w["latency_us"]["p50"],
+            }
+            previous = best.get(w["name"])
+            if previous is None:
+                best[w["name"]] = current
+            else:
+                previous["iops"] = max(previous["iops"], current["iops"])
+                previous["bandwidth_MiBps"] = max(previous["bandwidth_MiBps"],
+                                                  current["bandwidth_MiBps"])
+                previous["latency_p50_us"] = min(previous["latency_p50_us"],
+                                                 current["latency_p50_us"])
+    return best
+
+
+def compare(baseline, results):
+    regressions = []
+    global_tolerance = dict(DEFAULT_TOLERANCE)
+    global_tolerance.update(baseline.get("tolerance", {}))
+    for name, expected in baseline["workloads"].items():
+        if name not in results:
+            regressions.append(f"{name}: missing from the results")
+            continue
+        actual = results[name]
+        tolerance = dict(global_tolerance)
+        tolerance.update(expected.get("tolerance", {}))
+        min_iops = expected["iops"] * (1.0 - tolerance["iops"])
+        max_latency = expected["latency_p50_us"] * (1.0 + tolerance["latency_p50_us"])
+        status = "ok"
+        if actual["iops"] < min_iops:
+            status = "REGRESSION"
+            regressions.append(
+                f"{name}: {actual['iops']:.0f} IOPS < {min_iops:.0f} "
+                f"(baseline {expected['iops']:.0f})")
+        if actual["latency_p50_us"] > max_latency:
+            status = "REGRESSION"
+            regressions.append(
+                f"{name}: p50 latency {actual['latency_p50_us']:.2f} us > {max_latency:.2f} us "
+                f"(baseline {expected['latency_p50_us']:.2f} us)")
+        print(f"{name:32s} {actual['iops']:12.0f} IOPS ({expected['iops']:12.0f}) "
+              f"p50 {actual['latency_p50_us']:10.2f} us ({expected['latency_p50_us']:10.2f}) "
+              f"{status}")
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--bench", required=True, help="path to warabi-bench")
+    parser.add_argument("--workloads", required=True, help="workload file")
+    parser.add_argument("--baseline", required=True, help="baseline file")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="number of runs of the workloads (default 3)")
+    parser.add_argument("--update", action="store_true",
+                        help="write the results as the new baseline")
+    args = parser.parse_args()
+
+    if not args.update and not os.path.exists(args.baseline):
+        print(f"Baseline {args.baseline} not found: generate it on the "
+              "reference machine with the perf-baseline target, or point "
+              "WARABI_PERF_BASELINE to an existing one")
+        return MISSING_BASELINE
+
+    results = run_workloads(args.bench, args.workloads, max(args.repeat, 1))
+
+    if args.update:
+        tolerance = DEFAULT_TOLERANCE
+        if os.path.exists(args.baseline):
+            previous = json.load(open(args.baseline))
+            tolerance = previous.get("tolerance", tolerance)
+            # keep the per-workload tolerances
+            for name, w in previous.get("workloads", {}).items():
+                if name in results and "tolerance" in w:
+                    results[name]["tolerance"] = w["tolerance"]
+        baseline = {"host": socket.gethostname(), "tolerance": tolerance,
+                    "workloads": results}
+        with open(args.baseline, "w") as f:
+            json.dump(baseline, f, indent=4)
+            f.write("\n")
+        print(f"Baseline written to {args.baseline}")
+        return 0
+
+    baseline = json.load(open(args.baseline))
+    if baseline.get("host") not in (None, socket.gethostname()):
+        print(f"Warning: baseline was generated on {baseline['host']}")
+    regressions = compare(baseline, results)
+    if regressions:
+        print("Performance regressions:")
+        for r in regressions:
+            print(f"  {r}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,452 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <tclap/CmdLine.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <unistd.h>
+#include <sys/wait.h>
+
+namespace tl = thallium;
+using json = nlohmann::json;
+using namespace std::string_literals;
+
+static std::string g_workload_file;
+static std::string g_output_file;
+static std::string g_log_level = "warning";
+
+static void parse_command_line(int argc, char** argv);
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point t) {
+    return std::chrono::duration<double>(Clock::now() - t).count();
+}
+
+/**
+ * @brief Description of a workload, parsed from a JSON object.
+ * Default values are taken from the "defaults" object of the
+ * workload file, if any.
+ */
+struct Workload {
+
+    std::string name;
+    std::string operation;       // create, write, read, erase, create_write
+    json        provider_config; // configuration of the provider
+    uint16_t    provider_id      = 0;
+    size_t      num_ops          = 1000; // per client ULT
+    size_t      warmup_ops       = 0;    // per client ULT, write and read only
+    size_t      size             = 4096; // bytes per operation
+    size_t      num_segments     = 1;    // the size is split into this many segments
+    size_t      segment_stride   = 0;    // distance between segments (0 = contiguous)
+    size_t      num_blocks       = 16;   // per-ULT region size, in blocks of num_segments*stride
+    size_t      queue_depth      = 1;    // 1 = blocking API, otherwise outstanding requests
+    size_t      concurrency      = 1;    // number of client ULTs
+    int         eager            = -1;   // -1 = default thresholds, 0 = never, 1 = always
+    bool        persist          = false;
+    bool        register_buffer  = false; // expose the buffer once and use the bulk API
+    json        description;
+
+    size_t segmentSize() const { return size/num_segments; }
+    size_t stride() const { return segment_stride ? segment_stride : segmentSize(); }
+    size_t blockSize() const { return stride()*num_segments; }
+    size_t regionSize() const { return blockSize()*num_blocks; }
+
+    static Workload fromJSON(const json& defaults, const json& w) {
+        json j = defaults;
+        j.merge_patch(w);
+        Workload wl;
+        wl.description     = j;
+        wl.name            = j.value("name", j.value("operation", ""s));
+        wl.operation       = j.at("operation").get<std::string>();
+        wl.provider_config = j.value("provider", json::object());
+        wl.num_ops         = j.value("num_ops", wl.num_ops);
+        wl.warmup_ops      = j.value("warmup_ops", wl.warmup_ops);
+        wl.size            = j.value("size", wl.size);
+        wl.num_segments    = std::max<size_t>(1, j.value("num_segments", wl.num_segments));
+        wl.segment_stride  = j.value("segment_stride", wl.segment_stride);
+        wl.num_blocks      = std::max<size_t>(1, j.value("num_blocks", wl.num_blocks));
+        wl.queue_depth     = std::max<size_t>(1, j.value("queue_depth", wl.queue_depth));
+        wl.concurrency     = std::max<size_t>(1, j.value("concurrency", wl.concurrency));
+        wl.persist         = j.value("persist", wl.persist);
+        wl.register_buffer = j.value("register_buffer", wl.register_buffer);
+        if(j.contains("eager")) wl.eager = j["eager"].get<bool>() ? 1 : 0;
+        static const std::vector<std::string> operations = {
+            "create", "write", "read", "erase", "create_write"
+        };
+        if(std::find(operations.begin(), operations.end(), wl.operation) == operations.end())
+            throw warabi::Exception{fmt::format("Unknown operation \"{}\"", wl.operation)};
+        if(wl.size % wl.num_segments)
+            throw warabi::Exception{fmt::format(
+                "Size must be a multiple of num_segments in workload \"{}\"", wl.name)};
+        if(wl.segment_stride && wl.segment_stride < wl.segmentSize())
+            throw warabi::Exception{fmt::format(
+                "segment_stride is smaller than the segment size in workload \"{}\"", wl.name)};
+        return wl;
+    }
+};
+
+/**
+ * @brief State of a client ULT running a workload.
+ */
+struct Worker {
+
+    const Workload&              workload;
+    warabi::TargetHandle         target;
+    std::vector<char>            buffer;
+    tl::bulk                     bulk;
+    warabi::RegionID             region;
+    std::vector<warabi::RegionID> regions; // create, erase and create_write
+    std::vector<double>          latencies;
+    std::string                  error;
+
+    Worker(const Workload& w, warabi::TargetHandle th)
+    : workload(w), target(std::move(th)), buffer(w.size, 'x') {}
+
+    std::vector<std::pair<size_t, size_t>> segments(size_t i) const {
+        std::vector<std::pair<size_t, size_t>> segs;
+        segs.reserve(workload.num_segments);
+        auto block = (i % workload.num_blocks)*workload.blockSize();
+        for(size_t s = 0; s < workload.num_segments; ++s)
+            segs.emplace_back(block + s*workload.stride(), workload.segmentSize());
+        return segs;
+    }
+
+    void issue(const std::string& op, size_t i, warabi::AsyncRequest* req) {
+        auto& w = workload;
+        if(op == "create") {
+            target.create(&regions[i], w.size, req);
+        } else if(op == "erase") {
+            target.erase(regions[i], req);
+        } else if(op == "create_write") {
+            if(w.register_buffer)
+                target.createAndWrite(&regions[i], bulk, "", 0, w.size, w.persist, req);
+            else
+                target.createAndWrite(&regions[i], buffer.data(), w.size, w.persist, req);
+        } else if(op == "write") {
+            if(w.register_buffer)
+                target.write(region, segments(i), bulk, "", 0, w.persist, req);
+            else
+                target.write(region, segments(i), buffer.data(), w.persist, req);
+        } else if(op == "read") {
+            if(w.register_buffer)
+                target.read(region, segments(i), bulk, "", 0, req);
+            else
+                target.read(region, segments(i), buffer.data(), req);
+        }
+    }
+
+    /**
+     * @brief Issue count operations, keeping up to queue_depth of them
+     * in flight, and record their latencies if record is true.
+     */
+    void run(const std::string& op, size_t count, bool record) {
+        auto depth = workload.queue_depth;
+        if(record) latencies.reserve(count);
+        if(depth == 1) {
+            for(size_t i = 0; i < count; ++i) {
+                auto t = Clock::now();
+                issue(op, i, nullptr);
+                if(record) latencies.push_back(secondsSince(t));
+            }
+            return;
+        }
+        std::vector<warabi::AsyncRequest> reqs(depth);
+        std::vector<Clock::time_point>    starts(depth);
+        for(size_t i = 0; i < count; ++i) {
+            auto slot = i % depth;
+            if(reqs[slot]) {
+                reqs[slot].wait();
+                if(record) latencies.push_back(secondsSince(starts[slot]));
+            }
+            starts[slot] = Clock::now();
+            issue(op, i, &reqs[slot]);
+        }
+        // complete the remaining requests in the order they were issued
+        for(size_t i = count - std::min(count, depth); i < count; ++i) {
+            auto slot = i % depth;
+            reqs[slot].wait();
+            if(record) latencies.push_back(secondsSince(starts[slot]));
+        }
+    }
+
+    void setup(tl::engine& engine) {
+        auto& w = workload;
+        if(w.eager == 0) {
+            target.setEagerWriteThreshold(0);
+            target.setEagerReadThreshold(0);
+        } else if(w.eager == 1) {
+            target.setEagerWriteThreshold(std::numeric_limits<size_t>::max());
+            target.setEagerReadThreshold(std::numeric_limits<size_t>::max());
+        }
+        if(w.register_buffer)
+            bulk = engine.expose({{buffer.data(), buffer.size()}}, tl::bulk_mode::read_write);
+        if(w.operation == "write" || w.operation == "read") {
+            target.create(&region, w.regionSize());
+            if(w.operation == "read") { // fill the region so reads are not sparse
+                std::vector<char> data(w.regionSize(), 'y');
+                target.write(region, 0, data.data(), data.size());
+            }
+            run(w.operation, w.warmup_ops, false);
+        } else {
+            regions.resize(w.num_ops);
+            if(w.operation == "erase")
+                run("create", w.num_ops, false);
+        }
+    }
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if(sorted.empty()) return 0.0;
+    auto rank = static_cast<size_t>(p*(sorted.size()-1) + 0.5);
+    return sorted[std::min(rank, sorted.size()-1)];
+}
+
+/**
+ * @brief Run a workload and return its results as JSON.
+ */
+static json runWorkload(const Workload& w, tl::engine& engine,
+                        warabi::Client& client, const std::string& address,
+                        tl::pool& pool) {
+    std::vector<std::unique_ptr<Worker>> workers;
+    for(size_t i = 0; i < w.concurrency; ++i)
+        workers.push_back(std::make_unique<Worker>(
+            w, client.makeTargetHandle(address, w.provider_id)));
+
+    auto runInULTs = [&](auto&& f) {
+        std::vector<tl::managed<tl::thread>> ults;
+        for(auto& worker : workers)
+            ults.push_back(pool.make_thread([&f, &worker]() {
+                try {
+                    f(*worker);
+                } catch(const std::exception& ex) {
+                    worker->error = ex.what();
+                }
+            }));
+        for(auto& ult : ults) ult->join();
+        for(auto& worker : workers)
+            if(!worker->error.empty())
+                throw warabi::Exception{fmt::format(
+                    "Workload \"{}\" failed: {}", w.name, worker->error)};
+    };
+
+    runInULTs([&](Worker& worker) { worker.setup(engine); });
+    auto start = Clock::now();
+    runInULTs([&](Worker& worker) { worker.run(w.operation, w.num_ops, true); });
+    auto duration = secondsSince(start);
+
+    std::vector<double> latencies;
+    for(auto& worker : workers)
+        latencies.insert(latencies.end(), worker->latencies.begin(), worker->latencies.end());
+    std::sort(latencies.begin(), latencies.end());
+
+    // cleanup (not timed)
+    runInULTs([&](Worker& worker) {
+        if(w.operation == "write" || w.operation == "read")
+            worker.target.erase(worker.region);
+        else if(w.operation != "erase")
+            for(auto& r : worker.regions) worker.target.erase(r);
+    });
+
+    auto ops   = latencies.size();
+    auto bytes = (w.operation == "create" || w.operation == "erase") ? 0 : ops*w.size;
+    auto us    = [](double s) { return s*1e6; };
+    json result = json::object();
+    result["name"]            = w.name;
+    result["workload"]        = w.description;
+    result["num_ops"]         = ops;
+    result["bytes"]           = bytes;
+    result["duration_s"]      = duration;
+    result["iops"]            = ops/duration;
+    result["bandwidth_MiBps"] = bytes/duration/(1024.0*1024.0);
+    result["latency_us"] = {
+        {"min",  us(latencies.empty() ? 0.0 : latencies.front())},
+        {"mean", us(latencies.empty() ? 0.0 :
+                    std::accumulate(latencies.begin(), latencies.end(), 0.0)/ops)},
+        {"p50",  us(percentile(latencies, 0.50))},
+        {"p90",  us(percentile(latencies, 0.90))},
+        {"p99",  us(percentile(latencies, 0.99))},
+        {"p999", us(percentile(latencies, 0.999))},
+        {"max",  us(latencies.empty() ? 0.0 : latencies.back())}
+    };
+    return result;
+}
+
+/**
+ * @brief Assign a provider id to each distinct provider configuration
+ * and return the configurations indexed by provider id.
+ */
+static std::map<uint16_t, json> assignProviders(std::vector<Workload>& workloads) {
+    std::map<std::string, uint16_t> ids;
+    std::map<uint16_t, json> providers;
+    for(auto& w : workloads) {
+        auto key = w.provider_config.dump();
+        auto it = ids.find(key);
+        if(it == ids.end()) {
+            auto id = static_cast<uint16_t>(ids.size() + 1);
+            it = ids.emplace(key, id).first;
+            providers[id] = w.provider_config;
+        }
+        w.provider_id = it->second;
+    }
+    return providers;
+}
+
+static std::vector<warabi::Provider> startProviders(
+        tl::engine& engine, const std::map<uint16_t, json>& providers) {
+    std::vector<warabi::Provider> result;
+    for(auto& p : providers)
+        result.emplace_back(engine, p.first, p.second.dump());
+    return result;
+}
+
+int main(int argc, char** argv) {
+    parse_command_line(argc, argv);
+    spdlog::set_level(spdlog::level::from_str(g_log_level));
+
+    json config;
+    try {
+        std::ifstream file(g_workload_file);
+        if(!file.good()) throw warabi::Exception{fmt::format("Could not open {}", g_workload_file)};
+        config = json::parse(file);
+    } catch(const std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        return -1;
+    }
+
+    auto protocol        = config.value("protocol", "na+sm"s);
+    auto mode            = config.value("server", "in-process"s);
+    auto progress_thread = config.value("progress_thread", false);
+    auto rpc_threads     = config.value("rpc_threads", 0);
+    auto client_threads  = config.value("client_threads", 1);
+    auto defaults        = config.value("defaults", json::object());
+
+    std::vector<Workload> workloads;
+    try {
+        for(auto& w : config.at("workloads"))
+            workloads.push_back(Workload::fromJSON(defaults, w));
+    } catch(const std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        return -1;
+    }
+    auto providers = assignProviders(workloads);
+
+    pid_t server_pid = -1;
+    std::string server_address;
+    if(mode == "separate-process") {
+        // the providers run in a child process, reached via the network
+        int fds[2];
+        if(pipe(fds) != 0) {
+            perror("pipe");
+            return -1;
+        }
+        server_pid = fork();
+        if(server_pid == 0) {
+            close(fds[0]);
+            tl::engine engine(protocol, THALLIUM_SERVER_MODE, progress_thread, rpc_threads);
+            engine.enable_remote_shutdown();
+            {
+                auto ps = startProviders(engine, providers);
+                std::string addr = engine.self();
+                auto written = write(fds[1], addr.c_str(), addr.size() + 1);
+                close(fds[1]);
+                if(written != (ssize_t)(addr.size() + 1)) engine.finalize();
+                engine.wait_for_finalize();
+            }
+            _exit(0);
+        }
+        close(fds[1]);
+        char c;
+        while(read(fds[0], &c, 1) == 1 && c != '\0') server_address += c;
+        close(fds[0]);
+    } else if(mode != "in-process") {
+        std::cerr << "error: server should be \"in-process\" or \"separate-process\"" << std::endl;
+        return -1;
+    }
+
+    tl::engine engine(protocol,
+                      server_pid > 0 ? THALLIUM_CLIENT_MODE : THALLIUM_SERVER_MODE,
+                      progress_thread, server_pid > 0 ? 0 : rpc_threads);
+    std::vector<warabi::Provider> localProviders;
+    if(server_pid < 0) {
+        localProviders = startProviders(engine, providers);
+        server_address = static_cast<std::string>(engine.self());
+    }
+
+    // client ULTs run in their own pool and execution streams
+    auto pool = tl::pool::create(tl::pool::access::mpmc);
+    std::vector<tl::managed<tl::xstream>> xstreams;
+    for(int i = 0; i < std::max(client_threads, 1); ++i)
+        xstreams.push_back(tl::xstream::create(tl::scheduler::predef::deflt, *pool));
+
+    int ret = 0;
+    json results = json::object();
+    results["protocol"] = protocol;
+    results["server"]   = mode;
+    results["workloads"] = json::array();
+    {
+        warabi::Client client(engine);
+        try {
+            for(auto& w : workloads) {
+                spdlog::info("Running workload \"{}\"", w.name);
+                results["workloads"].push_back(
+                    runWorkload(w, engine, client, server_address, *pool));
+            }
+        } catch(const std::exception& ex) {
+            std::cerr << "error: " << ex.what() << std::endl;
+            ret = -1;
+        }
+    }
+
+    for(auto& x : xstreams) x->join();
+    xstreams.clear();
+    localProviders.clear();
+    if(server_pid > 0) {
+        engine.shutdown_remote_engine(engine.lookup(server_address));
+        waitpid(server_pid, nullptr, 0);
+    }
+    engine.finalize();
+
+    if(ret == 0) {
+        if(g_output_file.empty()) {
+            std::cout << results.dump(4) << std::endl;
+        } else {
+            std::ofstream out(g_output_file);
+            out << results.dump(4) << std::endl;
+        }
+    }
+    return ret;
+}
+
+void parse_command_line(int argc, char** argv) {
+    try {
+        TCLAP::CmdLine cmd("Runs Warabi workloads and reports their performance", ' ', "0.1");
+        TCLAP::ValueArg<std::string> workloadArg("c", "config", "JSON file describing the workloads", true, "", "file");
+        TCLAP::ValueArg<std::string> outputArg("o", "output", "Output JSON file (default: standard output)", false, "", "file");
+        TCLAP::ValueArg<std::string> logLevel("v","verbose", "Log level (trace, debug, info, warning, error, critical, off)", false, "warning", "string");
+        cmd.add(workloadArg);
+        cmd.add(outputArg);
+        cmd.add(logLevel);
+        cmd.parse(argc, argv);
+        g_workload_file = workloadArg.getValue();
+        g_output_file = outputArg.getValue();
+        g_log_level = logLevel.getValue();
+    } catch(TCLAP::ArgException &e) {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        exit(-1);
+    }
+}
@@ -0,0 +1,384 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "WorkloadCapture.hpp"
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include <nlohmann/json.hpp>
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <tclap/CmdLine.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <numeric>
+
+namespace tl = thallium;
+using json = nlohmann::json;
+using namespace std::string_literals;
+using warabi::CaptureOp;
+using warabi::CaptureRecord;
+
+static std::string g_capture_file;
+static std::string g_provider_config_file;
+static std::string g_output_file;
+static std::string g_protocol = "na+sm";
+static std::string g_log_level = "warning";
+static double      g_time_scale = 0.0;
+static size_t      g_concurrency = 16;
+static int         g_client_threads = 1;
+static bool        g_include_failed = false;
+
+static void parse_command_line(int argc, char** argv);
+
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point t) {
+    return std::chrono::duration<double>(Clock::now() - t).count();
+}
+
+static bool isCreate(CaptureOp op) {
+    return op == CaptureOp::Create
+        || op == CaptureOp::CreateWrite
+        || op == CaptureOp::CreateWriteEager;
+}
+
+/**
+ * @brief Region of the replay. Captured region ids are mapped to
+ * slots, a new slot being used every time a captured operation
+ * creates a region (since backends may reuse ids of erased regions).
+ * Operations on a region wait for the operation creating it.
+ */
+struct RegionSlot {
+    tl::eventual<bool> ready;
+    warabi::RegionID   id      = {};
+    bool               created = false; // created by the replay before it is timed
+    size_t             size    = 0;     // size needed by the operations (if created)
+};
+
+/**
+ * @brief Operation to replay. Operations on the same region are
+ * executed one after the other, in the order they were captured,
+ * whatever the concurrency of the replay.
+ */
+struct ReplayOp {
+    const CaptureRecord* record;
+    RegionSlot*          slot     = nullptr;
+    ReplayOp*            previous = nullptr; // previous operation on the region
+    tl::eventual<void>   done;
+    double               latency = 0.0;
+    bool                 success = false;
+
+    explicit ReplayOp(const CaptureRecord* r)
+    : record(r) {}
+};
+
+/**
+ * @brief Map the operations to region slots, and chain the
+ * operations on each slot.
+ */
+static void assignSlots(std::deque<ReplayOp>& ops, std::deque<RegionSlot>& slots) {
+    std::map<warabi::RegionID, RegionSlot*> current;
+    std::map<RegionSlot*, ReplayOp*> last;
+    for(auto& op : ops) {
+        auto& r = *op.record;
+        if(isCreate(r.op)) {
+            slots.emplace_back();
+            op.slot = &slots.back();
+            current[r.region] = op.slot;
+            last[op.slot] = &op;
+            continue;
+        }
+        auto it = current.find(r.region);
+        if(it == current.end()) { // region created before the capture started
+            slots.emplace_back();
+            slots.back().created = true;
+            it = current.emplace(r.region, &slots.back()).first;
+        }
+        op.slot = it->second;
+        op.previous = last[op.slot];
+        last[op.slot] = &op;
+        for(auto& s : r.segments)
+            op.slot->size = std::max(op.slot->size, s.first + s.second);
+        if(r.op == CaptureOp::Erase) current.erase(it);
+    }
+}
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if(sorted.empty()) return 0.0;
+    auto rank = static_cast<size_t>(p*(sorted.size()-1) + 0.5);
+    return sorted[std::min(rank, sorted.size()-1)];
+}
+
+/**
+ * @brief Summarize the latency and bandwidth of a set of operations.
+ */
+static json summarize(const std::vector<const ReplayOp*>& ops, double duration) {
+    std::vector<double> latencies;
+    size_t bytes = 0, errors = 0;
+    double captured = 0.0;
+    for(auto op : ops) {
+        if(!op->success) { ++errors; continue; }
+        latencies.push_back(op->latency);
+        captured += op->record->duration*1e-9;
+        if(op->record->op != CaptureOp::Create && op->record->op != CaptureOp::Erase
+        && op->record->op != CaptureOp::Persist)
+            bytes += op->record->size;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto n  = latencies.size();
+    auto us = [](double s) { return s*1e6; };
+    json result = json::object();
+    result["num_ops"]         = n;
+    result["errors"]          = errors;
+    result["bytes"]           = bytes;
+    result["iops"]            = duration > 0 ? n/duration : 0.0;
+    result["bandwidth_MiBps"] = duration > 0 ? bytes/duration/(1024.0*1024.0) : 0.0;
+    result["latency_us"] = {
+        {"min",  us(n ? latencies.front() : 0.0)},
+        {"mean", us(n ? std::accumulate(latencies.begin(), latencies.end(), 0.0)/n : 0.0)},
+        {"p50",  us(percentile(latencies, 0.50))},
+        {"p90",  us(percentile(latencies, 0.90))},
+        {"p99",  us(percentile(latencies, 0.99))},
+        {"max",  us(n ? latencies.back() : 0.0)}
+    };
+    result["captured_handler_us_mean"] = us(n ? captured/n : 0.0);
+    return result;
+}
+
+/**
+ * @brief Execute an operation. Returns false if the operation could
+ * not be executed because the region it accesses could not be created.
+ */
+static bool execute(ReplayOp& op, const warabi::TargetHandle& eager,
+                    const warabi::TargetHandle& bulk, std::vector<char>& buffer) {
+    auto& r = *op.record;
+    auto& slot = *op.slot;
+    if(!isCreate(r.op) && !slot.ready.wait()) return false;
+    if(buffer.size() < r.size) buffer.resize(r.size, 'r');
+    switch(r.op) {
+        case CaptureOp::Create:
+            bulk.create(&slot.id, r.size);
+            break;
+        case CaptureOp::CreateWrite:
+            bulk.createAndWrite(&slot.id, buffer.data(), r.size, r.persist);
+            break;
+        case CaptureOp::CreateWriteEager:
+            eager.createAndWrite(&slot.id, buffer.data(), r.size, r.persist);
+            break;
+        case CaptureOp::Write:
+            bulk.write(slot.id, r.segments, buffer.data(), r.persist);
+            break;
+        case CaptureOp::WriteEager:
+            eager.write(slot.id, r.segments, buffer.data(), r.persist);
+            break;
+        case CaptureOp::Persist:
+            bulk.persist(slot.id, r.segments);
+            break;
+        case CaptureOp::Read:
+            bulk.read(slot.id, r.segments, buffer.data());
+            break;
+        case CaptureOp::ReadEager:
+            eager.read(slot.id, r.segments, buffer.data());
+            break;
+        case CaptureOp::Erase:
+            bulk.erase(slot.id);
+            break;
+        case CaptureOp::Append:
+            bulk.append(slot.id, buffer.data(), r.size, nullptr, r.persist);
+            break;
+        case CaptureOp::AppendEager:
+            eager.append(slot.id, buffer.data(), r.size, nullptr, r.persist);
+            break;
+        case CaptureOp::Atomic:
+            {
+                // adding 0 accesses the word without changing the data
+                const char zero[16] = {};
+                eager.atomic(slot.id, r.segments.at(0).first, warabi::AtomicOp::FetchAdd,
+                             r.size, zero, nullptr, nullptr, r.persist);
+            }
+            break;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    parse_command_line(argc, argv);
+    spdlog::set_level(spdlog::level::from_str(g_log_level));
+
+    std::vector<CaptureRecord> records;
+    json providerConfig = {{"target", {{"type", "memory"}}}};
+    try {
+        std::ifstream in(g_capture_file, std::ios::in | std::ios::binary);
+        if(!in.good()) throw warabi::Exception{fmt::format("Could not open {}", g_capture_file)};
+        uint16_t capturedProviderId;
+        records = warabi::WorkloadCapture::load(in, capturedProviderId);
+        if(!g_provider_config_file.empty()) {
+            std::ifstream file(g_provider_config_file);
+            if(!file.good())
+                throw warabi::Exception{fmt::format("Could not open {}", g_provider_config_file)};
+            providerConfig = json::parse(file);
+        }
+    } catch(const std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        return -1;
+    }
+
+    // records are written when operations complete, replay them in arrival order
+    std::stable_sort(records.begin(), records.end(),
+        [](auto& a, auto& b) { return a.timestamp < b.timestamp; });
+    std::deque<ReplayOp> ops;
+    for(auto& r : records)
+        if(r.success || g_include_failed) ops.emplace_back(&r);
+    std::deque<RegionSlot> slots;
+    assignSlots(ops, slots);
+
+    tl::engine engine(g_protocol, THALLIUM_SERVER_MODE, false, 0);
+    auto pool = tl::pool::create(tl::pool::access::mpmc);
+    std::vector<tl::managed<tl::xstream>> xstreams;
+    for(int i = 0; i < std::max(g_client_threads, 1); ++i)
+        xstreams.push_back(tl::xstream::create(tl::scheduler::predef::deflt, *pool));
+
+    int ret = 0;
+    json results = json::object();
+    try {
+        warabi::Provider provider(engine, 1, providerConfig.dump());
+        warabi::Client client(engine);
+        auto address = static_cast<std::string>(engine.self());
+        auto eager = client.makeTargetHandle(address, 1);
+        auto bulk  = client.makeTargetHandle(address, 1);
+        eager.setEagerWriteThreshold(std::numeric_limits<size_t>::max());
+        eager.setEagerReadThreshold(std::numeric_limits<size_t>::max());
+        bulk.setEagerWriteThreshold(0);
+        bulk.setEagerReadThreshold(0);
+
+        // regions that existed before the capture started (not timed)
+        for(auto& slot : slots) {
+            if(!slot.created) continue;
+            std::vector<char> data(std::max<size_t>(slot.size, 1), 'p');
+            bulk.createAndWrite(&slot.id, data.data(), data.size());
+            slot.ready.set_value(true);
+        }
+
+        std::atomic<size_t> next{0};
+        auto firstTimestamp = ops.empty() ? 0 : ops.front().record->timestamp;
+        auto start = Clock::now();
+        std::vector<tl::managed<tl::thread>> ults;
+        for(size_t i = 0; i < std::max<size_t>(g_concurrency, 1); ++i) {
+            ults.push_back(pool->make_thread([&]() {
+                std::vector<char> buffer;
+                size_t index;
+                while((index = next.fetch_add(1)) < ops.size()) {
+                    auto& op = ops[index];
+                    if(g_time_scale > 0) {
+                        auto due = (op.record->timestamp - firstTimestamp)*1e-9*g_time_scale;
+                        auto now = secondsSince(start);
+                        if(due > now) tl::thread::sleep(engine, (due - now)*1e3);
+                    }
+                    // not timed: the operation is only issued once the
+                    // previous operation on its region has completed
+                    if(op.previous) op.previous->done.wait();
+                    auto t = Clock::now();
+                    try {
+                        op.success = execute(op, eager, bulk, buffer);
+                    } catch(const warabi::Exception& ex) {
+                        spdlog::debug("{} operation failed: {}",
+                                      warabi::captureOpName(op.record->op), ex.what());
+                        op.success = false;
+                    }
+                    op.latency = secondsSince(t);
+                    if(isCreate(op.record->op)) op.slot->ready.set_value(op.success);
+                    op.done.set_value();
+                }
+            }));
+        }
+        for(auto& ult : ults) ult->join();
+        auto duration = secondsSince(start);
+
+        // cleanup (not timed)
+        for(auto& slot : slots) {
+            if(!slot.ready.test() || !slot.ready.wait()) continue;
+            try { bulk.erase(slot.id); } catch(const warabi::Exception&) {}
+        }
+
+        std::vector<const ReplayOp*> all;
+        std::map<CaptureOp, std::vector<const ReplayOp*>> byType;
+        for(auto& op : ops) {
+            all.push_back(&op);
+            byType[op.record->op].push_back(&op);
+        }
+        results["capture"]         = g_capture_file;
+        results["provider"]        = providerConfig;
+        results["time_scale"]      = g_time_scale;
+        results["concurrency"]     = g_concurrency;
+        results["captured_span_s"] = records.empty() ? 0.0 : records.back().timestamp*1e-9;
+        results["duration_s"]      = duration;
+        results["total"]           = summarize(all, duration);
+        results["operations"]      = json::object();
+        for(auto& p : byType)
+            results["operations"][warabi::captureOpName(p.first)] = summarize(p.second, duration);
+    } catch(const std::exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        ret = -1;
+    }
+
+    for(auto& x : xstreams) x->join();
+    xstreams.clear();
+    engine.finalize();
+
+    if(ret == 0) {
+        if(g_output_file.empty()) {
+            std::cout << results.dump(4) << std::endl;
+        } else {
+            std::ofstream out(g_output_file);
+            out << results.dump(4) << std::endl;
+        }
+    }
+    return ret;
+}
+
+void parse_command_line(int argc, char** argv) {
+    try {
+        TCLAP::CmdLine cmd("Replays a workload captured by a Warabi provider", ' ', "0.1");
+        TCLAP::UnlabeledValueArg<std::string> captureArg("capture", "Workload capture produced by a provider", true, "", "file");
+        TCLAP::ValueArg<std::string> configArg("c", "config", "JSON configuration of the provider (default: memory target)", false, "", "file");
+        TCLAP::ValueArg<std::string> outputArg("o", "output", "Output JSON file (default: standard output)", false, "", "file");
+        TCLAP::ValueArg<std::string> protocolArg("p", "protocol", "Protocol", false, "na+sm", "string");
+        TCLAP::ValueArg<double> timeScaleArg("s", "time-scale", "Multiplier of the captured timestamps (0 = as fast as possible)", false, 0.0, "double");
+        TCLAP::ValueArg<size_t> concurrencyArg("n", "concurrency", "Maximum number of concurrent operations", false, 16, "int");
+        TCLAP::ValueArg<int> threadsArg("t", "threads", "Number of client execution streams", false, 1, "int");
+        TCLAP::SwitchArg failedArg("f", "include-failed", "Also replay operations that failed when captured");
+        TCLAP::ValueArg<std::string> logLevel("v","verbose", "Log level (trace, debug, info, warning, error, critical, off)", false, "warning", "string");
+        cmd.add(captureArg);
+        cmd.add(configArg);
+        cmd.add(outputArg);
+        cmd.add(protocolArg);
+        cmd.add(timeScaleArg);
+        cmd.add(concurrencyArg);
+        cmd.add(threadsArg);
+        cmd.add(failedArg);
+        cmd.add(logLevel);
+        cmd.parse(argc, argv);
+        g_capture_file = captureArg.getValue();
+        g_provider_config_file = configArg.getValue();
+        g_output_file = outputArg.getValue();
+        g_protocol = protocolArg.getValue();
+        g_time_scale = timeScaleArg.getValue();
+        g_concurrency = concurrencyArg.getValue();
+        g_client_threads = threadsArg.getValue();
+        g_include_failed = failedArg.getValue();
+        g_log_level = logLevel.getValue();
+    } catch(TCLAP::ArgException &e) {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        exit(-1);
+    }
+}
@@ -0,0 +1,40 @@
+import asyncio
+import mochi.margo
+from mochi.warabi.server import Provider
+from mochi.warabi.client import Client
+from mochi.warabi.aio import AsyncClient
+
+# The event loop blocks in epoll while waiting, so network progress
+# (and the provider's handlers) must run in another execution stream.
+engine = mochi.margo.Engine("na+sm", mochi.margo.server, use_progress_thread=True)
+provider = Provider(engine=engine, provider_id=42,
+                   config={"target": {"type": "memory"}})
+client = AsyncClient(Client(engine=engine))
+target = client.make_target_handle(str(engine.addr()), 42)
+
+
+async def store(name, data):
+    region = await target.create_and_write(data, persist=True)
+    print(f"Stored {name} in {region}")
+    return region
+
+
+async def main():
+    # Operations awaited concurrently are in flight at the same time
+    objects = {f"object-{i}": f"Data of object {i}".encode() for i in range(8)}
+    regions = await asyncio.gather(
+        *(store(name, data) for name, data in objects.items()))
+
+    for region, data in zip(regions, objects.values()):
+        assert await target.read(region, 0, len(data)) == data
+    print("All objects read back")
+
+    # Requests issued with the *_async methods of any TargetHandle
+    # can also be awaited through the AsyncClient
+    req = target.handle.erase_async(regions[0])
+    await client.wait(req)
+
+
+asyncio.run(main())
+client.close()
+engine.finalize()
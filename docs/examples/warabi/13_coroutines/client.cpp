@@ -0,0 +1,85 @@
+/*
+ * (C) 2024 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <thallium.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Coroutines.hpp>
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace tl = thallium;
+using warabi::coro::Task;
+
+// Copy a region into a new one, chunk by chunk, as straight-line code.
+// Each co_await suspends this task (not the ULT) until the operation
+// completes, letting the scheduler run the other tasks in the meantime.
+Task<warabi::RegionID> copyRegion(const warabi::TargetHandle& target,
+                                  warabi::RegionID source, size_t size,
+                                  size_t chunk_size) {
+    warabi::RegionID copy;
+    co_await target.createAsync(&copy, size);
+    std::vector<char> buffer(chunk_size);
+    for(size_t offset = 0; offset < size; offset += chunk_size) {
+        size_t n = std::min(chunk_size, size - offset);
+        co_await target.readAsync(source, offset, buffer.data(), n);
+        co_await target.writeAsync(copy, offset, buffer.data(), n);
+    }
+    co_return copy;
+}
+
+// Write a region, copy it, and check the copy.
+Task<> writeCopyCheck(const warabi::TargetHandle& target, int i, int* failures) {
+    std::string data(64*1024, 'a' + (i % 26));
+    warabi::RegionID region;
+    co_await target.createAndWriteAsync(&region, data.data(), data.size());
+
+    // awaiting another Task runs it in the same scheduler
+    warabi::RegionID copy = co_await copyRegion(target, region, data.size(), 8*1024);
+
+    std::string result(data.size(), '\0');
+    co_await target.readAsync(copy, 0, result.data(), result.size());
+    if(result != data) *failures += 1;
+
+    co_await target.eraseAsync(region);
+    co_await target.eraseAsync(copy);
+}
+
+int main(int argc, char** argv)
+{
+    if(argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <server> <provider_id>" << std::endl;
+        return -1;
+    }
+
+    try {
+        tl::engine engine("na+sm", THALLIUM_CLIENT_MODE);
+        warabi::Client client(engine);
+        warabi::TargetHandle target = client.makeTargetHandle(
+            argv[1], std::atoi(argv[2])
+        );
+
+        // 100 pipelines of operations, all overlapping
+        warabi::coro::Scheduler scheduler;
+        int failures = 0;
+        for(int i = 0; i < 100; ++i)
+            scheduler.spawn(writeCopyCheck(target, i, &failures));
+        scheduler.run();
+
+        if(failures == 0) {
+            std::cout << "SUCCESS: all the copies were verified" << std::endl;
+        } else {
+            std::cout << "FAILURE: " << failures << " copies differ" << std::endl;
+            return 1;
+        }
+
+    } catch(const warabi::Exception& ex) {
+        std::cerr << "Warabi error: " << ex.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
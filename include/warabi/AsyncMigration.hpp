@@ -0,0 +1,123 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_ASYNC_MIGRATION_HPP
+#define __WARABI_ASYNC_MIGRATION_HPP
+
+#include <cstddef>
+#include <memory>
+
+namespace warabi {
+
+class AsyncMigrationImpl;
+class Provider;
+
+/**
+ * @brief AsyncMigration objects are used to keep track of an
+ * on-going migration of the target of a Provider, started by
+ * Provider::migrateTarget. The migration keeps running if all
+ * the AsyncMigration objects referring to it are destroyed.
+ */
+class AsyncMigration {
+
+    friend Provider;
+
+    public:
+
+    /**
+     * @brief Default constructor. Will create a non-valid AsyncMigration.
+     */
+    AsyncMigration();
+
+    /**
+     * @brief Copy constructor.
+     */
+    AsyncMigration(const AsyncMigration& other);
+
+    /**
+     * @brief Move constructor.
+     */
+    AsyncMigration(AsyncMigration&& other);
+
+    /**
+     * @brief Copy-assignment operator.
+     */
+    AsyncMigration& operator=(const AsyncMigration& other);
+
+    /**
+     * @brief Move-assignment operator.
+     */
+    AsyncMigration& operator=(AsyncMigration&& other);
+
+    /**
+     * @brief Destructor.
+     */
+    ~AsyncMigration();
+
+    /**
+     * @brief Wait for the migration to complete. Throws an Exception
+     * if the migration failed or was cancelled, in which case the
+     * target is still attached to the source provider.
+     */
+    void wait() const;
+
+    /**
+     * @brief Test if the migration has completed, without blocking.
+     */
+    bool completed() const;
+
+    /**
+     * @brief Request the cancellation of the migration. The migration
+     * stops before its next transfer, and wait() then throws. This has
+     * no effect if the destination already received the whole target.
+     */
+    void cancel() const;
+
+    /**
+     * @brief Number of bytes of the target's files to transfer.
+     * An incremental migration adds the size of the extents modified
+     * during its first phase once it starts its second phase.
+     */
+    size_t bytesTotal() const;
+
+    /**
+     * @brief Number of bytes of the target's files transferred so far.
+     */
+    size_t bytesTransferred() const;
+
+    /**
+     * @brief Number of bytes actually sent to the destination so far,
+     * which is less than bytesTransferred() if compression is enabled.
+     */
+    size_t bytesSent() const;
+
+    /**
+     * @brief Time in seconds since the migration started, or that it
+     * took if it has completed.
+     */
+    double elapsed() const;
+
+    /**
+     * @brief Average throughput of the migration so far, i.e. the number
+     * of bytes transferred divided by elapsed(), in bytes per second.
+     */
+    double throughput() const;
+
+    /**
+     * @brief Checks if the object is valid.
+     */
+    operator bool() const;
+
+    private:
+
+    std::shared_ptr<AsyncMigrationImpl> self;
+
+    AsyncMigration(const std::shared_ptr<AsyncMigrationImpl>& impl);
+
+};
+
+}
+
+#endif
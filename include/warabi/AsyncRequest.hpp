@@ -6,6 +6,8 @@
 #ifndef __WARABI_ASYNC_REQUEST_HPP
 #define __WARABI_ASYNC_REQUEST_HPP
 
+#include <warabi/RequestTimings.hpp>
+#include <cstddef>
 #include <memory>
 #include <string>
 
@@ -64,11 +66,43 @@ class AsyncRequest {
      */
     bool completed() const;
 
+    /**
+     * @brief Timing breakdown of the request. This function
+     * waits for the request to complete if it has not already.
+     * The server-side timings are valid only if the provider
+     * is configured to report them.
+     */
+    const RequestTimings& timings() const;
+
     /**
      * @brief Checks if the object is valid.
      */
     operator bool() const;
 
+    /**
+     * @brief Block until one of the requests has completed and return
+     * its index. Invalid requests and requests that have already been
+     * waited on are ignored; if all the requests are in this case,
+     * count is returned. The caller still needs to call wait() on the
+     * request to get its outcome. Pending requests are waited on by a
+     * ULT each, started in the pool of the calling ULT, rather than
+     * polled.
+     *
+     * @param requests Array of requests.
+     * @param count Number of requests.
+     */
+    static size_t waitAny(const AsyncRequest* requests, size_t count);
+
+    /**
+     * @brief Test without blocking whether all the requests have
+     * completed (ignoring invalid requests and requests that have
+     * already been waited on).
+     *
+     * @param requests Array of requests.
+     * @param count Number of requests.
+     */
+    static bool testAll(const AsyncRequest* requests, size_t count);
+
     private:
 
     std::shared_ptr<AsyncRequestImpl> self;
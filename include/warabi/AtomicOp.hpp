@@ -0,0 +1,29 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_ATOMIC_OP_HPP
+#define __WARABI_ATOMIC_OP_HPP
+
+#include <stdint.h>
+
+namespace warabi {
+
+/**
+ * @brief Read-modify-write operations executed atomically by providers
+ * on 8 or 16-byte words of a region (see TargetHandle::atomic). Words
+ * are unsigned integers in the byte order of the provider's host.
+ */
+enum class AtomicOp : uint8_t {
+    FetchAdd,    // word += operand
+    CompareSwap, // if word == compare then word = operand
+    FetchAnd,    // word &= operand
+    FetchOr,     // word |= operand
+    FetchXor,    // word ^= operand
+    Swap         // word = operand
+};
+
+}
+
+#endif
@@ -89,6 +89,17 @@ class ReadableRegion : public Region {
     virtual Result<bool> read(
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
             void* data) = 0;
+
+    /**
+     * @brief Hint that the specified ranges will be read soon.
+     * Backends that can start loading them in advance override
+     * this function; the default implementation does nothing.
+     */
+    virtual Result<bool> prefetch(
+            const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
+        (void)regionOffsetSizes;
+        return Result<bool>{};
+    }
 };
 
 /**
@@ -183,6 +194,109 @@ class Backend {
     virtual Result<bool> erase(
             const RegionID& region) = 0;
 
+    /**
+     * @brief Atomically reserve size bytes right after the data previously
+     * appended to a region and return the offset of the reserved range,
+     * which the caller then writes through write(). Concurrent appends
+     * to the same region obtain disjoint ranges.
+     *
+     * @param region Region to append to.
+     * @param size Number of bytes to reserve.
+     *
+     * @return the offset of the reserved range in the region.
+     */
+    virtual Result<size_t> reserve(const RegionID& region, size_t size) {
+        (void)region;
+        (void)size;
+        Result<size_t> result;
+        result.success() = false;
+        result.error() = "Append is not supported by this backend";
+        return result;
+    }
+
+    /**
+     * @brief Give back a range obtained from reserve() that could not be
+     * written, if no range was reserved after it in the meantime.
+     *
+     * @param region Region the range was reserved in.
+     * @param offset Offset returned by reserve().
+     * @param size Number of bytes reserved.
+     *
+     * @return whether the range was given back (otherwise it stays
+     * reserved and is left unwritten).
+     */
+    virtual bool unreserve(const RegionID& region, size_t offset, size_t size) {
+        (void)region;
+        (void)offset;
+        (void)size;
+        return false;
+    }
+
+    /**
+     * @brief Change the size of a region, keeping its content up to the
+     * smaller of its old and new sizes. Bytes added are zero. Depending
+     * on the backend, the region may be moved, in which case its old
+     * RegionID becomes invalid.
+     *
+     * @param region Region to resize.
+     * @param size New size of the region.
+     *
+     * @return the RegionID of the resized region.
+     */
+    virtual Result<RegionID> resize(const RegionID& region, size_t size) {
+        (void)region;
+        (void)size;
+        Result<RegionID> result;
+        result.success() = false;
+        result.error() = "Resize is not supported by this backend";
+        return result;
+    }
+
+    /**
+     * @brief Copy size bytes from a region to another (or the same)
+     * region without transferring them through the network. Source
+     * and destination ranges may overlap.
+     */
+    virtual Result<bool> copy(const RegionID& source, size_t sourceOffset,
+                              const RegionID& dest, size_t destOffset,
+                              size_t size) {
+        (void)source;
+        (void)sourceOffset;
+        (void)dest;
+        (void)destOffset;
+        (void)size;
+        Result<bool> result;
+        result.success() = false;
+        result.error() = "Copy is not supported by this backend";
+        return result;
+    }
+
+    /**
+     * @brief Create a new region with the same size and content
+     * as an existing region.
+     *
+     * @return the RegionID of the new region.
+     */
+    virtual Result<RegionID> clone(const RegionID& region) {
+        (void)region;
+        Result<RegionID> result;
+        result.success() = false;
+        result.error() = "Clone is not supported by this backend";
+        return result;
+    }
+
+    /**
+     * @brief Return the size of a region (which, depending on the
+     * backend, may be larger than the size requested at creation).
+     */
+    virtual Result<size_t> size(const RegionID& region) {
+        (void)region;
+        Result<size_t> result;
+        result.success() = false;
+        result.error() = "Getting the size of regions is not supported by this backend";
+        return result;
+    }
+
     /**
      * @brief Destroys the underlying target.
      *
@@ -199,6 +313,17 @@ class Backend {
      */
     virtual Result<std::unique_ptr<MigrationHandle>> startMigration(bool removeSource) = 0;
 
+    /**
+     * @brief Create a DirtyTracker recording the changes made to the
+     * files of the target, to migrate it incrementally.
+     */
+    virtual Result<std::unique_ptr<DirtyTracker>> trackChanges() {
+        Result<std::unique_ptr<DirtyTracker>> result;
+        result.success() = false;
+        result.error() = "Incremental migration is not supported by this backend";
+        return result;
+    }
+
 };
 
 /**
@@ -0,0 +1,169 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_BUFFER_POOL_HPP
+#define __WARABI_BUFFER_POOL_HPP
+
+#include <thallium.hpp>
+#include <cstddef>
+#include <memory>
+
+namespace warabi {
+
+class BufferPool;
+class BufferPoolImpl;
+class RegisteredBufferImpl;
+
+/**
+ * @brief Memory buffer registered with the network (i.e. exposed as
+ * a bulk handle), borrowed from a BufferPool. Reading a region into
+ * a RegisteredBuffer transfers the data straight into its memory
+ * without registering memory for each read. Copies of a RegisteredBuffer
+ * refer to the same memory, which goes back to its pool when the last
+ * copy is destroyed.
+ */
+class RegisteredBuffer {
+
+    friend class BufferPool;
+
+    public:
+
+    /**
+     * @brief Default constructor (creates an invalid buffer).
+     */
+    RegisteredBuffer();
+
+    /**
+     * @brief Copy-constructor.
+     */
+    RegisteredBuffer(const RegisteredBuffer&);
+
+    /**
+     * @brief Move-constructor.
+     */
+    RegisteredBuffer(RegisteredBuffer&&);
+
+    /**
+     * @brief Copy-assignment operator.
+     */
+    RegisteredBuffer& operator=(const RegisteredBuffer&);
+
+    /**
+     * @brief Move-assignment operator.
+     */
+    RegisteredBuffer& operator=(RegisteredBuffer&&);
+
+    /**
+     * @brief Destructor.
+     */
+    ~RegisteredBuffer();
+
+    /**
+     * @brief Checks if the RegisteredBuffer instance is valid.
+     */
+    operator bool() const;
+
+    /**
+     * @brief Pointer to the memory of the buffer.
+     */
+    char* data() const;
+
+    /**
+     * @brief Size requested when getting the buffer from its pool.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Size of the underlying memory block (at least size()).
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Bulk handle exposing the memory block (read-write).
+     */
+    const thallium::bulk& bulk() const;
+
+    private:
+
+    RegisteredBuffer(std::shared_ptr<RegisteredBufferImpl> impl);
+
+    std::shared_ptr<RegisteredBufferImpl> self;
+};
+
+/**
+ * @brief Pool of memory blocks registered with the network. Blocks are
+ * allocated in power-of-two sizes classes (of at least 4 KiB) and recycled
+ * when the RegisteredBuffers using them are destroyed, up to a maximum
+ * number of bytes kept in the pool.
+ *
+ * Each Client owns a BufferPool, accessible via Client::bufferPool().
+ */
+class BufferPool {
+
+    public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param engine Engine used to register the memory.
+     * @param maxCachedBytes Maximum number of bytes of unused blocks
+     * kept in the pool (blocks released beyond that are freed).
+     */
+    BufferPool(const thallium::engine& engine,
+               size_t maxCachedBytes = 64*1024*1024);
+
+    /**
+     * @brief Copy-constructor (the copy refers to the same pool).
+     */
+    BufferPool(const BufferPool&);
+
+    /**
+     * @brief Move-constructor.
+     */
+    BufferPool(BufferPool&&);
+
+    /**
+     * @brief Copy-assignment operator.
+     */
+    BufferPool& operator=(const BufferPool&);
+
+    /**
+     * @brief Move-assignment operator.
+     */
+    BufferPool& operator=(BufferPool&&);
+
+    /**
+     * @brief Destructor.
+     */
+    ~BufferPool();
+
+    /**
+     * @brief Checks if the BufferPool instance is valid.
+     */
+    operator bool() const;
+
+    /**
+     * @brief Get a buffer of the specified size, reusing an unused
+     * block of the same size class if the pool has one.
+     */
+    RegisteredBuffer get(size_t size) const;
+
+    /**
+     * @brief Number of bytes of unused blocks currently in the pool.
+     */
+    size_t cachedBytes() const;
+
+    private:
+
+    friend class Client;
+
+    BufferPool(std::shared_ptr<BufferPoolImpl> impl);
+
+    std::shared_ptr<BufferPoolImpl> self;
+};
+
+}
+
+#endif
@@ -7,13 +7,21 @@
 #define __WARABI_CLIENT_HPP
 
 #include <warabi/TargetHandle.hpp>
+#include <warabi/RequestTimings.hpp>
+#include <warabi/BufferPool.hpp>
+#include <warabi/ReadCache.hpp>
 #include <thallium.hpp>
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace warabi {
 
 class ClientImpl;
 class TargetHandle;
+class TargetGroup;
+enum class Placement;
 
 /**
  * @brief The Client object is the main object used to establish
@@ -74,6 +82,13 @@ class Client {
      */
     const thallium::engine& engine() const;
 
+    /**
+     * @brief Returns the pool of registered buffers of the client,
+     * from which buffers passed to TargetHandle::read and
+     * TargetHandle::write can be taken.
+     */
+    BufferPool bufferPool() const;
+
     /**
      * @brief Creates a handle to a remote target and returns.
      * You may set "check" to false if you know for sure that the
@@ -87,6 +102,32 @@ class Client {
     TargetHandle makeTargetHandle(const std::string& address,
                                   uint16_t provider_id) const;
 
+    /**
+     * @brief Creates a group of targets across which regions are
+     * spread, using consistent hashing to place them.
+     *
+     * @param targets Address and provider id of each target.
+     *
+     * @return a TargetGroup instance.
+     */
+    TargetGroup makeTargetGroup(
+        const std::vector<std::pair<std::string, uint16_t>>& targets) const;
+
+    /**
+     * @brief Creates a group of targets across which regions are
+     * spread, using the specified placement policy.
+     *
+     * @param targets Address and provider id of each target.
+     * @param placement Placement policy.
+     * @param virtual_nodes Number of points per target on the hash
+     * ring used by the ConsistentHashing policy.
+     *
+     * @return a TargetGroup instance.
+     */
+    TargetGroup makeTargetGroup(
+        const std::vector<std::pair<std::string, uint16_t>>& targets,
+        Placement placement, size_t virtual_nodes = 64) const;
+
     /**
      * @brief Checks that the Client instance is valid.
      */
@@ -99,6 +140,45 @@ class Client {
      */
     std::string getConfig() const;
 
+    /**
+     * @brief Get the statistics aggregated over the timings of the
+     * requests issued by this client (and its TargetHandles) to
+     * providers that report timings, since its creation or the last
+     * call to resetTimingStats().
+     */
+    TimingStats getTimingStats() const;
+
+    /**
+     * @brief Reset the statistics returned by getTimingStats().
+     */
+    void resetTimingStats();
+
+    /**
+     * @brief Enable (or reconfigure) the read cache of the client.
+     *
+     * Blocking reads of a single range of at most options.maxEntrySize
+     * bytes are then cached, along with the version of their region,
+     * in an LRU cache of options.capacity bytes shared by all the
+     * TargetHandles of the client. A cached range is served without
+     * any RPC during options.leaseMs milliseconds after it was read
+     * or validated; after that, a small RPC validates its version
+     * before it is served. Writes and erasures issued by this client
+     * invalidate the cached ranges of their region immediately, while
+     * modifications by other clients are only noticed once the lease
+     * expires. Asynchronous reads bypass the cache.
+     */
+    void enableReadCache(const ReadCacheOptions& options = ReadCacheOptions{}) const;
+
+    /**
+     * @brief Disable the read cache and drop its content.
+     */
+    void disableReadCache() const;
+
+    /**
+     * @brief Get the statistics of the read cache.
+     */
+    ReadCacheStats getReadCacheStats() const;
+
     private:
 
     Client(const std::shared_ptr<ClientImpl>& impl);
@@ -0,0 +1,148 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_COMPLETION_QUEUE_HPP
+#define __WARABI_COMPLETION_QUEUE_HPP
+
+#include <warabi/AsyncRequest.hpp>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace warabi {
+
+class CompletionQueueImpl;
+
+/**
+ * @brief Request that has completed, as returned by a CompletionQueue.
+ */
+struct Completion {
+
+    uint64_t           tag = 0;  // tag the request was pushed with
+    AsyncRequest       request;  // the request (already waited on)
+    std::exception_ptr error;    // exception of the request, if it failed
+
+    /**
+     * @brief Whether the request succeeded.
+     */
+    bool success() const { return !error; }
+
+    /**
+     * @brief Rethrow the exception of the request, if it failed.
+     */
+    void check() const { if(error) std::rethrow_exception(error); }
+};
+
+/**
+ * @brief A CompletionQueue tracks many asynchronous requests at once.
+ * Requests are pushed into the queue with a tag and an optional callback,
+ * and the caller then polls or waits on the queue instead of waiting on
+ * each request. The requests are waited on in push order by up to 16
+ * ULTs, started in the pool of the ULT that pushes them (errors do not
+ * throw but are stored in the Completion); a request is then made
+ * available to waitAny/waitSome once its callback has been invoked.
+ * waitAny and waitSome block until enough requests have completed
+ * rather than polling them.
+ *
+ * Callbacks are invoked by the thread calling waitAny, waitSome, or
+ * testAll, outside of any lock, so they can push new requests.
+ */
+class CompletionQueue {
+
+    public:
+
+    using Callback = std::function<void(const Completion&)>;
+
+    /**
+     * @brief Constructor. Creates an empty queue.
+     */
+    CompletionQueue();
+
+    /**
+     * @brief Copy-constructor (the copy refers to the same queue).
+     */
+    CompletionQueue(const CompletionQueue&);
+
+    /**
+     * @brief Move-constructor.
+     */
+    CompletionQueue(CompletionQueue&&);
+
+    /**
+     * @brief Copy-assignment operator.
+     */
+    CompletionQueue& operator=(const CompletionQueue&);
+
+    /**
+     * @brief Move-assignment operator.
+     */
+    CompletionQueue& operator=(CompletionQueue&&);
+
+    /**
+     * @brief Destructor. Requests still in the queue are waited on
+     * when the last reference to the queue is destroyed.
+     */
+    ~CompletionQueue();
+
+    /**
+     * @brief Checks if the CompletionQueue instance is valid.
+     */
+    operator bool() const;
+
+    /**
+     * @brief Add a request to the queue.
+     *
+     * @param request Request (must be valid and not waited on).
+     * @param tag Tag identifying the request in its Completion.
+     * @param callback Optional function called when the request completes.
+     */
+    void push(AsyncRequest request, uint64_t tag = 0, Callback callback = {}) const;
+
+    /**
+     * @brief Number of requests that have not completed yet.
+     */
+    size_t pending() const;
+
+    /**
+     * @brief Number of completed requests not yet returned
+     * by waitAny or waitSome.
+     */
+    size_t ready() const;
+
+    /**
+     * @brief Block until a request completes and return it.
+     * Returns false if the queue has no request left.
+     */
+    bool waitAny(Completion* completion) const;
+
+    /**
+     * @brief Block until at least min requests have completed (or
+     * until the queue has no request left) and append up to max of
+     * them to completions. With min = 0, this function does not block.
+     *
+     * @return The number of completions appended.
+     */
+    size_t waitSome(std::vector<Completion>* completions,
+                    size_t min = 1,
+                    size_t max = std::numeric_limits<size_t>::max()) const;
+
+    /**
+     * @brief Test without blocking whether all the requests pushed
+     * into the queue have completed. The completed requests remain
+     * available to waitAny and waitSome.
+     */
+    bool testAll() const;
+
+    private:
+
+    std::shared_ptr<CompletionQueueImpl> self;
+};
+
+}
+
+#endif
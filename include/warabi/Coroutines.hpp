@@ -0,0 +1,313 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_COROUTINES_HPP
+#define __WARABI_COROUTINES_HPP
+
+#if !defined(__cpp_impl_coroutine) || !__has_include(<coroutine>)
+#error "warabi/Coroutines.hpp requires C++20 coroutines"
+#endif
+
+#include <warabi/AsyncRequest.hpp>
+#include <warabi/Exception.hpp>
+#include <thallium.hpp>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <optional>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace warabi {
+
+namespace coro {
+
+class Scheduler;
+
+template<typename T> class Task;
+
+namespace detail {
+
+struct PromiseBase {
+
+    Scheduler*              scheduler = nullptr;
+    std::coroutine_handle<> continuation;
+    std::exception_ptr      error;
+    bool                    detached = false;
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept;
+        void await_resume() noexcept {}
+    };
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template<typename T>
+struct PromiseValue {
+
+    std::optional<T> value;
+
+    template<typename U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+    T result() { return std::move(*value); }
+};
+
+template<>
+struct PromiseValue<void> {
+
+    void return_void() noexcept {}
+
+    void result() {}
+};
+
+}
+
+/**
+ * @brief Coroutine returned by functions that co_await warabi
+ * operations. A Task does not start until it is either co_awaited
+ * by another Task, spawned in a Scheduler, or run by Scheduler::run.
+ */
+template<typename T = void>
+class [[nodiscard]] Task {
+
+    friend class Scheduler;
+
+    public:
+
+    struct promise_type : detail::PromiseBase, detail::PromiseValue<T> {
+        Task get_return_object() {
+            return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+    };
+
+    Task(Task&& other) noexcept
+    : m_handle(std::exchange(other.m_handle, {})) {}
+
+    Task& operator=(Task&& other) noexcept {
+        if(this == &other) return *this;
+        if(m_handle) m_handle.destroy();
+        m_handle = std::exchange(other.m_handle, {});
+        return *this;
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    ~Task() {
+        if(m_handle) m_handle.destroy();
+    }
+
+    /**
+     * @brief Awaiting a Task from another Task runs it in the
+     * same Scheduler and resumes the caller when it completes.
+     */
+    auto operator co_await() && noexcept {
+        return Awaiter{m_handle};
+    }
+
+    private:
+
+    struct Awaiter {
+        std::coroutine_handle<promise_type> handle;
+        bool await_ready() noexcept { return false; }
+        template<typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> caller) noexcept {
+            handle.promise().scheduler    = caller.promise().scheduler;
+            handle.promise().continuation = caller;
+            return handle;
+        }
+        T await_resume() {
+            auto& promise = handle.promise();
+            if(promise.error) std::rethrow_exception(promise.error);
+            return promise.result();
+        }
+    };
+
+    explicit Task(std::coroutine_handle<promise_type> handle)
+    : m_handle(handle) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * @brief Single-threaded scheduler for Tasks. Tasks run in the ULT
+ * calling run(): when a Task awaits an AsyncRequest that has not
+ * completed, it is suspended and the scheduler resumes other Tasks.
+ * When no Task can make progress, the scheduler polls the requests
+ * in flight, yielding to other Argobots ULTs (including the Mercury
+ * progress loop) between rounds.
+ */
+class Scheduler {
+
+    struct Waiting {
+        const AsyncRequest*     request;
+        std::coroutine_handle<> handle;
+    };
+
+    std::deque<std::coroutine_handle<>>         m_ready;
+    std::vector<Waiting>                        m_waiting;
+    std::unordered_set<void*>                   m_detached; // addresses of spawned Tasks
+    std::exception_ptr                          m_error;
+
+    public:
+
+    Scheduler() = default;
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /**
+     * @brief Destructor. Tasks that have not completed are destroyed.
+     */
+    ~Scheduler() {
+        for(auto address : m_detached)
+            std::coroutine_handle<>::from_address(address).destroy();
+    }
+
+    /**
+     * @brief Start a Task in the background. The Task runs when run()
+     * is called. If it throws, the exception is rethrown by run().
+     */
+    void spawn(Task<void> task) {
+        auto h = std::exchange(task.m_handle, {});
+        h.promise().scheduler = this;
+        h.promise().detached  = true;
+        m_detached.insert(h.address());
+        m_ready.push_back(h);
+    }
+
+    /**
+     * @brief Run until all the spawned Tasks have completed. Rethrows
+     * the exception of the first spawned Task that failed, if any.
+     */
+    void run() {
+        loop([]() { return false; });
+        if(m_error) std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+
+    /**
+     * @brief Run a Task (along with the spawned Tasks) until it
+     * completes, and return its result.
+     */
+    template<typename T>
+    T run(Task<T> task) {
+        auto h = task.m_handle;
+        h.promise().scheduler = this;
+        m_ready.push_back(h);
+        loop([h]() { return h.done(); });
+        if(h.promise().error) std::rethrow_exception(h.promise().error);
+        return h.promise().result();
+    }
+
+    /**
+     * @brief Number of operations in flight.
+     */
+    size_t inFlight() const {
+        return m_waiting.size();
+    }
+
+    /**
+     * @brief Suspend a Task until the request completes
+     * (called when a Task awaits an AsyncRequest).
+     */
+    void suspend(const AsyncRequest& request, std::coroutine_handle<> h) {
+        m_waiting.push_back({&request, h});
+    }
+
+    /**
+     * @brief Release a spawned Task that has completed
+     * (called when the Task reaches its final suspension point).
+     */
+    void finished(std::coroutine_handle<> h, std::exception_ptr error) {
+        if(error && !m_error) m_error = error;
+        m_detached.erase(h.address());
+        h.destroy();
+    }
+
+    private:
+
+    template<typename Done>
+    void loop(Done&& done) {
+        while(true) {
+            while(!m_ready.empty()) {
+                auto h = m_ready.front();
+                m_ready.pop_front();
+                h.resume();
+            }
+            if(done() || m_waiting.empty()) return;
+            if(poll() == 0) thallium::thread::yield();
+        }
+    }
+
+    size_t poll() {
+        size_t count = 0;
+        for(size_t i = 0; i < m_waiting.size();) {
+            if(m_waiting[i].request->completed()) {
+                m_ready.push_back(m_waiting[i].handle);
+                m_waiting[i] = m_waiting.back();
+                m_waiting.pop_back();
+                count += 1;
+            } else {
+                ++i;
+            }
+        }
+        return count;
+    }
+};
+
+template<typename Promise>
+std::coroutine_handle<> detail::PromiseBase::FinalAwaiter::await_suspend(
+        std::coroutine_handle<Promise> h) noexcept {
+    auto& promise = h.promise();
+    if(promise.continuation) return promise.continuation;
+    if(promise.detached) promise.scheduler->finished(h, promise.error);
+    return std::noop_coroutine();
+}
+
+/**
+ * @brief Awaiter of an AsyncRequest (see operator co_await below).
+ */
+struct RequestAwaiter {
+
+    AsyncRequest request;
+
+    bool await_ready() const {
+        return request.completed();
+    }
+
+    template<typename Promise>
+    void await_suspend(std::coroutine_handle<Promise> h) {
+        auto scheduler = h.promise().scheduler;
+        if(!scheduler)
+            throw Exception("AsyncRequest awaited outside of a warabi::coro::Scheduler");
+        scheduler->suspend(request, h);
+    }
+
+    void await_resume() const {
+        request.wait();
+    }
+};
+
+}
+
+/**
+ * @brief Makes AsyncRequests awaitable from a warabi::coro::Task.
+ * Awaiting a request suspends the Task until the request completes,
+ * then throws if the request failed.
+ */
+inline coro::RequestAwaiter operator co_await(AsyncRequest request) {
+    return coro::RequestAwaiter{std::move(request)};
+}
+
+}
+
+#endif
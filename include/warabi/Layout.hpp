@@ -0,0 +1,502 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_LAYOUT_HPP
+#define __WARABI_LAYOUT_HPP
+
+#include <warabi/Exception.hpp>
+#include <thallium.hpp>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace warabi {
+
+struct CompactLayout;
+
+/**
+ * @brief A Layout describes the ranges of a region accessed by an
+ * operation, in the manner of MPI datatypes: a contiguous range, a
+ * vector of equally spaced blocks, a subarray of a multidimensional
+ * array stored in row-major order, or an explicit (indexed) list of
+ * offset/size pairs. The data transferred for a Layout is the content
+ * of its segments, packed in order.
+ *
+ * Only the parameters of a Layout are sent to providers, which expand
+ * it into segments by batches as they transfer the data. Indexed lists
+ * of more than s_inline_segments segments are not sent inline: the
+ * provider pulls them from the client's memory.
+ */
+class Layout {
+
+    public:
+
+    using Segments = std::vector<std::pair<size_t, size_t>>;
+
+    enum class Kind : uint8_t {
+        Contiguous,
+        Vector,
+        Subarray,
+        Indexed
+    };
+
+    /**
+     * @brief Number of segments of an indexed Layout above which its
+     * list of segments is transferred via RDMA instead of inline.
+     */
+    static constexpr size_t s_inline_segments = 1024;
+
+    /**
+     * @brief Maximum number of segments of an indexed Layout.
+     */
+    static constexpr size_t s_max_segments = size_t{1} << 24;
+
+    /**
+     * @brief Default constructor (empty contiguous range).
+     */
+    Layout() = default;
+
+    /**
+     * @brief Contiguous range of size bytes starting at offset.
+     */
+    static Layout contiguous(size_t offset, size_t size) {
+        Layout layout;
+        layout.m_offset = offset;
+        layout.m_params = {size};
+        return layout;
+    }
+
+    /**
+     * @brief count blocks of blockLength bytes, the first starting at
+     * offset and each starting stride bytes after the previous one.
+     */
+    static Layout vector(size_t offset, size_t count, size_t blockLength, size_t stride) {
+        if(count > 1 && stride < blockLength)
+            throw Exception("Invalid vector layout: stride smaller than block length");
+        Layout layout;
+        layout.m_kind   = Kind::Vector;
+        layout.m_offset = offset;
+        layout.m_params = {count, blockLength, stride};
+        return layout;
+    }
+
+    /**
+     * @brief Subarray of an array of elements of elementSize bytes stored
+     * in row-major order starting at offset. sizes are the dimensions of
+     * the array, subsizes those of the subarray, and starts the coordinates
+     * of its first element.
+     */
+    static Layout subarray(size_t offset,
+                           const std::vector<size_t>& sizes,
+                           const std::vector<size_t>& subsizes,
+                           const std::vector<size_t>& starts,
+                           size_t elementSize) {
+        auto n = sizes.size();
+        if(n == 0 || subsizes.size() != n || starts.size() != n)
+            throw Exception("Invalid subarray layout: mismatching number of dimensions");
+        for(size_t i = 0; i < n; ++i) {
+            if(starts[i] > sizes[i] || subsizes[i] > sizes[i] - starts[i])
+                throw Exception("Invalid subarray layout: subarray exceeds the array");
+        }
+        Layout layout;
+        layout.m_kind   = Kind::Subarray;
+        layout.m_offset = offset;
+        layout.m_params.assign(1, elementSize);
+        layout.m_params.reserve(3*n + 1);
+        layout.m_params.insert(layout.m_params.end(), sizes.begin(), sizes.end());
+        layout.m_params.insert(layout.m_params.end(), subsizes.begin(), subsizes.end());
+        layout.m_params.insert(layout.m_params.end(), starts.begin(), starts.end());
+        return layout;
+    }
+
+    /**
+     * @brief Explicit list of offset/size pairs.
+     */
+    static Layout indexed(Segments segments) {
+        Layout layout;
+        layout.m_kind     = Kind::Indexed;
+        layout.m_count    = segments.size();
+        layout.m_segments = std::move(segments);
+        return layout;
+    }
+
+    /**
+     * @brief Layout of a list of offset/size pairs, using the
+     * most compact kind (contiguous for a single pair).
+     */
+    static Layout fromSegments(const Segments& segments) {
+        if(segments.size() == 1)
+            return contiguous(segments[0].first, segments[0].second);
+        return indexed(segments);
+    }
+
+    Kind kind() const {
+        return m_kind;
+    }
+
+    /**
+     * @brief Offset of the first element (not meaningful for Indexed).
+     */
+    size_t offset() const {
+        return m_offset;
+    }
+
+    /**
+     * @brief Total number of bytes covered by the Layout.
+     */
+    size_t size() const {
+        switch(m_kind) {
+        case Kind::Contiguous:
+            return m_params[0];
+        case Kind::Vector:
+            return m_params[0] * m_params[1];
+        case Kind::Subarray:
+            {
+                size_t n = dimensions(), size = m_params[0];
+                for(size_t i = 0; i < n; ++i) size *= m_params[1 + n + i];
+                return size;
+            }
+        case Kind::Indexed:
+            {
+                size_t size = 0;
+                for(auto& s : m_segments) size += s.second;
+                return size;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Number of segments (upper bound, some may be empty).
+     */
+    size_t numSegments() const {
+        switch(m_kind) {
+        case Kind::Contiguous:
+            return 1;
+        case Kind::Vector:
+            return m_params[0];
+        case Kind::Subarray:
+            {
+                size_t n = dimensions(), d = innermost(), count = 1;
+                for(size_t i = 0; i < d; ++i) count *= m_params[1 + n + i];
+                return count;
+            }
+        case Kind::Indexed:
+            return m_count;
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Call f(offset, size) for each non-empty segment, in order.
+     */
+    template<typename F>
+    void forEach(F&& f) const {
+        switch(m_kind) {
+        case Kind::Contiguous:
+            if(m_params[0]) f(m_offset, m_params[0]);
+            break;
+        case Kind::Vector:
+            if(m_params[1] == 0) break;
+            for(size_t i = 0; i < m_params[0]; ++i)
+                f(m_offset + i * m_params[2], m_params[1]);
+            break;
+        case Kind::Subarray:
+            forEachRow(f);
+            break;
+        case Kind::Indexed:
+            for(auto& s : m_segments)
+                if(s.second) f(s.first, s.second);
+            break;
+        }
+    }
+
+    /**
+     * @brief Call f(segments, bytesBefore) with batches of at most
+     * maxSegments segments, bytesBefore being the number of bytes
+     * covered by the previous batches. Stops when f returns false.
+     *
+     * @return false if f returned false, true otherwise.
+     */
+    template<typename F>
+    bool forEachBatch(size_t maxSegments, F&& f) const {
+        if(m_kind == Kind::Indexed && m_segments.size() <= maxSegments)
+            return f(m_segments, (size_t)0);
+        Segments batch;
+        batch.reserve(std::min(maxSegments, numSegments()));
+        size_t before = 0, batchSize = 0;
+        bool ok = true;
+        forEach([&](size_t offset, size_t size) {
+            if(!ok) return;
+            batch.emplace_back(offset, size);
+            batchSize += size;
+            if(batch.size() < maxSegments) return;
+            ok = f(batch, before);
+            before += batchSize;
+            batchSize = 0;
+            batch.clear();
+        });
+        if(ok && !batch.empty()) ok = f(batch, before);
+        return ok;
+    }
+
+    /**
+     * @brief Explicit list of the segments of the Layout.
+     */
+    Segments expand() const {
+        if(m_kind == Kind::Indexed) return m_segments;
+        Segments segments;
+        segments.reserve(numSegments());
+        forEach([&](size_t offset, size_t size) { segments.emplace_back(offset, size); });
+        return segments;
+    }
+
+    /**
+     * @brief Check that the parameters of the Layout are consistent with
+     * its kind and that its segments do not overflow (used by providers
+     * upon reception of a Layout, before and after pull()).
+     *
+     * @throw Exception if the Layout is invalid.
+     */
+    void validate() const {
+        auto error = check();
+        if(error) throw Exception(std::string{"Invalid layout: "} + error);
+    }
+
+    /**
+     * @brief Same as validate() but returns whether the Layout is valid.
+     */
+    bool valid() const noexcept {
+        return check() == nullptr;
+    }
+
+    /**
+     * @brief Whether the list of segments must be exposed with
+     * expose() before the Layout is sent to a provider.
+     */
+    bool needsBulk() const {
+        return m_kind == Kind::Indexed && m_count > s_inline_segments && m_bulk.is_null();
+    }
+
+    /**
+     * @brief Expose the list of segments of a large indexed Layout
+     * for the provider to pull it. The Layout must remain valid
+     * until the operation it is sent with completes.
+     */
+    void expose(thallium::engine& engine) {
+        if(!needsBulk()) return;
+        std::vector<std::pair<void*, size_t>> segment{
+            {m_segments.data(), m_segments.size() * sizeof(m_segments[0])}};
+        m_bulk = engine.expose(segment, thallium::bulk_mode::read_only);
+    }
+
+    /**
+     * @brief Pull the list of segments exposed by the sender, if any
+     * (used by providers upon reception of a Layout).
+     */
+    void pull(thallium::engine& engine, const thallium::endpoint& source) {
+        if(m_bulk.is_null() || m_segments.size() == m_count) return;
+        m_segments.resize(m_count);
+        std::vector<std::pair<void*, size_t>> segment{
+            {m_segments.data(), m_segments.size() * sizeof(m_segments[0])}};
+        auto local = engine.expose(segment, thallium::bulk_mode::write_only);
+        local << m_bulk.on(source);
+        m_bulk = thallium::bulk{};
+    }
+
+    template<typename Archive>
+    void save(Archive& ar) const {
+        uint8_t kind = static_cast<uint8_t>(m_kind);
+        ar & kind;
+        if(m_kind == Kind::Indexed) {
+            ar & m_count;
+            bool inlined = m_bulk.is_null();
+            ar & inlined;
+            if(inlined)
+                ar.write(reinterpret_cast<const char*>(m_segments.data()),
+                         m_segments.size() * sizeof(m_segments[0]));
+            else
+                ar & m_bulk;
+            return;
+        }
+        ar & m_offset;
+        uint8_t numParams = m_params.size();
+        ar & numParams;
+        ar.write(reinterpret_cast<const char*>(m_params.data()),
+                 m_params.size() * sizeof(m_params[0]));
+    }
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        uint8_t kind = 0;
+        ar & kind;
+        if(kind > static_cast<uint8_t>(Kind::Indexed))
+            throw Exception("Invalid layout kind");
+        m_kind = static_cast<Kind>(kind);
+        m_count = 0;
+        m_segments.clear();
+        m_params.clear();
+        m_bulk = thallium::bulk{};
+        if(m_kind == Kind::Indexed) {
+            ar & m_count;
+            bool inlined = true;
+            ar & inlined;
+            if(inlined) {
+                // read by batches so that a bogus count fails at the end
+                // of the message instead of allocating memory for it
+                for(size_t done = 0; done < m_count;) {
+                    size_t n = std::min(m_count - done, s_inline_segments);
+                    m_segments.resize(done + n);
+                    ar.read(reinterpret_cast<char*>(m_segments.data() + done),
+                            n * sizeof(m_segments[0]));
+                    done += n;
+                }
+            } else {
+                ar & m_bulk;
+            }
+            return;
+        }
+        ar & m_offset;
+        uint8_t numParams = 0;
+        ar & numParams;
+        m_params.resize(numParams);
+        ar.read(reinterpret_cast<char*>(m_params.data()),
+                m_params.size() * sizeof(m_params[0]));
+    }
+
+    private:
+
+    friend struct CompactLayout; // encoding of the version 2 protocol
+
+    Kind                  m_kind   = Kind::Contiguous;
+    size_t                m_offset = 0;
+    std::vector<uint64_t> m_params = {0}; // depends on m_kind
+    size_t                m_count  = 0;   // number of segments (Indexed)
+    Segments              m_segments;     // Indexed
+    thallium::bulk        m_bulk;         // Indexed, large lists
+
+    /**
+     * @brief Returns a description of what makes the Layout invalid,
+     * or nullptr if it is valid.
+     */
+    const char* check() const noexcept {
+        size_t end = 0;
+        switch(m_kind) {
+        case Kind::Contiguous:
+            if(m_params.size() != 1)
+                return "contiguous layouts have 1 parameter";
+            if(__builtin_add_overflow(m_offset, m_params[0], &end))
+                return "range exceeds the addressable size";
+            return nullptr;
+        case Kind::Vector:
+            {
+                if(m_params.size() != 3)
+                    return "vector layouts have 3 parameters";
+                size_t count = m_params[0], blockLength = m_params[1], stride = m_params[2];
+                if(count > 1 && stride < blockLength)
+                    return "stride smaller than block length";
+                if(count == 0) return nullptr;
+                if(__builtin_mul_overflow(count, blockLength, &end)
+                || __builtin_mul_overflow(count - 1, stride, &end)
+                || __builtin_add_overflow(end, blockLength, &end)
+                || __builtin_add_overflow(end, m_offset, &end))
+                    return "blocks exceed the addressable size";
+                return nullptr;
+            }
+        case Kind::Subarray:
+            {
+                if(m_params.size() < 4 || (m_params.size() - 1) % 3 != 0)
+                    return "subarray layouts have 3n+1 parameters";
+                size_t n = dimensions();
+                const uint64_t* sizes    = m_params.data() + 1;
+                const uint64_t* subsizes = sizes + n;
+                const uint64_t* starts   = subsizes + n;
+                end = m_params[0];
+                for(size_t i = 0; i < n; ++i) {
+                    if(starts[i] > sizes[i] || subsizes[i] > sizes[i] - starts[i])
+                        return "subarray exceeds the array";
+                    if(__builtin_mul_overflow(end, sizes[i], &end))
+                        return "array exceeds the addressable size";
+                }
+                if(__builtin_add_overflow(end, m_offset, &end))
+                    return "array exceeds the addressable size";
+                return nullptr;
+            }
+        case Kind::Indexed:
+            {
+                if(m_count > s_max_segments)
+                    return "too many segments";
+                if(m_segments.size() != m_count) {
+                    // segments not pulled yet
+                    if(m_bulk.is_null())
+                        return "number of segments does not match their count";
+                    if(m_bulk.size() != m_count * sizeof(m_segments[0]))
+                        return "size of the list of segments does not match their count";
+                    return nullptr;
+                }
+                size_t total = 0;
+                for(auto& s : m_segments) {
+                    if(__builtin_add_overflow(s.first, s.second, &end)
+                    || __builtin_add_overflow(total, s.second, &total))
+                        return "segments exceed the addressable size";
+                }
+                return nullptr;
+            }
+        }
+        return "invalid kind";
+    }
+
+    size_t dimensions() const {
+        return (m_params.size() - 1) / 3;
+    }
+
+    /**
+     * @brief Outermost dimension of the contiguous rows of a subarray:
+     * the dimensions after it are covered entirely by the subarray.
+     */
+    size_t innermost() const {
+        size_t n = dimensions(), d = n - 1;
+        while(d > 0 && m_params[1 + n + d] == m_params[1 + d]) --d;
+        return d;
+    }
+
+    template<typename F>
+    void forEachRow(F& f) const {
+        size_t n = dimensions();
+        const uint64_t* sizes    = m_params.data() + 1;
+        const uint64_t* subsizes = sizes + n;
+        const uint64_t* starts   = subsizes + n;
+        std::vector<size_t> strides(n);
+        size_t base = m_offset;
+        for(size_t i = n; i-- > 0;) {
+            strides[i] = (i == n - 1) ? m_params[0] : strides[i + 1] * sizes[i + 1];
+            base += starts[i] * strides[i];
+        }
+        for(size_t i = 0; i < n; ++i) if(subsizes[i] == 0) return;
+        size_t d = innermost();
+        size_t row = subsizes[d] * strides[d];
+        std::vector<size_t> index(d, 0);
+        while(true) {
+            size_t offset = base;
+            for(size_t i = 0; i < d; ++i) offset += index[i] * strides[i];
+            f(offset, row);
+            size_t i = d;
+            while(i > 0) {
+                --i;
+                if(++index[i] < subsizes[i]) break;
+                index[i] = 0;
+                if(i == 0) return;
+            }
+            if(d == 0) return;
+        }
+    }
+};
+
+}
+
+#endif
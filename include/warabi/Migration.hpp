@@ -8,6 +8,8 @@
 
 #include <list>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace warabi {
 
@@ -48,6 +50,54 @@ class MigrationHandle {
     virtual void cancel() = 0;
 };
 
+/**
+ * @brief Extents of a file of a target that were modified.
+ */
+struct FileExtents {
+
+    std::string                            file;    // relative to the root
+    size_t                                 size = 0; // current size of the file
+    std::vector<std::pair<size_t, size_t>> extents;  // offsets and sizes
+};
+
+/**
+ * @brief A DirtyTracker is an abstract class representing an object
+ * that one can request from a target using target.trackChanges(), to
+ * migrate the target incrementally: the files of the target are first
+ * sent while it keeps serving requests, then a MigrationHandle locks
+ * the target and only the extents modified in the meantime are sent.
+ * Changes are tracked from the creation of the DirtyTracker until
+ * its destruction.
+ */
+class DirtyTracker {
+
+    public:
+
+    /**
+     * @brief Destructor.
+     */
+    virtual ~DirtyTracker() = default;
+
+    /**
+     * @brief Get the path relative to which
+     * the files returned by getFiles are located.
+     */
+    virtual std::string getRoot() const = 0;
+
+    /**
+     * @brief Get a list of files to migrate.
+     * The file names must be relative to the root.
+     */
+    virtual std::list<std::string> getFiles() const = 0;
+
+    /**
+     * @brief Get the extents of the files modified since the creation of
+     * the DirtyTracker or the previous call. Must be called while the
+     * target is locked by a MigrationHandle.
+     */
+    virtual std::vector<FileExtents> takeDirty() = 0;
+};
+
 }
 
 #endif
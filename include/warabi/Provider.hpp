@@ -6,8 +6,11 @@
 #ifndef __WARABI_PROVIDER_HPP
 #define __WARABI_PROVIDER_HPP
 
+#include <warabi/RegionID.hpp>
+#include <warabi/AsyncMigration.hpp>
 #include <thallium.hpp>
 #include <memory>
+#include <vector>
 
 typedef struct remi_client* remi_client_t;     // forward-define without including <remi-client.h>
 typedef struct remi_provider* remi_provider_t; // forward-define without including <remi-server.h>
@@ -102,23 +105,102 @@ class Provider {
      * The options argument should be a JSON string with the following
      * optional keys:
      *
+     * - "transport" (string): "remi" to send the files of the target
+     *   through REMI, or "rpc" to stream them through Warabi RPCs
+     *   (defaults to "remi" if the provider has a REMI client and none
+     *   of the options below that require "rpc" are given);
      * - "new_root" (string): path where to place the target in the
      *   destination (defaults to the same path as in the source);
-     * - "transfer_size" (int): size of individual transfers used by
-     *   REMI (defaults to using a single transfer for the full target);
+     * - "transfer_size" (int): size of individual transfers (defaults
+     *   to using a single transfer for the full target with REMI, and
+     *   to 4 MB chunks with "rpc");
      * - "merge_config" (object): the content of this field will be
      *   merged with the target's configuration (defaults to an empty
      *   object);
      * - "remove_source" (bool): whether to remove the target in the
      *   source provider (defaults to true);
+     * - "incremental" (bool): whether to first send the target while it
+     *   keeps serving requests, then lock it and only send the extents
+     *   modified in the meantime (defaults to false; backends that cannot
+     *   track their changes fall back to a regular migration);
+     * - "streams" (int): number of chunks sent in parallel ("rpc" only,
+     *   defaults to 1);
+     * - "max_bandwidth" (int): maximum bandwidth used by the migration,
+     *   in bytes per second ("rpc" only, defaults to 0, i.e. no limit);
+     * - "compression" (string): "sparse" to skip the 4 KB pages that only
+     *   contain zeros, or "none" ("rpc" only, defaults to "none").
+     *
+     * The options are checked before this function returns. If migration
+     * is not null, the migration then runs in the background in the pool
+     * of the provider, and migration can be used to follow its progress,
+     * wait for it, or cancel it. Otherwise the function returns once the
+     * migration has completed, and throws an Exception if it failed.
      *
      * @param address
      * @param provider_id
      * @param options
+     * @param migration Optional handle to the migration.
      */
     void migrateTarget(const std::string& address,
                        uint16_t provider_id,
-                       const std::string& options);
+                       const std::string& options,
+                       AsyncMigration* migration = nullptr);
+
+    /**
+     * @brief Migrate some regions of the target into the target of a
+     * destination provider, while they keep being read and written.
+     * Each region is first copied as a whole, then the extents written
+     * in the meantime are copied again, for a bounded number of rounds.
+     * Writes to the region are then held while the last extents are
+     * copied, after which the region is erased from this target and
+     * requests for it fail in a way that lets clients find its new
+     * location and redirect them there.
+     *
+     * The options argument is a JSON string with the following
+     * optional keys:
+     *
+     * - "max_rounds" (int): maximum number of copy rounds before the
+     *   switchover (defaults to 8);
+     * - "switchover_size" (int): number of bytes left to copy below
+     *   which the switchover happens (defaults to 4 MB);
+     * - "persist" (bool): whether to persist the regions in the
+     *   destination (defaults to false).
+     *
+     * @param regions Regions to migrate.
+     * @param address Address of the destination provider.
+     * @param provider_id Id of the destination provider.
+     * @param options Migration options.
+     *
+     * @return the RegionIDs of the regions in the destination target.
+     */
+    std::vector<RegionID> migrateRegions(const std::vector<RegionID>& regions,
+                                         const std::string& address,
+                                         uint16_t provider_id,
+                                         const std::string& options = "");
+
+    /**
+     * @brief Write the events recorded by the provider's tracer
+     * in Chrome trace JSON format (readable by chrome://tracing and
+     * https://ui.perfetto.dev). Tracing must have been enabled in the
+     * provider's configuration ("tracing": {"enabled": true}).
+     * If filename is empty, the "output" field of the tracing
+     * configuration is used.
+     *
+     * @param filename Output file.
+     */
+    void dumpTrace(const std::string& filename = "") const;
+
+    /**
+     * @brief Write the provider's binary event log into a file.
+     * The event log must have been enabled in the provider's
+     * configuration ("event_log": {"enabled": true}). If filename is
+     * empty, the "output" field of the event_log configuration is used.
+     * The resulting file can be converted into text using the
+     * warabi-decode-events program.
+     *
+     * @param filename Output file.
+     */
+    void dumpEventLog(const std::string& filename = "") const;
 
     private:
 
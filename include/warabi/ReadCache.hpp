@@ -0,0 +1,41 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_READ_CACHE_HPP
+#define __WARABI_READ_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace warabi {
+
+/**
+ * @brief Options of the client-side read cache (see Client::enableReadCache).
+ */
+struct ReadCacheOptions {
+
+    size_t   capacity     = 64*1024*1024; // maximum number of bytes cached
+    size_t   maxEntrySize = 1024*1024;    // larger reads are not cached
+    uint64_t leaseMs      = 0;            // time during which a cached range
+                                          // is served without validation
+};
+
+/**
+ * @brief Statistics of the client-side read cache.
+ */
+struct ReadCacheStats {
+
+    uint64_t hits          = 0; // reads served within the lease, without RPC
+    uint64_t validatedHits = 0; // reads served after a validation RPC
+    uint64_t misses        = 0; // reads that transferred the data
+    uint64_t invalidations = 0; // cached ranges dropped as out of date
+    uint64_t evictions     = 0; // cached ranges dropped to make room
+    size_t   entries       = 0; // number of cached ranges
+    size_t   bytes         = 0; // number of bytes cached
+};
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REQUEST_TIMINGS_HPP
+#define __WARABI_REQUEST_TIMINGS_HPP
+
+#include <cstdint>
+
+namespace warabi {
+
+/**
+ * @brief Timing breakdown of a single request.
+ *
+ * The server-side fields are only filled if the provider was
+ * configured with "report_timings": true, in which case valid
+ * is set to true. The transfer, backend, and persist times are
+ * cumulative over all the ULTs that worked on the request, hence
+ * may add up to more than the handler time when the provider's
+ * transfer manager processes a request in parallel.
+ *
+ * The provider cannot observe how long a request waited before
+ * its handler started, so queueAndNetworkNs() is computed on the
+ * client as the end-to-end latency minus the handler time.
+ */
+struct RequestTimings {
+
+    bool     valid       = false; /* server-side timings are available */
+    uint64_t handler_ns  = 0;     /* time spent in the provider's handler */
+    uint64_t transfer_ns = 0;     /* RDMA transfers and transfer buffer waits */
+    uint64_t backend_ns  = 0;     /* calls into the backend */
+    uint64_t persist_ns  = 0;     /* flushes to durable storage */
+    uint64_t total_ns    = 0;     /* end-to-end latency seen by the client */
+
+    /**
+     * @brief Time spent in the network and waiting for the
+     * provider to schedule the request's handler.
+     */
+    uint64_t queueAndNetworkNs() const {
+        return total_ns > handler_ns ? total_ns - handler_ns : 0;
+    }
+
+    template<typename Archive>
+    void serialize(Archive& a) {
+        a & valid;
+        if(valid) {
+            a & handler_ns;
+            a & transfer_ns;
+            a & backend_ns;
+            a & persist_ns;
+        }
+    }
+};
+
+/**
+ * @brief Statistics aggregated by a Client over the
+ * RequestTimings of the requests it has issued. Only the requests
+ * whose provider reported timings (valid is true) are accounted for,
+ * so that clients of providers that do not report them pay nothing.
+ */
+struct TimingStats {
+
+    struct Accumulator {
+
+        uint64_t count  = 0;
+        uint64_t sum_ns = 0;
+        uint64_t max_ns = 0;
+
+        void add(uint64_t ns) {
+            count  += 1;
+            sum_ns += ns;
+            if(ns > max_ns) max_ns = ns;
+        }
+
+        double meanNs() const {
+            return count ? static_cast<double>(sum_ns)/count : 0.0;
+        }
+    };
+
+    Accumulator total;             /* end-to-end latency */
+    Accumulator queue_and_network;
+    Accumulator handler;
+    Accumulator transfer;
+    Accumulator backend;
+    Accumulator persist;
+
+    void add(const RequestTimings& t) {
+        total.add(t.total_ns);
+        queue_and_network.add(t.queueAndNetworkNs());
+        handler.add(t.handler_ns);
+        transfer.add(t.transfer_ns);
+        backend.add(t.backend_ns);
+        persist.add(t.persist_ns);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,300 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_TARGET_GROUP_HPP
+#define __WARABI_TARGET_GROUP_HPP
+
+#include <warabi/TargetHandle.hpp>
+#include <warabi/AsyncRequest.hpp>
+#include <warabi/RegionID.hpp>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace warabi {
+
+class Client;
+class TargetGroupImpl;
+
+/**
+ * @brief Identifier of a region in a TargetGroup: the index of
+ * the target holding the region in the group, and the RegionID
+ * of the region in this target.
+ */
+struct GroupRegionID {
+
+    uint32_t target = 0;
+    RegionID region = {};
+
+    template<typename Archive>
+    void serialize(Archive& a) {
+        a & target;
+        a & region;
+    }
+};
+
+/**
+ * @brief Layout of a striped object: a large object split into
+ * fixed-size stripes stored in regions spread across the targets
+ * of a TargetGroup. The layout is also stored in a small manifest
+ * region, from which it can be reloaded with TargetGroup::openStriped.
+ */
+struct StripedObject {
+
+    GroupRegionID              manifest;       // region holding the layout
+    uint64_t                   size       = 0; // size of the object
+    uint64_t                   stripeSize = 0; // size of each stripe (except the last)
+    std::vector<GroupRegionID> stripes;        // regions holding the stripes
+};
+
+/**
+ * @brief Policy used by a TargetGroup to place new regions.
+ */
+enum class Placement {
+    /* targets are placed on a hash ring with virtual nodes, and a
+     * region goes to the first target after the hash of its key */
+    ConsistentHashing,
+    /* a region goes to the target in which the group has placed
+     * the fewest bytes */
+    LeastLoaded
+};
+
+/**
+ * @brief A TargetGroup is a set of TargetHandles across which a
+ * client spreads its regions. New regions are placed according to
+ * a Placement policy, and are identified by a GroupRegionID that
+ * records the target they were placed on, so subsequent operations
+ * go directly to this target. Batch operations are issued to all
+ * the targets in parallel.
+ *
+ * The order of the targets defines the group: clients that create
+ * groups with the same targets in the same order can exchange
+ * GroupRegionIDs, and place keys identically.
+ */
+class TargetGroup {
+
+    friend class Client;
+
+    public:
+
+    /**
+     * @brief Constructor. The resulting TargetGroup will be invalid.
+     */
+    TargetGroup();
+
+    /**
+     * @brief Copy-constructor.
+     */
+    TargetGroup(const TargetGroup&);
+
+    /**
+     * @brief Move-constructor.
+     */
+    TargetGroup(TargetGroup&&);
+
+    /**
+     * @brief Copy-assignment operator.
+     */
+    TargetGroup& operator=(const TargetGroup&);
+
+    /**
+     * @brief Move-assignment operator.
+     */
+    TargetGroup& operator=(TargetGroup&&);
+
+    /**
+     * @brief Destructor.
+     */
+    ~TargetGroup();
+
+    /**
+     * @brief Checks if the TargetGroup instance is valid.
+     */
+    operator bool() const;
+
+    /**
+     * @brief Number of targets in the group.
+     */
+    size_t size() const;
+
+    /**
+     * @brief Handle of the target at the specified index.
+     */
+    const TargetHandle& target(size_t index) const;
+
+    /**
+     * @brief Placement policy of the group.
+     */
+    Placement placement() const;
+
+    /**
+     * @brief Index of the target on which a new region with the
+     * specified key would be placed. With the LeastLoaded policy,
+     * the key is ignored. With the ConsistentHashing policy, an
+     * empty key is replaced by a per-group counter, spreading
+     * keyless regions evenly across targets.
+     */
+    size_t place(const std::string& key = "") const;
+
+    /**
+     * @brief Create a region of the specified size.
+     *
+     * @param[out] region Resulting region.
+     * @param[in] size Size of the region.
+     * @param[in] key Placement key (see place()).
+     * @param[out] req Optional request to wait on.
+     */
+    void create(GroupRegionID* region, size_t size,
+                const std::string& key = "",
+                AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Write data to a region (see TargetHandle::write).
+     */
+    void write(const GroupRegionID& region,
+               size_t regionOffset,
+               const char* data, size_t size,
+               bool persist = false,
+               AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Write segments of a region (see TargetHandle::write).
+     */
+    void write(const GroupRegionID& region,
+               const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+               const char* data,
+               bool persist = false,
+               AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Persist a range of a region (see TargetHandle::persist).
+     */
+    void persist(const GroupRegionID& region,
+                 size_t offset, size_t size,
+                 AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Create a region and write data to it
+     * (see TargetHandle::createAndWrite).
+     */
+    void createAndWrite(GroupRegionID* region,
+                        const char* data, size_t size,
+                        bool persist = false,
+                        const std::string& key = "",
+                        AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Read data from a region (see TargetHandle::read).
+     */
+    void read(const GroupRegionID& region,
+              size_t regionOffset,
+              char* data, size_t size,
+              AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Read segments of a region (see TargetHandle::read).
+     */
+    void read(const GroupRegionID& region,
+              const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+              char* data,
+              AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Erase a region.
+     */
+    void erase(const GroupRegionID& region,
+               AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Create one region per buffer, placed according to the
+     * policy of the group, and write the buffer into it. The requests
+     * are issued in parallel. If some of them fail, the exception of
+     * the first failed request is thrown once all of them completed.
+     *
+     * @param[out] regions Resulting regions (resized to the number of buffers).
+     * @param[in] buffers Pointer and size of each buffer.
+     * @param[in] persist Whether to persist the data.
+     */
+    void createAndWriteBatch(std::vector<GroupRegionID>* regions,
+                             const std::vector<std::pair<const char*, size_t>>& buffers,
+                             bool persist = false) const;
+
+    /**
+     * @brief Read the first buffers[i].second bytes of regions[i]
+     * into buffers[i].first, for all i, in parallel.
+     */
+    void readBatch(const std::vector<GroupRegionID>& regions,
+                   const std::vector<std::pair<char*, size_t>>& buffers) const;
+
+    /**
+     * @brief Erase regions in parallel.
+     */
+    void eraseBatch(const std::vector<GroupRegionID>& regions) const;
+
+    /**
+     * @brief Create a striped object from a buffer. The buffer is split
+     * into stripes of stripeSize bytes; the first stripe goes to the
+     * target on which a region with the specified key would be placed
+     * and the next ones to the following targets, round-robin. All the
+     * stripes are written in parallel, then the manifest is written to
+     * the target holding the first stripe. If some of the stripes could
+     * not be written, the stripes that were are erased and the exception
+     * of the first failed request is thrown.
+     *
+     * @param[out] object Resulting object.
+     * @param[in] data Data of the object.
+     * @param[in] size Size of the object.
+     * @param[in] stripeSize Size of the stripes (must not be 0).
+     * @param[in] persist Whether to persist the stripes and the manifest.
+     * @param[in] key Placement key (see place()).
+     */
+    void createStriped(StripedObject* object,
+                       const char* data, size_t size,
+                       size_t stripeSize,
+                       bool persist = false,
+                       const std::string& key = "") const;
+
+    /**
+     * @brief Load the layout of a striped object from its manifest.
+     *
+     * @param[out] object Resulting object.
+     * @param[in] manifest Manifest region of the object.
+     */
+    void openStriped(StripedObject* object, const GroupRegionID& manifest) const;
+
+    /**
+     * @brief Overwrite a range of a striped object. The range must be
+     * within the object. The stripes it covers are written in parallel.
+     */
+    void writeStriped(const StripedObject& object,
+                      size_t offset,
+                      const char* data, size_t size,
+                      bool persist = false) const;
+
+    /**
+     * @brief Read a range of a striped object into a buffer. The range
+     * must be within the object. The stripes it covers are read in
+     * parallel, each directly into its part of the buffer.
+     */
+    void readStriped(const StripedObject& object,
+                     size_t offset,
+                     char* data, size_t size) const;
+
+    /**
+     * @brief Erase the stripes and the manifest of a striped object.
+     */
+    void eraseStriped(const StripedObject& object) const;
+
+    private:
+
+    TargetGroup(const std::shared_ptr<TargetGroupImpl>& impl);
+
+    std::shared_ptr<TargetGroupImpl> self;
+};
+
+}
+
+#endif
@@ -13,7 +13,10 @@
 #include <warabi/Client.hpp>
 #include <warabi/Exception.hpp>
 #include <warabi/AsyncRequest.hpp>
+#include <warabi/BufferPool.hpp>
 #include <warabi/RegionID.hpp>
+#include <warabi/Layout.hpp>
+#include <warabi/AtomicOp.hpp>
 
 namespace warabi {
 
@@ -117,6 +120,23 @@ class TargetHandle {
                bool persist = false,
                AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Write data in the segments of a region described by a Layout
+     * (e.g. a strided vector or a subarray). Only the parameters of the
+     * Layout are sent to the provider, which expands it into segments.
+     *
+     * @param[in] region Region to write into.
+     * @param[in] layout Layout of the segments in the region.
+     * @param[in] data Pointer to the data to write (layout.size() bytes).
+     * @param[in] persist Whether to also persist to data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void write(const RegionID& region,
+               const Layout& layout,
+               const char* data,
+               bool persist = false,
+               AsyncRequest* req = nullptr) const;
+
     /**
      * @brief Write data in a region.
      *
@@ -163,6 +183,26 @@ class TargetHandle {
                bool persist = false,
                AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Write data pulled from a bulk handle in the segments
+     * of a region described by a Layout.
+     *
+     * @param[in] region Region to write into.
+     * @param[in] layout Layout of the segments in the region.
+     * @param[in] data Bulk handle from which to pull the data.
+     * @param[in] address Address of the process in which the data is.
+     * @param[in] bulkOffset Offset at which the data starts in the bulk handle.
+     * @param[in] persist Whether to also persist to data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void write(const RegionID& region,
+               const Layout& layout,
+               thallium::bulk data,
+               const std::string& address,
+               size_t bulkOffset,
+               bool persist = false,
+               AsyncRequest* req = nullptr) const;
+
     /**
      * @brief Persist a segment of the specified region.
      *
@@ -187,6 +227,17 @@ class TargetHandle {
                  const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
                  AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Persist the segments of a region described by a Layout.
+     *
+     * @param[in] region Region to persist.
+     * @param[in] layout Layout of the segments to persist.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void persist(const RegionID& region,
+                 const Layout& layout,
+                 AsyncRequest* req = nullptr) const;
+
     /**
      * @brief Combines create and write.
      */
@@ -207,6 +258,149 @@ class TargetHandle {
         bool persist = false,
         AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Append data to a region used as a log. The provider
+     * atomically reserves the next size bytes after the data previously
+     * appended to the region (starting at offset 0), so that concurrent
+     * appends from any number of clients never overlap, then writes the
+     * data there. Regions of the memory backend grow as needed; other
+     * backends fail the append if the region is full.
+     *
+     * @param[in] region Region to append to.
+     * @param[in] data Pointer to the data to append.
+     * @param[in] size Size to append.
+     * @param[out] offset Optional offset at which the data was written.
+     * @param[in] persist Whether to also persist to data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void append(const RegionID& region,
+                const char* data, size_t size,
+                size_t* offset = nullptr,
+                bool persist = false,
+                AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Append data pulled from a bulk handle to a region.
+     *
+     * @param[in] region Region to append to.
+     * @param[in] data Bulk handle from which to pull the data.
+     * @param[in] address Address of the process in which the data is.
+     * @param[in] bulkOffset Offset at which the data starts in the bulk handle.
+     * @param[in] size Size to append.
+     * @param[out] offset Optional offset at which the data was written.
+     * @param[in] persist Whether to also persist to data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void append(const RegionID& region,
+                thallium::bulk data,
+                const std::string& address,
+                size_t bulkOffset, size_t size,
+                size_t* offset = nullptr,
+                bool persist = false,
+                AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Atomically apply a read-modify-write operation to a word of
+     * width bytes (8 or 16) at the given offset of a region, which must
+     * be a multiple of width. Words are unsigned integers in the byte
+     * order of the provider. Atomic operations on the same word are
+     * serialized by the provider, but are not atomic with respect to
+     * regular writes to the word.
+     *
+     * @param[in] region Region containing the word.
+     * @param[in] offset Offset of the word in the region.
+     * @param[in] op Operation to apply.
+     * @param[in] width Size of the word (8 or 16).
+     * @param[in] operand Operand of the operation (width bytes).
+     * @param[in] compare Value compared with the word by
+     * AtomicOp::CompareSwap (width bytes), ignored otherwise.
+     * @param[out] previous Optional buffer receiving the value of
+     * the word before the operation (width bytes).
+     * @param[in] persist Whether to persist the word.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void atomic(const RegionID& region, size_t offset,
+                AtomicOp op, size_t width,
+                const void* operand, const void* compare,
+                void* previous,
+                bool persist = false,
+                AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Atomically apply a read-modify-write operation to the
+     * 8-byte word at the given offset of a region.
+     *
+     * @return the value of the word before the operation.
+     */
+    uint64_t atomic(const RegionID& region, size_t offset,
+                    AtomicOp op, uint64_t operand,
+                    uint64_t compare = 0,
+                    bool persist = false) const;
+
+    /**
+     * @brief Change the size of a region, keeping its content up to the
+     * smaller of its old and new sizes; bytes added are zero. Depending
+     * on the backend, the region may be moved by the provider, in which
+     * case *region is updated with its new RegionID and the old one
+     * becomes invalid. Backends may round the size up (e.g. the abtio
+     * backend rounds it up to its alignment).
+     *
+     * @param[in,out] region Region to resize.
+     * @param[in] size New size of the region.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void resize(RegionID* region, size_t size,
+                AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Copy size bytes from a region to another (or the same)
+     * region of the target. The data is copied by the provider and
+     * never transferred to the client. Ranges may overlap.
+     *
+     * @param[in] source Region to copy from.
+     * @param[in] sourceOffset Offset at which to start copying.
+     * @param[in] dest Region to copy to.
+     * @param[in] destOffset Offset at which to copy the data.
+     * @param[in] size Number of bytes to copy.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void copy(const RegionID& source, size_t sourceOffset,
+              const RegionID& dest, size_t destOffset,
+              size_t size,
+              AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Create a new region with the same size and content as an
+     * existing region. The memory backend shares the content of both
+     * regions until either of them is written.
+     *
+     * @param[in] region Region to clone.
+     * @param[out] clone RegionID of the new region.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void clone(const RegionID& region, RegionID* clone,
+               AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Copy a region of this target into a new region of the
+     * target of another provider. The provider of this target sends the
+     * region to the destination provider directly, in pipelined chunks
+     * that the destination provider pulls; the data never goes through
+     * the client. The source region is left untouched (erase it after
+     * the transfer to move the region).
+     *
+     * @param[in] region Region to transfer.
+     * @param[in] size Size of the region.
+     * @param[in] dest Handle to the destination target.
+     * @param[out] destRegion RegionID of the new region in the destination target.
+     * @param[in] persist Whether to persist the new region.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void transfer(const RegionID& region, size_t size,
+                  const TargetHandle& dest, RegionID* destRegion,
+                  bool persist = false,
+                  AsyncRequest* req = nullptr) const;
+
     /**
      * @brief Read part of a region into the provided local
      * memory buffer.
@@ -239,6 +433,20 @@ class TargetHandle {
               char* data,
               AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Read the segments of a region described by a Layout
+     * into a contiguous local buffer of layout.size() bytes.
+     *
+     * @param[in] region Region to read.
+     * @param[in] layout Layout of the segments in the region.
+     * @param[in] data Buffer into which to read.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void read(const RegionID& region,
+              const Layout& layout,
+              char* data,
+              AsyncRequest* req = nullptr) const;
+
     /**
      * @brief Read part of a region into the provided local
      * memory buffer.
@@ -279,6 +487,118 @@ class TargetHandle {
               size_t bulkOffset,
               AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief Read the segments of a region described by a Layout
+     * and push them into a bulk handle.
+     *
+     * @param[in] region Region to read.
+     * @param[in] layout Layout of the segments in the region.
+     * @param[in] data Bulk handle into which to push the data.
+     * @param[in] address Address of the process owning the bulk handle.
+     * @param[in] bulkOffset Offset at which to push in the provided bulk handle.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void read(const RegionID& region,
+              const Layout& layout,
+              thallium::bulk data,
+              const std::string& address,
+              size_t bulkOffset,
+              AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Write the content of a RegisteredBuffer (obtained from
+     * Client::bufferPool()) into a region. Above the eager threshold,
+     * the data is pulled from the buffer's bulk handle, avoiding the
+     * registration of the memory for this write.
+     *
+     * @param[in] region Region to write to.
+     * @param[in] regionOffset Offset in the region.
+     * @param[in] data Buffer to write (data.size() bytes are written).
+     * @param[in] persist Whether to also persist the written data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void write(const RegionID& region,
+               size_t regionOffset,
+               const RegisteredBuffer& data,
+               bool persist = false,
+               AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Read part of a region into a RegisteredBuffer (obtained
+     * from Client::bufferPool()). Above the eager threshold, the data
+     * is pushed into the buffer's bulk handle, avoiding the registration
+     * of the memory for this read.
+     *
+     * @param[in] region Region to read.
+     * @param[in] regionOffset Offset at which to read.
+     * @param[in] data Buffer into which to read (data.size() bytes are read).
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void read(const RegionID& region,
+              size_t regionOffset,
+              const RegisteredBuffer& data,
+              AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Write a contiguous range of a region from non-contiguous
+     * local memory segments, taken in order. Above the eager threshold,
+     * the segments are exposed as a single bulk handle instead of being
+     * copied into a contiguous buffer.
+     *
+     * @param[in] region Region to write to.
+     * @param[in] regionOffset Offset in the region.
+     * @param[in] segments Pointer/size pairs of the local memory.
+     * @param[in] persist Whether to also persist the written data.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void writeGather(const RegionID& region,
+                     size_t regionOffset,
+                     const std::vector<std::pair<const char*, size_t>>& segments,
+                     bool persist = false,
+                     AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Read a contiguous range of a region into non-contiguous
+     * local memory segments, filled in order. Several segments are
+     * exposed as a single bulk handle.
+     *
+     * @param[in] region Region to read.
+     * @param[in] regionOffset Offset at which to read.
+     * @param[in] segments Pointer/size pairs of the local memory.
+     * @param[out] req Optional request to make the call asynchronous.
+     */
+    void readScatter(const RegionID& region,
+                     size_t regionOffset,
+                     const std::vector<std::pair<char*, size_t>>& segments,
+                     AsyncRequest* req = nullptr) const;
+
+    /**
+     * @brief Start reading a range of a region into a buffer of the
+     * client's pool, so that a subsequent blocking read() of this range
+     * is served locally. Ranges are read in the order they are prefetched,
+     * with at most the readahead depth (see setReadahead) in flight; the
+     * provider is told about the others so its backend can start loading
+     * them. Prefetched ranges are expected to be read in that order:
+     * reading a range drops the ones prefetched before it. Writes and
+     * erasures issued through this TargetHandle drop the prefetched
+     * ranges of the region; writes by other clients are not detected.
+     *
+     * @param[in] region Region to read.
+     * @param[in] regionOffset Offset at which to read.
+     * @param[in] size Size to read.
+     */
+    void prefetch(const RegionID& region,
+                  size_t regionOffset, size_t size) const;
+
+    /**
+     * @brief Prefetch the first size bytes of each of the regions, in
+     * order (e.g. before reading a list of objects one after another).
+     *
+     * @param[in] regions Regions to read.
+     * @param[in] size Size to read from each region.
+     */
+    void prefetch(const std::vector<RegionID>& regions, size_t size) const;
+
     /**
      * @brief Erase a region.
      *
@@ -288,6 +608,34 @@ class TargetHandle {
     void erase(const RegionID& region,
                AsyncRequest* req = nullptr) const;
 
+    /**
+     * @brief The following functions issue the corresponding operation
+     * in a non-blocking manner and return the resulting AsyncRequest.
+     * Including warabi/Coroutines.hpp (C++20) makes AsyncRequests
+     * awaitable, e.g. co_await th.writeAsync(region, 0, data, size).
+     * Output arguments and buffers must remain valid until the
+     * request completes.
+     */
+    AsyncRequest createAsync(RegionID* region, size_t size) const;
+
+    AsyncRequest writeAsync(const RegionID& region,
+                            size_t regionOffset,
+                            const char* data, size_t size,
+                            bool persist = false) const;
+
+    AsyncRequest persistAsync(const RegionID& region,
+                              size_t offset, size_t size) const;
+
+    AsyncRequest createAndWriteAsync(RegionID* region,
+                                     const char* data, size_t size,
+                                     bool persist = false) const;
+
+    AsyncRequest readAsync(const RegionID& region,
+                           size_t regionOffset,
+                           char* data, size_t size) const;
+
+    AsyncRequest eraseAsync(const RegionID& region) const;
+
     /**
      * @brief Set the threshold for eager writes
      * (default is 2048).
@@ -300,6 +648,32 @@ class TargetHandle {
      */
     void setEagerReadThreshold(size_t size);
 
+    /**
+     * @brief Set the number of prefetched reads kept in flight (default
+     * is 4) and enable sequential readahead: if chunkSize is not 0, once
+     * a blocking read starts where the previous one ended, the next
+     * depth chunks of chunkSize bytes of the region are prefetched.
+     */
+    void setReadahead(size_t depth, size_t chunkSize = 0);
+
+    /**
+     * @brief Version of the wire protocol used with the provider. It is
+     * negotiated on the first create, write, read, or erase: version 2,
+     * which uses a more compact encoding, if the provider supports it,
+     * version 1 otherwise. Asynchronous calls do not wait for the
+     * negotiation and use version 1 until it completes. Returns 0 if
+     * it has not been negotiated yet. Operations throw if the provider
+     * predates version 1 (it does not know the question).
+     */
+    uint16_t protocolVersion() const;
+
+    /**
+     * @brief Force the version of the wire protocol used with the
+     * provider (1 or 2), e.g. to use version 1 with a provider whose
+     * version could not be determined, or 0 to negotiate it again.
+     */
+    void setProtocolVersion(uint16_t version);
+
     private:
 
     /**
@@ -27,6 +27,46 @@ typedef struct warabi_region {
     uint8_t opaque[16];
 } warabi_region_t;
 
+typedef struct warabi_target_group* warabi_target_group_t;
+#define WARABI_TARGET_GROUP_NULL ((warabi_target_group_t)0)
+
+/**
+ * @brief Region in a target group: index of the target
+ * holding the region in the group, and region in this target.
+ */
+typedef struct warabi_group_region {
+    uint32_t        target;
+    warabi_region_t region;
+} warabi_group_region_t;
+
+/**
+ * @brief Handle to the layout of a striped object
+ * (large object split into stripes across a target group).
+ */
+typedef struct warabi_striped_object* warabi_striped_object_t;
+#define WARABI_STRIPED_OBJECT_NULL ((warabi_striped_object_t)0)
+
+/**
+ * @brief Placement policy of a target group.
+ */
+typedef enum warabi_placement {
+    WARABI_PLACEMENT_CONSISTENT_HASHING,
+    WARABI_PLACEMENT_LEAST_LOADED
+} warabi_placement_t;
+
+/**
+ * @brief Read-modify-write operation applied by warabi_atomic
+ * (same order as warabi::AtomicOp).
+ */
+typedef enum warabi_atomic_op {
+    WARABI_ATOMIC_FETCH_ADD,
+    WARABI_ATOMIC_COMPARE_SWAP,
+    WARABI_ATOMIC_FETCH_AND,
+    WARABI_ATOMIC_FETCH_OR,
+    WARABI_ATOMIC_FETCH_XOR,
+    WARABI_ATOMIC_SWAP
+} warabi_atomic_op_t;
+
 /**
  * @brief Create a client.
  *
@@ -205,6 +245,152 @@ warabi_err_t warabi_create_write_bulk(
         warabi_region_t* region,
         warabi_async_request_t* req);
 
+/**
+ * @brief Atomically append data to a region: the data is written right
+ * after the data previously appended to the region, without overlapping
+ * concurrent appends.
+ *
+ * @param[in] th Target handle.
+ * @param[in] region Region to append to.
+ * @param[in] data Data to append.
+ * @param[in] size Size of the data.
+ * @param[in] persist Whether to persist the data.
+ * @param[out] offset Optional offset at which the data was written.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_append(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        const char* data, size_t size,
+        bool persist,
+        size_t* offset,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Same as warabi_append but the data is coming from
+ * an hg_bulk_t handle at a specified bulkOffset.
+ */
+warabi_err_t warabi_append_bulk(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        hg_bulk_t bulk, const char* address,
+        size_t bulkOffset, size_t size,
+        bool persist,
+        size_t* offset,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Atomically apply a read-modify-write operation to the word of
+ * width bytes (8 or 16) at a given offset (multiple of width) of a region.
+ *
+ * @param[in] th Target handle.
+ * @param[in] region Region containing the word.
+ * @param[in] offset Offset of the word in the region.
+ * @param[in] op Operation to apply.
+ * @param[in] width Size of the word.
+ * @param[in] operand Operand (width bytes).
+ * @param[in] compare Value to compare with (WARABI_ATOMIC_COMPARE_SWAP only).
+ * @param[out] previous Optional buffer receiving the previous value of the word.
+ * @param[in] persist Whether to persist the word.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_atomic(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t offset,
+        warabi_atomic_op_t op,
+        size_t width,
+        const void* operand,
+        const void* compare,
+        void* previous,
+        bool persist,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Change the size of a region. The region may be moved by the
+ * provider, in which case *region is updated with its new identifier.
+ *
+ * @param[in] th Target handle.
+ * @param[in,out] region Region to resize.
+ * @param[in] size New size of the region.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_resize(
+        warabi_target_handle_t th,
+        warabi_region_t* region,
+        size_t size,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Copy size bytes from a region to another (or the same) region
+ * of the target, without transferring them to the client.
+ *
+ * @param[in] th Target handle.
+ * @param[in] source Region to copy from.
+ * @param[in] sourceOffset Offset in the source region.
+ * @param[in] dest Region to copy to.
+ * @param[in] destOffset Offset in the destination region.
+ * @param[in] size Number of bytes to copy.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_copy(
+        warabi_target_handle_t th,
+        warabi_region_t source,
+        size_t sourceOffset,
+        warabi_region_t dest,
+        size_t destOffset,
+        size_t size,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Create a new region with the same size and content as
+ * an existing region.
+ *
+ * @param[in] th Target handle.
+ * @param[in] region Region to clone.
+ * @param[out] clone New region.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_clone(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        warabi_region_t* clone,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Copy a region of the target into a new region of another
+ * target. The source provider sends the data to the destination
+ * provider directly.
+ *
+ * @param[in] th Target handle of the source target.
+ * @param[in] region Region to transfer.
+ * @param[in] size Size of the region.
+ * @param[in] dest Target handle of the destination target.
+ * @param[in] persist Whether to persist the new region.
+ * @param[out] dest_region New region in the destination target.
+ * @param[out] req Optional asynchronous request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_transfer(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t size,
+        warabi_target_handle_t dest,
+        bool persist,
+        warabi_region_t* dest_region,
+        warabi_async_request_t* req);
+
 /**
  * @brief Read a region from a given offset.
  *
@@ -299,6 +485,33 @@ warabi_err_t warabi_wait(warabi_async_request_t req);
  */
 warabi_err_t warabi_test(warabi_async_request_t req, bool* flag);
 
+/**
+ * @brief Wait until one of the requests completes, then wait on it
+ * (freeing it), set its entry in reqs to WARABI_ASYNC_REQUEST_NULL,
+ * and set index to its position. NULL entries are ignored; if all the
+ * entries are NULL, index is set to count and the function returns
+ * immediately.
+ *
+ * @param[in] count Number of requests.
+ * @param[inout] reqs Array of requests.
+ * @param[out] index Index of the completed request.
+ *
+ * @return warabi_err_t handle (error of the completed request).
+ */
+warabi_err_t warabi_wait_any(size_t count, warabi_async_request_t* reqs, size_t* index);
+
+/**
+ * @brief Test without blocking whether all the (non-NULL) requests
+ * have completed. The caller still needs to call warabi_wait on them.
+ *
+ * @param[in] count Number of requests.
+ * @param[in] reqs Array of requests.
+ * @param[out] flag Whether all the requests completed.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_test_all(size_t count, const warabi_async_request_t* reqs, bool* flag);
+
 /**
  * @brief Set the thresdhold for using RPC messages instead of RDMA
  * for write operations on this target handle.
@@ -325,6 +538,281 @@ warabi_err_t warabi_set_eager_read_threshold(
         warabi_target_handle_t th,
         size_t size);
 
+/**
+ * @brief Set the number of prefetched reads kept in flight and enable
+ * sequential readahead by chunks of chunk_size bytes (0 disables it).
+ *
+ * @param th Target handle.
+ * @param depth Number of prefetched reads in flight.
+ * @param chunk_size Size of the reads issued by sequential readahead.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_set_readahead(
+        warabi_target_handle_t th,
+        size_t depth,
+        size_t chunk_size);
+
+/**
+ * @brief Start reading a range of a region so that a subsequent
+ * blocking warabi_read of this range is served locally.
+ *
+ * @param th Target handle.
+ * @param region Region to read.
+ * @param regionOffset Offset at which to read.
+ * @param size Size to read.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_prefetch(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t regionOffset,
+        size_t size);
+
+/**
+ * @brief Creates a group of targets across which regions are spread.
+ * The order of the targets defines the group.
+ *
+ * @param[in] client Warabi client.
+ * @param[in] count Number of targets.
+ * @param[in] addresses Address of each target.
+ * @param[in] provider_ids Provider id of each target.
+ * @param[in] placement Placement policy.
+ * @param[out] group Resulting target group.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_client_make_target_group(
+        warabi_client_t client,
+        size_t count,
+        const char* const* addresses,
+        const uint16_t* provider_ids,
+        warabi_placement_t placement,
+        warabi_target_group_t* group);
+
+/**
+ * @brief Free a target group.
+ *
+ * @param group Target group.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_target_group_free(warabi_target_group_t group);
+
+/**
+ * @brief Get the number of targets in a target group.
+ *
+ * @param[in] group Target group.
+ * @param[out] count Number of targets.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_target_group_size(
+        warabi_target_group_t group,
+        size_t* count);
+
+/**
+ * @brief Create a region in a target group. The key (which may be NULL)
+ * is used by the consistent hashing placement policy.
+ *
+ * @param[in] group Target group.
+ * @param[in] size Size of the region.
+ * @param[in] key Placement key (may be NULL).
+ * @param[out] region Resulting region.
+ * @param[out] req Optional request.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_group_create(
+        warabi_target_group_t group,
+        size_t size,
+        const char* key,
+        warabi_group_region_t* region,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Write data to a region of a target group (see warabi_write).
+ */
+warabi_err_t warabi_group_write(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        const char* data, size_t size,
+        bool persist,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Persist part of a region of a target group (see warabi_persist).
+ */
+warabi_err_t warabi_group_persist(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        size_t size,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Create a region in a target group and write data to it
+ * (see warabi_create_write). The key may be NULL.
+ */
+warabi_err_t warabi_group_create_write(
+        warabi_target_group_t group,
+        const char* key,
+        const char* data, size_t size,
+        bool persist,
+        warabi_group_region_t* region,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Read data from a region of a target group (see warabi_read).
+ */
+warabi_err_t warabi_group_read(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        char* data, size_t size,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Erase a region of a target group.
+ */
+warabi_err_t warabi_group_erase(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        warabi_async_request_t* req);
+
+/**
+ * @brief Create count regions in the target group, writing data[i]
+ * (of size sizes[i]) into regions[i]. The requests are issued in
+ * parallel and the function returns when all of them completed.
+ *
+ * @param[in] group Target group.
+ * @param[in] count Number of regions.
+ * @param[in] data Buffers.
+ * @param[in] sizes Size of the buffers.
+ * @param[in] persist Whether to persist the data.
+ * @param[out] regions Resulting regions.
+ *
+ * @return warabi_err_t handle (error of the first failed request).
+ */
+warabi_err_t warabi_group_create_write_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const char* const* data,
+        const size_t* sizes,
+        bool persist,
+        warabi_group_region_t* regions);
+
+/**
+ * @brief Read the first sizes[i] bytes of regions[i] into data[i],
+ * for i in [0, count), in parallel.
+ *
+ * @return warabi_err_t handle (error of the first failed request).
+ */
+warabi_err_t warabi_group_read_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const warabi_group_region_t* regions,
+        char* const* data,
+        const size_t* sizes);
+
+/**
+ * @brief Erase count regions in parallel.
+ *
+ * @return warabi_err_t handle (error of the first failed request).
+ */
+warabi_err_t warabi_group_erase_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const warabi_group_region_t* regions);
+
+/**
+ * @brief Create a striped object: split data into stripes of
+ * stripe_size bytes written in parallel to regions spread across the
+ * targets of the group, and write its layout into a manifest region.
+ * The key (which may be NULL) selects the target of the first stripe.
+ *
+ * @param[in] group Target group.
+ * @param[in] key Placement key (may be NULL).
+ * @param[in] data Data of the object.
+ * @param[in] size Size of the object.
+ * @param[in] stripe_size Size of the stripes.
+ * @param[in] persist Whether to persist the data.
+ * @param[out] object Resulting object (to free with warabi_striped_object_free).
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_group_create_striped(
+        warabi_target_group_t group,
+        const char* key,
+        const char* data, size_t size,
+        size_t stripe_size,
+        bool persist,
+        warabi_striped_object_t* object);
+
+/**
+ * @brief Load the layout of a striped object from its manifest region.
+ *
+ * @param[in] group Target group.
+ * @param[in] manifest Manifest region.
+ * @param[out] object Resulting object (to free with warabi_striped_object_free).
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_group_open_striped(
+        warabi_target_group_t group,
+        warabi_group_region_t manifest,
+        warabi_striped_object_t* object);
+
+/**
+ * @brief Free a striped object handle (does not erase the object).
+ */
+warabi_err_t warabi_striped_object_free(warabi_striped_object_t object);
+
+/**
+ * @brief Get the size of a striped object.
+ */
+warabi_err_t warabi_striped_object_size(
+        warabi_striped_object_t object,
+        size_t* size);
+
+/**
+ * @brief Get the manifest region of a striped object.
+ */
+warabi_err_t warabi_striped_object_manifest(
+        warabi_striped_object_t object,
+        warabi_group_region_t* manifest);
+
+/**
+ * @brief Overwrite a range of a striped object, writing the
+ * stripes it covers in parallel.
+ */
+warabi_err_t warabi_group_write_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object,
+        size_t offset,
+        const char* data, size_t size,
+        bool persist);
+
+/**
+ * @brief Read a range of a striped object, reading the
+ * stripes it covers in parallel.
+ */
+warabi_err_t warabi_group_read_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object,
+        size_t offset,
+        char* data, size_t size);
+
+/**
+ * @brief Erase the stripes and the manifest of a striped object.
+ * The handle still needs to be freed.
+ */
+warabi_err_t warabi_group_erase_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object);
+
 #ifdef __cplusplus
 }
 #endif
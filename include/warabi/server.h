@@ -7,6 +7,7 @@
 #define __WARABI_SERVER_H
 
 #include <margo.h>
+#include <stdbool.h>
 #include <warabi/error.h>
 
 #ifdef __cplusplus
@@ -19,6 +20,20 @@ typedef struct remi_provider* remi_provider_t; // forward-define without includi
 typedef struct warabi_provider* warabi_provider_t;
 #define WARABI_PROVIDER_IGNORE ((warabi_provider_t)0)
 
+typedef struct warabi_migration* warabi_migration_t;
+#define WARABI_MIGRATION_NULL ((warabi_migration_t)0)
+
+/**
+ * @brief Progress of a target migration (see warabi::AsyncMigration).
+ */
+typedef struct warabi_migration_progress {
+    size_t bytes_total;       // bytes of the target's files to transfer
+    size_t bytes_transferred; // bytes of the target's files transferred
+    size_t bytes_sent;        // bytes sent, after compression
+    double elapsed;           // seconds since the migration started
+    double throughput;        // bytes transferred per second
+} warabi_migration_progress_t;
+
 struct warabi_provider_init_args {
     ABT_pool        pool;
     remi_client_t   remi_cl;
@@ -55,12 +70,12 @@ char* warabi_provider_get_config(warabi_provider_t provider);
 
 /**
  * @brief Request that the provider migrate its target to another
- * provider.
+ * provider (see warabi::Provider::migrateTarget for the options).
  *
- * @param provider Provider whose target to migrate.
- * @param dest_addr Destination address.
- * @param dest_provider_id Destination provider ID.
- * @param migration_config Migration config.
+ * @param[in] provider Provider whose target to migrate.
+ * @param[in] dest_addr Destination address.
+ * @param[in] dest_provider_id Destination provider ID.
+ * @param[in] migration_config Migration config.
  *
  * @return warabi_err_t handle.
  */
@@ -69,6 +84,48 @@ warabi_err_t warabi_provider_migrate(warabi_provider_t provider,
                                      uint16_t dest_provider_id,
                                      const char* migration_config);
 
+/**
+ * @brief Same as warabi_provider_migrate but the migration runs in the
+ * background and must be completed with warabi_migration_wait.
+ *
+ * @param[in] provider Provider whose target to migrate.
+ * @param[in] dest_addr Destination address.
+ * @param[in] dest_provider_id Destination provider ID.
+ * @param[in] migration_config Migration config.
+ * @param[out] migration Handle to the migration.
+ *
+ * @return warabi_err_t handle.
+ */
+warabi_err_t warabi_provider_migrate_async(warabi_provider_t provider,
+                                           const char* dest_addr,
+                                           uint16_t dest_provider_id,
+                                           const char* migration_config,
+                                           warabi_migration_t* migration);
+
+/**
+ * @brief Wait for a migration to complete and free the migration handle.
+ * Returns an error if the migration failed or was cancelled.
+ */
+warabi_err_t warabi_migration_wait(warabi_migration_t migration);
+
+/**
+ * @brief Test without blocking whether a migration has completed.
+ * The caller still needs to call warabi_migration_wait.
+ */
+warabi_err_t warabi_migration_test(warabi_migration_t migration, bool* flag);
+
+/**
+ * @brief Request the cancellation of a migration.
+ * The caller still needs to call warabi_migration_wait.
+ */
+warabi_err_t warabi_migration_cancel(warabi_migration_t migration);
+
+/**
+ * @brief Get the progress of a migration.
+ */
+warabi_err_t warabi_migration_get_progress(warabi_migration_t migration,
+                                           warabi_migration_progress_t* progress);
+
 #ifdef __cplusplus
 }
 #endif
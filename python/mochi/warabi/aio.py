@@ -0,0 +1,163 @@
+"""
+Warabi asyncio module.
+
+This module lets asyncio coroutines await Warabi operations without
+blocking the event loop. Requests are issued with the asynchronous
+methods of TargetHandle, and a CompletionNotifier waits on them in a
+separate Argobots execution stream, signaling the event loop through
+an eventfd when they complete.
+
+The PyMargo engine must run network progress outside of the thread
+running the event loop, i.e. it must be created with
+use_progress_thread=True.
+
+Example
+-------
+>>> import asyncio
+>>> import mochi.margo
+>>> from mochi.warabi.client import Client
+>>> from mochi.warabi.aio import AsyncClient
+>>>
+>>> engine = mochi.margo.Engine("na+sm", mochi.margo.client,
+...                             use_progress_thread=True)
+>>> client = AsyncClient(Client(engine))
+>>>
+>>> async def main():
+...     target = client.make_target_handle("na+sm://12345", 0)
+...     region = await target.create_and_write(b"Hello, Warabi!")
+...     return await target.read(region, 0, 14)
+>>>
+>>> asyncio.run(main())
+"""
+
+import asyncio
+import _pywarabi_client
+from .client import CompletionNotifier, Exception
+
+
+class _Bridge:
+    """Resolves asyncio futures when the requests they wrap complete."""
+
+    def __init__(self, loop):
+        self._loop = loop
+        self._notifier = CompletionNotifier()
+        self._futures = {}
+        loop.add_reader(self._notifier.fileno(), self._on_ready)
+
+    def watch(self, request, result=None):
+        """
+        Return a future resolved when the AsyncRequest completes.
+        result is called (if not None) to produce the future's value.
+        """
+        future = self._loop.create_future()
+        id = self._notifier.watch(request)
+        # keeping a reference to the request keeps its buffers alive
+        self._futures[id] = (future, request, result)
+        return future
+
+    def _on_ready(self):
+        for id, error in self._notifier.drain():
+            future, _, result = self._futures.pop(id)
+            if future.cancelled():
+                continue
+            if error is not None:
+                future.set_exception(Exception(error))
+            else:
+                try:
+                    future.set_result(result() if result is not None else None)
+                except BaseException as e:
+                    future.set_exception(e)
+
+    def close(self):
+        self._loop.remove_reader(self._notifier.fileno())
+        self._notifier.close()
+
+
+class AsyncClient:
+    """
+    Wraps a Client to create target handles usable from asyncio coroutines.
+    A bridge to the event loop is created the first time a handle is used
+    in a given loop, and closed with close().
+    """
+
+    def __init__(self, client):
+        self._client = client
+        self._bridges = {}
+
+    @property
+    def client(self):
+        return self._client
+
+    def make_target_handle(self, address, provider_id):
+        """Create an AsyncTargetHandle to a remote Warabi target."""
+        return AsyncTargetHandle(
+            self, self._client.make_target_handle(address, provider_id))
+
+    def wait(self, request):
+        """Await an AsyncRequest or AsyncCreateRequest issued by any handle."""
+        if isinstance(request, _pywarabi_client.AsyncCreateRequest):
+            return self._bridge().watch(request.request, request.wait)
+        return self._bridge().watch(request)
+
+    def _bridge(self):
+        loop = asyncio.get_running_loop()
+        bridge = self._bridges.get(loop)
+        if bridge is None:
+            bridge = _Bridge(loop)
+            self._bridges[loop] = bridge
+        return bridge
+
+    def close(self):
+        """Close the bridges (waiting for the requests still in flight)."""
+        for bridge in self._bridges.values():
+            bridge.close()
+        self._bridges.clear()
+
+
+class AsyncTargetHandle:
+    """
+    TargetHandle whose operations are coroutines. Each operation is
+    issued asynchronously and the coroutine is suspended until it
+    completes, letting other tasks of the event loop run meanwhile.
+    """
+
+    def __init__(self, client, handle):
+        self._client = client
+        self._handle = handle
+
+    @property
+    def handle(self):
+        """Underlying (synchronous) TargetHandle."""
+        return self._handle
+
+    async def create(self, size):
+        return await self._client.wait(self._handle.create_async(size))
+
+    async def write(self, region, offset, data, persist=False):
+        await self._client.wait(
+            self._handle.write_async(region, offset, data, persist))
+
+    async def read_into(self, region, offset, buffer):
+        await self._client.wait(self._handle.read_async(region, offset, buffer))
+
+    async def read(self, region, offset, size):
+        buffer = bytearray(size)
+        await self.read_into(region, offset, buffer)
+        return bytes(buffer)
+
+    async def persist(self, region, offset, size):
+        await self._client.wait(self._handle.persist_async(region, offset, size))
+
+    async def erase(self, region):
+        await self._client.wait(self._handle.erase_async(region))
+
+    async def create_and_write(self, data, persist=False):
+        return await self._client.wait(
+            self._handle.create_and_write_async(data, persist))
+
+
+__all__ = [
+    'AsyncClient',
+    'AsyncTargetHandle',
+    'CompletionNotifier',
+]
@@ -35,6 +35,15 @@ TargetHandle = _pywarabi_client.TargetHandle
 RegionID = _pywarabi_client.RegionID
 AsyncRequest = _pywarabi_client.AsyncRequest
 AsyncCreateRequest = _pywarabi_client.AsyncCreateRequest
+TargetGroup = _pywarabi_client.TargetGroup
+GroupRegionID = _pywarabi_client.GroupRegionID
+Placement = _pywarabi_client.Placement
+AtomicOp = _pywarabi_client.AtomicOp
+StripedObject = _pywarabi_client.StripedObject
+CompletionNotifier = _pywarabi_client.CompletionNotifier
+ReadCacheStats = _pywarabi_client.ReadCacheStats
+RegisteredBuffer = _pywarabi_client.RegisteredBuffer
+Layout = _pywarabi_client.Layout
 Exception = _pywarabi_client.Exception
 
 __all__ = [
@@ -43,5 +52,14 @@ __all__ = [
     'RegionID',
     'AsyncRequest',
     'AsyncCreateRequest',
+    'TargetGroup',
+    'GroupRegionID',
+    'Placement',
+    'AtomicOp',
+    'StripedObject',
+    'CompletionNotifier',
+    'ReadCacheStats',
+    'RegisteredBuffer',
+    'Layout',
     'Exception',
 ]
@@ -4,10 +4,14 @@ Integration tests for Warabi Python bindings.
 Run with: python -m pytest test_warabi.py
 """
 
+import asyncio
 import unittest
 import mochi.margo
 from mochi.margo import Engine
 from mochi.warabi.client import Client, TargetHandle, RegionID, AsyncRequest, AsyncCreateRequest
+from mochi.warabi.client import TargetGroup, GroupRegionID, Placement, Layout, AtomicOp
+from mochi.warabi.client import Exception as WarabiException
+from mochi.warabi.aio import AsyncClient
 from mochi.warabi.server import Provider
 
 
@@ -82,6 +86,66 @@ class TestWarabiMemoryBackend(unittest.TestCase):
         self.target.read_into(region, offset=0, buffer=buffer)
         self.assertEqual(bytes(buffer), data)
 
+    def test_read_buffer(self):
+        """Test reading into a buffer from the client's pool."""
+        # testing both eager and bulk paths
+        for size in (64, 65536):
+            data = bytes(i % 251 for i in range(size))
+            region = self.target.create_and_write(data)
+            view = self.target.read_buffer(region, offset=0, size=size)
+            self.assertIsInstance(view, memoryview)
+            self.assertEqual(len(view), size)
+            self.assertEqual(view.tobytes(), data)
+            view.release()
+
+    def test_prefetch(self):
+        """Test reading prefetched ranges and sequential readahead."""
+        data = bytes(i % 251 for i in range(4096))
+        region = self.target.create_and_write(data)
+        self.target.prefetch(region, offset=0, size=1024)
+        self.assertEqual(self.target.read(region, offset=0, size=1024), data[:1024])
+        regions = [self.target.create_and_write(bytes([i]) * 64) for i in range(8)]
+        self.target.prefetch_regions(regions, size=64)
+        for i, r in enumerate(regions):
+            self.assertEqual(self.target.read(r, offset=0, size=64), bytes([i]) * 64)
+        self.target.set_readahead(depth=2, chunk_size=512)
+        result = b"".join(self.target.read(region, offset=o, size=512)
+                          for o in range(0, 4096, 512))
+        self.assertEqual(result, data)
+
+    def test_read_cache(self):
+        """Test reading through the client's read cache."""
+        self.client.enable_read_cache(lease_ms=0)
+        region = self.target.create_and_write(b"cached data")
+        self.assertEqual(self.target.read(region, offset=0, size=6), b"cached")
+        self.assertEqual(self.target.read(region, offset=0, size=6), b"cached")
+        self.assertEqual(self.client.read_cache_stats.validated_hits, 1)
+        self.target.write(region, offset=0, data=b"CACHED")
+        self.assertEqual(self.target.read(region, offset=0, size=6), b"CACHED")
+        self.assertEqual(self.client.read_cache_stats.misses, 2)
+        self.client.disable_read_cache()
+        self.assertEqual(self.client.read_cache_stats.entries, 0)
+
+    def test_layouts(self):
+        """Test writing and reading strided and subarray layouts."""
+        region = self.target.create(size=1024)
+        data = bytes(range(256)) * 4
+        self.target.write(region, offset=0, data=data)
+        vector = Layout.vector(offset=8, count=4, block_length=2, stride=16)
+        self.assertEqual(vector.size, 8)
+        self.assertEqual(vector.segments(), [(8, 2), (24, 2), (40, 2), (56, 2)])
+        expected = b"".join(data[o:o+2] for o in range(8, 64, 16))
+        self.assertEqual(self.target.read_layout(region, vector), expected)
+        self.target.write_layout(region, vector, b"abcdefgh", persist=True)
+        self.assertEqual(self.target.read(region, offset=24, size=2), b"cd")
+        # 2x3 block at (1, 2) of an 8x8 array of 4-byte elements
+        subarray = Layout.subarray(0, [8, 8], [2, 3], [1, 2], element_size=4)
+        self.assertEqual(subarray.segments(), [(40, 12), (72, 12)])
+        self.target.write_layout(region, subarray, b"x" * 24)
+        self.assertEqual(self.target.read(region, offset=40, size=12), b"x" * 12)
+        with self.assertRaises(WarabiException):
+            self.target.write_layout(region, vector, b"too short")
+
     def test_offset_operations(self):
         """Test reading and writing at offsets."""
         # Create a 1KB region
@@ -188,6 +252,54 @@ class TestWarabiMemoryBackend(unittest.TestCase):
         result = self.target.read(region, offset=0, size=len(data))
         self.assertEqual(result, data)
 
+    def test_append(self):
+        """Test appending to a region."""
+        region = self.target.create(size=0)
+        offsets = [self.target.append(region, bytes([65 + i]) * 10) for i in range(3)]
+        self.assertEqual(offsets, [0, 10, 20])
+        expected = b"".join(bytes([65 + i]) * 10 for i in range(3))
+        self.assertEqual(self.target.read(region, offset=0, size=30), expected)
+
+    def test_atomic(self):
+        """Test atomic read-modify-write operations."""
+        region = self.target.create(size=64)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.FETCH_ADD, 5), 0)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.FETCH_ADD, 2), 5)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.COMPARE_SWAP, 42, compare=6), 7)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.COMPARE_SWAP, 42, compare=7), 7)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.FETCH_OR, 1), 42)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.SWAP, 0), 43)
+        self.assertEqual(self.target.atomic(region, 8, AtomicOp.FETCH_ADD, 1, persist=True), 0)
+        with self.assertRaises(WarabiException):
+            self.target.atomic(region, 3, AtomicOp.FETCH_ADD, 1)
+
+    def test_resize_copy_clone(self):
+        """Test server-side resize, copy and clone of regions."""
+        data = b"0123456789abcdef"
+        region = self.target.create_and_write(data)
+        region = self.target.resize(region, 32)
+        self.assertEqual(self.target.read(region, offset=0, size=32), data + bytes(16))
+        self.target.copy(region, 0, region, 16, 16)
+        self.assertEqual(self.target.read(region, offset=16, size=16), data)
+        clone = self.target.clone(region)
+        self.target.write(region, offset=0, data=b"x" * 16)
+        self.assertEqual(self.target.read(clone, offset=0, size=16), data)
+
+    def test_protocol_version(self):
+        """Test both versions of the wire protocol."""
+        for version in [1, 2]:
+            self.target.set_protocol_version(version)
+            self.assertEqual(self.target.protocol_version, version)
+            data = b"Protocol version test"
+            region = self.target.create_and_write(data)
+            self.assertEqual(self.target.read(region, offset=0, size=len(data)), data)
+            self.target.erase(region)
+        self.target.set_protocol_version(0)
+        self.target.create(size=16)
+        self.assertEqual(self.target.protocol_version, 2)
+        with self.assertRaises(Exception):
+            self.target.set_protocol_version(3)
+
     def test_multiple_regions(self):
         """Test managing multiple regions."""
         regions = []
@@ -202,6 +314,140 @@ class TestWarabiMemoryBackend(unittest.TestCase):
             self.assertEqual(result, expected_data)
 
 
+class TestWarabiTargetGroup(unittest.TestCase):
+    """Test Warabi target groups."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        self.engine = Engine("na+sm", mochi.margo.server)
+        self.providers = [
+            Provider(
+                engine=self.engine,
+                provider_id=i,
+                config={"target": {"type": "memory"}}
+            ) for i in (1, 2, 3)
+        ]
+        self.client = Client(engine=self.engine)
+        self.targets = [(str(self.engine.addr()), i) for i in (1, 2, 3)]
+
+    def test_transfer(self):
+        """Test transferring a region between targets."""
+        source = self.client.make_target_handle(*self.targets[0])
+        dest = self.client.make_target_handle(*self.targets[1])
+        data = b"Transferred from provider to provider"
+        region = source.create_and_write(data)
+        copy = source.transfer(region, len(data), dest)
+        self.assertEqual(dest.read(copy, offset=0, size=len(data)), data)
+        self.assertEqual(source.read(region, offset=0, size=len(data)), data)
+
+    def test_consistent_hashing(self):
+        """Test that keys are placed identically by identical groups."""
+        group1 = self.client.make_target_group(self.targets)
+        group2 = self.client.make_target_group(self.targets)
+        self.assertEqual(len(group1), 3)
+        self.assertEqual(group1.placement, Placement.CONSISTENT_HASHING)
+        for i in range(32):
+            self.assertEqual(group1.place(str(i)), group2.place(str(i)))
+
+    def test_operations(self):
+        """Test single-region operations."""
+        group = self.client.make_target_group(
+            self.targets, placement=Placement.LEAST_LOADED)
+        data = b"Hello, Warabi!"
+        region = group.create_and_write(data, persist=True, key="my-key")
+        self.assertIsInstance(region, GroupRegionID)
+        self.assertLess(region.target, 3)
+        self.assertEqual(group.read(region, offset=0, size=len(data)), data)
+        buffer = bytearray(len(data))
+        group.read_into(region, offset=0, buffer=buffer)
+        self.assertEqual(bytes(buffer), data)
+        group.erase(region)
+
+    def test_batch_operations(self):
+        """Test batch operations across targets."""
+        group = self.client.make_target_group(self.targets)
+        contents = [bytes([65 + i]) * (16 + i) for i in range(12)]
+        regions = group.create_and_write_batch(contents)
+        self.assertEqual(len(regions), len(contents))
+        self.assertGreater(len(set(r.target for r in regions)), 1)
+        buffers = [bytearray(len(c)) for c in contents]
+        group.read_batch_into(regions, buffers)
+        self.assertEqual([bytes(b) for b in buffers], contents)
+        group.erase_batch(regions)
+
+    def test_striped_object(self):
+        """Test striped objects."""
+        group = self.client.make_target_group(self.targets)
+        data = bytes(i % 251 for i in range(10000))
+        obj = group.create_striped(data, stripe_size=1024)
+        self.assertEqual(obj.size, len(data))
+        self.assertEqual(len(obj.stripes), 10)
+        self.assertEqual(group.read_striped(obj, offset=0, size=len(data)), data)
+        group.write_striped(obj, offset=1000, data=b"x" * 100)
+        opened = group.open_striped(obj.manifest)
+        buffer = bytearray(200)
+        group.read_striped_into(opened, offset=950, buffer=buffer)
+        self.assertEqual(bytes(buffer), data[950:1000] + b"x" * 100 + data[1100:1150])
+        group.erase_striped(opened)
+
+
+class TestWarabiAsyncIO(unittest.TestCase):
+    """Test awaiting Warabi operations from asyncio coroutines."""
+
+    def setUp(self):
+        """Set up test fixtures."""
+        # asyncio needs network progress outside of the event loop's thread
+        self.engine = Engine("na+sm", mochi.margo.server, use_progress_thread=True)
+        self.provider = Provider(
+            engine=self.engine,
+            provider_id=45,
+            config={"target": {"type": "memory"}}
+        )
+        self.client = AsyncClient(Client(engine=self.engine))
+        self.target = self.client.make_target_handle(
+            address=str(self.engine.addr()),
+            provider_id=45
+        )
+
+    def tearDown(self):
+        """Clean up."""
+        self.client.close()
+
+    def test_operations(self):
+        """Test awaiting each operation."""
+        async def run():
+            data = b"Hello, asyncio!"
+            region = await self.target.create_and_write(data)
+            self.assertEqual(await self.target.read(region, 0, len(data)), data)
+            await self.target.write(region, 7, b"ASYNCIO")
+            await self.target.persist(region, 0, len(data))
+            buffer = bytearray(len(data))
+            await self.target.read_into(region, 0, buffer)
+            self.assertEqual(bytes(buffer), b"Hello, ASYNCIO!")
+            await self.target.erase(region)
+            region = await self.target.create(16)
+            self.assertIsInstance(region, RegionID)
+        asyncio.run(run())
+
+    def test_gather(self):
+        """Test many concurrent operations in the same event loop."""
+        async def run():
+            contents = [bytes([i % 256]) * (64 + i * 100) for i in range(32)]
+            regions = await asyncio.gather(
+                *(self.target.create_and_write(c) for c in contents))
+            results = await asyncio.gather(
+                *(self.target.read(r, 0, len(c)) for r, c in zip(regions, contents)))
+            self.assertEqual(results, contents)
+        asyncio.run(run())
+
+    def test_error(self):
+        """Test that failed requests raise in the awaiting coroutine."""
+        async def run():
+            with self.assertRaises(WarabiException):
+                await self.target.erase(RegionID(bytes([234] * 16)))
+        asyncio.run(run())
+
+
 class TestWarabiWithNumpy(unittest.TestCase):
     """Test Warabi with NumPy arrays (if available)."""
 
@@ -256,6 +502,41 @@ class TestWarabiWithNumpy(unittest.TestCase):
 
         self.np.testing.assert_array_equal(array, result_array)
 
+    def test_numpy_non_contiguous(self):
+        """Test writing from and reading into non-contiguous views."""
+        matrix = self.np.arange(64 * 64, dtype=self.np.int32).reshape(64, 64)
+        column = matrix[:, 3]
+        self.assertFalse(column.flags["C_CONTIGUOUS"])
+
+        # a column is written as if it was contiguous
+        region = self.target.create(size=column.nbytes)
+        self.target.write(region, offset=0, data=column)
+        result = self.np.frombuffer(
+            self.target.read(region, offset=0, size=column.nbytes),
+            dtype=self.np.int32)
+        self.np.testing.assert_array_equal(result, column)
+
+        # and read back into a column of another matrix
+        other = self.np.zeros((64, 64), dtype=self.np.int32)
+        self.target.read_into(region, offset=0, buffer=other[:, 5])
+        self.np.testing.assert_array_equal(other[:, 5], column)
+        self.assertEqual(int(other[:, :5].sum()), 0)
+
+        # sub-block of a matrix
+        block = matrix[8:40, 16:48]
+        region = self.target.create_and_write(block)
+        result = self.np.empty((32, 32), dtype=self.np.int32)
+        self.target.read_into(region, offset=0, buffer=result)
+        self.np.testing.assert_array_equal(result, block)
+
+    def test_numpy_read_buffer(self):
+        """Test reading into a pooled buffer viewed as a NumPy array."""
+        array = self.np.arange(4096, dtype=self.np.float64)
+        region = self.target.create_and_write(array)
+        view = self.target.read_buffer(region, offset=0, size=array.nbytes)
+        result = self.np.frombuffer(view, dtype=self.np.float64)
+        self.np.testing.assert_array_equal(array, result)
+
 
 def test_provider_config():
     """Test provider configuration retrieval."""
@@ -10,13 +10,22 @@
 
 #include <warabi/Client.hpp>
 #include <warabi/TargetHandle.hpp>
+#include <warabi/TargetGroup.hpp>
 #include <warabi/AsyncRequest.hpp>
 #include <warabi/Exception.hpp>
 #include <warabi/RegionID.hpp>
+#include <warabi/Layout.hpp>
 
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <mutex>
+#include <optional>
 #include <sstream>
 #include <string>
 
@@ -24,17 +33,21 @@
 PYBIND11_MAKE_OPAQUE(warabi::RegionID);
 
 namespace py = pybind11;
+namespace tl = thallium;
 using namespace pybind11::literals;
 
 // Wrapper class for async create operations
 class AsyncCreateRequest {
     std::shared_ptr<warabi::RegionID> m_region;
     std::shared_ptr<warabi::AsyncRequest> m_request;
+    std::shared_ptr<void> m_data; // data to keep alive, if any
 
 public:
     AsyncCreateRequest(std::shared_ptr<warabi::RegionID> region,
-                       std::shared_ptr<warabi::AsyncRequest> request)
-        : m_region(std::move(region)), m_request(std::move(request)) {}
+                       std::shared_ptr<warabi::AsyncRequest> request,
+                       std::shared_ptr<void> data = nullptr)
+        : m_region(std::move(region)), m_request(std::move(request))
+        , m_data(std::move(data)) {}
 
     warabi::RegionID wait() {
         m_request->wait();
@@ -44,8 +57,176 @@ public:
     bool completed() const {
         return m_request->completed();
     }
+
+    const std::shared_ptr<warabi::AsyncRequest>& request() const {
+        return m_request;
+    }
+};
+
+// Notifies an event loop (e.g. asyncio) of the completion of AsyncRequests.
+// Each watched request is waited on by a ULT running in an execution stream
+// owned by the notifier; when it completes, the ULT records it and writes
+// to an eventfd that the event loop monitors. The event loop then calls
+// drain() to get the requests that completed.
+class CompletionNotifier {
+
+    struct State {
+        tl::mutex                                     m_mtx;
+        std::vector<std::pair<uint64_t, std::string>> m_done; // (id, error)
+        int                                           m_fd = -1;
+    };
+
+    std::shared_ptr<State>                  m_state;
+    std::optional<tl::managed<tl::pool>>    m_pool;
+    std::optional<tl::managed<tl::xstream>> m_xstream;
+    uint64_t                                m_next_id = 0;
+    bool                                    m_closed = false;
+
+public:
+    CompletionNotifier()
+        : m_state(std::make_shared<State>()) {
+        m_state->m_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_state->m_fd < 0) {
+            throw warabi::Exception(
+                std::string{"Could not create eventfd: "} + std::strerror(errno));
+        }
+        m_pool.emplace(tl::pool::create(tl::pool::access::mpmc));
+        m_xstream.emplace(tl::xstream::create(tl::scheduler::predef::basic_wait, **m_pool));
+    }
+
+    ~CompletionNotifier() {
+        close();
+    }
+
+    int fileno() const {
+        return m_state->m_fd;
+    }
+
+    uint64_t watch(std::shared_ptr<warabi::AsyncRequest> request) {
+        if (m_closed) throw warabi::Exception("CompletionNotifier is closed");
+        if (!request || !*request) throw warabi::Exception("Invalid AsyncRequest");
+        auto id = m_next_id++;
+        auto state = m_state;
+        (*m_pool)->make_thread([state, request, id]() {
+            std::string error;
+            try {
+                request->wait();
+            } catch (const std::exception& ex) {
+                error = ex.what();
+                if (error.empty()) error = "Unknown error";
+            }
+            {
+                std::lock_guard<tl::mutex> lock{state->m_mtx};
+                state->m_done.emplace_back(id, std::move(error));
+            }
+            uint64_t one = 1;
+            [[maybe_unused]] auto r = ::write(state->m_fd, &one, sizeof(one));
+        }, tl::anonymous());
+        return id;
+    }
+
+    std::vector<std::pair<uint64_t, std::string>> drain() {
+        uint64_t count;
+        [[maybe_unused]] auto r = ::read(m_state->m_fd, &count, sizeof(count));
+        std::lock_guard<tl::mutex> lock{m_state->m_mtx};
+        return std::exchange(m_state->m_done, {});
+    }
+
+    void close() {
+        if (m_closed) return;
+        m_closed = true;
+        // waits for the requests still being watched
+        (*m_xstream)->join();
+        m_xstream.reset();
+        m_pool.reset();
+        ::close(m_state->m_fd);
+    }
+};
+
+// Buffer requested from a Python object. The buffer_info keeps the
+// memory exported until it is destroyed (with the GIL held).
+struct Buffer {
+    py::buffer_info                       info;
+    char*                                 data;     // start of the first segment
+    size_t                                size;     // total size in bytes
+    std::vector<std::pair<char*, size_t>> segments; // contiguous runs, in order
+
+    bool contiguous() const {
+        return segments.size() <= 1;
+    }
+
+    std::vector<std::pair<const char*, size_t>> constSegments() const {
+        return {segments.begin(), segments.end()};
+    }
+
+    std::string gather() const {
+        std::string result;
+        result.reserve(size);
+        for (auto& segment : segments) result.append(segment.first, segment.second);
+        return result;
+    }
 };
 
+// Helper function to split a (possibly strided) buffer into the runs
+// of memory its elements occupy, in C order. The innermost dimensions
+// that are contiguous are merged, so a C-contiguous buffer has one run.
+static std::vector<std::pair<char*, size_t>> buffer_segments(const py::buffer_info& info) {
+    std::vector<std::pair<char*, size_t>> segments;
+    for (auto extent : info.shape) {
+        if (extent == 0) return segments;
+    }
+    auto inner = info.ndim;
+    auto run = info.itemsize;
+    while (inner > 0 && info.strides[inner-1] == run) {
+        run *= info.shape[inner-1];
+        inner -= 1;
+    }
+    std::vector<py::ssize_t> index(inner, 0);
+    auto base = static_cast<char*>(info.ptr);
+    while (true) {
+        char* ptr = base;
+        for (py::ssize_t d = 0; d < inner; ++d) ptr += index[d] * info.strides[d];
+        if (!segments.empty() && segments.back().first + segments.back().second == ptr)
+            segments.back().second += run;
+        else
+            segments.emplace_back(ptr, run);
+        auto d = inner - 1;
+        while (d >= 0 && ++index[d] == info.shape[d]) {
+            index[d] = 0;
+            d -= 1;
+        }
+        if (d < 0) break;
+    }
+    return segments;
+}
+
+// Helper function to request a buffer. Non-contiguous buffers (e.g. NumPy
+// views) are only accepted if strided is true, in which case they are
+// transferred segment by segment rather than copied into contiguous memory.
+static Buffer buffer_data(const py::buffer& data, bool writable, bool strided = false) {
+    py::buffer_info info = data.request(writable);
+    if (writable && info.readonly) {
+        throw warabi::Exception("Buffer must be writable");
+    }
+    auto segments = buffer_segments(info);
+    if (!strided && segments.size() > 1) {
+        throw warabi::Exception("Buffer must be contiguous");
+    }
+    size_t size = 0;
+    for (auto& segment : segments) size += segment.second;
+    auto ptr = segments.empty() ? static_cast<char*>(info.ptr) : segments[0].first;
+    return Buffer{std::move(info), ptr, size, std::move(segments)};
+}
+
+// Helper function to allocate a bytes object to read into, avoiding
+// a copy from an intermediate buffer
+static py::bytes make_bytes(size_t size, char** data) {
+    PyObject* obj = PyBytes_FromStringAndSize(nullptr, static_cast<py::ssize_t>(size));
+    if (!obj) throw py::error_already_set();
+    *data = PyBytes_AS_STRING(obj);
+    return py::reinterpret_steal<py::bytes>(obj);
+}
+
 // Helper function to convert RegionID to Python bytes
 static py::bytes region_id_to_bytes(const warabi::RegionID& region_id) {
     return py::bytes(reinterpret_cast<const char*>(region_id.data()), region_id.size());
@@ -117,6 +298,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             AsyncRequest constructor.
             )")
         .def("wait", &warabi::AsyncRequest::wait,
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Wait for the asynchronous request to complete.
             )")
@@ -132,6 +314,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
     // Bind AsyncCreateRequest
     py::class_<AsyncCreateRequest>(m, "AsyncCreateRequest")
         .def("wait", &AsyncCreateRequest::wait,
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Wait for the asynchronous create operation to complete.
 
@@ -146,8 +329,182 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             Returns
             -------
             bool: True if completed, False otherwise.
+            )")
+        .def_property_readonly("request", &AsyncCreateRequest::request,
+            R"(
+            AsyncRequest of the create operation.
+            )");
+
+    // Bind CompletionNotifier
+    py::class_<CompletionNotifier>(m, "CompletionNotifier")
+        .def(py::init<>(),
+            R"(
+            CompletionNotifier constructor. Starts an execution stream
+            waiting on the watched requests and creates the eventfd
+            signaled when they complete.
+            )")
+        .def("fileno", &CompletionNotifier::fileno,
+            R"(
+            File descriptor that becomes readable when watched requests complete.
+            )")
+        .def("watch", &CompletionNotifier::watch,
+            R"(
+            Start watching an AsyncRequest.
+
+            Parameters
+            ----------
+            request (AsyncRequest): Request to watch (must not have been waited on).
+
+            Returns
+            -------
+            int: Identifier of the request, returned by drain() once it completes.
+            )",
+            "request"_a)
+        .def("drain",
+            [](CompletionNotifier& notifier) {
+                py::list result;
+                for (auto& [id, error] : notifier.drain()) {
+                    if (error.empty())
+                        result.append(py::make_tuple(id, py::none()));
+                    else
+                        result.append(py::make_tuple(id, error));
+                }
+                return result;
+            },
+            R"(
+            Get the requests that completed since the last call.
+
+            Returns
+            -------
+            list: (id, error) tuples, where error is None if the request
+            succeeded and the error message otherwise.
+            )")
+        .def("close", &CompletionNotifier::close,
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Wait for the watched requests, then stop the execution stream
+            and close the eventfd.
             )");
 
+    // Bind RegisteredBuffer
+    py::class_<warabi::RegisteredBuffer>(m, "RegisteredBuffer", py::buffer_protocol())
+        .def_buffer([](warabi::RegisteredBuffer& buffer) {
+            return py::buffer_info(
+                buffer.data(), 1, py::format_descriptor<uint8_t>::format(), 1,
+                {static_cast<py::ssize_t>(buffer.size())}, {1});
+        })
+        .def("__len__", &warabi::RegisteredBuffer::size);
+
+    // Bind Placement
+    py::enum_<warabi::Placement>(m, "Placement")
+        .value("CONSISTENT_HASHING", warabi::Placement::ConsistentHashing)
+        .value("LEAST_LOADED", warabi::Placement::LeastLoaded);
+
+    // Bind AtomicOp enum
+    py::enum_<warabi::AtomicOp>(m, "AtomicOp")
+        .value("FETCH_ADD", warabi::AtomicOp::FetchAdd)
+        .value("COMPARE_SWAP", warabi::AtomicOp::CompareSwap)
+        .value("FETCH_AND", warabi::AtomicOp::FetchAnd)
+        .value("FETCH_OR", warabi::AtomicOp::FetchOr)
+        .value("FETCH_XOR", warabi::AtomicOp::FetchXor)
+        .value("SWAP", warabi::AtomicOp::Swap);
+
+    // Bind GroupRegionID
+    py::class_<warabi::GroupRegionID>(m, "GroupRegionID")
+        .def(py::init<>(),
+            R"(
+            Default GroupRegionID constructor.
+            )")
+        .def(py::init([](uint32_t target, const warabi::RegionID& region) {
+                return warabi::GroupRegionID{target, region};
+            }),
+            R"(
+            GroupRegionID constructor.
+
+            Parameters
+            ----------
+            target (int): Index of the target in the group.
+            region (RegionID): Region in this target.
+            )",
+            "target"_a, "region"_a)
+        .def_readwrite("target", &warabi::GroupRegionID::target)
+        .def_readwrite("region", &warabi::GroupRegionID::region)
+        .def("__repr__", [](const warabi::GroupRegionID& rid) {
+            std::stringstream ss;
+            ss << "GroupRegionID(" << rid.target << ", ";
+            for (size_t i = 0; i < 16; ++i) {
+                ss << std::hex << std::setfill('0') << std::setw(2)
+                   << static_cast<int>(rid.region[i]);
+            }
+            ss << ")";
+            return ss.str();
+        })
+        .def("__eq__", [](const warabi::GroupRegionID& a, const warabi::GroupRegionID& b) {
+            return a.target == b.target && a.region == b.region;
+        });
+
+    // Bind StripedObject
+    py::class_<warabi::StripedObject>(m, "StripedObject")
+        .def(py::init<>())
+        .def_readonly("manifest", &warabi::StripedObject::manifest)
+        .def_readonly("size", &warabi::StripedObject::size)
+        .def_readonly("stripe_size", &warabi::StripedObject::stripeSize)
+        .def_readonly("stripes", &warabi::StripedObject::stripes)
+        .def("__len__", [](const warabi::StripedObject& object) {
+            return object.size;
+        });
+
+    // Bind Layout
+    py::class_<warabi::Layout>(m, "Layout")
+        .def(py::init<>())
+        .def_static("contiguous", &warabi::Layout::contiguous,
+            R"(
+            Contiguous range of size bytes starting at offset.
+            )",
+            "offset"_a, "size"_a)
+        .def_static("vector", &warabi::Layout::vector,
+            R"(
+            count blocks of block_length bytes, the first starting at
+            offset and each starting stride bytes after the previous one.
+            )",
+            "offset"_a, "count"_a, "block_length"_a, "stride"_a)
+        .def_static("subarray", &warabi::Layout::subarray,
+            R"(
+            Subarray of an array of elements of element_size bytes stored
+            in row-major order starting at offset.
+
+            Parameters
+            ----------
+            offset (int): Offset of the array in the region.
+            sizes (list[int]): Dimensions of the array.
+            subsizes (list[int]): Dimensions of the subarray.
+            starts (list[int]): Coordinates of the first element of the subarray.
+            element_size (int): Size of an element in bytes.
+            )",
+            "offset"_a, "sizes"_a, "subsizes"_a, "starts"_a, "element_size"_a)
+        .def_static("indexed", &warabi::Layout::indexed,
+            R"(
+            Explicit list of (offset, size) pairs.
+            )",
+            "segments"_a)
+        .def_property_readonly("size", &warabi::Layout::size)
+        .def_property_readonly("num_segments", &warabi::Layout::numSegments)
+        .def("segments", &warabi::Layout::expand,
+            R"(
+            Returns the list of (offset, size) pairs of the layout.
+            )")
+        .def("__len__", &warabi::Layout::size);
+
+    // Bind ReadCacheStats
+    py::class_<warabi::ReadCacheStats>(m, "ReadCacheStats")
+        .def_readonly("hits", &warabi::ReadCacheStats::hits)
+        .def_readonly("validated_hits", &warabi::ReadCacheStats::validatedHits)
+        .def_readonly("misses", &warabi::ReadCacheStats::misses)
+        .def_readonly("invalidations", &warabi::ReadCacheStats::invalidations)
+        .def_readonly("evictions", &warabi::ReadCacheStats::evictions)
+        .def_readonly("entries", &warabi::ReadCacheStats::entries)
+        .def_readonly("bytes", &warabi::ReadCacheStats::bytes);
+
     // Bind Client
     py::class_<warabi::Client>(m, "Client")
         .def(py::init([](const py::object& pyMargoEngine) {
@@ -165,6 +522,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             "engine"_a)
         .def("make_target_handle",
             &warabi::Client::makeTargetHandle,
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Create a TargetHandle to a remote Warabi target.
 
@@ -178,6 +536,59 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             TargetHandle: Handle to the remote target.
             )",
             "address"_a, "provider_id"_a)
+        .def("make_target_group",
+            [](const warabi::Client& client,
+               const std::vector<std::pair<std::string, uint16_t>>& targets,
+               warabi::Placement placement,
+               size_t virtual_nodes) {
+                return client.makeTargetGroup(targets, placement, virtual_nodes);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Create a TargetGroup spreading regions across several targets.
+
+            Parameters
+            ----------
+            targets (list): List of (address, provider_id) tuples.
+            placement (Placement): Placement policy (default: CONSISTENT_HASHING).
+            virtual_nodes (int): Points per target on the hash ring (default: 64).
+
+            Returns
+            -------
+            TargetGroup: Group of targets.
+            )",
+            "targets"_a, "placement"_a=warabi::Placement::ConsistentHashing,
+            "virtual_nodes"_a=64)
+        .def("enable_read_cache",
+            [](const warabi::Client& client, size_t capacity,
+               size_t max_entry_size, uint64_t lease_ms) {
+                warabi::ReadCacheOptions options;
+                options.capacity     = capacity;
+                options.maxEntrySize = max_entry_size;
+                options.leaseMs      = lease_ms;
+                client.enableReadCache(options);
+            },
+            R"(
+            Enable (or reconfigure) the read cache shared by the
+            TargetHandles of this client. Cached ranges are validated
+            against the version of their region before being served,
+            unless they were validated less than lease_ms ago.
+
+            Parameters
+            ----------
+            capacity (int): Maximum number of bytes cached (default: 64 MiB).
+            max_entry_size (int): Larger reads are not cached (default: 1 MiB).
+            lease_ms (int): Time during which a range is served without validation (default: 0).
+            )",
+            "capacity"_a=64*1024*1024, "max_entry_size"_a=1024*1024, "lease_ms"_a=0)
+        .def("disable_read_cache", &warabi::Client::disableReadCache,
+            R"(
+            Disable the read cache and drop its content.
+            )")
+        .def_property_readonly("read_cache_stats", &warabi::Client::getReadCacheStats,
+            R"(
+            Statistics of the read cache (ReadCacheStats).
+            )")
         .def("get_config", &warabi::Client::getConfig,
             R"(
             Get the client configuration as a JSON string.
@@ -200,6 +611,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
                 handle.create(&region, size);
                 return region;
             },
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Create a new region with the specified size.
 
@@ -239,14 +651,12 @@ PYBIND11_MODULE(_pywarabi_client, m) {
                size_t offset,
                const py::buffer& data,
                bool persist) {
-                py::buffer_info info = data.request();
-                if (info.ndim != 1) {
-                    throw warabi::Exception("Buffer must be 1-dimensional");
-                }
-                handle.write(region, offset,
-                            static_cast<const char*>(info.ptr),
-                            info.size * info.itemsize,
-                            persist);
+                auto buffer = buffer_data(data, false, true);
+                py::gil_scoped_release release;
+                if (buffer.contiguous())
+                    handle.write(region, offset, buffer.data, buffer.size, persist);
+                else
+                    handle.writeGather(region, offset, buffer.constSegments(), persist);
             },
             R"(
             Write data to a region.
@@ -256,6 +666,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             region (RegionID): Region to write to.
             offset (int): Offset in the region.
             data (buffer): Data to write (bytes, bytearray, memoryview, numpy array, etc.).
+                Non-contiguous arrays are transferred without being copied.
             persist (bool): Whether to persist the data (default: False).
             )",
             "region"_a, "offset"_a, "data"_a, "persist"_a=false)
@@ -265,17 +676,15 @@ PYBIND11_MODULE(_pywarabi_client, m) {
                size_t offset,
                const py::buffer& data,
                bool persist) {
-                py::buffer_info info = data.request();
-                if (info.ndim != 1) {
-                    throw warabi::Exception("Buffer must be 1-dimensional");
-                }
+                auto buffer = buffer_data(data, false, true);
                 auto req = std::make_shared<warabi::AsyncRequest>();
-                handle.write(region, offset,
-                            static_cast<const char*>(info.ptr),
-                            info.size * info.itemsize,
-                            persist, req.get());
+                if (buffer.contiguous())
+                    handle.write(region, offset, buffer.data, buffer.size, persist, req.get());
+                else
+                    handle.writeGather(region, offset, buffer.constSegments(), persist, req.get());
                 return req;
             },
+            py::keep_alive<0, 4>(),
             R"(
             Write data to a region asynchronously.
 
@@ -297,9 +706,13 @@ PYBIND11_MODULE(_pywarabi_client, m) {
                const warabi::RegionID& region,
                size_t offset,
                size_t size) {
-                std::vector<char> buffer(size);
-                handle.read(region, offset, buffer.data(), size);
-                return py::bytes(buffer.data(), size);
+                char* data = nullptr;
+                auto result = make_bytes(size, &data);
+                {
+                    py::gil_scoped_release release;
+                    handle.read(region, offset, data, size);
+                }
+                return result;
             },
             R"(
             Read data from a region.
@@ -315,21 +728,48 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             bytes: Data read from the region.
             )",
             "region"_a, "offset"_a, "size"_a)
-        .def("read_into",
+        .def("read_buffer",
             [](const warabi::TargetHandle& handle,
                const warabi::RegionID& region,
                size_t offset,
-               py::buffer& buffer) {
-                py::buffer_info info = buffer.request();
-                if (info.ndim != 1) {
-                    throw warabi::Exception("Buffer must be 1-dimensional");
-                }
-                if (info.readonly) {
-                    throw warabi::Exception("Buffer must be writable");
+               size_t size) {
+                warabi::RegisteredBuffer buffer;
+                {
+                    py::gil_scoped_release release;
+                    buffer = handle.client().bufferPool().get(size);
+                    handle.read(region, offset, buffer);
                 }
-                handle.read(region, offset,
-                           static_cast<char*>(info.ptr),
-                           info.size * info.itemsize);
+                return py::memoryview(py::cast(std::move(buffer)));
+            },
+            R"(
+            Read data from a region into a buffer taken from the client's
+            pool of registered buffers. The data is transferred directly
+            into the buffer, which returns to the pool when the memoryview
+            (and any object created from it, such as a NumPy array made
+            with numpy.frombuffer) is released.
+
+            Parameters
+            ----------
+            region (RegionID): Region to read from.
+            offset (int): Offset in the region.
+            size (int): Number of bytes to read.
+
+            Returns
+            -------
+            memoryview: Writable view of the data read.
+            )",
+            "region"_a, "offset"_a, "size"_a)
+        .def("read_into",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& region,
+               size_t offset,
+               py::buffer& data) {
+                auto buffer = buffer_data(data, true, true);
+                py::gil_scoped_release release;
+                if (buffer.contiguous())
+                    handle.read(region, offset, buffer.data, buffer.size);
+                else
+                    handle.readScatter(region, offset, buffer.segments);
             },
             R"(
             Read data from a region into a pre-allocated buffer.
@@ -339,27 +779,23 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             region (RegionID): Region to read from.
             offset (int): Offset in the region.
             buffer (writable buffer): Buffer to read into (must be writable).
+                Non-contiguous arrays are filled without an intermediate copy.
             )",
             "region"_a, "offset"_a, "buffer"_a)
         .def("read_async",
             [](const warabi::TargetHandle& handle,
                const warabi::RegionID& region,
                size_t offset,
-               py::buffer& buffer) {
-                py::buffer_info info = buffer.request();
-                if (info.ndim != 1) {
-                    throw warabi::Exception("Buffer must be 1-dimensional");
-                }
-                if (info.readonly) {
-                    throw warabi::Exception("Buffer must be writable");
-                }
+               py::buffer& data) {
+                auto buffer = buffer_data(data, true, true);
                 auto req = std::make_shared<warabi::AsyncRequest>();
-                handle.read(region, offset,
-                           static_cast<char*>(info.ptr),
-                           info.size * info.itemsize,
-                           req.get());
+                if (buffer.contiguous())
+                    handle.read(region, offset, buffer.data, buffer.size, req.get());
+                else
+                    handle.readScatter(region, offset, buffer.segments, req.get());
                 return req;
             },
+            py::keep_alive<0, 4>(),
             R"(
             Read data from a region asynchronously into a buffer.
 
@@ -382,6 +818,7 @@ PYBIND11_MODULE(_pywarabi_client, m) {
                size_t size) {
                 handle.persist(region, offset, size);
             },
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Persist a segment of a region.
 
@@ -415,12 +852,79 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             AsyncRequest: Asynchronous request handle.
             )",
             "region"_a, "offset"_a, "size"_a)
+        // Layout operations
+        .def("write_layout",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& region,
+               const warabi::Layout& layout,
+               const py::buffer& data,
+               bool persist) {
+                auto buffer = buffer_data(data, false);
+                if (buffer.size != layout.size())
+                    throw warabi::Exception("Buffer size does not match the layout");
+                py::gil_scoped_release release;
+                handle.write(region, layout, buffer.data, persist);
+            },
+            R"(
+            Write data to the segments of a region described by a Layout.
+
+            Parameters
+            ----------
+            region (RegionID): Region to write to.
+            layout (Layout): Layout of the segments in the region.
+            data (buffer): Contiguous data to write (layout.size bytes).
+            persist (bool): Whether to persist the data (default: False).
+            )",
+            "region"_a, "layout"_a, "data"_a, "persist"_a=false)
+        .def("read_layout",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& region,
+               const warabi::Layout& layout) {
+                char* data = nullptr;
+                auto size = layout.size();
+                auto result = make_bytes(size, &data);
+                {
+                    py::gil_scoped_release release;
+                    handle.read(region, layout, data);
+                }
+                return result;
+            },
+            R"(
+            Read the segments of a region described by a Layout.
+
+            Parameters
+            ----------
+            region (RegionID): Region to read from.
+            layout (Layout): Layout of the segments in the region.
+
+            Returns
+            -------
+            bytes: Content of the segments, packed in order.
+            )",
+            "region"_a, "layout"_a)
+        .def("persist_layout",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& region,
+               const warabi::Layout& layout) {
+                handle.persist(region, layout);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Persist the segments of a region described by a Layout.
+
+            Parameters
+            ----------
+            region (RegionID): Region to persist.
+            layout (Layout): Layout of the segments in the region.
+            )",
+            "region"_a, "layout"_a)
         // Erase operations
         .def("erase",
             [](const warabi::TargetHandle& handle,
                const warabi::RegionID& region) {
                 handle.erase(region);
             },
+            py::call_guard<py::gil_scoped_release>(),
             R"(
             Erase a region.
 
@@ -453,15 +957,17 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             [](const warabi::TargetHandle& handle,
                const py::buffer& data,
                bool persist) {
-                py::buffer_info info = data.request();
-                if (info.ndim != 1) {
-                    throw warabi::Exception("Buffer must be 1-dimensional");
-                }
+                auto buffer = buffer_data(data, false, true);
                 warabi::RegionID region;
-                handle.createAndWrite(&region,
-                                     static_cast<const char*>(info.ptr),
-                                     info.size * info.itemsize,
-                                     persist);
+                {
+                    py::gil_scoped_release release;
+                    if (buffer.contiguous()) {
+                        handle.createAndWrite(&region, buffer.data, buffer.size, persist);
+                    } else {
+                        auto contiguous = buffer.gather();
+                        handle.createAndWrite(&region, contiguous.data(), contiguous.size(), persist);
+                    }
+                }
                 return region;
             },
             R"(
@@ -469,7 +975,8 @@ PYBIND11_MODULE(_pywarabi_client, m) {
 
             Parameters
             ----------
-            data (buffer): Data to write.
+            data (buffer): Data to write (non-contiguous arrays are copied
+                into contiguous memory first).
             persist (bool): Whether to persist the data (default: False).
 
             Returns
@@ -477,6 +984,182 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             RegionID: ID of the created region.
             )",
             "data"_a, "persist"_a=false)
+        .def("create_and_write_async",
+            [](const warabi::TargetHandle& handle,
+               const py::buffer& data,
+               bool persist) {
+                auto buffer = buffer_data(data, false, true);
+                auto region = std::make_shared<warabi::RegionID>();
+                auto req = std::make_shared<warabi::AsyncRequest>();
+                if (buffer.contiguous()) {
+                    handle.createAndWrite(region.get(), buffer.data, buffer.size,
+                                          persist, req.get());
+                    return AsyncCreateRequest(region, req);
+                }
+                // a single RPC needs contiguous data: gather the segments
+                // into a copy that lives as long as the request
+                auto contiguous = std::make_shared<std::string>(buffer.gather());
+                handle.createAndWrite(region.get(), contiguous->data(), contiguous->size(),
+                                      persist, req.get());
+                return AsyncCreateRequest(region, req, contiguous);
+            },
+            py::keep_alive<0, 2>(),
+            R"(
+            Create a new region and write data to it asynchronously.
+
+            Parameters
+            ----------
+            data (buffer): Data to write (kept alive until the request completes).
+            persist (bool): Whether to persist the data (default: False).
+
+            Returns
+            -------
+            AsyncCreateRequest: Async request that can be waited on to get the RegionID.
+            )",
+            "data"_a, "persist"_a=false)
+        // Append
+        .def("append",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& region,
+               const py::buffer& data,
+               bool persist) {
+                auto buffer = buffer_data(data, false, true);
+                size_t offset = 0;
+                {
+                    py::gil_scoped_release release;
+                    if (buffer.contiguous()) {
+                        handle.append(region, buffer.data, buffer.size, &offset, persist);
+                    } else {
+                        auto contiguous = buffer.gather();
+                        handle.append(region, contiguous.data(), contiguous.size(), &offset, persist);
+                    }
+                }
+                return offset;
+            },
+            R"(
+            Atomically append data to a region, right after the data
+            previously appended to it.
+
+            Parameters
+            ----------
+            region (RegionID): Region to append to.
+            data (buffer): Data to append.
+            persist (bool): Whether to persist the data (default: False).
+
+            Returns
+            -------
+            int: Offset at which the data was written in the region.
+            )",
+            "region"_a, "data"_a, "persist"_a=false)
+        // Atomic operations
+        .def("atomic",
+            [](const warabi::TargetHandle& handle, const warabi::RegionID& region,
+               size_t offset, warabi::AtomicOp op, uint64_t operand, uint64_t compare,
+               bool persist) {
+                return handle.atomic(region, offset, op, operand, compare, persist);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Atomically apply a read-modify-write operation to the 8-byte
+            unsigned integer at the given offset (multiple of 8) of a region.
+
+            Parameters
+            ----------
+            region (RegionID): Region containing the integer.
+            offset (int): Offset of the integer in the region.
+            op (AtomicOp): Operation to apply.
+            operand (int): Operand of the operation.
+            compare (int): Value compared with by COMPARE_SWAP (default: 0).
+            persist (bool): Whether to persist the integer (default: False).
+
+            Returns
+            -------
+            int: Value of the integer before the operation.
+            )",
+            "region"_a, "offset"_a, "op"_a, "operand"_a, "compare"_a=0, "persist"_a=false)
+        .def("resize",
+            [](const warabi::TargetHandle& handle, warabi::RegionID region, size_t size) {
+                handle.resize(&region, size);
+                return region;
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Change the size of a region, keeping its content up to the
+            smaller of its old and new sizes. The region may be moved.
+
+            Parameters
+            ----------
+            region (RegionID): Region to resize.
+            size (int): New size of the region.
+
+            Returns
+            -------
+            RegionID: RegionID of the resized region, to use from now on.
+            )",
+            "region"_a, "size"_a)
+        .def("copy",
+            [](const warabi::TargetHandle& handle,
+               const warabi::RegionID& source, size_t source_offset,
+               const warabi::RegionID& dest, size_t dest_offset, size_t size) {
+                handle.copy(source, source_offset, dest, dest_offset, size);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Copy bytes from a region to another (or the same) region,
+            without transferring them to the client.
+
+            Parameters
+            ----------
+            source (RegionID): Region to copy from.
+            source_offset (int): Offset in the source region.
+            dest (RegionID): Region to copy to.
+            dest_offset (int): Offset in the destination region.
+            size (int): Number of bytes to copy.
+            )",
+            "source"_a, "source_offset"_a, "dest"_a, "dest_offset"_a, "size"_a)
+        .def("clone",
+            [](const warabi::TargetHandle& handle, const warabi::RegionID& region) {
+                warabi::RegionID clone;
+                handle.clone(region, &clone);
+                return clone;
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Create a new region with the same size and content as a region.
+
+            Parameters
+            ----------
+            region (RegionID): Region to clone.
+
+            Returns
+            -------
+            RegionID: RegionID of the new region.
+            )",
+            "region"_a)
+        .def("transfer",
+            [](const warabi::TargetHandle& handle, const warabi::RegionID& region,
+               size_t size, const warabi::TargetHandle& dest, bool persist) {
+                warabi::RegionID dest_region;
+                handle.transfer(region, size, dest, &dest_region, persist);
+                return dest_region;
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Copy a region into a new region of another target. The data
+            is sent from provider to provider without going through the client.
+
+            Parameters
+            ----------
+            region (RegionID): Region to transfer.
+            size (int): Size of the region.
+            dest (TargetHandle): Destination target.
+            persist (bool): Whether to persist the new region (default: False).
+
+            Returns
+            -------
+            RegionID: RegionID of the new region in the destination target.
+            )",
+            "region"_a, "size"_a, "dest"_a, "persist"_a=false)
         // Threshold setters
         .def("set_eager_write_threshold",
             &warabi::TargetHandle::setEagerWriteThreshold,
@@ -498,7 +1181,352 @@ PYBIND11_MODULE(_pywarabi_client, m) {
             size (int): Threshold size in bytes.
             )",
             "size"_a)
+        .def("set_readahead",
+            &warabi::TargetHandle::setReadahead,
+            R"(
+            Set the number of prefetched reads kept in flight and enable
+            sequential readahead: once a read starts where the previous one
+            ended, the next chunks of the region are read in advance.
+
+            Parameters
+            ----------
+            depth (int): Number of prefetched reads in flight (default: 4).
+            chunk_size (int): Size of the readahead chunks, 0 to disable (default: 0).
+            )",
+            "depth"_a=4, "chunk_size"_a=0)
+        .def_property_readonly("protocol_version",
+            &warabi::TargetHandle::protocolVersion,
+            R"(
+            Version of the wire protocol used with the provider (2 if the
+            provider supports the compact encoding, 1 otherwise), or 0 if
+            it has not been negotiated yet.
+            )")
+        .def("set_protocol_version",
+            &warabi::TargetHandle::setProtocolVersion,
+            R"(
+            Force the version of the wire protocol used with the provider.
+
+            Parameters
+            ----------
+            version (int): 1, 2, or 0 to negotiate it again.
+            )",
+            "version"_a)
+        .def("prefetch",
+            [](const warabi::TargetHandle& handle, const warabi::RegionID& region,
+               size_t offset, size_t size) {
+                handle.prefetch(region, offset, size);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Start reading a range of a region so that a subsequent read
+            of this range is served locally. Prefetched ranges are expected
+            to be read in the order they were prefetched.
+
+            Parameters
+            ----------
+            region (RegionID): Region to read.
+            offset (int): Offset at which to read.
+            size (int): Size to read.
+            )",
+            "region"_a, "offset"_a, "size"_a)
+        .def("prefetch_regions",
+            [](const warabi::TargetHandle& handle,
+               const std::vector<warabi::RegionID>& regions, size_t size) {
+                handle.prefetch(regions, size);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Prefetch the first bytes of each of the regions, in order.
+
+            Parameters
+            ----------
+            regions (list): Regions to read.
+            size (int): Size to read from each region.
+            )",
+            "regions"_a, "size"_a)
         .def("__bool__", [](const warabi::TargetHandle& handle) {
             return static_cast<bool>(handle);
         });
+
+    // Bind TargetGroup
+    py::class_<warabi::TargetGroup>(m, "TargetGroup")
+        .def(py::init<>(),
+            R"(
+            Default TargetGroup constructor (creates invalid group).
+            )")
+        .def("__len__", &warabi::TargetGroup::size)
+        .def("__bool__", [](const warabi::TargetGroup& group) {
+            return static_cast<bool>(group);
+        })
+        .def("target", &warabi::TargetGroup::target,
+            R"(
+            Get the TargetHandle at the specified index.
+            )",
+            "index"_a)
+        .def_property_readonly("placement", &warabi::TargetGroup::placement)
+        .def("place", &warabi::TargetGroup::place,
+            R"(
+            Get the index of the target a new region with this key would go to.
+            )",
+            "key"_a="")
+        .def("create",
+            [](const warabi::TargetGroup& group, size_t size, const std::string& key) {
+                warabi::GroupRegionID region;
+                group.create(&region, size, key);
+                return region;
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Create a new region with the specified size.
+
+            Parameters
+            ----------
+            size (int): Size of the region to create.
+            key (str): Placement key (default: none).
+
+            Returns
+            -------
+            GroupRegionID: ID of the created region.
+            )",
+            "size"_a, "key"_a="")
+        .def("write",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& region,
+               size_t offset,
+               const py::buffer& data,
+               bool persist) {
+                auto buffer = buffer_data(data, false);
+                py::gil_scoped_release release;
+                group.write(region, offset, buffer.data, buffer.size, persist);
+            },
+            R"(
+            Write data to a region.
+            )",
+            "region"_a, "offset"_a, "data"_a, "persist"_a=false)
+        .def("read",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& region,
+               size_t offset,
+               size_t size) {
+                char* data = nullptr;
+                auto result = make_bytes(size, &data);
+                {
+                    py::gil_scoped_release release;
+                    group.read(region, offset, data, size);
+                }
+                return result;
+            },
+            R"(
+            Read data from a region.
+            )",
+            "region"_a, "offset"_a, "size"_a)
+        .def("read_into",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& region,
+               size_t offset,
+               py::buffer& data) {
+                auto buffer = buffer_data(data, true);
+                py::gil_scoped_release release;
+                group.read(region, offset, buffer.data, buffer.size);
+            },
+            R"(
+            Read data from a region into a pre-allocated buffer.
+            )",
+            "region"_a, "offset"_a, "buffer"_a)
+        .def("persist",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& region,
+               size_t offset,
+               size_t size) {
+                group.persist(region, offset, size);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Persist a segment of a region.
+            )",
+            "region"_a, "offset"_a, "size"_a)
+        .def("erase",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& region) {
+                group.erase(region);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Erase a region.
+            )",
+            "region"_a)
+        .def("create_and_write",
+            [](const warabi::TargetGroup& group,
+               const py::buffer& data,
+               bool persist,
+               const std::string& key) {
+                auto buffer = buffer_data(data, false);
+                warabi::GroupRegionID region;
+                {
+                    py::gil_scoped_release release;
+                    group.createAndWrite(&region, buffer.data, buffer.size, persist, key);
+                }
+                return region;
+            },
+            R"(
+            Create a new region and write data to it in one operation.
+            )",
+            "data"_a, "persist"_a=false, "key"_a="")
+        .def("create_and_write_batch",
+            [](const warabi::TargetGroup& group,
+               const std::vector<py::buffer>& data,
+               bool persist) {
+                std::vector<Buffer> held;
+                std::vector<std::pair<const char*, size_t>> buffers;
+                for (auto& d : data) {
+                    held.push_back(buffer_data(d, false));
+                    buffers.emplace_back(held.back().data, held.back().size);
+                }
+                std::vector<warabi::GroupRegionID> regions;
+                {
+                    py::gil_scoped_release release;
+                    group.createAndWriteBatch(&regions, buffers, persist);
+                }
+                return regions;
+            },
+            R"(
+            Create one region per buffer and write the buffer into it,
+            issuing the requests to all the targets in parallel.
+
+            Parameters
+            ----------
+            data (list): Buffers to write.
+            persist (bool): Whether to persist the data (default: False).
+
+            Returns
+            -------
+            list: GroupRegionID of each buffer.
+            )",
+            "data"_a, "persist"_a=false)
+        .def("read_batch_into",
+            [](const warabi::TargetGroup& group,
+               const std::vector<warabi::GroupRegionID>& regions,
+               const std::vector<py::buffer>& data) {
+                std::vector<Buffer> held;
+                std::vector<std::pair<char*, size_t>> buffers;
+                for (auto& d : data) {
+                    held.push_back(buffer_data(d, true));
+                    buffers.emplace_back(held.back().data, held.back().size);
+                }
+                py::gil_scoped_release release;
+                group.readBatch(regions, buffers);
+            },
+            R"(
+            Read the beginning of each region into the corresponding
+            buffer, issuing the requests to all the targets in parallel.
+            )",
+            "regions"_a, "buffers"_a)
+        .def("erase_batch",
+            [](const warabi::TargetGroup& group,
+               const std::vector<warabi::GroupRegionID>& regions) {
+                group.eraseBatch(regions);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Erase regions, issuing the requests to all the targets in parallel.
+            )",
+            "regions"_a)
+        .def("create_striped",
+            [](const warabi::TargetGroup& group,
+               const py::buffer& data,
+               size_t stripe_size,
+               bool persist,
+               const std::string& key) {
+                auto buffer = buffer_data(data, false);
+                warabi::StripedObject object;
+                {
+                    py::gil_scoped_release release;
+                    group.createStriped(&object, buffer.data, buffer.size,
+                                        stripe_size, persist, key);
+                }
+                return object;
+            },
+            R"(
+            Create a striped object: split the data into stripes written
+            in parallel across the targets, and write its layout into a
+            manifest region.
+
+            Parameters
+            ----------
+            data (buffer): Data of the object.
+            stripe_size (int): Size of the stripes.
+            persist (bool): Whether to persist the data (default: False).
+            key (str): Placement key of the first stripe (default: none).
+
+            Returns
+            -------
+            StripedObject: Layout of the object.
+            )",
+            "data"_a, "stripe_size"_a, "persist"_a=false, "key"_a="")
+        .def("open_striped",
+            [](const warabi::TargetGroup& group,
+               const warabi::GroupRegionID& manifest) {
+                warabi::StripedObject object;
+                group.openStriped(&object, manifest);
+                return object;
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Load the layout of a striped object from its manifest region.
+            )",
+            "manifest"_a)
+        .def("write_striped",
+            [](const warabi::TargetGroup& group,
+               const warabi::StripedObject& object,
+               size_t offset,
+               const py::buffer& data,
+               bool persist) {
+                auto buffer = buffer_data(data, false);
+                py::gil_scoped_release release;
+                group.writeStriped(object, offset, buffer.data, buffer.size, persist);
+            },
+            R"(
+            Overwrite a range of a striped object.
+            )",
+            "object"_a, "offset"_a, "data"_a, "persist"_a=false)
+        .def("read_striped",
+            [](const warabi::TargetGroup& group,
+               const warabi::StripedObject& object,
+               size_t offset,
+               size_t size) {
+                char* data = nullptr;
+                auto result = make_bytes(size, &data);
+                {
+                    py::gil_scoped_release release;
+                    group.readStriped(object, offset, data, size);
+                }
+                return result;
+            },
+            R"(
+            Read a range of a striped object.
+            )",
+            "object"_a, "offset"_a, "size"_a)
+        .def("read_striped_into",
+            [](const warabi::TargetGroup& group,
+               const warabi::StripedObject& object,
+               size_t offset,
+               py::buffer& data) {
+                auto buffer = buffer_data(data, true);
+                py::gil_scoped_release release;
+                group.readStriped(object, offset, buffer.data, buffer.size);
+            },
+            R"(
+            Read a range of a striped object into a pre-allocated buffer.
+            )",
+            "object"_a, "offset"_a, "buffer"_a)
+        .def("erase_striped",
+            [](const warabi::TargetGroup& group,
+               const warabi::StripedObject& object) {
+                group.eraseStriped(object);
+            },
+            py::call_guard<py::gil_scoped_release>(),
+            R"(
+            Erase the stripes and the manifest of a striped object.
+            )",
+            "object"_a);
 }
@@ -13,6 +13,7 @@
 #include <sys/stat.h>
 #include "AbtIOBackend.hpp"
 #include "Defer.hpp"
+#include "Tracing.hpp"
 #include <nlohmann/json.hpp>
 #include <nlohmann/json-schema.hpp>
 #include <fmt/format.h>
@@ -56,6 +57,7 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
     size_t           m_region_offset;
 
     ~AbtIORegion() {
+        m_owner->m_region_locks.get(m_id).unlock();
         m_owner->m_migration_lock.unlock();
     }
 
@@ -86,7 +88,10 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
         }
         // LCOV_EXCL_STOP
         auto localBulk = m_owner->m_engine.expose({{data, size}}, thallium::bulk_mode::write_only);
-        localBulk << remoteBulk.on(address)(remoteBulkOffset, size);
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk << remoteBulk.on(address)(remoteBulkOffset, size);
+        }
         result = write(regionOffsetSizes, data, persist);
         free(data);
         return result;
@@ -102,26 +107,32 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
 
         const char* ptr = static_cast<const char*>(data);
         size_t offset = 0;
-        for(const auto& seg : regionOffsetSizes) {
-            ssize_t remaining = seg.second;
-            while(remaining) {
-                auto s = abt_io_pwrite(
-                    m_owner->m_abtio,
-                    m_owner->m_fd,
-                    ptr + offset,
-                    remaining,
-                    m_region_offset + seg.first);
-                if(s <= 0) {
-                    result.success() = false;
-                    result.error() = fmt::format(
-                        "abt_io_pwrite failed in write: {}", strerror(-s));
-                    return result;
+        {
+            TraceSpan span{"pwrite", TraceStage::Backend};
+            for(const auto& seg : regionOffsetSizes) {
+                // recorded up front so that a partial write is sent too
+                m_owner->m_dirty.add(m_region_offset + seg.first, seg.second);
+                ssize_t remaining = seg.second;
+                while(remaining) {
+                    auto s = abt_io_pwrite(
+                        m_owner->m_abtio,
+                        m_owner->m_fd,
+                        ptr + offset,
+                        remaining,
+                        m_region_offset + seg.first);
+                    if(s <= 0) {
+                        result.success() = false;
+                        result.error() = fmt::format(
+                            "abt_io_pwrite failed in write: {}", strerror(-s));
+                        return result;
+                    }
+                    offset += s;
+                    remaining -= s;
                 }
-                offset += s;
-                remaining -= s;
             }
         }
         if(persist) {
+            TraceSpan span{"fdatasync", TraceStage::Persist};
             auto ret = abt_io_fdatasync(m_owner->m_abtio, m_owner->m_fd);
             if(ret != 0) {
                 result.success() = false;
@@ -135,6 +146,7 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) override {
         (void)regionOffsetSizes;
         Result<bool> result;
+        TraceSpan span{"fdatasync", TraceStage::Persist};
         int ret = abt_io_fdatasync(m_owner->m_abtio, m_owner->m_fd);
         if(ret != 0) {
             result.success() = false;
@@ -165,7 +177,10 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
             return result;
         }
         auto localBulk = m_owner->m_engine.expose({{data, size}}, thallium::bulk_mode::read_only);
-        localBulk >> remoteBulk.on(address)(remoteBulkOffset, size);
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk >> remoteBulk.on(address)(remoteBulkOffset, size);
+        }
         free(data);
         return result;
      }
@@ -180,6 +195,7 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
         char* ptr = static_cast<char*>(data);
         size_t offset = 0;
         int i = 0;
+        TraceSpan span{"pread", TraceStage::Backend};
         for(const auto& seg : regionOffsetSizes) {
             abt_io_op* op = abt_io_pread_nb(
                 m_owner->m_abtio,
@@ -211,6 +227,22 @@ struct AbtIORegion : public WritableRegion, public ReadableRegion {
         }
         return result;
     }
+
+    Result<bool> prefetch(
+            const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) override {
+        Result<bool> result;
+        // the page cache is bypassed with O_DIRECT
+        if(m_owner->m_config.value("directio", false)) return result;
+        for(const auto& seg : regionOffsetSizes) {
+            int ret = posix_fadvise(m_owner->m_fd, m_region_offset + seg.first,
+                                    seg.second, POSIX_FADV_WILLNEED);
+            if(ret != 0) {
+                result.success() = false;
+                result.error() = fmt::format("posix_fadvise failed: {}", strerror(ret));
+            }
+        }
+        return result;
+    }
 };
 
 AbtIOTarget::AbtIOTarget(thallium::engine engine, const json& config,
@@ -222,7 +254,16 @@ AbtIOTarget::AbtIOTarget(thallium::engine engine, const json& config,
 , m_file_size(file_size)
 , m_filename(config["path"].get_ref<const std::string&>())
 , m_alignment(config.value("alignment", 8))
-{}
+{
+    // access pattern hint for the kernel's readahead (ignored with O_DIRECT)
+    // the regions of an existing file may have been appended to
+    if(file_size) m_tails.setUnknown();
+    auto readahead = config.value("readahead", std::string{"normal"});
+    if(readahead != "normal" && !config.value("directio", false)) {
+        int advice = readahead == "sequential" ? POSIX_FADV_SEQUENTIAL : POSIX_FADV_RANDOM;
+        posix_fadvise(m_fd, 0, 0, advice);
+    }
+}
 
 AbtIOTarget::~AbtIOTarget() {
     if(m_fd && m_abtio) abt_io_close(m_abtio, m_fd);
@@ -260,6 +301,8 @@ Result<std::unique_ptr<WritableRegion>> AbtIOTarget::create(size_t size) {
         return result;
     }
     m_migration_lock.rdlock();
+    // recorded up front so that a partial write is sent too
+    m_dirty.add(offset, alignedSize);
     ssize_t remaining = alignedSize;
     size_t off = offset;
     while(remaining) {
@@ -273,6 +316,8 @@ Result<std::unique_ptr<WritableRegion>> AbtIOTarget::create(size_t size) {
         remaining -= s;
         off += s;
     }
+    m_tails.created(regionID);
+    m_region_locks.get(regionID).rdlock();
     result.value() = std::make_unique<AbtIORegion>(this, regionID, offset);
     return result;
 }
@@ -288,6 +333,7 @@ Result<std::unique_ptr<WritableRegion>> AbtIOTarget::write(const RegionID& regio
         return result;
     }
     auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
+    m_region_locks.get(region_id).rdlock();
     result.value() = std::make_unique<AbtIORegion>(
         this, region_id, regionOffsetSize.first);
     return result;
@@ -297,6 +343,7 @@ Result<std::unique_ptr<ReadableRegion>> AbtIOTarget::read(const RegionID& region
     Result<std::unique_ptr<ReadableRegion>> result;
     auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
     m_migration_lock.rdlock();
+    m_region_locks.get(region_id).rdlock();
     result.value() = std::make_unique<AbtIORegion>(
         this, region_id, regionOffsetSize.first);
     return result;
@@ -306,6 +353,7 @@ Result<bool> AbtIOTarget::erase(const RegionID& region_id) {
     Result<bool> result;
     auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
     m_migration_lock.rdlock();
+    m_region_locks.get(region_id).wrlock();
     int ret = abt_io_fallocate(
         m_abtio, m_fd,
         FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
@@ -314,17 +362,216 @@ Result<bool> AbtIOTarget::erase(const RegionID& region_id) {
         result.error() = "abt_io_fallocate failed to erase region";
         result.success() = false;
     }
+    m_dirty.add(regionOffsetSize.first, regionOffsetSize.second);
+    m_tails.erased(region_id);
+    m_region_locks.get(region_id).unlock();
     m_migration_lock.unlock();
 
     return result;
 }
 
+Result<size_t> AbtIOTarget::reserve(const RegionID& region_id, size_t size) {
+    auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
+    return m_tails.reserve(region_id, size, regionOffsetSize.second);
+}
+
+bool AbtIOTarget::unreserve(const RegionID& region_id, size_t offset, size_t size) {
+    return m_tails.release(region_id, offset, size);
+}
+
+Result<size_t> AbtIOTarget::allocateExtent(size_t size) {
+    Result<size_t> result;
+    size_t offset = m_file_size.fetch_add(size);
+    if(size == 0) {
+        result.value() = offset;
+        return result;
+    }
+    int ret = abt_io_fallocate(m_abtio, m_fd, 0, offset, size);
+    if(ret != 0) {
+        result.error() = fmt::format("abt_io_fallocate failed to allocate region: {}", strerror(-ret));
+        result.success() = false;
+        return result;
+    }
+    m_dirty.add(offset, size);
+    result.value() = offset;
+    return result;
+}
+
+Result<bool> AbtIOTarget::copyRange(size_t from, size_t to, size_t size) {
+    Result<bool> result;
+    if(size == 0 || from == to) return result;
+    // recorded up front so that a partial copy is sent too (dirty
+    // extents are only taken once the target is locked)
+    m_dirty.add(to, size);
+    const size_t chunkSize = WARABI_ALIGN_UP(std::min<size_t>(size, 4*1024*1024), m_alignment);
+    char* buffer = nullptr;
+    int ret = posix_memalign((void**)(&buffer), m_alignment, chunkSize);
+    if(ret != 0) {
+        result.error() = fmt::format("posix_memalign failed in copy: {}", strerror(ret));
+        result.success() = false;
+        return result;
+    }
+    DEFER(free(buffer));
+    // copy backward when the destination overlaps the end of the source
+    const bool backward = to > from && to < from + size;
+    size_t done = 0;
+    while(done < size) {
+        size_t n = std::min(chunkSize, size - done);
+        size_t pos = backward ? size - done - n : done;
+        for(size_t r = 0; r < n;) {
+            ssize_t s = abt_io_pread(m_abtio, m_fd, buffer + r, n - r, from + pos + r);
+            if(s <= 0) {
+                result.error() = fmt::format("abt_io_pread failed in copy: {}",
+                                             s == 0 ? "end of file" : strerror(-s));
+                result.success() = false;
+                return result;
+            }
+            r += s;
+        }
+        for(size_t w = 0; w < n;) {
+            ssize_t s = abt_io_pwrite(m_abtio, m_fd, buffer + w, n - w, to + pos + w);
+            if(s <= 0) {
+                result.error() = fmt::format("abt_io_pwrite failed in copy: {}", strerror(-s));
+                result.success() = false;
+                return result;
+            }
+            w += s;
+        }
+        done += n;
+    }
+    return result;
+}
+
+Result<RegionID> AbtIOTarget::resize(const RegionID& region_id, size_t size) {
+    Result<RegionID> result;
+    auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
+    size_t alignedSize = WARABI_ALIGN_UP(size, m_alignment);
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // writes to the old extent while it is copied would be lost,
+    // so this waits for the AbtIORegion objects using the region
+    auto& regionLock = m_region_locks.get(region_id);
+    regionLock.wrlock();
+    DEFER(regionLock.unlock());
+    if(alignedSize <= regionOffsetSize.second) {
+        // shrinking keeps the region in place and releases its tail
+        if(alignedSize < regionOffsetSize.second) {
+            int ret = abt_io_fallocate(
+                m_abtio, m_fd,
+                FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                regionOffsetSize.first + alignedSize,
+                regionOffsetSize.second - alignedSize);
+            if(ret != 0) {
+                result.error() = "abt_io_fallocate failed to shrink region";
+                result.success() = false;
+                return result;
+            }
+            m_dirty.add(regionOffsetSize.first + alignedSize,
+                        regionOffsetSize.second - alignedSize);
+        }
+        result.value() = OffsetSizeToRegionID(regionOffsetSize.first, alignedSize);
+        m_tails.resized(region_id, result.value(), alignedSize);
+        return result;
+    }
+    // growing moves the region to a new extent at the end of the file
+    auto offset = allocateExtent(alignedSize);
+    if(!offset.success()) {
+        result.error() = offset.error();
+        result.success() = false;
+        return result;
+    }
+    auto copied = copyRange(regionOffsetSize.first, offset.value(), regionOffsetSize.second);
+    if(!copied.success()) {
+        result.error() = copied.error();
+        result.success() = false;
+        return result;
+    }
+    int ret = abt_io_fallocate(
+        m_abtio, m_fd,
+        FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+        regionOffsetSize.first, regionOffsetSize.second);
+    if(ret != 0) {
+        result.error() = fmt::format(
+            "abt_io_fallocate failed to release the old extent of the region: {}",
+            strerror(-ret));
+        result.success() = false;
+        return result;
+    }
+    m_dirty.add(regionOffsetSize.first, regionOffsetSize.second);
+    result.value() = OffsetSizeToRegionID(offset.value(), alignedSize);
+    m_tails.resized(region_id, result.value(), alignedSize);
+    return result;
+}
+
+Result<bool> AbtIOTarget::copy(const RegionID& source, size_t sourceOffset,
+                               const RegionID& dest, size_t destOffset,
+                               size_t size) {
+    Result<bool> result;
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // the extents cannot be moved or released until the copy completes
+    RegionLocks::SharedPair regionLocks{m_region_locks, source, dest};
+    auto from = RegionIDtoOffsetSize(source);
+    auto to = RegionIDtoOffsetSize(dest);
+    if(sourceOffset > from.second || size > from.second - sourceOffset
+    || destOffset > to.second || size > to.second - destOffset) {
+        result.error() = fmt::format(
+            "Cannot copy {} bytes from offset {} (region size {}) to offset {} (region size {})",
+            size, sourceOffset, from.second, destOffset, to.second);
+        result.success() = false;
+        return result;
+    }
+    return copyRange(from.first + sourceOffset, to.first + destOffset, size);
+}
+
+Result<size_t> AbtIOTarget::size(const RegionID& region_id) {
+    Result<size_t> result;
+    result.value() = RegionIDtoOffsetSize(region_id).second;
+    return result;
+}
+
+Result<RegionID> AbtIOTarget::clone(const RegionID& region_id) {
+    Result<RegionID> result;
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // the source cannot be moved or released until it is copied
+    auto& regionLock = m_region_locks.get(region_id);
+    regionLock.rdlock();
+    DEFER(regionLock.unlock());
+    auto regionOffsetSize = RegionIDtoOffsetSize(region_id);
+    auto offset = allocateExtent(regionOffsetSize.second);
+    if(!offset.success()) {
+        result.error() = offset.error();
+        result.success() = false;
+        return result;
+    }
+    auto copied = copyRange(regionOffsetSize.first, offset.value(), regionOffsetSize.second);
+    if(!copied.success()) {
+        result.error() = copied.error();
+        result.success() = false;
+        return result;
+    }
+    result.value() = OffsetSizeToRegionID(offset.value(), regionOffsetSize.second);
+    return result;
+}
+
 Result<std::unique_ptr<MigrationHandle>> AbtIOTarget::startMigration(bool removeSource) {
     Result<std::unique_ptr<MigrationHandle>> result;
     result.value() = std::make_unique<AbtIOMigrationHandle>(this, removeSource);
     return result;
 }
 
+Result<std::unique_ptr<DirtyTracker>> AbtIOTarget::trackChanges() {
+    Result<std::unique_ptr<DirtyTracker>> result;
+    if(!m_dirty.start()) {
+        result.success() = false;
+        result.error() = "Changes to the target are already being tracked";
+        return result;
+    }
+    result.value() = std::make_unique<AbtIODirtyTracker>(this);
+    return result;
+}
+
 Result<std::unique_ptr<warabi::Backend>> AbtIOTarget::recover(
         const thallium::engine& engine, const json& cfg,
         const std::vector<std::string>& filenames) {
@@ -488,6 +735,7 @@ Result<bool> AbtIOTarget::validate(const json& config) {
             "alignment": {"type": "integer", "minimum": 8, "multipleOf": 8},
             "sync": {"type": "boolean"},
             "directio": {"type": "boolean"},
+            "readahead": {"type": "string", "enum": ["normal", "sequential", "random"]},
             "abt_io": {"type": "object"}
         },
         "required": ["path"]
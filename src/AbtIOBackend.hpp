@@ -8,6 +8,10 @@
 
 #include <warabi/Backend.hpp>
 #include <abt-io.h>
+#include "RegionTails.hpp"
+#include "DirtyExtents.hpp"
+#include "RegionLocks.hpp"
+#include <filesystem>
 
 namespace warabi {
 
@@ -29,6 +33,10 @@ class AbtIOTarget : public warabi::Backend {
     bool                           m_sync;
     size_t                         m_alignment;
     thallium::rwlock               m_migration_lock;
+    // held by AbtIORegion objects, taken exclusively to move or free a region
+    RegionLocks                    m_region_locks;
+    RegionTails                    m_tails;
+    DirtyExtents                   m_dirty;
 
     struct AbtIOMigrationHandle : public MigrationHandle {
 
@@ -71,6 +79,45 @@ class AbtIOTarget : public warabi::Backend {
         }
     };
 
+    struct AbtIODirtyTracker : public DirtyTracker {
+
+        AbtIOTarget* m_target;
+
+        AbtIODirtyTracker(AbtIOTarget* target)
+        : m_target(target) {}
+
+        ~AbtIODirtyTracker() {
+            m_target->m_dirty.stop();
+        }
+
+        std::string getRoot() const override {
+            size_t found = m_target->m_filename.find_last_of("/");
+            if(found != std::string::npos) {
+                return m_target->m_filename.substr(0, found);
+            } else {
+                return "";
+            }
+        }
+
+        std::list<std::string> getFiles() const override {
+            size_t found = m_target->m_filename.find_last_of("/");
+            if(found != std::string::npos) {
+                return {m_target->m_filename.substr(found + 1)};
+            } else {
+                return {m_target->m_filename};
+            }
+        }
+
+        std::vector<FileExtents> takeDirty() override {
+            FileExtents file;
+            file.file = getFiles().front();
+            std::error_code ec;
+            file.size = std::filesystem::file_size(m_target->m_filename, ec);
+            file.extents = m_target->m_dirty.take(file.size);
+            return {std::move(file)};
+        }
+    };
+
     /**
      * @brief Constructor.
      */
@@ -125,6 +172,51 @@ class AbtIOTarget : public warabi::Backend {
      */
     Result<bool> erase(const RegionID& region) override;
 
+    /**
+     * @see Backend::reserve
+     */
+    Result<size_t> reserve(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::unreserve
+     */
+    bool unreserve(const RegionID& region, size_t offset, size_t size) override;
+
+    /**
+     * @see Backend::resize
+     */
+    Result<RegionID> resize(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::copy
+     */
+    Result<bool> copy(const RegionID& source, size_t sourceOffset,
+                      const RegionID& dest, size_t destOffset,
+                      size_t size) override;
+
+    /**
+     * @see Backend::clone
+     */
+    Result<RegionID> clone(const RegionID& region) override;
+
+    /**
+     * @see Backend::size
+     */
+    Result<size_t> size(const RegionID& region) override;
+
+    /**
+     * @brief Copy size bytes of the file from an offset to another,
+     * in chunks, without loading them all in memory. The ranges may
+     * overlap. Must be called with m_migration_lock held.
+     */
+    Result<bool> copyRange(size_t from, size_t to, size_t size);
+
+    /**
+     * @brief Allocate a new zero-filled extent of size bytes (aligned)
+     * at the end of the file. Must be called with m_migration_lock held.
+     */
+    Result<size_t> allocateExtent(size_t size);
+
     /**
      * @brief Destroy the underlying storage.
      */
@@ -135,6 +227,11 @@ class AbtIOTarget : public warabi::Backend {
      */
     Result<std::unique_ptr<MigrationHandle>> startMigration(bool removeSource) override;
 
+    /**
+     * @brief Start tracking the extents of the file that are modified.
+     */
+    Result<std::unique_ptr<DirtyTracker>> trackChanges() override;
+
     /**
      * @brief Static factory function used by the TargetFactory to
      * create a AbtIOTarget.
@@ -0,0 +1,81 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "warabi/Exception.hpp"
+#include "warabi/AsyncMigration.hpp"
+#include "AsyncMigrationImpl.hpp"
+
+namespace warabi {
+
+AsyncMigration::AsyncMigration() = default;
+
+AsyncMigration::AsyncMigration(const std::shared_ptr<AsyncMigrationImpl>& impl)
+: self(impl) {}
+
+AsyncMigration::AsyncMigration(const AsyncMigration& other) = default;
+
+AsyncMigration::AsyncMigration(AsyncMigration&& other) {
+    self = std::move(other.self);
+    other.self = nullptr;
+}
+
+AsyncMigration& AsyncMigration::operator=(const AsyncMigration& other) = default;
+
+AsyncMigration& AsyncMigration::operator=(AsyncMigration&& other) {
+    if(this == &other) return *this;
+    self = std::move(other.self);
+    other.self = nullptr;
+    return *this;
+}
+
+AsyncMigration::~AsyncMigration() = default;
+
+AsyncMigration::operator bool() const {
+    return static_cast<bool>(self);
+}
+
+void AsyncMigration::wait() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    self->m_done.wait();
+    if(!self->m_error.empty()) throw Exception(self->m_error);
+}
+
+bool AsyncMigration::completed() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    return self->m_done.test();
+}
+
+void AsyncMigration::cancel() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    self->m_cancelled = true;
+}
+
+size_t AsyncMigration::bytesTotal() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    return self->m_total.load();
+}
+
+size_t AsyncMigration::bytesTransferred() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    return self->m_transferred.load();
+}
+
+size_t AsyncMigration::bytesSent() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    return self->m_sent.load();
+}
+
+double AsyncMigration::elapsed() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    return self->elapsed();
+}
+
+double AsyncMigration::throughput() const {
+    if(not self) throw Exception("Invalid warabi::AsyncMigration object");
+    auto seconds = self->elapsed();
+    return seconds > 0 ? self->m_transferred.load() / seconds : 0.0;
+}
+
+}
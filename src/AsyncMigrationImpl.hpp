@@ -0,0 +1,59 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_ASYNC_MIGRATION_IMPL_H
+#define __WARABI_ASYNC_MIGRATION_IMPL_H
+
+#include <thallium.hpp>
+#include <atomic>
+#include <chrono>
+#include <string>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief State of a target migration, shared between the ULT running
+ * it and the AsyncMigration objects. Progress counters are updated by
+ * the transfers of the migration and read without locking.
+ */
+struct AsyncMigrationImpl {
+
+    using clock = std::chrono::steady_clock;
+
+    std::atomic<size_t> m_total{0};
+    std::atomic<size_t> m_transferred{0};
+    std::atomic<size_t> m_sent{0};
+    std::atomic<bool>   m_cancelled{false};
+
+    clock::time_point          m_start = clock::now();
+    std::atomic<int64_t>       m_duration_ns{-1}; // set on completion
+    tl::eventual<void>         m_done;
+    std::string                m_error; // written before m_done is set
+
+    /**
+     * @brief Record the outcome of the migration and wake up waiters.
+     */
+    void complete(std::string error = "") {
+        m_error = std::move(error);
+        auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            clock::now() - m_start);
+        m_duration_ns.store(duration.count(), std::memory_order_release);
+        m_done.set_value();
+    }
+
+    double elapsed() const {
+        auto ns = m_duration_ns.load(std::memory_order_acquire);
+        if(ns < 0)
+            ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                clock::now() - m_start).count();
+        return ns * 1e-9;
+    }
+};
+
+}
+
+#endif
@@ -6,9 +6,90 @@
 #include "warabi/Exception.hpp"
 #include "warabi/AsyncRequest.hpp"
 #include "AsyncRequestImpl.hpp"
+#include "TargetHandleImpl.hpp"
+#include "BufferWrapper.hpp"
+
+#include <algorithm>
+#include <cstring>
 
 namespace warabi {
 
+void AsyncRequestImpl::watch(const std::shared_ptr<AsyncRequestImpl>& impl,
+                             const std::shared_ptr<CompletionSignal>& signal,
+                             size_t index) {
+    {
+        std::lock_guard<tl::mutex> lock{impl->m_watch_mtx};
+        if(impl->m_arrived) {
+            signal->notify(index);
+            return;
+        } else {
+            // drop the signals of earlier waitAny calls that already returned
+            auto& watchers = impl->m_watchers;
+            watchers.erase(std::remove_if(watchers.begin(), watchers.end(),
+                [](const auto& w) { return w.first->index.load() != SIZE_MAX; }),
+                watchers.end());
+            watchers.emplace_back(signal, index);
+            if(impl->m_watched) return;
+            impl->m_watched = true;
+        }
+    }
+    tl::thread::self().get_last_pool().make_thread([impl]() {
+        try { impl->waitResponse(); } catch(...) {}
+        decltype(impl->m_watchers) watchers;
+        {
+            std::lock_guard<tl::mutex> lock{impl->m_watch_mtx};
+            impl->m_arrived = true;
+            watchers.swap(impl->m_watchers);
+        }
+        for(auto& w : watchers) w.first->notify(w.second);
+    }, tl::anonymous());
+}
+
+void AsyncRequestImpl::complete() {
+    switch(m_completion) {
+    case Completion::Check:
+        {
+            auto response = decodeResult<bool>(waitResponse(), *m_client, m_start, m_end, &m_timings, m_compact);
+            m_code = response.code;
+            response.check();
+        }
+        break;
+    case Completion::Region:
+        {
+            auto response = decodeResult<RegionID>(waitResponse(), *m_client, m_start, m_end, &m_timings, m_compact);
+            m_code = response.code;
+            if(m_region) *m_region = std::move(response).valueOrThrow();
+            else response.check();
+        }
+        break;
+    case Completion::EagerRead:
+        {
+            auto response = decodeResult<BufferWrapper>(waitResponse(), *m_client, m_start, m_end, &m_timings, m_compact);
+            m_code = response.code;
+            response.check();
+            if(m_size) std::memcpy(m_data, response.value().data(), m_size);
+        }
+        break;
+    case Completion::Offset:
+        {
+            auto response = decodeResult<size_t>(waitResponse(), *m_client, m_start, m_end, &m_timings, m_compact);
+            m_code = response.code;
+            if(m_offset) *m_offset = std::move(response).valueOrThrow();
+            else response.check();
+        }
+        break;
+    case Completion::Forward:
+        {
+            auto response = decodeResult<RegionID>(waitResponse(), *m_client, m_start, m_end, &m_timings, m_compact);
+            m_code = response.code;
+            auto& forwarded = response.valueOrThrow();
+            std::static_pointer_cast<const ForwardedRegion>(m_keepalive)->apply(forwarded);
+            if(m_region) *m_region = forwarded;
+        }
+        break;
+    }
+}
+
 AsyncRequest::AsyncRequest() = default;
 
 AsyncRequest::AsyncRequest(const std::shared_ptr<AsyncRequestImpl>& impl)
@@ -54,12 +135,46 @@ void AsyncRequest::wait() const {
     if(not self) throw Exception("Invalid warabi::AsyncRequest object");
     if(self->m_waited) return;
     self->m_waited = true;
-    self->m_wait_callback(*self);
+    self->complete();
+}
+
+const RequestTimings& AsyncRequest::timings() const {
+    wait();
+    return self->m_timings;
 }
 
 bool AsyncRequest::completed() const {
     if(not self) throw Exception("Invalid warabi::AsyncRequest object");
-    return self->m_async_response.received();
+    return self->received();
+}
+
+size_t AsyncRequest::waitAny(const AsyncRequest* requests, size_t count) {
+    bool pending = false;
+    for(size_t i = 0; i < count; ++i) {
+        auto& impl = requests[i].self;
+        if(!impl || impl->m_waited) continue;
+        if(impl->received()) return i;
+        pending = true;
+    }
+    if(!pending) return count;
+    auto signal = std::make_shared<CompletionSignal>();
+    for(size_t i = 0; i < count; ++i) {
+        auto& impl = requests[i].self;
+        if(!impl || impl->m_waited) continue;
+        AsyncRequestImpl::watch(impl, signal, i);
+    }
+    std::unique_lock<tl::mutex> lock{signal->mtx};
+    while(signal->index.load() == SIZE_MAX) signal->cv.wait(lock);
+    return signal->index.load();
+}
+
+bool AsyncRequest::testAll(const AsyncRequest* requests, size_t count) {
+    for(size_t i = 0; i < count; ++i) {
+        auto& impl = requests[i].self;
+        if(!impl || impl->m_waited) continue;
+        if(!impl->received()) return false;
+    }
+    return true;
 }
 
 }
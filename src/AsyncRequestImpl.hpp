@@ -6,22 +6,195 @@
 #ifndef __WARABI_ASYNC_REQUEST_IMPL_H
 #define __WARABI_ASYNC_REQUEST_IMPL_H
 
-#include <functional>
+#include "warabi/RegionID.hpp"
+#include "warabi/RequestTimings.hpp"
+#include "ClientImpl.hpp"
+#include "TimedResult.hpp"
+#include "WireProtocol.hpp"
 #include <thallium.hpp>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
 
 namespace warabi {
 
 namespace tl = thallium;
 
+using PackedResponse = decltype(std::declval<tl::async_response&>().wait());
+
+/**
+ * @brief Decodes the response of an RPC issued at the specified start
+ * time and received at the specified end time, records its timings in
+ * the client's statistics, and returns its Result along with its
+ * ErrorCode. If timings is not null, the timings of the request are
+ * also copied into it. compact indicates that the RPC uses version 2
+ * of the wire protocol (see WireProtocol.hpp).
+ */
+template<typename T>
+static inline CodedResult<T> decodeResult(const PackedResponse& packed,
+                                          ClientImpl& client,
+                                          uint64_t start, uint64_t end,
+                                          RequestTimings* timings = nullptr,
+                                          bool compact = false) {
+    TimedResult<T> response = compact
+        ? static_cast<CompactTimedResult<T>>(packed).timed
+        : static_cast<TimedResult<T>>(packed);
+    response.timings.total_ns = end - start;
+    if(response.timings.valid) client.recordTimings(response.timings);
+    if(timings) *timings = response.timings;
+    return CodedResult<T>{std::move(response.result), response.code};
+}
+
+/**
+ * @brief Waits for the response of an RPC issued at the specified
+ * start time and decodes it (see decodeResult).
+ */
+template<typename T>
+static inline CodedResult<T> waitForResult(tl::async_response& async_response,
+                                           ClientImpl& client, uint64_t start,
+                                           RequestTimings* timings = nullptr,
+                                           bool compact = false) {
+    auto packed = async_response.wait();
+    return decodeResult<T>(packed, client, start, traceClock(), timings, compact);
+}
+
+/**
+ * @brief Set by the first of the requests passed to AsyncRequest::waitAny
+ * whose response arrives.
+ */
+struct CompletionSignal {
+    tl::mutex               mtx;
+    tl::condition_variable  cv;
+    std::atomic<size_t>     index{SIZE_MAX};
+
+    void notify(size_t i) {
+        std::lock_guard<tl::mutex> lock{mtx};
+        size_t expected = SIZE_MAX;
+        if(index.compare_exchange_strong(expected, i)) cv.notify_all();
+    }
+};
+
 struct AsyncRequestImpl {
 
-    AsyncRequestImpl(tl::async_response&& async_response)
-    : m_async_response(std::move(async_response)) {}
+    /**
+     * @brief How the response is processed when the request is waited
+     * on. Using a fixed set of completions rather than a closure avoids
+     * an allocation per request.
+     */
+    enum class Completion : uint8_t {
+        Check,     // Result<bool>: throw if it is an error
+        Region,    // Result<RegionID>: store the region into m_region
+        EagerRead, // Result<BufferWrapper>: copy m_size bytes into m_data
+        Offset,    // Result<size_t>: store the offset into m_offset
+        Forward    // Result<RegionID>: record it as the forward held by m_keepalive
+                   // (a ForwardedRegion) and store it into m_region if not null
+    };
+
+    AsyncRequestImpl(tl::async_response&& async_response,
+                     std::shared_ptr<ClientImpl> client,
+                     uint64_t start,
+                     Completion completion)
+    : m_async_response(std::move(async_response))
+    , m_client(std::move(client))
+    , m_start(start)
+    , m_completion(completion) {}
+
+    tl::async_response          m_async_response;
+    std::shared_ptr<ClientImpl> m_client;
+    uint64_t                    m_start;
+    std::atomic<uint64_t>       m_end{0}; // when the response was first seen
+    Completion                  m_completion;
+    bool                        m_waited = false;
+    RegionID*                   m_region = nullptr;
+    char*                       m_data   = nullptr;
+    size_t                      m_size   = 0;
+    size_t*                     m_offset = nullptr;
+    RequestTimings              m_timings;
+    std::shared_ptr<const void> m_keepalive; // released when the request is destroyed
+    bool                        m_compact = false; // version 2 response
+    ErrorCode                   m_code = ErrorCode::Success; // set by complete()
+
+    // response of the RPC, waited on once by whichever ULT needs it first
+    tl::mutex                      m_response_mtx;
+    std::optional<PackedResponse>  m_response;
+    std::exception_ptr             m_response_error;
+
+    // ULT waiting for the response on behalf of AsyncRequest::waitAny
+    tl::mutex                      m_watch_mtx;
+    bool                           m_watched = false;
+    bool                           m_arrived = false;
+    std::vector<std::pair<std::shared_ptr<CompletionSignal>, size_t>> m_watchers;
+
+    /**
+     * @brief Wait for the response and process it according
+     * to m_completion (throws if the request failed).
+     */
+    void complete();
+
+    /**
+     * @brief Wait for the response (only once, whichever ULT calls
+     * this first) and return it, recording the time at which it
+     * arrived as the end of the request.
+     */
+    const PackedResponse& waitResponse() {
+        std::lock_guard<tl::mutex> lock{m_response_mtx};
+        if(!m_response && !m_response_error) {
+            try {
+                m_response.emplace(m_async_response.wait());
+            } catch(...) {
+                m_response_error = std::current_exception();
+            }
+            uint64_t expected = 0;
+            m_end.compare_exchange_strong(expected, traceClock());
+        }
+        if(m_response_error) std::rethrow_exception(m_response_error);
+        return *m_response;
+    }
+
+    /**
+     * @brief Test whether the response has arrived, recording the time
+     * at which it is first seen as the end of the request. While another
+     * ULT is blocked waiting for the response, this returns false until
+     * that ULT is woken up.
+     */
+    bool received() {
+        if(m_end.load()) return true;
+        std::unique_lock<tl::mutex> lock{m_response_mtx, std::try_to_lock};
+        if(!lock.owns_lock()) return false;
+        if(m_response || m_response_error) return true;
+        if(!m_async_response.received()) return false;
+        uint64_t expected = 0;
+        m_end.compare_exchange_strong(expected, traceClock());
+        return true;
+    }
 
-    tl::async_response                     m_async_response;
-    bool                                   m_waited = false;
-    std::function<void(AsyncRequestImpl&)> m_wait_callback;
+    /**
+     * @brief Notify the signal with the given index once the response of
+     * the request has arrived. The first call starts a ULT, in the pool of
+     * the calling ULT, that blocks waiting for the response; later calls
+     * only add the signal to those notified by that ULT.
+     */
+    static void watch(const std::shared_ptr<AsyncRequestImpl>& impl,
+                      const std::shared_ptr<CompletionSignal>& signal,
+                      size_t index);
 
+    /**
+     * @brief Allocate an AsyncRequestImpl from the request pool of the client.
+     */
+    static std::shared_ptr<AsyncRequestImpl> make(
+            tl::async_response&& async_response,
+            const std::shared_ptr<ClientImpl>& client,
+            uint64_t start,
+            Completion completion) {
+        return std::allocate_shared<AsyncRequestImpl>(
+            PoolAllocator<AsyncRequestImpl>{client->m_request_pool},
+            std::move(async_response), client, start, completion);
+    }
 };
 
 }
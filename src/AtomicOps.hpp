@@ -0,0 +1,90 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_ATOMIC_OPS_HPP
+#define __WARABI_ATOMIC_OPS_HPP
+
+#include "warabi/AtomicOp.hpp"
+#include "warabi/RegionID.hpp"
+#include <thallium.hpp>
+#include <array>
+#include <cstring>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Whether an atomic operation on words of the given width exists.
+ */
+static inline bool validAtomic(AtomicOp op, size_t width) {
+    return (width == 8 || width == 16)
+        && static_cast<uint8_t>(op) <= static_cast<uint8_t>(AtomicOp::Swap);
+}
+
+/**
+ * @brief Apply an atomic operation to a word of width bytes (8 or 16),
+ * treated as an unsigned integer in native byte order. compare is only
+ * used by CompareSwap. The caller is responsible for atomicity.
+ */
+static inline void applyAtomic(AtomicOp op, size_t width, char* word,
+                               const char* operand, const char* compare) {
+    uint64_t w[2] = {0, 0}, o[2] = {0, 0};
+    std::memcpy(w, word, width);
+    std::memcpy(o, operand, width);
+    // index of the low and high 64-bit halves of a 16-byte word
+    const bool little = [] { uint16_t one = 1; return *reinterpret_cast<char*>(&one) == 1; }();
+    const size_t lo = little ? 0 : 1, hi = 1 - lo;
+    switch(op) {
+    case AtomicOp::FetchAdd:
+        if(width == 8) {
+            w[0] += o[0];
+        } else {
+            uint64_t sum = w[lo] + o[lo];
+            w[hi] += o[hi] + (sum < w[lo]);
+            w[lo] = sum;
+        }
+        break;
+    case AtomicOp::CompareSwap:
+        if(std::memcmp(word, compare, width) == 0) std::memcpy(w, o, width);
+        break;
+    case AtomicOp::FetchAnd:
+        w[0] &= o[0]; w[1] &= o[1];
+        break;
+    case AtomicOp::FetchOr:
+        w[0] |= o[0]; w[1] |= o[1];
+        break;
+    case AtomicOp::FetchXor:
+        w[0] ^= o[0]; w[1] ^= o[1];
+        break;
+    case AtomicOp::Swap:
+        std::memcpy(w, o, width);
+        break;
+    }
+    std::memcpy(word, w, width);
+}
+
+/**
+ * @brief Locks serializing the atomic operations of a provider. A word
+ * is mapped to a lock by its region and its 16-byte aligned offset,
+ * so that overlapping 8 and 16-byte words share the same lock.
+ */
+class AtomicLocks {
+
+    std::array<tl::mutex, 64> m_locks;
+
+    public:
+
+    tl::mutex& get(const RegionID& region, size_t offset) {
+        uint64_t h[2];
+        std::memcpy(h, region.data(), sizeof(h));
+        uint64_t key = h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull) ^ ((offset / 16) * 0xc2b2ae3d27d4eb4full);
+        return m_locks[(key ^ (key >> 32)) % m_locks.size()];
+    }
+};
+
+}
+
+#endif
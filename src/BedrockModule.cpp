@@ -6,6 +6,7 @@
 
 #include "warabi/Provider.hpp"
 #include <bedrock/AbstractComponent.hpp>
+#include <nlohmann/json.hpp>
 
 namespace tl = thallium;
 
@@ -34,6 +35,17 @@ class WarabiComponent : public bedrock::AbstractComponent {
         return m_provider->getConfig();
     }
 
+    void migrate(const char* dest_addr,
+                 uint16_t dest_provider_id,
+                 const char* options_json,
+                 bool remove_source) override {
+        auto options = nlohmann::json::object();
+        if(options_json && *options_json)
+            options = nlohmann::json::parse(options_json);
+        options["remove_source"] = remove_source;
+        m_provider->migrateTarget(dest_addr, dest_provider_id, options.dump());
+    }
+
     static std::shared_ptr<bedrock::AbstractComponent>
         Register(const bedrock::ComponentArgs& args) {
             tl::pool pool;
@@ -0,0 +1,114 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "warabi/BufferPool.hpp"
+#include "warabi/Exception.hpp"
+#include "BufferPoolImpl.hpp"
+
+namespace warabi {
+
+BufferPoolImpl::Block BufferPoolImpl::acquire(size_t size) {
+    size_t capacity = sizeClass(size);
+    {
+        std::lock_guard<std::mutex> lock{m_mtx};
+        auto it = m_free.find(capacity);
+        if(it != m_free.end() && !it->second.empty()) {
+            auto block = std::move(it->second.back());
+            it->second.pop_back();
+            m_cached_bytes -= capacity;
+            return block;
+        }
+    }
+    Block block;
+    block.capacity = capacity;
+    block.memory.reset(new char[capacity]);
+    std::vector<std::pair<void*, size_t>> segment{{block.memory.get(), capacity}};
+    block.bulk = m_engine.expose(segment, tl::bulk_mode::read_write);
+    return block;
+}
+
+void BufferPoolImpl::release(Block&& block) {
+    std::lock_guard<std::mutex> lock{m_mtx};
+    if(m_cached_bytes + block.capacity > m_max_cached_bytes)
+        return; // the block is freed when it goes out of scope
+    m_cached_bytes += block.capacity;
+    m_free[block.capacity].push_back(std::move(block));
+}
+
+RegisteredBufferImpl::~RegisteredBufferImpl() {
+    m_pool->release(std::move(m_block));
+}
+
+RegisteredBuffer::RegisteredBuffer() = default;
+
+RegisteredBuffer::RegisteredBuffer(std::shared_ptr<RegisteredBufferImpl> impl)
+: self(std::move(impl)) {}
+
+RegisteredBuffer::RegisteredBuffer(const RegisteredBuffer&) = default;
+
+RegisteredBuffer::RegisteredBuffer(RegisteredBuffer&&) = default;
+
+RegisteredBuffer& RegisteredBuffer::operator=(const RegisteredBuffer&) = default;
+
+RegisteredBuffer& RegisteredBuffer::operator=(RegisteredBuffer&&) = default;
+
+RegisteredBuffer::~RegisteredBuffer() = default;
+
+RegisteredBuffer::operator bool() const {
+    return static_cast<bool>(self);
+}
+
+char* RegisteredBuffer::data() const {
+    if(not self) throw Exception("Invalid warabi::RegisteredBuffer object");
+    return self->m_block.memory.get();
+}
+
+size_t RegisteredBuffer::size() const {
+    if(not self) throw Exception("Invalid warabi::RegisteredBuffer object");
+    return self->m_size;
+}
+
+size_t RegisteredBuffer::capacity() const {
+    if(not self) throw Exception("Invalid warabi::RegisteredBuffer object");
+    return self->m_block.capacity;
+}
+
+const thallium::bulk& RegisteredBuffer::bulk() const {
+    if(not self) throw Exception("Invalid warabi::RegisteredBuffer object");
+    return self->m_block.bulk;
+}
+
+BufferPool::BufferPool(const thallium::engine& engine, size_t maxCachedBytes)
+: self(std::make_shared<BufferPoolImpl>(engine, maxCachedBytes)) {}
+
+BufferPool::BufferPool(std::shared_ptr<BufferPoolImpl> impl)
+: self(std::move(impl)) {}
+
+BufferPool::BufferPool(const BufferPool&) = default;
+
+BufferPool::BufferPool(BufferPool&&) = default;
+
+BufferPool& BufferPool::operator=(const BufferPool&) = default;
+
+BufferPool& BufferPool::operator=(BufferPool&&) = default;
+
+BufferPool::~BufferPool() = default;
+
+BufferPool::operator bool() const {
+    return static_cast<bool>(self);
+}
+
+RegisteredBuffer BufferPool::get(size_t size) const {
+    if(not self) throw Exception("Invalid warabi::BufferPool object");
+    return std::make_shared<RegisteredBufferImpl>(self, self->acquire(size), size);
+}
+
+size_t BufferPool::cachedBytes() const {
+    if(not self) throw Exception("Invalid warabi::BufferPool object");
+    std::lock_guard<std::mutex> lock{self->m_mtx};
+    return self->m_cached_bytes;
+}
+
+}
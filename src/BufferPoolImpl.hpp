@@ -0,0 +1,81 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_BUFFER_POOL_IMPL_H
+#define __WARABI_BUFFER_POOL_IMPL_H
+
+#include <thallium.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+class BufferPoolImpl {
+
+    public:
+
+    struct Block {
+        std::unique_ptr<char[]> memory;
+        size_t                  capacity = 0;
+        tl::bulk                bulk;
+    };
+
+    tl::engine                                      m_engine;
+    size_t                                          m_max_cached_bytes;
+    std::mutex                                      m_mtx;
+    std::unordered_map<size_t, std::vector<Block>>  m_free; // by capacity
+    size_t                                          m_cached_bytes = 0;
+
+    static constexpr size_t s_min_block_size = 4096;
+
+    BufferPoolImpl(const tl::engine& engine, size_t maxCachedBytes)
+    : m_engine(engine)
+    , m_max_cached_bytes(maxCachedBytes) {}
+
+    static size_t sizeClass(size_t size) {
+        size_t capacity = s_min_block_size;
+        while(capacity < size) capacity <<= 1;
+        return capacity;
+    }
+
+    /**
+     * @brief Take an unused block of the size class of the
+     * specified size, or allocate and register a new one.
+     */
+    Block acquire(size_t size);
+
+    /**
+     * @brief Give a block back to the pool (or free it if the pool
+     * already holds its maximum number of bytes).
+     */
+    void release(Block&& block);
+};
+
+class RegisteredBufferImpl {
+
+    public:
+
+    std::shared_ptr<BufferPoolImpl> m_pool;
+    BufferPoolImpl::Block           m_block;
+    size_t                          m_size;
+
+    RegisteredBufferImpl(std::shared_ptr<BufferPoolImpl> pool,
+                         BufferPoolImpl::Block&& block,
+                         size_t size)
+    : m_pool(std::move(pool))
+    , m_block(std::move(block))
+    , m_size(size) {}
+
+    ~RegisteredBufferImpl();
+};
+
+}
+
+#endif
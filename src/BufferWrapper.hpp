@@ -6,6 +6,9 @@
 #ifndef __WARABI_BUFFER_WRAPPER_H
 #define __WARABI_BUFFER_WRAPPER_H
 
+#include <cstddef>
+#include <cstdint>
+
 namespace warabi {
 
 class BufferWrapper {
@@ -87,6 +90,22 @@ class BufferWrapper {
 
 };
 
+/**
+ * @brief Data read from a region along with the version of the region
+ * at the time of the read (see RegionVersions), 0 if it was being written.
+ */
+struct VersionedBuffer {
+
+    uint64_t      version = 0;
+    BufferWrapper buffer;
+
+    template<typename Archive>
+    void serialize(Archive& ar) {
+        ar & version;
+        ar & buffer;
+    }
+};
+
 }
 
 #endif
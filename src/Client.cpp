@@ -43,6 +43,11 @@ const tl::engine& Client::engine() const {
     return self->m_engine;
 }
 
+BufferPool Client::bufferPool() const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    return BufferPool{self->m_buffer_pool};
+}
+
 Client::operator bool() const {
     return static_cast<bool>(self);
 }
@@ -59,4 +64,35 @@ std::string Client::getConfig() const {
     return "{}";
 }
 
+TimingStats Client::getTimingStats() const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    std::lock_guard<tl::mutex> lock{self->m_timing_stats_mtx};
+    return self->m_timing_stats;
+}
+
+void Client::resetTimingStats() {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    std::lock_guard<tl::mutex> lock{self->m_timing_stats_mtx};
+    self->m_timing_stats = TimingStats{};
+}
+
+void Client::enableReadCache(const ReadCacheOptions& options) const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    if(options.capacity == 0)
+        throw Exception("Read cache capacity must be greater than 0");
+    self->m_read_cache.configure(options);
+}
+
+void Client::disableReadCache() const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    ReadCacheOptions options;
+    options.capacity = 0;
+    self->m_read_cache.configure(options);
+}
+
+ReadCacheStats Client::getReadCacheStats() const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    return self->m_read_cache.stats();
+}
+
 }
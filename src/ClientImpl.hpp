@@ -6,10 +6,18 @@
 #ifndef __WARABI_CLIENT_IMPL_H
 #define __WARABI_CLIENT_IMPL_H
 
+#include "warabi/RequestTimings.hpp"
+#include "RequestPool.hpp"
+#include "BufferPoolImpl.hpp"
+#include "ReadCache.hpp"
 #include <thallium.hpp>
 #include <thallium/serialization/stl/unordered_set.hpp>
 #include <thallium/serialization/stl/unordered_map.hpp>
 #include <thallium/serialization/stl/string.hpp>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
 
 namespace warabi {
 
@@ -27,27 +35,93 @@ class ClientImpl {
     tl::remote_procedure m_persist;
     tl::remote_procedure m_create_write;
     tl::remote_procedure m_create_write_eager;
+    tl::remote_procedure m_append;
+    tl::remote_procedure m_append_eager;
+    tl::remote_procedure m_atomic;
+    tl::remote_procedure m_resize;
+    tl::remote_procedure m_copy;
+    tl::remote_procedure m_clone;
+    tl::remote_procedure m_transfer;
+    tl::remote_procedure m_get_forward;
     tl::remote_procedure m_read;
     tl::remote_procedure m_read_eager;
     tl::remote_procedure m_erase;
+    tl::remote_procedure m_read_versioned;
+    tl::remote_procedure m_read_eager_versioned;
+    tl::remote_procedure m_get_versions;
+    tl::remote_procedure m_prefetch;
+    tl::remote_procedure m_get_protocol_version;
+    tl::remote_procedure m_create_v2;
+    tl::remote_procedure m_write_v2;
+    tl::remote_procedure m_write_eager_v2;
+    tl::remote_procedure m_read_v2;
+    tl::remote_procedure m_read_eager_v2;
+    tl::remote_procedure m_erase_v2;
+
+    // request ids are made of a random 24-bit client tag
+    // followed by a 40-bit per-client counter
+    std::atomic<uint64_t> m_next_request_id;
+
+    // timings of the requests issued by this client
+    TimingStats           m_timing_stats;
+    tl::mutex             m_timing_stats_mtx;
+
+    // recycled memory for the AsyncRequests issued by this client
+    std::shared_ptr<RequestPool> m_request_pool = std::make_shared<RequestPool>();
+
+    // registered memory blocks lent to users via Client::bufferPool()
+    std::shared_ptr<BufferPoolImpl> m_buffer_pool =
+        std::make_shared<BufferPoolImpl>(m_engine, 64*1024*1024);
+
+    // cache of the data read by this client (disabled by default)
+    ReadCache             m_read_cache;
 
     ClientImpl(const tl::engine& engine)
     : m_engine(engine)
-    , m_create(m_engine.define("warabi_create"))
-    , m_write(m_engine.define("warabi_write"))
-    , m_write_eager(m_engine.define("warabi_write_eager"))
-    , m_persist(m_engine.define("warabi_persist"))
-    , m_create_write(m_engine.define("warabi_create_write"))
-    , m_create_write_eager(m_engine.define("warabi_create_write_eager"))
-    , m_read(m_engine.define("warabi_read"))
-    , m_read_eager(m_engine.define("warabi_read_eager"))
-    , m_erase(m_engine.define("warabi_erase"))
+    , m_create(m_engine.define("warabi_v1_create"))
+    , m_write(m_engine.define("warabi_v1_write"))
+    , m_write_eager(m_engine.define("warabi_v1_write_eager"))
+    , m_persist(m_engine.define("warabi_v1_persist"))
+    , m_create_write(m_engine.define("warabi_v1_create_write"))
+    , m_create_write_eager(m_engine.define("warabi_v1_create_write_eager"))
+    , m_append(m_engine.define("warabi_append"))
+    , m_append_eager(m_engine.define("warabi_append_eager"))
+    , m_atomic(m_engine.define("warabi_atomic"))
+    , m_resize(m_engine.define("warabi_resize"))
+    , m_copy(m_engine.define("warabi_copy"))
+    , m_clone(m_engine.define("warabi_clone"))
+    , m_transfer(m_engine.define("warabi_transfer"))
+    , m_get_forward(m_engine.define("warabi_get_forward"))
+    , m_read(m_engine.define("warabi_v1_read"))
+    , m_read_eager(m_engine.define("warabi_v1_read_eager"))
+    , m_erase(m_engine.define("warabi_v1_erase"))
+    , m_read_versioned(m_engine.define("warabi_read_versioned"))
+    , m_read_eager_versioned(m_engine.define("warabi_read_eager_versioned"))
+    , m_get_versions(m_engine.define("warabi_get_versions"))
+    , m_prefetch(m_engine.define("warabi_prefetch"))
+    , m_get_protocol_version(m_engine.define("warabi_get_protocol_version"))
+    , m_create_v2(m_engine.define("warabi_v2_create"))
+    , m_write_v2(m_engine.define("warabi_v2_write"))
+    , m_write_eager_v2(m_engine.define("warabi_v2_write_eager"))
+    , m_read_v2(m_engine.define("warabi_v2_read"))
+    , m_read_eager_v2(m_engine.define("warabi_v2_read_eager"))
+    , m_erase_v2(m_engine.define("warabi_v2_erase"))
+    , m_next_request_id((std::random_device{}() & 0xFFFFFFull) << 40)
     {}
 
     ClientImpl(margo_instance_id mid)
     : ClientImpl(tl::engine(mid)) {}
 
     ~ClientImpl() {}
+
+    uint64_t nextRequestID() {
+        return m_next_request_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void recordTimings(const RequestTimings& timings) {
+        std::lock_guard<tl::mutex> lock{m_timing_stats_mtx};
+        m_timing_stats.add(timings);
+    }
 };
 
 }
@@ -0,0 +1,186 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "warabi/CompletionQueue.hpp"
+#include "warabi/Exception.hpp"
+
+#include <thallium.hpp>
+#include <deque>
+#include <mutex>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+class CompletionQueueImpl {
+
+    public:
+
+    struct Entry {
+        AsyncRequest              request;
+        uint64_t                  tag;
+        CompletionQueue::Callback callback;
+    };
+
+    struct Waited {
+        Completion                completion;
+        CompletionQueue::Callback callback;
+    };
+
+    // maximum number of ULTs waiting on the requests of a queue
+    static constexpr size_t s_max_waiters = 16;
+
+    mutable tl::mutex      m_mtx;
+    tl::condition_variable m_cv;
+    std::deque<Entry>      m_pending;   // not yet taken by a waiter
+    std::deque<Waited>     m_waited;    // waited on, callback not yet invoked
+    std::deque<Completion> m_ready;
+    size_t                 m_waiting = 0;    // being waited on by a waiter
+    size_t                 m_completing = 0; // callback being invoked
+    size_t                 m_waiters = 0;
+
+    ~CompletionQueueImpl() {
+        std::unique_lock<tl::mutex> lock{m_mtx};
+        while(m_waiters != 0) m_cv.wait(lock);
+    }
+
+    /**
+     * @brief Number of requests that are not yet in m_ready.
+     */
+    size_t outstanding() const {
+        return m_pending.size() + m_waiting + m_waited.size() + m_completing;
+    }
+
+    /**
+     * @brief Body of the waiter ULTs: block on the pending requests in
+     * push order until none is left, moving them to m_waited.
+     */
+    void waiter() {
+        std::unique_lock<tl::mutex> lock{m_mtx};
+        while(!m_pending.empty()) {
+            Entry entry = std::move(m_pending.front());
+            m_pending.pop_front();
+            m_waiting += 1;
+            lock.unlock();
+            Completion completion;
+            completion.tag     = entry.tag;
+            completion.request = std::move(entry.request);
+            try {
+                completion.request.wait();
+            } catch(...) {
+                completion.error = std::current_exception();
+            }
+            lock.lock();
+            m_waiting -= 1;
+            m_waited.push_back({std::move(completion), std::move(entry.callback)});
+            m_cv.notify_all();
+        }
+        m_waiters -= 1;
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief Invoke the callbacks of the requests in m_waited
+     * and move them to m_ready.
+     */
+    void dispatch() {
+        std::unique_lock<tl::mutex> lock{m_mtx};
+        while(!m_waited.empty()) {
+            Waited waited = std::move(m_waited.front());
+            m_waited.pop_front();
+            m_completing += 1;
+            lock.unlock();
+            auto& completion = waited.completion;
+            if(waited.callback) {
+                try {
+                    waited.callback(completion);
+                } catch(...) {
+                    if(!completion.error) completion.error = std::current_exception();
+                }
+            }
+            lock.lock();
+            m_ready.push_back(std::move(completion));
+            m_completing -= 1;
+            m_cv.notify_all();
+        }
+    }
+};
+
+CompletionQueue::CompletionQueue()
+: self(std::make_shared<CompletionQueueImpl>()) {}
+
+CompletionQueue::CompletionQueue(const CompletionQueue&) = default;
+
+CompletionQueue::CompletionQueue(CompletionQueue&&) = default;
+
+CompletionQueue& CompletionQueue::operator=(const CompletionQueue&) = default;
+
+CompletionQueue& CompletionQueue::operator=(CompletionQueue&&) = default;
+
+CompletionQueue::~CompletionQueue() = default;
+
+CompletionQueue::operator bool() const {
+    return static_cast<bool>(self);
+}
+
+void CompletionQueue::push(AsyncRequest request, uint64_t tag, Callback callback) const {
+    if(not self) throw Exception("Invalid warabi::CompletionQueue object");
+    if(not request) throw Exception("Cannot push an invalid AsyncRequest in a CompletionQueue");
+    std::lock_guard<tl::mutex> lock{self->m_mtx};
+    self->m_pending.push_back({std::move(request), tag, std::move(callback)});
+    if(self->m_waiters < CompletionQueueImpl::s_max_waiters) {
+        self->m_waiters += 1;
+        auto impl = self.get();
+        tl::thread::self().get_last_pool().make_thread(
+            [impl]() { impl->waiter(); }, tl::anonymous());
+    }
+}
+
+size_t CompletionQueue::pending() const {
+    if(not self) throw Exception("Invalid warabi::CompletionQueue object");
+    std::lock_guard<tl::mutex> lock{self->m_mtx};
+    return self->outstanding();
+}
+
+size_t CompletionQueue::ready() const {
+    if(not self) throw Exception("Invalid warabi::CompletionQueue object");
+    std::lock_guard<tl::mutex> lock{self->m_mtx};
+    return self->m_ready.size();
+}
+
+bool CompletionQueue::waitAny(Completion* completion) const {
+    std::vector<Completion> completions;
+    if(waitSome(&completions, 1, 1) == 0) return false;
+    *completion = std::move(completions[0]);
+    return true;
+}
+
+size_t CompletionQueue::waitSome(std::vector<Completion>* completions,
+                                 size_t min, size_t max) const {
+    if(not self) throw Exception("Invalid warabi::CompletionQueue object");
+    size_t count = 0;
+    while(true) {
+        self->dispatch();
+        std::unique_lock<tl::mutex> lock{self->m_mtx};
+        auto& ready = self->m_ready;
+        while(count < max && !ready.empty()) {
+            completions->push_back(std::move(ready.front()));
+            ready.pop_front();
+            count += 1;
+        }
+        if(count >= min || count >= max) return count;
+        if(self->outstanding() == 0) return count;
+        if(self->m_waited.empty() && ready.empty()) self->m_cv.wait(lock);
+    }
+}
+
+bool CompletionQueue::testAll() const {
+    if(not self) throw Exception("Invalid warabi::CompletionQueue object");
+    self->dispatch();
+    std::lock_guard<tl::mutex> lock{self->m_mtx};
+    return self->outstanding() == 0;
+}
+
+}
@@ -0,0 +1,52 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "EventLog.hpp"
+#include "warabi/Exception.hpp"
+#include <tclap/CmdLine.h>
+#include <fstream>
+#include <iostream>
+
+static std::string g_input;
+static std::string g_output;
+
+static void parse_command_line(int argc, char** argv);
+
+int main(int argc, char** argv) {
+    parse_command_line(argc, argv);
+    std::ifstream in(g_input, std::ios::in | std::ios::binary);
+    if(!in.good()) {
+        std::cerr << "error: could not open " << g_input << std::endl;
+        return -1;
+    }
+    try {
+        if(g_output.empty()) {
+            warabi::EventLog::decode(in, std::cout);
+        } else {
+            std::ofstream out(g_output, std::ios::out | std::ios::trunc);
+            warabi::EventLog::decode(in, out);
+        }
+    } catch(const warabi::Exception& ex) {
+        std::cerr << "error: " << ex.what() << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+void parse_command_line(int argc, char** argv) {
+    try {
+        TCLAP::CmdLine cmd("Converts a Warabi binary event log into text", ' ', "0.1");
+        TCLAP::UnlabeledValueArg<std::string> inputArg("input", "Event log produced by a provider", true, "", "file");
+        TCLAP::ValueArg<std::string> outputArg("o", "output", "Output file (default: standard output)", false, "", "file");
+        cmd.add(inputArg);
+        cmd.add(outputArg);
+        cmd.parse(argc, argv);
+        g_input = inputArg.getValue();
+        g_output = outputArg.getValue();
+    } catch(TCLAP::ArgException &e) {
+        std::cerr << "error: " << e.error() << " for arg " << e.argId() << std::endl;
+        exit(-1);
+    }
+}
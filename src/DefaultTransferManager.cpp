@@ -4,6 +4,7 @@
  * See COPYRIGHT in top-level directory.
  */
 #include "warabi/TransferManager.hpp"
+#include "Tracing.hpp"
 
 namespace warabi {
 
@@ -29,6 +30,7 @@ class DefaultTransferManager : public TransferManager {
             thallium::endpoint address,
             size_t bulkOffset,
             bool persist) override {
+        TraceSpan span{"backend_write", TraceStage::Backend};
         return region.write(regionOffsetSizes, data, address, bulkOffset, persist);
     }
 
@@ -38,6 +40,7 @@ class DefaultTransferManager : public TransferManager {
             thallium::bulk data,
             thallium::endpoint address,
             size_t bulkOffset) override {
+        TraceSpan span{"backend_read", TraceStage::Backend};
         return region.read(regionOffsetSizes, data, address, bulkOffset);
     }
 
@@ -0,0 +1,124 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_DIRTY_EXTENTS_HPP
+#define __WARABI_DIRTY_EXTENTS_HPP
+
+#include <thallium.hpp>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Extents of the file of a backend modified since tracking
+ * started, used by the DirtyTracker of the backend. Backends record
+ * extents once they are written, so an extent written while the file
+ * is being copied is always sent again. When tracking is off,
+ * recording an extent only costs an atomic load.
+ */
+class DirtyExtents {
+
+    public:
+
+    using Extents = std::vector<std::pair<size_t, size_t>>;
+
+    private:
+
+    tl::mutex         m_mtx;
+    std::atomic<bool> m_tracking{false};
+    bool              m_whole = false;
+    Extents           m_extents;
+
+    public:
+
+    /**
+     * @brief Start tracking. Returns false if tracking already started.
+     */
+    bool start() {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(m_tracking) return false;
+        m_whole = false;
+        m_extents.clear();
+        m_tracking.store(true, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Stop tracking and forget the extents recorded.
+     */
+    void stop() {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        m_tracking.store(false, std::memory_order_release);
+        m_whole = false;
+        Extents{}.swap(m_extents);
+    }
+
+    /**
+     * @brief Record size bytes written at the given offset.
+     */
+    void add(size_t offset, size_t size) {
+        if(!m_tracking.load(std::memory_order_acquire) || size == 0) return;
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(m_tracking && !m_whole) m_extents.emplace_back(offset, size);
+    }
+
+    /**
+     * @brief Record a modification whose extents are unknown,
+     * which makes the whole file dirty.
+     */
+    void addWhole() {
+        if(!m_tracking.load(std::memory_order_acquire)) return;
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(!m_tracking) return;
+        m_whole = true;
+        Extents{}.swap(m_extents);
+    }
+
+    /**
+     * @brief Return the extents recorded since tracking started or since
+     * the previous call, merged and clamped to a file of fileSize bytes,
+     * and forget them.
+     */
+    Extents take(size_t fileSize) {
+        Extents dirty;
+        {
+            std::lock_guard<tl::mutex> lock{m_mtx};
+            if(m_whole) {
+                m_whole = false;
+                if(fileSize) dirty.emplace_back(0, fileSize);
+                return dirty;
+            }
+            dirty.swap(m_extents);
+        }
+        Extents merged;
+        for(auto& e : dirty) {
+            if(e.first >= fileSize) continue;
+            e.second = std::min(e.second, fileSize - e.first);
+            merged.push_back(e);
+        }
+        std::sort(merged.begin(), merged.end());
+        size_t n = 0;
+        for(size_t i = 0; i < merged.size(); ++i) {
+            if(n && merged[n-1].first + merged[n-1].second >= merged[i].first) {
+                auto end = std::max(merged[n-1].first + merged[n-1].second,
+                                    merged[i].first + merged[i].second);
+                merged[n-1].second = end - merged[n-1].first;
+            } else {
+                merged[n++] = merged[i];
+            }
+        }
+        merged.resize(n);
+        return merged;
+    }
+};
+
+}
+
+#endif
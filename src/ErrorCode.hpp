@@ -0,0 +1,104 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_ERROR_CODE_HPP
+#define __WARABI_ERROR_CODE_HPP
+
+#include "warabi/Result.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace warabi {
+
+/**
+ * @brief Error codes carried by the responses of the RPCs that operate
+ * on regions, so that clients can react to an error (e.g. follow a
+ * migrated region) without parsing its message. Version 2 responses
+ * pack them in a byte along with 2 flags, hence at most 63 codes.
+ */
+enum class ErrorCode : uint8_t {
+    Success = 0,
+    NoTarget,        // the provider has no target
+    InvalidRegion,   // the region does not exist or cannot be accessed
+    InvalidLayout,   // the layout could not be received or does not match the data
+    Backend,         // the backend or the transfer manager failed
+    Moved,           // the region was migrated to another provider
+    InvalidArgument, // another argument of the request is invalid
+};
+
+inline const char* errorMessage(ErrorCode code) {
+    switch(code) {
+    case ErrorCode::Success:         return "";
+    case ErrorCode::NoTarget:        return "No target found in the provider";
+    case ErrorCode::InvalidRegion:   return "Invalid region";
+    case ErrorCode::InvalidLayout:   return "Invalid layout";
+    case ErrorCode::Backend:         return "Backend error";
+    case ErrorCode::Moved:           return "Region was migrated to another provider";
+    case ErrorCode::InvalidArgument: return "Invalid argument";
+    }
+    return "Unknown error";
+}
+
+/**
+ * @brief Result along with the ErrorCode describing its failure, as
+ * produced by handlers and returned to the client by waitForResult.
+ */
+template<typename T>
+class CodedResult : public Result<T> {
+
+    public:
+
+    ErrorCode code = ErrorCode::Success;
+
+    CodedResult() = default;
+
+    CodedResult(Result<T>&& result, ErrorCode code)
+    : Result<T>(std::move(result))
+    , code(code) {}
+
+    /**
+     * @brief Assign a Result produced by a backend or transfer manager.
+     */
+    CodedResult& operator=(Result<T>&& other) {
+        Result<T>::operator=(std::move(other));
+        code = this->success() ? ErrorCode::Success : ErrorCode::Backend;
+        return *this;
+    }
+};
+
+/**
+ * @brief ErrorCode of a result, Backend if it failed without a code.
+ */
+template<typename T>
+ErrorCode errorCode(const Result<T>& result) {
+    return result.success() ? ErrorCode::Success : ErrorCode::Backend;
+}
+
+template<typename T>
+ErrorCode errorCode(const CodedResult<T>& result) {
+    if(result.success()) return ErrorCode::Success;
+    return result.code == ErrorCode::Success ? ErrorCode::Backend : result.code;
+}
+
+/**
+ * @brief Record an error in the result of a handler. If message
+ * is empty, the default message of the code is used.
+ */
+template<typename T>
+void fail(Result<T>& result, ErrorCode code, std::string message = {}) {
+    result.success() = false;
+    result.error() = message.empty() ? std::string{errorMessage(code)} : std::move(message);
+}
+
+template<typename T>
+void fail(CodedResult<T>& result, ErrorCode code, std::string message = {}) {
+    fail(static_cast<Result<T>&>(result), code, std::move(message));
+    result.code = code;
+}
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "EventLog.hpp"
+#include "warabi/Exception.hpp"
+#include <fmt/format.h>
+#include <fmt/args.h>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#include <vector>
+
+namespace warabi {
+
+/*
+ * Binary format (native endianness):
+ * - magic (8 bytes): "WRBEVLG1"
+ * - provider id (uint16_t)
+ * - number of format strings (uint32_t), then for each format string
+ *   its length (uint32_t) followed by its characters
+ * - number of records (uint64_t), then for each record:
+ *   timestamp (uint64_t), format index (uint32_t), xstream (int32_t),
+ *   number of arguments (uint8_t), arguments (uint64_t each)
+ */
+static constexpr char EventLogMagic[8] = {'W','R','B','E','V','L','G','1'};
+
+template<typename T>
+static void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+static void readValue(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    if(!in) throw Exception{"Invalid or truncated event log"};
+}
+
+EventLog::EventLog(uint16_t provider_id, size_t events_per_xstream, size_t max_xstreams)
+: m_provider_id(provider_id)
+, m_records(events_per_xstream, max_xstreams)
+, m_epoch(0) {
+    m_epoch = now();
+}
+
+void EventLog::dump(const std::string& filename) const {
+    std::vector<const char*>                 formats;
+    std::unordered_map<const char*, uint32_t> formatIndices;
+    std::vector<EventRecord>                 records;
+    m_records.forEach([&](const EventRecord& r) {
+        if(!r.format) return;
+        if(formatIndices.emplace(r.format, (uint32_t)formats.size()).second)
+            formats.push_back(r.format);
+        records.push_back(r);
+    });
+
+    std::ofstream out(filename, std::ios::out | std::ios::trunc | std::ios::binary);
+    if(!out.good())
+        throw Exception{fmt::format("Could not open {} to write event log", filename)};
+    out.write(EventLogMagic, sizeof(EventLogMagic));
+    writeValue(out, m_provider_id);
+    writeValue(out, (uint32_t)formats.size());
+    for(auto f : formats) {
+        auto length = (uint32_t)std::strlen(f);
+        writeValue(out, length);
+        out.write(f, length);
+    }
+    writeValue(out, (uint64_t)records.size());
+    for(auto& r : records) {
+        writeValue(out, r.timestamp);
+        writeValue(out, formatIndices[r.format]);
+        writeValue(out, r.xstream);
+        writeValue(out, r.num_args);
+        for(uint8_t i = 0; i < r.num_args; ++i)
+            writeValue(out, r.args[i]);
+    }
+    if(!out.good())
+        throw Exception{fmt::format("Could not write event log to {}", filename)};
+}
+
+void EventLog::decode(std::istream& in, std::ostream& out) {
+    char magic[sizeof(EventLogMagic)];
+    in.read(magic, sizeof(magic));
+    if(!in || std::memcmp(magic, EventLogMagic, sizeof(magic)) != 0)
+        throw Exception{"Invalid event log (wrong magic number)"};
+    uint16_t provider_id;
+    readValue(in, provider_id);
+    uint32_t numFormats;
+    readValue(in, numFormats);
+    std::vector<std::string> formats(numFormats);
+    for(auto& f : formats) {
+        uint32_t length;
+        readValue(in, length);
+        f.resize(length);
+        in.read(f.data(), length);
+        if(!in) throw Exception{"Invalid or truncated event log"};
+    }
+
+    struct Record {
+        uint64_t timestamp;
+        uint32_t format;
+        int32_t  xstream;
+        uint8_t  num_args;
+        uint64_t args[2];
+    };
+    uint64_t numRecords;
+    readValue(in, numRecords);
+    std::vector<Record> records(numRecords);
+    for(auto& r : records) {
+        readValue(in, r.timestamp);
+        readValue(in, r.format);
+        readValue(in, r.xstream);
+        readValue(in, r.num_args);
+        if(r.format >= formats.size() || r.num_args > 2)
+            throw Exception{"Invalid event log (corrupted record)"};
+        for(uint8_t i = 0; i < r.num_args; ++i)
+            readValue(in, r.args[i]);
+    }
+    std::stable_sort(records.begin(), records.end(),
+        [](const Record& a, const Record& b) { return a.timestamp < b.timestamp; });
+
+    for(auto& r : records) {
+        fmt::dynamic_format_arg_store<fmt::format_context> args;
+        for(uint8_t i = 0; i < r.num_args; ++i)
+            args.push_back(r.args[i]);
+        std::string message;
+        try {
+            message = fmt::vformat(formats[r.format], args);
+        } catch(const fmt::format_error&) {
+            message = formats[r.format];
+        }
+        out << fmt::format("[{:.3f}us] [xstream {}] [warabi:{}] {}\n",
+                           r.timestamp/1000.0, r.xstream, provider_id, message);
+    }
+}
+
+}
@@ -0,0 +1,100 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_EVENT_LOG_HPP
+#define __WARABI_EVENT_LOG_HPP
+
+#include "XstreamRings.hpp"
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <type_traits>
+
+namespace warabi {
+
+/**
+ * @brief A log message recorded in binary form: a pointer to
+ * its (static) format string and its integer arguments.
+ */
+struct EventRecord {
+    const char* format    = nullptr;
+    uint64_t    timestamp = 0; // ns since the EventLog's creation
+    uint64_t    args[2]   = {0, 0};
+    uint8_t     num_args  = 0;
+    int32_t     xstream   = 0;
+};
+
+/**
+ * @brief The EventLog is a binary structured log for hot paths.
+ * Instead of formatting messages, it records the address of their
+ * format string and their arguments into per-xstream ring buffers
+ * (see XstreamRings). Formatting is deferred to decode(), which
+ * converts a file produced by dump() into text.
+ *
+ * Format strings must have static storage duration (e.g. literals)
+ * and take at most two integer arguments.
+ */
+class EventLog {
+
+    uint16_t                  m_provider_id;
+    XstreamRings<EventRecord> m_records;
+    uint64_t                  m_epoch;
+
+    public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param provider_id Provider id (written in the file header).
+     * @param events_per_xstream Capacity of each ring buffer.
+     * @param max_xstreams Number of ring buffers.
+     */
+    EventLog(uint16_t provider_id, size_t events_per_xstream, size_t max_xstreams);
+
+    /**
+     * @brief Record a message.
+     */
+    template<typename ... Args>
+    void record(const char* format, Args... args) {
+        static_assert(sizeof...(Args) <= 2,
+            "EventLog messages can have at most 2 arguments");
+        static_assert((std::is_integral_v<Args> && ...),
+            "EventLog message arguments must be integers");
+        auto timestamp = now();
+        m_records.record([&](EventRecord& r, int32_t xstream) {
+            r.format    = format;
+            r.timestamp = timestamp;
+            r.num_args  = sizeof...(Args);
+            r.xstream   = xstream;
+            [[maybe_unused]] size_t i = 0;
+            ((r.args[i++] = static_cast<uint64_t>(args)), ...);
+        });
+    }
+
+    /**
+     * @brief Write the recorded messages into a binary file.
+     * Throws an Exception if the file cannot be written.
+     */
+    void dump(const std::string& filename) const;
+
+    /**
+     * @brief Convert a binary stream produced by dump() into text,
+     * one message per line, sorted by timestamp.
+     * Throws an Exception if the stream is not a valid event log.
+     */
+    static void decode(std::istream& in, std::ostream& out);
+
+    private:
+
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count() - m_epoch;
+    }
+};
+
+}
+
+#endif
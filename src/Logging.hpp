@@ -0,0 +1,55 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_LOGGING_HPP
+#define __WARABI_LOGGING_HPP
+
+#include "config.h"
+#include <spdlog/spdlog.h>
+#include <fmt/format.h>
+#include <iterator>
+#include <utility>
+
+/*
+ * Messages with a level lower than WARABI_LOG_LEVEL are compiled out.
+ * Levels follow spdlog's numbering: 0 = trace, 1 = debug, 2 = info,
+ * 3 = warn, 4 = error, 5 = critical, 6 = off. It is defined in config.h
+ * from the WARABI_LOG_LEVEL CMake variable.
+ */
+#ifndef WARABI_LOG_LEVEL
+#define WARABI_LOG_LEVEL 0
+#endif
+
+namespace warabi {
+
+/**
+ * @brief Log a message with the specified level, prefixed with
+ * the provider id. The level of the default spdlog logger is checked
+ * before the message is formatted, and the message is formatted into
+ * a stack buffer, so a disabled message costs a single comparison.
+ * Note that arguments are still evaluated by the caller.
+ *
+ * @tparam Level Log level.
+ * @param provider_id Provider id.
+ * @param args Format string followed by its arguments.
+ */
+template<spdlog::level::level_enum Level, typename ... Args>
+inline void log(uint16_t provider_id, Args&&... args) {
+    if constexpr (static_cast<int>(Level) < WARABI_LOG_LEVEL) {
+        (void)provider_id;
+        ((void)args, ...);
+    } else {
+        auto logger = spdlog::default_logger_raw();
+        if(!logger->should_log(Level)) return;
+        fmt::memory_buffer msg;
+        fmt::format_to(std::back_inserter(msg), "[warabi:{}] ", provider_id);
+        fmt::format_to(std::back_inserter(msg), std::forward<Args>(args)...);
+        logger->log(Level, spdlog::string_view_t{msg.data(), msg.size()});
+    }
+}
+
+}
+
+#endif
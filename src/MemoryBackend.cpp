@@ -4,10 +4,23 @@
  * See COPYRIGHT in top-level directory.
  */
 #include "MemoryBackend.hpp"
+#include "Tracing.hpp"
+#include <nlohmann/json-schema.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <iostream>
+#include <unordered_map>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 namespace warabi {
 
+using nlohmann::json_schema::json_validator;
+
 WARABI_REGISTER_BACKEND(memory, MemoryTarget);
 
 struct MemoryRegion : public WritableRegion, public ReadableRegion {
@@ -39,6 +52,22 @@ struct MemoryRegion : public WritableRegion, public ReadableRegion {
         return segments;
     }
 
+    Result<bool> checkBounds(
+        const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) const {
+        Result<bool> result;
+        for(auto& segment : regionOffsetSizes) {
+            if(segment.first > m_region.size()
+            || segment.second > m_region.size() - segment.first) {
+                result.success() = false;
+                result.error() = fmt::format(
+                    "Range [{}, {}) is out of the bounds of the region (size {})",
+                    segment.first, segment.first + segment.second, m_region.size());
+                break;
+            }
+        }
+        return result;
+    }
+
     Result<RegionID> getRegionID() override {
         Result<RegionID> result;
         result.value() = m_id;
@@ -52,14 +81,18 @@ struct MemoryRegion : public WritableRegion, public ReadableRegion {
             size_t remoteBulkOffset,
             bool persist) override {
         (void)persist;
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         if(segments.size() == 0) return result;
         size_t totalSize = std::accumulate(
             segments.begin(), segments.end(), (size_t)0,
             [](size_t acc, const auto& pair) { return acc + pair.second; });
         auto localBulk = m_engine.expose(segments, thallium::bulk_mode::write_only);
-        localBulk << remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk << remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        }
         return result;
     }
 
@@ -67,7 +100,8 @@ struct MemoryRegion : public WritableRegion, public ReadableRegion {
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
             const void* data, bool persist) override {
         (void)persist;
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         size_t offset = 0;
         const char* ptr = (const char*)data;
@@ -89,21 +123,26 @@ struct MemoryRegion : public WritableRegion, public ReadableRegion {
             thallium::bulk remoteBulk,
             const thallium::endpoint& address,
             size_t remoteBulkOffset) override {
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         if(segments.size() == 0) return result;
         size_t totalSize = std::accumulate(
             segments.begin(), segments.end(), (size_t)0,
             [](size_t acc, const auto& pair) { return acc + pair.second; });
         auto localBulk = m_engine.expose(segments, thallium::bulk_mode::read_only);
-        localBulk >> remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk >> remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        }
         return result;
      }
 
     Result<bool> read(
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
             void* data) override {
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         if(segments.size() == 0) return result;
         size_t offset = 0;
@@ -116,10 +155,202 @@ struct MemoryRegion : public WritableRegion, public ReadableRegion {
     }
 };
 
+/*
+ * Snapshot of a memory target, written upon migration. The file starts
+ * with a SnapshotHeader, followed by the index (one SnapshotEntry per
+ * region, in the order of their RegionIDs) and by the content of the
+ * regions, each starting on a page boundary so that the file can be
+ * mapped and its regions read in place. Regions shared by clones are
+ * stored once. Integers are in the byte order of the host.
+ */
+struct SnapshotHeader {
+    char     magic[8];
+    uint64_t num_regions;
+    uint64_t file_size;
+};
+
+struct SnapshotEntry {
+    uint64_t offset; // 0 for empty regions
+    uint64_t size;
+};
+
+static constexpr char   s_snapshot_magic[8]  = {'W', 'A', 'R', 'A', 'B', 'I', 'M', '1'};
+static constexpr size_t s_snapshot_alignment = 4096;
+static constexpr size_t s_snapshot_chunk     = 8*1024*1024;
+
+static uint64_t alignSnapshotOffset(uint64_t offset) {
+    return (offset + s_snapshot_alignment - 1) / s_snapshot_alignment * s_snapshot_alignment;
+}
+
+/**
+ * @brief Write size bytes at the given offset of a file,
+ * returning 0 or the errno of the failed call.
+ */
+static int writeAll(int fd, const char* data, size_t size, uint64_t offset) {
+    while(size) {
+        auto written = ::pwrite(fd, data, size, offset);
+        if(written < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        data   += written;
+        size   -= written;
+        offset += written;
+    }
+    return 0;
+}
+
+/**
+ * @brief Snapshot file mapped in memory, from which the regions of
+ * a recovered target are copied. Entries are only accessed with the
+ * m_mutex of the target held.
+ */
+struct MemoryTarget::Snapshot {
+
+    std::string          path;
+    const char*          data = nullptr;
+    size_t               size = 0;
+    const SnapshotEntry* entries = nullptr;
+    size_t               num_regions = 0;
+    // set once the content of the file is held elsewhere (all its regions
+    // were loaded, or migrated away), so that the file can be removed
+    bool                 consumed = false;
+    // regions loaded, by offset in the file, to share them again among clones
+    std::unordered_map<uint64_t, std::weak_ptr<std::vector<char>>> loaded;
+
+    static Result<std::shared_ptr<Snapshot>> open(const std::string& path) {
+        Result<std::shared_ptr<Snapshot>> result;
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if(fd < 0) {
+            result.success() = false;
+            result.error() = fmt::format("Could not open snapshot {}: {}", path, strerror(errno));
+            return result;
+        }
+        struct stat statbuf;
+        if(fstat(fd, &statbuf) < 0) {
+            result.success() = false;
+            result.error() = fmt::format("Could not fstat snapshot {}: {}", path, strerror(errno));
+            ::close(fd);
+            return result;
+        }
+        auto snapshot = std::make_shared<Snapshot>();
+        snapshot->path = path;
+        snapshot->size = statbuf.st_size;
+        if(snapshot->size < sizeof(SnapshotHeader)) {
+            ::close(fd);
+            result.success() = false;
+            result.error() = fmt::format("File {} is not a memory target snapshot", path);
+            return result;
+        }
+        void* addr = mmap(nullptr, snapshot->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if(addr == MAP_FAILED) {
+            result.success() = false;
+            result.error() = fmt::format("Could not map snapshot {}: {}", path, strerror(errno));
+            return result;
+        }
+        // the background loader reads the regions in order
+        madvise(addr, snapshot->size, MADV_SEQUENTIAL);
+        snapshot->data = static_cast<const char*>(addr);
+        SnapshotHeader header;
+        std::memcpy(&header, snapshot->data, sizeof(header));
+        bool valid = std::memcmp(header.magic, s_snapshot_magic, sizeof(header.magic)) == 0
+                  && header.file_size == snapshot->size
+                  && header.num_regions <= (snapshot->size - sizeof(header)) / sizeof(SnapshotEntry);
+        if(valid) {
+            snapshot->entries = reinterpret_cast<const SnapshotEntry*>(snapshot->data + sizeof(header));
+            snapshot->num_regions = header.num_regions;
+            for(size_t i = 0; valid && i < snapshot->num_regions; ++i) {
+                auto& entry = snapshot->entries[i];
+                valid = entry.offset <= snapshot->size && entry.size <= snapshot->size - entry.offset;
+            }
+        }
+        if(!valid) {
+            result.success() = false;
+            result.error() = fmt::format("File {} is not a valid memory target snapshot", path);
+            return result;
+        }
+        result.value() = std::move(snapshot);
+        return result;
+    }
+
+    /**
+     * @brief Release the mapping, and remove the file if it was consumed.
+     * A snapshot that failed to open or to load completely is kept, since
+     * it may be the only copy of the target.
+     */
+    void release() {
+        if(!data) return;
+        munmap(const_cast<char*>(data), size);
+        data = nullptr;
+        entries = nullptr;
+        loaded.clear();
+        if(consumed) ::unlink(path.c_str());
+    }
+
+    ~Snapshot() {
+        release();
+    }
+};
+
+/**
+ * @brief Handle of the migration of a memory target, holding the lock
+ * of the target and the snapshot file written for REMI to send.
+ */
+struct MemoryTarget::MemoryMigrationHandle : public MigrationHandle {
+
+    MemoryTarget&                     m_target;
+    std::unique_lock<thallium::mutex> m_lock;
+    std::string                       m_root;
+    std::string                       m_file;
+    bool                              m_remove_source;
+
+    MemoryMigrationHandle(MemoryTarget& target,
+                          std::unique_lock<thallium::mutex>&& lock,
+                          std::string root, std::string file,
+                          bool removeSource)
+    : m_target(target)
+    , m_lock(std::move(lock))
+    , m_root(std::move(root))
+    , m_file(std::move(file))
+    , m_remove_source(removeSource) {}
+
+    ~MemoryMigrationHandle() {
+        ::unlink((m_root + "/" + m_file).c_str());
+        if(m_remove_source) {
+            m_target.m_regions.clear();
+            if(m_target.m_snapshot) {
+                // the regions not loaded yet were sent from the mapping
+                m_target.m_snapshot->consumed = true;
+                m_target.m_snapshot->release();
+            }
+        }
+    }
+
+    std::string getRoot() const override {
+        return m_root;
+    }
+
+    std::list<std::string> getFiles() const override {
+        return {m_file};
+    }
+
+    void cancel() override {
+        m_remove_source = false;
+    }
+};
+
 MemoryTarget::MemoryTarget(thallium::engine engine, const json& config)
 : m_engine(std::move(engine))
 , m_config(config) {}
 
+MemoryTarget::~MemoryTarget() {
+    if(m_loader) {
+        m_stop_loading = true;
+        (*m_loader)->join();
+    }
+}
+
 std::string MemoryTarget::getConfig() const {
     return m_config.dump();
 }
@@ -133,13 +364,10 @@ Result<bool> MemoryTarget::destroy() {
 Result<std::unique_ptr<WritableRegion>> MemoryTarget::create(size_t size) {
     Result<std::unique_ptr<WritableRegion>> result;
     auto lock = std::unique_lock<thallium::mutex>{m_mutex};
-    m_regions.emplace_back(size);
-    auto& region = m_regions.back();
-    uint64_t index = m_regions.size() - 1;
-    RegionID region_id;
-    uint64_t s = size;
-    std::memcpy(region_id.data(), static_cast<void*>(&index), sizeof(index));
-    std::memcpy(region_id.data() + sizeof(index), static_cast<void*>(&s), sizeof(s));
+    m_regions.push_back(std::make_shared<std::vector<char>>(size));
+    auto& region = *m_regions.back();
+    auto region_id = indexToRegionID(m_regions.size() - 1, size);
+    m_tails.created(region_id);
     result.value() = std::make_unique<MemoryRegion>(m_engine, region_id, region, std::move(lock));
     return result;
 }
@@ -150,6 +378,33 @@ ssize_t MemoryTarget::regiondIDtoIndex(const RegionID& regionID) {
     return static_cast<ssize_t>(r);
 }
 
+RegionID MemoryTarget::indexToRegionID(uint64_t index, uint64_t size) {
+    RegionID region_id;
+    std::memcpy(region_id.data(), static_cast<void*>(&index), sizeof(index));
+    std::memcpy(region_id.data() + sizeof(index), static_cast<void*>(&size), sizeof(size));
+    return region_id;
+}
+
+std::vector<char>& MemoryTarget::content(size_t index) {
+    auto& region = m_regions[index];
+    if(region) return *region;
+    auto& entry = m_snapshot->entries[index];
+    auto& shared = m_snapshot->loaded[entry.offset];
+    if(entry.size && (region = shared.lock())) return *region;
+    const char* data = m_snapshot->data + entry.offset;
+    region = std::make_shared<std::vector<char>>(data, data + entry.size);
+    if(entry.size) shared = region;
+    return *region;
+}
+
+std::vector<char>& MemoryTarget::unshare(size_t index) {
+    auto& region = m_regions[index];
+    content(index);
+    if(region.use_count() > 1)
+        region = std::make_shared<std::vector<char>>(*region);
+    return *region;
+}
+
 Result<std::unique_ptr<WritableRegion>> MemoryTarget::write(const RegionID& region_id, bool persist) {
     (void)persist;
     Result<std::unique_ptr<WritableRegion>> result;
@@ -165,7 +420,10 @@ Result<std::unique_ptr<WritableRegion>> MemoryTarget::write(const RegionID& regi
         result.success() = false;
         return result;
     }
-    result.value() = std::make_unique<MemoryRegion>(m_engine, region_id, m_regions[index], std::move(lock));
+    auto& region = unshare(index);
+    auto tail = m_tails.end(region_id);
+    if(region.size() < tail) region.resize(tail);
+    result.value() = std::make_unique<MemoryRegion>(m_engine, region_id, region, std::move(lock));
     return result;
 }
 
@@ -183,7 +441,7 @@ Result<std::unique_ptr<ReadableRegion>> MemoryTarget::read(const RegionID& regio
         result.success() = false;
         return result;
     }
-    result.value() = std::make_unique<MemoryRegion>(m_engine, region_id, m_regions[index], std::move(lock));
+    result.value() = std::make_unique<MemoryRegion>(m_engine, region_id, content(index), std::move(lock));
     return result;
 }
 
@@ -196,27 +454,239 @@ Result<bool> MemoryTarget::erase(const RegionID& region_id) {
         result.success() = false;
         return result;
     }
-    m_regions[index].clear();
+    m_regions[index] = std::make_shared<std::vector<char>>();
+    m_tails.erased(region_id);
+    return result;
+}
+
+Result<size_t> MemoryTarget::reserve(const RegionID& region_id, size_t size) {
+    Result<size_t> result;
+    if(regiondIDtoIndex(region_id) < 0) {
+        result.error() = "Invalid RegionID";
+        result.success() = false;
+        return result;
+    }
+    // regions of this backend grow to accommodate the appended
+    // data, when write() is called for the reserved range
+    return m_tails.reserve(region_id, size);
+}
+
+bool MemoryTarget::unreserve(const RegionID& region_id, size_t offset, size_t size) {
+    return m_tails.release(region_id, offset, size);
+}
+
+Result<RegionID> MemoryTarget::resize(const RegionID& region_id, size_t size) {
+    Result<RegionID> result;
+    auto index = regiondIDtoIndex(region_id);
+    auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+    if(index < 0 || index >= (ssize_t)m_regions.size()) {
+        result.error() = "Invalid RegionID";
+        result.success() = false;
+        return result;
+    }
+    // regions are resized in place: their RegionID does not change
+    unshare(index).resize(size);
+    m_tails.resized(region_id, region_id, size);
+    result.value() = region_id;
+    return result;
+}
+
+Result<bool> MemoryTarget::copy(const RegionID& source, size_t sourceOffset,
+                                const RegionID& dest, size_t destOffset,
+                                size_t size) {
+    Result<bool> result;
+    auto sourceIndex = regiondIDtoIndex(source);
+    auto destIndex = regiondIDtoIndex(dest);
+    auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+    if(sourceIndex < 0 || sourceIndex >= (ssize_t)m_regions.size()
+    || destIndex < 0 || destIndex >= (ssize_t)m_regions.size()) {
+        result.error() = "Invalid RegionID";
+        result.success() = false;
+        return result;
+    }
+    auto& to = unshare(destIndex);
+    auto& from = content(sourceIndex);
+    if(sourceOffset > from.size() || size > from.size() - sourceOffset
+    || destOffset > to.size() || size > to.size() - destOffset) {
+        result.error() = fmt::format(
+            "Cannot copy {} bytes from offset {} (region size {}) to offset {} (region size {})",
+            size, sourceOffset, from.size(), destOffset, to.size());
+        result.success() = false;
+        return result;
+    }
+    if(size) std::memmove(to.data() + destOffset, from.data() + sourceOffset, size);
+    return result;
+}
+
+Result<size_t> MemoryTarget::size(const RegionID& region_id) {
+    Result<size_t> result;
+    auto index = regiondIDtoIndex(region_id);
+    auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+    if(index < 0 || index >= (ssize_t)m_regions.size()) {
+        result.error() = "Invalid RegionID";
+        result.success() = false;
+        return result;
+    }
+    result.value() = content(index).size();
+    return result;
+}
+
+Result<RegionID> MemoryTarget::clone(const RegionID& region_id) {
+    Result<RegionID> result;
+    auto index = regiondIDtoIndex(region_id);
+    auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+    if(index < 0 || index >= (ssize_t)m_regions.size()) {
+        result.error() = "Invalid RegionID";
+        result.success() = false;
+        return result;
+    }
+    // the clone shares the content of the region until either is written
+    content(index);
+    auto shared = m_regions[index];
+    m_regions.push_back(std::move(shared));
+    result.value() = indexToRegionID(m_regions.size() - 1, m_regions.back()->size());
+    return result;
+}
+
+Result<bool> MemoryTarget::writeSnapshot(int fd, const std::string& path, size_t threads) {
+    Result<bool> result;
+    // lay out the index and the content of the regions
+    struct Chunk {
+        uint64_t    offset;
+        const char* data;
+        size_t      size;
+    };
+    std::vector<SnapshotEntry> index(m_regions.size());
+    std::vector<Chunk> chunks;
+    std::unordered_map<const char*, uint64_t> stored;
+    uint64_t end = alignSnapshotOffset(sizeof(SnapshotHeader) + index.size()*sizeof(SnapshotEntry));
+    for(size_t i = 0; i < m_regions.size(); ++i) {
+        // regions not loaded yet are written straight from the mapping
+        const char* data = nullptr;
+        size_t size = 0;
+        if(m_regions[i]) {
+            data = m_regions[i]->data();
+            size = m_regions[i]->size();
+        } else {
+            data = m_snapshot->data + m_snapshot->entries[i].offset;
+            size = m_snapshot->entries[i].size;
+        }
+        index[i].size = size;
+        if(size == 0) continue;
+        auto it = stored.find(data);
+        if(it != stored.end()) {
+            index[i].offset = it->second;
+            continue;
+        }
+        index[i].offset = end;
+        stored.emplace(data, end);
+        for(size_t offset = 0; offset < size; offset += s_snapshot_chunk)
+            chunks.push_back({end + offset, data + offset, std::min(s_snapshot_chunk, size - offset)});
+        end = alignSnapshotOffset(end + size);
+    }
+    SnapshotHeader header;
+    std::memcpy(header.magic, s_snapshot_magic, sizeof(header.magic));
+    header.num_regions = index.size();
+    header.file_size = end;
+    int err = 0;
+    if(ftruncate(fd, end) < 0) err = errno;
+    if(!err) err = writeAll(fd, reinterpret_cast<const char*>(&header), sizeof(header), 0);
+    if(!err) err = writeAll(fd, reinterpret_cast<const char*>(index.data()),
+                            index.size()*sizeof(SnapshotEntry), sizeof(header));
+    // write the content in chunks, from several execution streams
+    std::atomic<size_t> next{0};
+    std::atomic<int> chunkErr{0};
+    auto writeChunks = [&]() {
+        for(size_t i = next++; i < chunks.size() && !chunkErr; i = next++) {
+            int e = writeAll(fd, chunks[i].data, chunks[i].size, chunks[i].offset);
+            if(e) chunkErr = e;
+        }
+    };
+    threads = std::min(threads, chunks.size());
+    if(!err && threads <= 1) {
+        writeChunks();
+    } else if(!err) {
+        std::vector<thallium::managed<thallium::xstream>> streams;
+        std::vector<thallium::managed<thallium::thread>> ults;
+        for(size_t i = 0; i < threads; ++i) {
+            streams.push_back(thallium::xstream::create());
+            ults.push_back(streams.back()->make_thread(writeChunks));
+        }
+        for(auto& ult : ults) ult->join();
+        for(auto& stream : streams) stream->join();
+    }
+    if(!err) err = chunkErr;
+    if(err) {
+        result.success() = false;
+        result.error() = fmt::format("Could not write snapshot {}: {}", path, strerror(err));
+    }
     return result;
 }
 
 Result<std::unique_ptr<MigrationHandle>> MemoryTarget::startMigration(bool removeSource) {
     Result<std::unique_ptr<MigrationHandle>> result;
-    result.success() = false;
-    result.error() = "startMigration operation not implemented";
-    (void)removeSource;
-    // TODO
+    auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+    auto root = m_config.value("snapshot_dir", std::string{"/tmp"});
+    auto threads = m_config.value("snapshot_threads", (size_t)4);
+    std::string path = root + "/warabi-memory-XXXXXX";
+    int fd = mkstemp(path.data());
+    if(fd < 0) {
+        result.success() = false;
+        result.error() = fmt::format("Could not create snapshot in {}: {}", root, strerror(errno));
+        return result;
+    }
+    auto written = writeSnapshot(fd, path, threads);
+    ::close(fd);
+    if(!written.success()) {
+        ::unlink(path.c_str());
+        result.success() = false;
+        result.error() = written.error();
+        return result;
+    }
+    result.value() = std::make_unique<MemoryMigrationHandle>(
+        *this, std::move(lock), root, path.substr(root.size() + 1), removeSource);
     return result;
 }
 
+void MemoryTarget::startLoading() {
+    m_loader = m_engine.get_handler_pool().make_thread([this]() {
+        for(size_t i = 0; !m_stop_loading; ++i) {
+            {
+                auto lock = std::unique_lock<thallium::mutex>{m_mutex};
+                // regions may have been removed by a migration
+                if(i >= m_snapshot->num_regions || i >= m_regions.size()) {
+                    if(i >= m_snapshot->num_regions) m_snapshot->consumed = true;
+                    m_snapshot->release();
+                    break;
+                }
+                content(i);
+            }
+            thallium::thread::yield();
+        }
+    });
+}
+
 Result<std::unique_ptr<warabi::Backend>> MemoryTarget::recover(
         const thallium::engine& engine, const json& config,
         const std::vector<std::string>& filenames) {
     Result<std::unique_ptr<warabi::Backend>> result;
-    (void)engine;
-    (void)config;
-    (void)filenames;
-    // TODO
+    if(filenames.size() != 1) {
+        result.error() = "Memory backend recovers from exactly one snapshot file";
+        result.success() = false;
+        return result;
+    }
+    auto snapshot = Snapshot::open(filenames[0]);
+    if(!snapshot.success()) {
+        result.error() = snapshot.error();
+        result.success() = false;
+        return result;
+    }
+    auto target = std::make_unique<MemoryTarget>(engine, config);
+    target->m_snapshot = std::move(snapshot.value());
+    target->m_tails.setUnknown();
+    target->m_regions.resize(target->m_snapshot->num_regions);
+    target->startLoading();
+    result.value() = std::move(target);
     return result;
 }
 
@@ -227,8 +697,29 @@ Result<std::unique_ptr<warabi::Backend>> MemoryTarget::create(const thallium::en
 }
 
 Result<bool> MemoryTarget::validate(const json& config) {
-    (void)config;
-    return Result<bool>{};
+
+    static const json schema = R"(
+    {
+        "type": "object",
+        "properties": {
+            "snapshot_dir": {"type": "string"},
+            "snapshot_threads": {"type": "integer", "minimum": 1}
+        }
+    }
+    )"_json;
+
+    Result<bool> result;
+
+    json_validator validator;
+    validator.set_root_schema(schema);
+    try {
+        validator.validate(config);
+    } catch(const std::exception& ex) {
+        result.success() = false;
+        result.error() = fmt::format(
+            "Error(s) while validating JSON config for warabi MemoryTarget: {}", ex.what());
+    }
+    return result;
 }
 
 }
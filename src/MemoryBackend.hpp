@@ -7,6 +7,9 @@
 #define __MEMORY_BACKEND_HPP
 
 #include <warabi/Backend.hpp>
+#include "RegionTails.hpp"
+#include <atomic>
+#include <optional>
 
 namespace warabi {
 
@@ -19,11 +22,48 @@ class MemoryTarget : public warabi::Backend {
 
     thallium::engine               m_engine;
     json                           m_config;
-    std::vector<std::vector<char>> m_regions;
     thallium::mutex                m_mutex;
+    RegionTails                    m_tails;
+    // regions are shared by their clones until written (copy-on-write),
+    // and null until loaded if the target was recovered from a snapshot
+    std::vector<std::shared_ptr<std::vector<char>>> m_regions;
+
+    struct Snapshot;
+    struct MemoryMigrationHandle;
+
+    // snapshot the target was recovered from, and the ULT loading it
+    std::shared_ptr<Snapshot>               m_snapshot;
+    std::optional<thallium::managed<thallium::thread>> m_loader;
+    std::atomic<bool>                       m_stop_loading{false};
 
     static ssize_t regiondIDtoIndex(const RegionID& regionID);
 
+    static RegionID indexToRegionID(uint64_t index, uint64_t size);
+
+    /**
+     * @brief Content of a region, loaded from the snapshot the target
+     * was recovered from if it was not yet. Must be called with m_mutex held.
+     */
+    std::vector<char>& content(size_t index);
+
+    /**
+     * @brief Content of a region about to be modified, copied first
+     * if it is shared with clones. Must be called with m_mutex held.
+     */
+    std::vector<char>& unshare(size_t index);
+
+    /**
+     * @brief Write a snapshot of the regions into a file, using
+     * threads execution streams. Must be called with m_mutex held.
+     */
+    Result<bool> writeSnapshot(int fd, const std::string& path, size_t threads);
+
+    /**
+     * @brief Start a ULT loading the regions of the snapshot in the
+     * background, so that they are resident by the time they are accessed.
+     */
+    void startLoading();
+
     public:
 
     /**
@@ -44,7 +84,7 @@ class MemoryTarget : public warabi::Backend {
     /**
      * @brief Destructor.
      */
-    virtual ~MemoryTarget() = default;
+    virtual ~MemoryTarget();
 
     /**
      * @brief Get the target's configuration as a JSON-formatted string.
@@ -79,13 +119,46 @@ class MemoryTarget : public warabi::Backend {
      */
     Result<bool> erase(const RegionID& region) override;
 
+    /**
+     * @see Backend::reserve
+     */
+    Result<size_t> reserve(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::unreserve
+     */
+    bool unreserve(const RegionID& region, size_t offset, size_t size) override;
+
+    /**
+     * @see Backend::resize
+     */
+    Result<RegionID> resize(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::copy
+     */
+    Result<bool> copy(const RegionID& source, size_t sourceOffset,
+                      const RegionID& dest, size_t destOffset,
+                      size_t size) override;
+
+    /**
+     * @see Backend::clone
+     */
+    Result<RegionID> clone(const RegionID& region) override;
+
+    /**
+     * @see Backend::size
+     */
+    Result<size_t> size(const RegionID& region) override;
+
     /**
      * @brief Destroy the underlying storage.
      */
     Result<bool> destroy() override;
 
     /**
-     * @brief Start a migration.
+     * @brief Start a migration by writing a snapshot of the target
+     * (see MemoryTarget::recover for its format).
      */
     Result<std::unique_ptr<MigrationHandle>> startMigration(bool removeSource) override;
 
@@ -101,7 +174,10 @@ class MemoryTarget : public warabi::Backend {
     static Result<std::unique_ptr<warabi::Backend>> create(const thallium::engine& engine, const json& config);
 
     /**
-     * @brief Recovers after migration.
+     * @brief Recovers after migration from a snapshot file, which is
+     * mapped in memory. The target is available right away: regions are
+     * copied out of the mapping when first accessed, and by a background
+     * ULT, after which the file is removed.
      */
     static Result<std::unique_ptr<warabi::Backend>> recover(
         const thallium::engine& engine, const json& config,
@@ -0,0 +1,244 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_MIGRATION_DELTA_HPP
+#define __WARABI_MIGRATION_DELTA_HPP
+
+#include "warabi/Result.hpp"
+#include "warabi/Migration.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace warabi {
+
+/*
+ * Delta file sent by the second phase of an incremental migration, with
+ * the extents of the files of the target modified during the first phase.
+ * It starts with the magic string, followed by the number of files and,
+ * for each file, the length of its name, its name, its size, its number
+ * of extents and their offsets and sizes. The content of the extents
+ * follows, in the same order. Integers are 64-bit, in the byte order of
+ * the host.
+ */
+static constexpr char s_migration_delta_magic[8] = {'W', 'A', 'R', 'A', 'B', 'I', 'D', '1'};
+
+namespace delta {
+
+static inline int writeAll(int fd, const void* data, size_t size) {
+    auto ptr = static_cast<const char*>(data);
+    while(size) {
+        auto n = ::write(fd, ptr, size);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        ptr  += n;
+        size -= n;
+    }
+    return 0;
+}
+
+static inline int readAll(int fd, void* data, size_t size) {
+    auto ptr = static_cast<char*>(data);
+    while(size) {
+        auto n = ::read(fd, ptr, size);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        if(n == 0) return EIO; // truncated delta
+        ptr  += n;
+        size -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Copy size bytes from offset of a file to the current position of
+ * another (or from the current position of a file to offset of another).
+ */
+static inline int copyExtent(int from, int to, uint64_t offset, uint64_t size,
+                             bool fromOffset, std::vector<char>& buffer) {
+    while(size) {
+        size_t n = std::min<uint64_t>(size, buffer.size());
+        int err = 0;
+        if(fromOffset) {
+            size_t r = 0;
+            while(r < n) {
+                auto s = ::pread(from, buffer.data() + r, n - r, offset + r);
+                if(s < 0 && errno == EINTR) continue;
+                if(s < 0) {
+                    err = errno;
+                    break;
+                }
+                // a file may be shorter than an extent punched at its end
+                if(s == 0) {
+                    std::memset(buffer.data() + r, 0, n - r);
+                    break;
+                }
+                r += s;
+            }
+            if(!err) err = writeAll(to, buffer.data(), n);
+        } else {
+            err = readAll(from, buffer.data(), n);
+            for(size_t w = 0; !err && w < n;) {
+                auto s = ::pwrite(to, buffer.data() + w, n - w, offset + w);
+                if(s < 0 && errno == EINTR) continue;
+                if(s < 0) err = errno;
+                else w += s;
+            }
+        }
+        if(err) return err;
+        offset += n;
+        size   -= n;
+    }
+    return 0;
+}
+
+}
+
+/**
+ * @brief Write the extents of the files located in root into a delta file.
+ */
+static inline Result<bool> writeMigrationDelta(const std::string& path,
+                                               const std::string& root,
+                                               const std::vector<FileExtents>& files) {
+    Result<bool> result;
+    int out = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if(out < 0) {
+        result.success() = false;
+        result.error() = fmt::format("Could not create delta file {}: {}", path, strerror(errno));
+        return result;
+    }
+    int err = 0;
+    uint64_t count = files.size();
+    err = delta::writeAll(out, s_migration_delta_magic, sizeof(s_migration_delta_magic));
+    if(!err) err = delta::writeAll(out, &count, sizeof(count));
+    for(auto& file : files) {
+        uint64_t header[3] = {file.file.size(), 0, 0};
+        if(!err) err = delta::writeAll(out, &header[0], sizeof(header[0]));
+        if(!err) err = delta::writeAll(out, file.file.data(), file.file.size());
+        header[1] = file.size;
+        header[2] = file.extents.size();
+        if(!err) err = delta::writeAll(out, &header[1], 2*sizeof(header[1]));
+        for(auto& extent : file.extents) {
+            uint64_t e[2] = {extent.first, extent.second};
+            if(!err) err = delta::writeAll(out, e, sizeof(e));
+        }
+    }
+    std::vector<char> buffer(4*1024*1024);
+    for(size_t i = 0; !err && i < files.size(); ++i) {
+        auto filename = root.empty() ? files[i].file : root + "/" + files[i].file;
+        int in = ::open(filename.c_str(), O_RDONLY);
+        if(in < 0) {
+            err = errno;
+            break;
+        }
+        for(auto& extent : files[i].extents) {
+            err = delta::copyExtent(in, out, extent.first, extent.second, true, buffer);
+            if(err) break;
+        }
+        ::close(in);
+    }
+    ::close(out);
+    if(err) {
+        result.success() = false;
+        result.error() = fmt::format("Could not write delta file {}: {}", path, strerror(err));
+    }
+    return result;
+}
+
+/**
+ * @brief Apply a delta file to the files located in root. Each file named
+ * by the delta must be relative to root and be one of the given files.
+ */
+static inline Result<bool> applyMigrationDelta(const std::string& path,
+                                               const std::string& root,
+                                               const std::vector<std::string>& targetFiles) {
+    namespace fs = std::filesystem;
+    Result<bool> result;
+    int in = ::open(path.c_str(), O_RDONLY);
+    if(in < 0) {
+        result.success() = false;
+        result.error() = fmt::format("Could not open delta file {}: {}", path, strerror(errno));
+        return result;
+    }
+    char magic[sizeof(s_migration_delta_magic)];
+    uint64_t count = 0;
+    int err = delta::readAll(in, magic, sizeof(magic));
+    if(!err && std::memcmp(magic, s_migration_delta_magic, sizeof(magic)) != 0) err = EINVAL;
+    if(!err) err = delta::readAll(in, &count, sizeof(count));
+    std::vector<FileExtents> files;
+    for(uint64_t i = 0; !err && i < count; ++i) {
+        FileExtents file;
+        uint64_t header[3];
+        err = delta::readAll(in, &header[0], sizeof(header[0]));
+        if(!err && header[0] > 4096) err = EINVAL;
+        if(!err) {
+            file.file.resize(header[0]);
+            err = delta::readAll(in, &file.file[0], header[0]);
+        }
+        if(!err) {
+            bool invalid = file.file.empty() || fs::path{file.file}.is_absolute();
+            for(auto& part : fs::path{file.file}) invalid = invalid || part == "..";
+            auto name = (fs::path{root} / file.file).lexically_normal();
+            invalid = invalid || std::none_of(targetFiles.begin(), targetFiles.end(),
+                [&](const std::string& f) { return fs::path{f}.lexically_normal() == name; });
+            if(invalid) {
+                ::close(in);
+                result.success() = false;
+                result.error() = fmt::format(
+                    "Invalid file name {} in delta file {}", file.file, path);
+                return result;
+            }
+        }
+        if(!err) err = delta::readAll(in, &header[1], 2*sizeof(header[1]));
+        // extents are merged, so there are fewer of them than bytes
+        if(!err && header[2] > header[1]) err = EINVAL;
+        if(!err) {
+            file.size = header[1];
+            file.extents.resize(header[2]);
+        }
+        for(auto& extent : file.extents) {
+            uint64_t e[2] = {0, 0};
+            if(!err) err = delta::readAll(in, e, sizeof(e));
+            extent = {e[0], e[1]};
+        }
+        files.push_back(std::move(file));
+    }
+    std::vector<char> buffer(4*1024*1024);
+    for(size_t i = 0; !err && i < files.size(); ++i) {
+        auto filename = (fs::path{root} / files[i].file).string();
+        int out = ::open(filename.c_str(), O_WRONLY);
+        if(out < 0) {
+            err = errno;
+            break;
+        }
+        if(::ftruncate(out, files[i].size) < 0) err = errno;
+        for(auto& extent : files[i].extents) {
+            if(err) break;
+            err = delta::copyExtent(in, out, extent.first, extent.second, false, buffer);
+        }
+        if(!err && ::fsync(out) < 0) err = errno;
+        ::close(out);
+    }
+    ::close(in);
+    if(err) {
+        result.success() = false;
+        result.error() = fmt::format("Could not apply delta file {}: {}", path, strerror(err));
+    }
+    return result;
+}
+
+}
+
+#endif
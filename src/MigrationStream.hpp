@@ -0,0 +1,275 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_MIGRATION_STREAM_HPP
+#define __WARABI_MIGRATION_STREAM_HPP
+
+#include "warabi/Result.hpp"
+#include "warabi/Migration.hpp"
+#include <thallium.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/*
+ * Helpers for the "rpc" transport of target migrations, which streams
+ * the files of a target to the destination provider in chunks, over
+ * several parallel streams, instead of handing them to REMI.
+ */
+namespace stream {
+
+/**
+ * @brief Paces the chunks sent by all the streams of a migration so
+ * that they do not exceed a given bandwidth. Each chunk reserves the
+ * time it takes to send at that bandwidth, and the stream sleeps until
+ * its reservation starts.
+ */
+class Throttle {
+
+    using clock = std::chrono::steady_clock;
+
+    tl::mutex         m_mtx;
+    double            m_bytes_per_ns;
+    clock::time_point m_next = clock::now();
+
+    public:
+
+    /**
+     * @param bandwidth Bandwidth in bytes per second, 0 for no limit.
+     */
+    explicit Throttle(size_t bandwidth)
+    : m_bytes_per_ns(bandwidth * 1e-9) {}
+
+    void acquire(const tl::engine& engine, size_t bytes) {
+        if(m_bytes_per_ns <= 0) return;
+        auto duration = std::chrono::nanoseconds{(int64_t)(bytes / m_bytes_per_ns)};
+        clock::time_point start;
+        {
+            std::lock_guard<tl::mutex> lock{m_mtx};
+            start = std::max(clock::now(), m_next);
+            m_next = start + duration;
+        }
+        auto wait = std::chrono::duration<double, std::milli>(start - clock::now()).count();
+        if(wait > 0) tl::thread::sleep(engine, wait);
+    }
+};
+
+// granularity at which the "sparse" compression elides zeros
+static constexpr size_t s_sparse_page = 4096;
+
+/**
+ * @brief Compress a chunk by removing its pages that only contain zeros.
+ * The non-zero pages are moved to the front of the buffer, mask gets
+ * one bit per page (set for the pages kept), and the function returns
+ * the size of the compressed chunk.
+ */
+static inline size_t compressSparse(char* data, size_t size, std::vector<uint64_t>& mask) {
+    size_t pages = (size + s_sparse_page - 1) / s_sparse_page;
+    mask.assign((pages + 63) / 64, 0);
+    size_t packed = 0;
+    for(size_t p = 0; p < pages; ++p) {
+        auto page = data + p * s_sparse_page;
+        auto n = std::min(s_sparse_page, size - p * s_sparse_page);
+        bool zero = page[0] == 0 && std::memcmp(page, page + 1, n - 1) == 0;
+        if(zero) continue;
+        mask[p / 64] |= uint64_t{1} << (p % 64);
+        if(data + packed != page) std::memmove(data + packed, page, n);
+        packed += n;
+    }
+    return packed;
+}
+
+static inline int pwriteAll(int fd, const char* data, size_t size, size_t offset) {
+    while(size) {
+        auto n = ::pwrite(fd, data, size, offset);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        data   += n;
+        offset += n;
+        size   -= n;
+    }
+    return 0;
+}
+
+static inline int preadAll(int fd, char* data, size_t size, size_t offset) {
+    while(size) {
+        auto n = ::pread(fd, data, size, offset);
+        if(n < 0) {
+            if(errno == EINTR) continue;
+            return errno;
+        }
+        // files are read while the target serves requests,
+        // the content of extents cut off by a shrink is irrelevant
+        if(n == 0) {
+            std::memset(data, 0, size);
+            return 0;
+        }
+        data   += n;
+        offset += n;
+        size   -= n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Write a chunk of size bytes received from the source at the
+ * given offset, decompressing it if mask is not empty (see compressSparse).
+ * Returns EINVAL if the dataSize bytes received do not match the mask.
+ */
+static inline int writeChunk(int fd, const char* data, size_t dataSize, size_t size,
+                             size_t offset, const std::vector<uint64_t>& mask) {
+    if(mask.empty()) return dataSize == size ? pwriteAll(fd, data, size, offset) : EINVAL;
+    static const std::vector<char> zeros(s_sparse_page, 0);
+    size_t pages = (size + s_sparse_page - 1) / s_sparse_page;
+    if(mask.size() != (pages + 63) / 64) return EINVAL;
+    size_t kept = 0;
+    for(size_t p = 0; p < pages; ++p) {
+        if(mask[p / 64] & (uint64_t{1} << (p % 64)))
+            kept += std::min(s_sparse_page, size - p * s_sparse_page);
+    }
+    if(kept != dataSize) return EINVAL;
+    for(size_t p = 0; p < pages; ++p) {
+        auto n = std::min(s_sparse_page, size - p * s_sparse_page);
+        bool kept = mask[p / 64] & (uint64_t{1} << (p % 64));
+        // the file may already have content there in the second
+        // phase of an incremental migration, so zeros are written
+        int err = pwriteAll(fd, kept ? data : zeros.data(), n, offset + p * s_sparse_page);
+        if(err) return err;
+        if(kept) data += n;
+    }
+    return 0;
+}
+
+/**
+ * @brief Extents covering the whole files returned by a MigrationHandle
+ * or a DirtyTracker, with the content of the directories listed.
+ */
+static inline Result<std::vector<FileExtents>> listFiles(const std::string& root,
+                                                         const std::list<std::string>& files) {
+    namespace fs = std::filesystem;
+    Result<std::vector<FileExtents>> result;
+    auto base = fs::path{root.empty() ? "." : root};
+    auto add = [&](const std::string& name) {
+        std::error_code ec;
+        auto size = fs::file_size(base / name, ec);
+        if(ec) {
+            result.success() = false;
+            result.error() = fmt::format("Could not get size of {}: {}", name, ec.message());
+            return;
+        }
+        FileExtents file;
+        file.file = name;
+        file.size = size;
+        if(size) file.extents.emplace_back(0, size);
+        result.value().push_back(std::move(file));
+    };
+    for(auto& name : files) {
+        if(!result.success()) break;
+        if(name.empty() || name.back() != '/') {
+            add(name);
+            continue;
+        }
+        std::error_code ec;
+        for(auto it = fs::recursive_directory_iterator{base / name, ec};
+            !ec && it != fs::recursive_directory_iterator{} && result.success();
+            it.increment(ec)) {
+            if(it->is_regular_file())
+                add(fs::relative(it->path(), base).string());
+        }
+        if(ec) {
+            result.success() = false;
+            result.error() = fmt::format("Could not list directory {}: {}", name, ec.message());
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Target being received by a destination provider through
+ * the "rpc" transport, whose files are created as the migration
+ * starts and recovered as a target once the source commits it.
+ */
+struct IncomingTarget {
+
+    uint64_t                 id = 0;
+    std::string              type;
+    std::string              config;
+    std::vector<std::string> files;
+    std::vector<int>         fds;
+    std::vector<size_t>      sizes; // set by the source before sending chunks
+
+    ~IncomingTarget() {
+        for(auto fd : fds) if(fd >= 0) ::close(fd);
+    }
+
+    /**
+     * @brief Create the files (and their directories) under root.
+     */
+    Result<bool> open(const std::string& root, const std::vector<std::string>& names) {
+        namespace fs = std::filesystem;
+        Result<bool> result;
+        for(auto& name : names) {
+            auto path = fs::path{root} / name;
+            bool invalid = fs::path{name}.is_absolute();
+            for(auto& part : fs::path{name}) invalid = invalid || part == "..";
+            if(invalid) {
+                result.success() = false;
+                result.error() = fmt::format("Invalid file name {} in migration", name);
+                return result;
+            }
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if(fd < 0) {
+                result.success() = false;
+                result.error() = fmt::format("Could not create {}: {}", path.string(), strerror(errno));
+                return result;
+            }
+            files.push_back(path.string());
+            fds.push_back(fd);
+            sizes.push_back(0);
+        }
+        return result;
+    }
+
+    /**
+     * @brief Flush the files if the migration completed, or remove them
+     * if it was aborted. The files are closed once the writes still
+     * holding the IncomingTarget (if the source aborted) complete.
+     */
+    Result<bool> finish(bool commit) {
+        Result<bool> result;
+        for(size_t i = 0; i < fds.size(); ++i) {
+            if(!commit) {
+                ::unlink(files[i].c_str());
+            } else if(::fsync(fds[i]) < 0 && result.success()) {
+                result.success() = false;
+                result.error() = fmt::format("Could not flush {}: {}", files[i], strerror(errno));
+            }
+        }
+        return result;
+    }
+};
+
+}
+
+}
+
+#endif
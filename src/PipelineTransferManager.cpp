@@ -4,6 +4,7 @@
  * See COPYRIGHT in top-level directory.
  */
 #include "warabi/TransferManager.hpp"
+#include "Tracing.hpp"
 #include <margo-bulk-pool.h>
 #include <thallium.hpp>
 #include <fmt/format.h>
@@ -85,12 +86,14 @@ class PipelineTransferManager : public TransferManager {
         std::vector<Result<bool>> ultResults;
         ults.reserve(bulkOffsets.size());
         ultResults.resize(bulkOffsets.size());
+        auto traceContext = currentTraceContext();
         for(size_t i = 0; i < bulkOffsets.size(); ++i) {
             ults.push_back(
                 tl::thread::self().get_last_pool().make_thread(
                     [&region, &data, &address, persist, i, this,
                      &regionOffsetSizesSets, bulkOffset=bulkOffsets[i],
-                     &ultResults]() mutable {
+                     &ultResults, &traceContext]() mutable {
+                    TraceContextGuard traceGuard{traceContext};
                     auto& regionOffsetSizes = regionOffsetSizesSets[i];
                     auto& result = ultResults[i];
                     // compute the size of this list of segments
@@ -99,18 +102,27 @@ class PipelineTransferManager : public TransferManager {
                         [](size_t s, const auto& p) { return s + p.second; });
                     // get a buffer into which to receive the data
                     hg_bulk_t bulk = HG_BULK_NULL;
-                    margo_bulk_poolset_get(m_poolset, size, &bulk);
+                    {
+                        TraceSpan span{"pool_wait", TraceStage::Transfer};
+                        margo_bulk_poolset_get(m_poolset, size, &bulk);
+                    }
                     // wrap it in a thallium bulk
                     auto localBulk = m_engine.wrap(bulk, true);
                     // issue the transfer
-                    localBulk << data.on(address).select(bulkOffset, size);
+                    {
+                        TraceSpan span{"rdma", TraceStage::Transfer};
+                        localBulk << data.on(address).select(bulkOffset, size);
+                    }
                     // access the underlying memory
                     void* bufPtr = nullptr;
                     hg_size_t bufSize = 0;
                     hg_uint32_t actualCount = 0;
                     margo_bulk_access(bulk, 0, size, HG_BULK_READWRITE, 1, &bufPtr, &bufSize, &actualCount);
                     // write the data into the region
-                    result = region.write(regionOffsetSizes, bufPtr, persist);
+                    {
+                        TraceSpan span{"backend_write", TraceStage::Backend};
+                        result = region.write(regionOffsetSizes, bufPtr, persist);
+                    }
                     // release the buffer
                     margo_bulk_poolset_release(m_poolset, bulk);
             }));
@@ -163,12 +175,14 @@ class PipelineTransferManager : public TransferManager {
         std::vector<Result<bool>> ultResults;
         ults.reserve(bulkOffsets.size());
         ultResults.resize(bulkOffsets.size());
+        auto traceContext = currentTraceContext();
         for(size_t i = 0; i < bulkOffsets.size(); ++i) {
             ults.push_back(
                 tl::thread::self().get_last_pool().make_thread(
                     [&region, &data, &address, i, this,
                      &regionOffsetSizesSets, bulkOffset=bulkOffsets[i],
-                     &ultResults]() mutable {
+                     &ultResults, &traceContext]() mutable {
+                    TraceContextGuard traceGuard{traceContext};
                     auto& regionOffsetSizes = regionOffsetSizesSets[i];
                     auto& result = ultResults[i];
                     // compute the size of this list of segments
@@ -177,18 +191,27 @@ class PipelineTransferManager : public TransferManager {
                         [](size_t s, const auto& p) { return s + p.second; });
                     // get a buffer into which to send the data
                     hg_bulk_t bulk = HG_BULK_NULL;
-                    margo_bulk_poolset_get(m_poolset, size, &bulk);
+                    {
+                        TraceSpan span{"pool_wait", TraceStage::Transfer};
+                        margo_bulk_poolset_get(m_poolset, size, &bulk);
+                    }
                     // access the underlying memory
                     void* bufPtr = nullptr;
                     hg_size_t bufSize = 0;
                     hg_uint32_t actualCount = 0;
                     margo_bulk_access(bulk, 0, size, HG_BULK_READWRITE, 1, &bufPtr, &bufSize, &actualCount);
                     // read the data from the region
-                    result = region.read(regionOffsetSizes, bufPtr);
+                    {
+                        TraceSpan span{"backend_read", TraceStage::Backend};
+                        result = region.read(regionOffsetSizes, bufPtr);
+                    }
                     // wrap it in a thallium bulk
                     auto localBulk = m_engine.wrap(bulk, true);
                     // issue the transfer
-                    localBulk >> data.on(address).select(bulkOffset, size);
+                    {
+                        TraceSpan span{"rdma", TraceStage::Transfer};
+                        localBulk >> data.on(address).select(bulkOffset, size);
+                    }
                     // release the buffer
                     margo_bulk_poolset_release(m_poolset, bulk);
             }));
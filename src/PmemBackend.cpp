@@ -5,6 +5,7 @@
  */
 #include "Defer.hpp"
 #include "PmemBackend.hpp"
+#include "Tracing.hpp"
 #include <nlohmann/json.hpp>
 #include <nlohmann/json-schema.hpp>
 #include <fmt/format.h>
@@ -43,6 +44,11 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
     RegionID    m_id;
     char*       m_region_ptr;
 
+    ~PmemRegion() {
+        m_target->m_region_locks.get(m_id).unlock();
+        m_target->m_migration_lock.unlock();
+    }
+
     std::vector<std::pair<void*, size_t>> convertToSegments(
         const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
         std::vector<std::pair<void*, size_t>> segments;
@@ -55,6 +61,29 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
         return segments;
     }
 
+    void recordWrites(const std::vector<std::pair<void*, size_t>>& segments) {
+        for(auto& segment : segments)
+            m_target->m_dirty.add(
+                static_cast<char*>(segment.first) - reinterpret_cast<char*>(m_target->m_pmem_pool),
+                segment.second);
+    }
+
+    Result<bool> checkBounds(
+        const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) const {
+        Result<bool> result;
+        size_t size = pmemobj_alloc_usable_size(RegionIDtoPMEMoid(m_id));
+        for(auto& segment : regionOffsetSizes) {
+            if(segment.first > size || segment.second > size - segment.first) {
+                result.success() = false;
+                result.error() = fmt::format(
+                    "Range [{}, {}) is out of the bounds of the region",
+                    segment.first, segment.first + segment.second);
+                break;
+            }
+        }
+        return result;
+    }
+
     Result<RegionID> getRegionID() override {
         Result<RegionID> result;
         result.value() = m_id;
@@ -75,8 +104,11 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
             segments.begin(), segments.end(), (size_t)0,
             [](size_t acc, const auto& pair) { return acc + pair.second; });
         auto localBulk = m_target->m_engine.expose(segments, thallium::bulk_mode::write_only);
-        localBulk << remoteBulk.on(address)(remoteBulkOffset, totalSize);
-        m_target->m_migration_lock.unlock();
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk << remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        }
+        recordWrites(segments);
         return result;
     }
 
@@ -99,19 +131,19 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
                 offset += segment.second;
             }
         }
-        m_target->m_migration_lock.unlock();
+        recordWrites(segments);
         return result;
     }
 
     Result<bool> persist(
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) override {
         Result<bool> result;
+        TraceSpan span{"persist", TraceStage::Persist};
         for(size_t i=0; i < regionOffsetSizes.size(); ++i) {
             if(regionOffsetSizes[i].second > 0) {
                 pmemobj_persist(m_target->m_pmem_pool, m_region_ptr + regionOffsetSizes[i].first, regionOffsetSizes[i].second);
             }
         }
-        m_target->m_migration_lock.unlock();
         return result;
     }
 
@@ -120,22 +152,26 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
             thallium::bulk remoteBulk,
             const thallium::endpoint& address,
             size_t remoteBulkOffset) override {
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         if(segments.size() == 0) return result;
         size_t totalSize = std::accumulate(
             segments.begin(), segments.end(), (size_t)0,
             [](size_t acc, const auto& pair) { return acc + pair.second; });
         auto localBulk = m_target->m_engine.expose(segments, thallium::bulk_mode::read_only);
-        localBulk >> remoteBulk.on(address)(remoteBulkOffset, totalSize);
-        m_target->m_migration_lock.unlock();
+        {
+            TraceSpan span{"rdma", TraceStage::Transfer};
+            localBulk >> remoteBulk.on(address)(remoteBulkOffset, totalSize);
+        }
         return result;
      }
 
     Result<bool> read(
             const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
             void* data) override {
-        Result<bool> result;
+        Result<bool> result = checkBounds(regionOffsetSizes);
+        if(!result.success()) return result;
         auto segments = convertToSegments(regionOffsetSizes);
         if(segments.size() == 0) return result;
         size_t offset = 0;
@@ -144,7 +180,6 @@ struct PmemRegion : public WritableRegion, public ReadableRegion {
             std::memcpy(ptr + offset, segment.first, segment.second);
             offset += segment.second;
         }
-        m_target->m_migration_lock.unlock();
         return result;
     }
 };
@@ -153,7 +188,10 @@ PmemTarget::PmemTarget(thallium::engine engine, const json& config, PMEMobjpool*
 : m_engine(std::move(engine))
 , m_config(config)
 , m_pmem_pool(pool)
-, m_filename(config["path"].get_ref<const std::string&>()) {}
+, m_filename(config["path"].get_ref<const std::string&>()) {
+    // the regions of an existing pool may have been appended to
+    if(!OID_IS_NULL(pmemobj_first(m_pmem_pool))) m_tails.setUnknown();
+}
 
 PmemTarget::~PmemTarget() {
     if(m_pmem_pool)
@@ -185,8 +223,11 @@ Result<std::unique_ptr<WritableRegion>> PmemTarget::create(size_t size) {
         m_migration_lock.unlock();
         return result;
     }
+    m_dirty.addWhole();
     RegionID regionID = PMEMoidToRegionID(oid);
     char* ptr = (char*)pmemobj_direct_inline(oid);
+    m_tails.created(regionID);
+    m_region_locks.get(regionID).rdlock();
     result.value() = std::make_unique<PmemRegion>(this, regionID, ptr);
     return result;
 }
@@ -202,6 +243,7 @@ Result<std::unique_ptr<WritableRegion>> PmemTarget::write(const RegionID& region
         return result;
     }
     m_migration_lock.rdlock();
+    m_region_locks.get(region_id).rdlock();
     result.value() = std::make_unique<PmemRegion>(this, region_id, ptr);
     return result;
 }
@@ -216,6 +258,7 @@ Result<std::unique_ptr<ReadableRegion>> PmemTarget::read(const RegionID& region_
         return result;
     }
     m_migration_lock.rdlock();
+    m_region_locks.get(region_id).rdlock();
     result.value() = std::make_unique<PmemRegion>(this, region_id, ptr);
     return result;
 }
@@ -230,7 +273,136 @@ Result<bool> PmemTarget::erase(const RegionID& region_id) {
         return result;
     }
     m_migration_lock.rdlock();
-    pmemobj_free(&oid);
+    {
+        // wait for the PmemRegion objects writing or reading the region
+        auto& lock = m_region_locks.get(region_id);
+        lock.wrlock();
+        pmemobj_free(&oid);
+        lock.unlock();
+    }
+    m_dirty.addWhole();
+    m_tails.erased(region_id);
+    m_migration_lock.unlock();
+    return result;
+}
+
+Result<size_t> PmemTarget::reserve(const RegionID& region_id, size_t size) {
+    PMEMoid oid = RegionIDtoPMEMoid(region_id);
+    if(!pmemobj_direct_inline(oid)) {
+        Result<size_t> result;
+        result.success() = false;
+        result.error() = "Invalid RegionID";
+        return result;
+    }
+    return m_tails.reserve(region_id, size, pmemobj_alloc_usable_size(oid));
+}
+
+bool PmemTarget::unreserve(const RegionID& region_id, size_t offset, size_t size) {
+    return m_tails.release(region_id, offset, size);
+}
+
+Result<RegionID> PmemTarget::resize(const RegionID& region_id, size_t size) {
+    Result<RegionID> result;
+    PMEMoid oid = RegionIDtoPMEMoid(region_id);
+    if(!pmemobj_direct_inline(oid)) {
+        result.success() = false;
+        result.error() = "Invalid RegionID";
+        return result;
+    }
+    if(size == 0) {
+        result.success() = false;
+        result.error() = "Cannot resize a region to 0 bytes with the pmdk backend";
+        return result;
+    }
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // pmemobj_zrealloc may move or free the object, which changes its
+    // RegionID, so it waits for the PmemRegion objects using the region
+    auto& lock = m_region_locks.get(region_id);
+    lock.wrlock();
+    DEFER(lock.unlock());
+    int ret = pmemobj_zrealloc(m_pmem_pool, &oid, size, 0);
+    if(ret != 0) {
+        result.success() = false;
+        result.error() = fmt::format("pmemobj_zrealloc failed: {}", pmemobj_errormsg());
+        return result;
+    }
+    m_dirty.addWhole();
+    result.value() = PMEMoidToRegionID(oid);
+    m_tails.resized(region_id, result.value(), pmemobj_alloc_usable_size(oid));
+    return result;
+}
+
+Result<bool> PmemTarget::copy(const RegionID& source, size_t sourceOffset,
+                              const RegionID& dest, size_t destOffset,
+                              size_t size) {
+    Result<bool> result;
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // the regions cannot be moved or freed until the copy completes
+    RegionLocks::SharedPair regionLocks{m_region_locks, source, dest};
+    PMEMoid from = RegionIDtoPMEMoid(source);
+    PMEMoid to = RegionIDtoPMEMoid(dest);
+    char* fromPtr = (char*)pmemobj_direct_inline(from);
+    char* toPtr = (char*)pmemobj_direct_inline(to);
+    if(!fromPtr || !toPtr) {
+        result.success() = false;
+        result.error() = "Invalid RegionID";
+        return result;
+    }
+    size_t fromSize = pmemobj_alloc_usable_size(from);
+    size_t toSize = pmemobj_alloc_usable_size(to);
+    if(sourceOffset > fromSize || size > fromSize - sourceOffset
+    || destOffset > toSize || size > toSize - destOffset) {
+        result.error() = fmt::format(
+            "Cannot copy {} bytes from offset {} (region size {}) to offset {} (region size {})",
+            size, sourceOffset, fromSize, destOffset, toSize);
+        result.success() = false;
+        return result;
+    }
+    pmemobj_memmove(m_pmem_pool, toPtr + destOffset, fromPtr + sourceOffset, size, 0);
+    m_dirty.add(toPtr + destOffset - reinterpret_cast<char*>(m_pmem_pool), size);
+    return result;
+}
+
+Result<size_t> PmemTarget::size(const RegionID& region_id) {
+    Result<size_t> result;
+    PMEMoid oid = RegionIDtoPMEMoid(region_id);
+    if(!pmemobj_direct_inline(oid)) {
+        result.success() = false;
+        result.error() = "Invalid RegionID";
+        return result;
+    }
+    result.value() = pmemobj_alloc_usable_size(oid);
+    return result;
+}
+
+Result<RegionID> PmemTarget::clone(const RegionID& region_id) {
+    Result<RegionID> result;
+    m_migration_lock.rdlock();
+    DEFER(m_migration_lock.unlock());
+    // the source cannot be moved or freed until it is copied
+    auto& lock = m_region_locks.get(region_id);
+    lock.rdlock();
+    DEFER(lock.unlock());
+    PMEMoid oid = RegionIDtoPMEMoid(region_id);
+    char* ptr = (char*)pmemobj_direct_inline(oid);
+    if(!ptr) {
+        result.success() = false;
+        result.error() = "Invalid RegionID";
+        return result;
+    }
+    size_t size = pmemobj_alloc_usable_size(oid);
+    PMEMoid copy;
+    int ret = pmemobj_alloc(m_pmem_pool, &copy, size, 0, NULL, NULL);
+    if(ret != 0) {
+        result.success() = false;
+        result.error() = fmt::format("pmemobj_alloc failed: {}", pmemobj_errormsg());
+        return result;
+    }
+    pmemobj_memcpy_persist(m_pmem_pool, pmemobj_direct_inline(copy), ptr, size);
+    m_dirty.addWhole();
+    result.value() = PMEMoidToRegionID(copy);
     return result;
 }
 
@@ -240,6 +412,17 @@ Result<std::unique_ptr<MigrationHandle>> PmemTarget::startMigration(bool removeS
     return result;
 }
 
+Result<std::unique_ptr<DirtyTracker>> PmemTarget::trackChanges() {
+    Result<std::unique_ptr<DirtyTracker>> result;
+    if(!m_dirty.start()) {
+        result.success() = false;
+        result.error() = "Changes to the target are already being tracked";
+        return result;
+    }
+    result.value() = std::make_unique<PmemDirtyTracker>(this);
+    return result;
+}
+
 Result<std::unique_ptr<warabi::Backend>> PmemTarget::recover(
          const thallium::engine& engine, const json& config,
          const std::vector<std::string>& filenames) {
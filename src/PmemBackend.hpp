@@ -8,6 +8,10 @@
 
 #include <warabi/Backend.hpp>
 #include <libpmemobj.h>
+#include "RegionTails.hpp"
+#include "DirtyExtents.hpp"
+#include "RegionLocks.hpp"
+#include <filesystem>
 
 namespace warabi {
 
@@ -27,6 +31,12 @@ class PmemTarget : public warabi::Backend {
     PMEMobjpool*                   m_pmem_pool;
     std::string                    m_filename;
     thallium::rwlock               m_migration_lock;
+    // held by PmemRegion objects, taken exclusively to move or free a region
+    RegionLocks                    m_region_locks;
+    RegionTails                    m_tails;
+    // writes to regions are tracked by offset in the pool file, while
+    // allocations change metadata of the pool and make the whole file dirty
+    DirtyExtents                   m_dirty;
 
     struct PmemMigrationHandle : public MigrationHandle {
 
@@ -74,6 +84,45 @@ class PmemTarget : public warabi::Backend {
         }
     };
 
+    struct PmemDirtyTracker : public DirtyTracker {
+
+        PmemTarget* m_target;
+
+        PmemDirtyTracker(PmemTarget* target)
+        : m_target(target) {}
+
+        ~PmemDirtyTracker() {
+            m_target->m_dirty.stop();
+        }
+
+        std::string getRoot() const override {
+            size_t found = m_target->m_filename.find_last_of("/");
+            if(found != std::string::npos) {
+                return m_target->m_filename.substr(0, found);
+            } else {
+                return "";
+            }
+        }
+
+        std::list<std::string> getFiles() const override {
+            size_t found = m_target->m_filename.find_last_of("/");
+            if(found != std::string::npos) {
+                return {m_target->m_filename.substr(found + 1)};
+            } else {
+                return {m_target->m_filename};
+            }
+        }
+
+        std::vector<FileExtents> takeDirty() override {
+            FileExtents file;
+            file.file = getFiles().front();
+            std::error_code ec;
+            file.size = std::filesystem::file_size(m_target->m_filename, ec);
+            file.extents = m_target->m_dirty.take(file.size);
+            return {std::move(file)};
+        }
+    };
+
     public:
 
     /**
@@ -129,6 +178,38 @@ class PmemTarget : public warabi::Backend {
      */
     Result<bool> erase(const RegionID& region) override;
 
+    /**
+     * @see Backend::reserve
+     */
+    Result<size_t> reserve(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::unreserve
+     */
+    bool unreserve(const RegionID& region, size_t offset, size_t size) override;
+
+    /**
+     * @see Backend::resize
+     */
+    Result<RegionID> resize(const RegionID& region, size_t size) override;
+
+    /**
+     * @see Backend::copy
+     */
+    Result<bool> copy(const RegionID& source, size_t sourceOffset,
+                      const RegionID& dest, size_t destOffset,
+                      size_t size) override;
+
+    /**
+     * @see Backend::clone
+     */
+    Result<RegionID> clone(const RegionID& region) override;
+
+    /**
+     * @see Backend::size
+     */
+    Result<size_t> size(const RegionID& region) override;
+
     /**
      * @brief Destroy the underlying storage.
      */
@@ -139,6 +220,11 @@ class PmemTarget : public warabi::Backend {
      */
     Result<std::unique_ptr<MigrationHandle>> startMigration(bool removeSource) override;
 
+    /**
+     * @brief Start tracking the extents of the pool file that are modified.
+     */
+    Result<std::unique_ptr<DirtyTracker>> trackChanges() override;
+
     /**
      * @brief Static factory function used by the TargetFactory to
      * create a PmemTarget.
@@ -47,9 +47,32 @@ Provider::~Provider() {
     }
 }
 
-void Provider::migrateTarget(const std::string &address, uint16_t provider_id, const std::string &options) {
+void Provider::migrateTarget(const std::string &address, uint16_t provider_id,
+                             const std::string &options, AsyncMigration* migration) {
     if(!self) return;
-    self->migrateTarget(address, provider_id, options);
+    if(migration) {
+        *migration = AsyncMigration{self->migrateTarget(address, provider_id, options, self)};
+    } else {
+        AsyncMigration{self->migrateTarget(address, provider_id, options)}.wait();
+    }
+}
+
+std::vector<RegionID> Provider::migrateRegions(const std::vector<RegionID>& regions,
+                                               const std::string& address,
+                                               uint16_t provider_id,
+                                               const std::string& options) {
+    if(!self) throw Exception{"Invalid warabi::Provider object"};
+    return self->migrateRegions(regions, address, provider_id, options);
+}
+
+void Provider::dumpTrace(const std::string& filename) const {
+    if(!self) throw Exception{"Invalid warabi::Provider object"};
+    self->dumpTrace(filename);
+}
+
+void Provider::dumpEventLog(const std::string& filename) const {
+    if(!self) throw Exception{"Invalid warabi::Provider object"};
+    self->dumpEventLog(filename);
 }
 
 std::string Provider::getConfig() const {
@@ -12,8 +12,21 @@
 #include "warabi/Backend.hpp"
 #include "warabi/TransferManager.hpp"
 #include "warabi/MigrationOptions.hpp"
+#include "warabi/Layout.hpp"
 #include "BufferWrapper.hpp"
 #include "Defer.hpp"
+#include "Tracing.hpp"
+#include "Logging.hpp"
+#include "EventLog.hpp"
+#include "WorkloadCapture.hpp"
+#include "RegionVersions.hpp"
+#include "TimedResult.hpp"
+#include "WireProtocol.hpp"
+#include "AtomicOps.hpp"
+#include "RegionMigrations.hpp"
+#include "MigrationDelta.hpp"
+#include "MigrationStream.hpp"
+#include "AsyncMigrationImpl.hpp"
 
 #include <thallium.hpp>
 #include <thallium/serialization/stl/string.hpp>
@@ -23,8 +36,8 @@
 
 #include <nlohmann/json-schema.hpp>
 #include <nlohmann/json.hpp>
-#include <spdlog/spdlog.h>
 
+#include <deque>
 #include <tuple>
 
 #ifdef WARABI_HAS_REMI
@@ -45,22 +58,33 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
 
     using json = nlohmann::json;
 
-    #define DEF_LOGGING_FUNCTION(__name__)                         \
-    template<typename ... Args>                                    \
-    void __name__(Args&&... args) {                                \
-        auto msg = fmt::format(std::forward<Args>(args)...);       \
-        spdlog::__name__("[warabi:{}] {}", get_provider_id(), msg); \
+    #define DEF_LOGGING_FUNCTION(__name__, __level__)                       \
+    template<typename ... Args>                                             \
+    void __name__(Args&&... args) const {                                   \
+        log<spdlog::level::__level__>(get_provider_id(), std::forward<Args>(args)...); \
     }
 
-    DEF_LOGGING_FUNCTION(trace)
-    DEF_LOGGING_FUNCTION(debug)
-    DEF_LOGGING_FUNCTION(info)
-    DEF_LOGGING_FUNCTION(warn)
-    DEF_LOGGING_FUNCTION(error)
-    DEF_LOGGING_FUNCTION(critical)
+    DEF_LOGGING_FUNCTION(trace, trace)
+    DEF_LOGGING_FUNCTION(debug, debug)
+    DEF_LOGGING_FUNCTION(info, info)
+    DEF_LOGGING_FUNCTION(warn, warn)
+    DEF_LOGGING_FUNCTION(error, err)
+    DEF_LOGGING_FUNCTION(critical, critical)
 
     #undef DEF_LOGGING_FUNCTION
 
+    /**
+     * @brief Log a message from a hot path (e.g. an RPC handler).
+     * If the binary event log is enabled, the message is recorded
+     * there without being formatted, otherwise it is logged at the
+     * trace level. Arguments must be integers.
+     */
+    template<typename ... Args>
+    void event(const char* format, Args... args) const {
+        if(m_event_log) m_event_log->record(format, args...);
+        else trace(format, args...);
+    }
+
     public:
 
     tl::engine      m_engine;
@@ -68,21 +92,111 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
     remi_client_t   m_remi_client;
     remi_provider_t m_remi_provider;
 
+    // Versions of the regions, used to validate client-side caches
+    RegionVersions  m_versions;
+
+    // Locks serializing atomic operations on the words of regions
+    AtomicLocks     m_atomic_locks;
+
+    // Regions being migrated to (or migrated to) other providers
+    RegionMigrations m_migrations;
+
+#ifdef WARABI_HAS_REMI
+    // Targets received by the first phase of incremental migrations,
+    // recovered once the delta of the second phase is applied to their
+    // files, by id of the migration (see migrationId)
+    struct PendingMigration {
+        std::string              type;
+        json                     config;
+        std::string              root;
+        std::vector<std::string> files;
+    };
+    tl::mutex                                         m_pending_mtx;
+    std::unordered_map<std::string, PendingMigration> m_pending_migrations;
+    std::atomic<uint64_t>                             m_outgoing_id{0};
+#endif
+
+    // Whether the target is being migrated to another provider
+    std::atomic<bool> m_migrating_target{false};
+
+    // Target being received through the "rpc" transport
+    tl::mutex                               m_incoming_mtx;
+    std::shared_ptr<stream::IncomingTarget> m_incoming;
+    uint64_t                                m_incoming_id = 0;
+
+    // Maximum number of segments of a Layout passed at once to the backend
+    static constexpr size_t s_layout_batch = 4096;
+
+    // Regions transferred to another provider are sent in chunks of
+    // s_transfer_chunk bytes, with up to s_transfer_depth chunks in flight
+    static constexpr size_t s_transfer_chunk = 4*1024*1024;
+    static constexpr size_t s_transfer_depth = 4;
+
+    // Endpoints of the addresses that requests refer to
+    tl::mutex                                    m_endpoints_mtx;
+    std::unordered_map<std::string, tl::endpoint> m_endpoints;
+    std::string                                  m_self_address;
+
     tl::auto_remote_procedure m_create;
     tl::auto_remote_procedure m_write;
     tl::auto_remote_procedure m_write_eager;
     tl::auto_remote_procedure m_persist;
     tl::auto_remote_procedure m_create_write;
     tl::auto_remote_procedure m_create_write_eager;
+    tl::auto_remote_procedure m_append;
+    tl::auto_remote_procedure m_append_eager;
+    tl::auto_remote_procedure m_atomic;
+    tl::auto_remote_procedure m_resize;
+    tl::auto_remote_procedure m_copy;
+    tl::auto_remote_procedure m_clone;
     tl::auto_remote_procedure m_read;
     tl::auto_remote_procedure m_read_eager;
     tl::auto_remote_procedure m_erase;
+    tl::auto_remote_procedure m_read_versioned;
+    tl::auto_remote_procedure m_read_eager_versioned;
+    tl::auto_remote_procedure m_get_versions;
+    tl::auto_remote_procedure m_prefetch;
     tl::auto_remote_procedure m_get_remi_provider_id;
+    tl::auto_remote_procedure m_get_protocol_version;
+    tl::auto_remote_procedure m_create_v2;
+    tl::auto_remote_procedure m_write_v2;
+    tl::auto_remote_procedure m_write_eager_v2;
+    tl::auto_remote_procedure m_read_v2;
+    tl::auto_remote_procedure m_read_eager_v2;
+    tl::auto_remote_procedure m_erase_v2;
+    tl::auto_remote_procedure m_transfer;
+    tl::auto_remote_procedure m_get_forward;
+    tl::auto_remote_procedure m_migration_open;
+    tl::auto_remote_procedure m_migration_resize;
+    tl::auto_remote_procedure m_migration_write;
+    tl::auto_remote_procedure m_migration_close;
+    tl::auto_remote_procedure m_create_legacy;
+    tl::auto_remote_procedure m_write_legacy;
+    tl::auto_remote_procedure m_write_eager_legacy;
+    tl::auto_remote_procedure m_persist_legacy;
+    tl::auto_remote_procedure m_create_write_legacy;
+    tl::auto_remote_procedure m_create_write_eager_legacy;
+    tl::auto_remote_procedure m_read_legacy;
+    tl::auto_remote_procedure m_read_eager_legacy;
+    tl::auto_remote_procedure m_erase_legacy;
 
     // Backend
     std::shared_ptr<Backend>         m_target;
     std::shared_ptr<TransferManager> m_transfer_manager;
 
+    // Tracing
+    json                    m_tracing_config;
+    std::unique_ptr<Tracer> m_tracer;
+    bool                    m_report_timings = false;
+
+    // Binary event log
+    json                      m_event_log_config;
+    std::unique_ptr<EventLog> m_event_log;
+
+    // Workload capture
+    json                             m_capture_config;
+    std::unique_ptr<WorkloadCapture> m_capture;
+
     ProviderImpl(
             const tl::engine& engine,
             uint16_t provider_id,
@@ -95,18 +209,51 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
     , m_pool(pool)
     , m_remi_client(remi_cl)
     , m_remi_provider(remi_pr)
-    , m_create(define("warabi_create",  &ProviderImpl::createRPC, pool))
-    , m_write(define("warabi_write",  &ProviderImpl::writeRPC, pool))
-    , m_write_eager(define("warabi_write_eager",  &ProviderImpl::writeEagerRPC, pool))
-    , m_persist(define("warabi_persist",  &ProviderImpl::persistRPC, pool))
-    , m_create_write(define("warabi_create_write",  &ProviderImpl::createWriteRPC, pool))
-    , m_create_write_eager(define("warabi_create_write_eager",  &ProviderImpl::createWriteEagerRPC, pool))
-    , m_read(define("warabi_read",  &ProviderImpl::readRPC, pool))
-    , m_read_eager(define("warabi_read_eager",  &ProviderImpl::readEagerRPC, pool))
-    , m_erase(define("warabi_erase",  &ProviderImpl::eraseRPC, pool))
+    , m_create(define("warabi_v1_create",  &ProviderImpl::createRPC, pool))
+    , m_write(define("warabi_v1_write",  &ProviderImpl::writeRPC, pool))
+    , m_write_eager(define("warabi_v1_write_eager",  &ProviderImpl::writeEagerRPC, pool))
+    , m_persist(define("warabi_v1_persist",  &ProviderImpl::persistRPC, pool))
+    , m_create_write(define("warabi_v1_create_write",  &ProviderImpl::createWriteRPC, pool))
+    , m_create_write_eager(define("warabi_v1_create_write_eager",  &ProviderImpl::createWriteEagerRPC, pool))
+    , m_append(define("warabi_append",  &ProviderImpl::appendRPC, pool))
+    , m_append_eager(define("warabi_append_eager",  &ProviderImpl::appendEagerRPC, pool))
+    , m_atomic(define("warabi_atomic",  &ProviderImpl::atomicRPC, pool))
+    , m_resize(define("warabi_resize",  &ProviderImpl::resizeRPC, pool))
+    , m_copy(define("warabi_copy",  &ProviderImpl::copyRPC, pool))
+    , m_clone(define("warabi_clone",  &ProviderImpl::cloneRPC, pool))
+    , m_read(define("warabi_v1_read",  &ProviderImpl::readRPC, pool))
+    , m_read_eager(define("warabi_v1_read_eager",  &ProviderImpl::readEagerRPC, pool))
+    , m_erase(define("warabi_v1_erase",  &ProviderImpl::eraseRPC, pool))
+    , m_read_versioned(define("warabi_read_versioned",  &ProviderImpl::readVersionedRPC, pool))
+    , m_read_eager_versioned(define("warabi_read_eager_versioned",  &ProviderImpl::readEagerVersionedRPC, pool))
+    , m_get_versions(define("warabi_get_versions",  &ProviderImpl::getVersionsRPC, pool))
+    , m_prefetch(define("warabi_prefetch",  &ProviderImpl::prefetchRPC, pool))
     , m_get_remi_provider_id(define("warabi_get_remi_provider_id",  &ProviderImpl::getREMIproviderIdRPC, pool))
+    , m_get_protocol_version(define("warabi_get_protocol_version",  &ProviderImpl::getProtocolVersionRPC, pool))
+    , m_create_v2(define("warabi_v2_create",  &ProviderImpl::createV2RPC, pool))
+    , m_write_v2(define("warabi_v2_write",  &ProviderImpl::writeV2RPC, pool))
+    , m_write_eager_v2(define("warabi_v2_write_eager",  &ProviderImpl::writeEagerV2RPC, pool))
+    , m_read_v2(define("warabi_v2_read",  &ProviderImpl::readV2RPC, pool))
+    , m_read_eager_v2(define("warabi_v2_read_eager",  &ProviderImpl::readEagerV2RPC, pool))
+    , m_erase_v2(define("warabi_v2_erase",  &ProviderImpl::eraseV2RPC, pool))
+    , m_transfer(define("warabi_transfer",  &ProviderImpl::transferRPC, pool))
+    , m_get_forward(define("warabi_get_forward",  &ProviderImpl::getForwardRPC, pool))
+    , m_migration_open(define("warabi_migration_open",  &ProviderImpl::migrationOpenRPC, pool))
+    , m_migration_resize(define("warabi_migration_resize",  &ProviderImpl::migrationResizeRPC, pool))
+    , m_migration_write(define("warabi_migration_write",  &ProviderImpl::migrationWriteRPC, pool))
+    , m_migration_close(define("warabi_migration_close",  &ProviderImpl::migrationCloseRPC, pool))
+    , m_create_legacy(define("warabi_create",  &ProviderImpl::createLegacyRPC, pool))
+    , m_write_legacy(define("warabi_write",  &ProviderImpl::writeLegacyRPC, pool))
+    , m_write_eager_legacy(define("warabi_write_eager",  &ProviderImpl::writeEagerLegacyRPC, pool))
+    , m_persist_legacy(define("warabi_persist",  &ProviderImpl::persistLegacyRPC, pool))
+    , m_create_write_legacy(define("warabi_create_write",  &ProviderImpl::createWriteLegacyRPC, pool))
+    , m_create_write_eager_legacy(define("warabi_create_write_eager",  &ProviderImpl::createWriteEagerLegacyRPC, pool))
+    , m_read_legacy(define("warabi_read",  &ProviderImpl::readLegacyRPC, pool))
+    , m_read_eager_legacy(define("warabi_read_eager",  &ProviderImpl::readEagerLegacyRPC, pool))
+    , m_erase_legacy(define("warabi_erase",  &ProviderImpl::eraseLegacyRPC, pool))
     {
         trace("Registered provider with id {}", get_provider_id());
+        m_self_address = static_cast<std::string>(m_engine.self());
         json json_config;
         try {
             if(!config.empty())
@@ -164,6 +311,33 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
                         "type": {"type": "string"},
                         "config": {"type": "object"}
                     }
+                },
+                "tracing": {
+                    "type": "object",
+                    "properties": {
+                        "enabled": {"type": "boolean"},
+                        "output": {"type": "string"},
+                        "events_per_xstream": {"type": "integer", "minimum": 1},
+                        "max_xstreams": {"type": "integer", "minimum": 1}
+                    }
+                },
+                "report_timings": {"type": "boolean"},
+                "event_log": {
+                    "type": "object",
+                    "properties": {
+                        "enabled": {"type": "boolean"},
+                        "output": {"type": "string"},
+                        "events_per_xstream": {"type": "integer", "minimum": 1},
+                        "max_xstreams": {"type": "integer", "minimum": 1}
+                    }
+                },
+                "capture": {
+                    "type": "object",
+                    "properties": {
+                        "enabled": {"type": "boolean"},
+                        "output": {"type": "string"},
+                        "buffer_size": {"type": "integer", "minimum": 1}
+                    }
                 }
             }
         }
@@ -188,6 +362,40 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
             setTransferManager(transfer_manager_type, transfer_manager_config);
         }
 
+        if(json_config.contains("tracing")) {
+            m_tracing_config = json_config["tracing"];
+            if(m_tracing_config.value("enabled", false)) {
+                m_tracer = std::make_unique<Tracer>(
+                    provider_id,
+                    m_tracing_config.value("events_per_xstream", (size_t)65536),
+                    m_tracing_config.value("max_xstreams", (size_t)64));
+            }
+        }
+
+        m_report_timings = json_config.value("report_timings", false);
+
+        if(json_config.contains("event_log")) {
+            m_event_log_config = json_config["event_log"];
+            if(m_event_log_config.value("enabled", false)) {
+                m_event_log = std::make_unique<EventLog>(
+                    provider_id,
+                    m_event_log_config.value("events_per_xstream", (size_t)65536),
+                    m_event_log_config.value("max_xstreams", (size_t)64));
+            }
+        }
+
+        if(json_config.contains("capture")) {
+            m_capture_config = json_config["capture"];
+            if(m_capture_config.value("enabled", false)) {
+                auto output = m_capture_config.value("output", ""s);
+                if(output.empty())
+                    throw Exception{"No output file specified for the workload capture"};
+                m_capture = std::make_unique<WorkloadCapture>(
+                    provider_id, output,
+                    m_capture_config.value("buffer_size", (size_t)1048576));
+            }
+        }
+
         if(json_config.contains("target")) {
             auto& target = json_config["target"];
             auto& target_type = target["type"].get_ref<const std::string&>();
@@ -201,6 +409,20 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
 
     ~ProviderImpl() {
         trace("Deregistering provider");
+        if(m_tracer && m_tracing_config.contains("output")) {
+            try {
+                dumpTrace("");
+            } catch(const std::exception& ex) {
+                error("{}", ex.what());
+            }
+        }
+        if(m_event_log && m_event_log_config.contains("output")) {
+            try {
+                dumpEventLog("");
+            } catch(const std::exception& ex) {
+                error("{}", ex.what());
+            }
+        }
 #ifdef WARABI_HAS_REMI
         if(m_remi_provider) {
             remi_provider_deregister_provider_migration_class(
@@ -222,9 +444,30 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
         auto& tm = config["transfer_manager"];
         tm["type"] = m_transfer_manager->name();
         tm["config"] = json::parse(m_transfer_manager->getConfig());
+        if(!m_tracing_config.is_null())
+            config["tracing"] = m_tracing_config;
+        config["report_timings"] = m_report_timings;
+        if(!m_event_log_config.is_null())
+            config["event_log"] = m_event_log_config;
+        if(!m_capture_config.is_null())
+            config["capture"] = m_capture_config;
         return config.dump();
     }
 
+    void dumpTrace(const std::string& filename) const {
+        if(!m_tracer) throw Exception{"Tracing is not enabled in this provider"};
+        auto output = filename.empty() ? m_tracing_config.value("output", ""s) : filename;
+        if(output.empty()) throw Exception{"No output file specified for the trace"};
+        m_tracer->dump(output);
+    }
+
+    void dumpEventLog(const std::string& filename) const {
+        if(!m_event_log) throw Exception{"Event log is not enabled in this provider"};
+        auto output = filename.empty() ? m_event_log_config.value("output", ""s) : filename;
+        if(output.empty()) throw Exception{"No output file specified for the event log"};
+        m_event_log->dump(output);
+    }
+
     Result<bool> validateTargetConfig(
             const std::string& target_type,
             const json& target_config) {
@@ -267,224 +510,1193 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
     }
 
     void createRPC(const tl::request& req,
+                   uint64_t request_id,
                    size_t size) {
-        trace("Received create request with size {}", size);
-        Result<RegionID> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        handleCreate<CodedResult<RegionID>>(req, request_id, size);
+    }
+
+    void createV2RPC(const tl::request& req,
+                     const RequestHeader& header,
+                     const Varint& size) {
+        handleCreate<CompactResult<RegionID>>(req, header.request_id, size.value);
+    }
+
+    template<typename ResultType>
+    void handleCreate(const tl::request& req,
+                      uint64_t request_id,
+                      size_t size) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"create"};
+        event("Received create request {} with size {}", request_id, size);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Create, request_id};
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
             return;
         }
-        auto region = m_target->create(size);
+        auto region = [&]() {
+            TraceSpan backendSpan{"backend_create", TraceStage::Backend};
+            return m_target->create(size);
+        }();
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::Backend, region.error());
             return;
         }
         result = region.value()->getRegionID();
-        trace("Successfully executed create request");
+        if(result.success()) capture.region = result.value();
+        capture.size = size;
+        capture.success = result.success();
+        event("Successfully executed create request");
+    }
+
+    /**
+     * @brief Validate a layout and pull the segments of a large indexed
+     * layout from the client that sent it. On failure, sets the error in
+     * result and returns false.
+     */
+    template<typename ResultType>
+    bool receiveLayout(Layout& layout, const tl::request& req, ResultType& result) {
+        try {
+            layout.validate();
+            layout.pull(m_engine, req.get_endpoint());
+            layout.validate();
+        } catch(const std::exception& ex) {
+            fail(result, ErrorCode::InvalidLayout,
+                 fmt::format("Could not receive the layout: {}", ex.what()));
+            return false;
+        }
+        return true;
     }
 
     void writeRPC(const tl::request& req,
+                  uint64_t request_id,
                   const RegionID& region_id,
-                  const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+                  Layout layout,
                   thallium::bulk data,
                   const std::string& address,
                   size_t bulkOffset,
                   bool persist) {
-        trace("Received write request");
-        Result<bool> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        handleWrite<CodedResult<bool>>(req, request_id, region_id, layout,
+                                  data, address, bulkOffset, persist);
+    }
+
+    void writeV2RPC(const tl::request& req,
+                    const RequestHeader& header,
+                    CompactLayout layout,
+                    const BulkLocation& data) {
+        handleWrite<CompactResult<bool>>(req, header.request_id, header.region, layout.layout,
+                                         data.bulk, data.address, data.offset, header.persist());
+    }
+
+    template<typename ResultType>
+    void handleWrite(const tl::request& req,
+                     uint64_t request_id,
+                     const RegionID& region_id,
+                     Layout& layout,
+                     const thallium::bulk& data,
+                     const std::string& address,
+                     size_t bulkOffset,
+                     bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"write"};
+        event("Received write request {}", request_id);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Write, request_id, persist, layout};
+        capture.region = region_id;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(!receiveLayout(layout, req, result)) return;
+        RegionMigrations::WriteAccess migration{m_migrations, region_id, &layout};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
             return;
         }
         auto region = m_target->write(region_id, persist);
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::InvalidRegion, region.error());
             return;
         }
-        auto source = address.empty() ? req.get_endpoint() : m_engine.lookup(address);
-        result = m_transfer_manager->pull(
-                *region.value(), regionOffsetSizes, data, source, bulkOffset, persist);
-        trace("Successfully executed write request");
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        auto source = address.empty() ? req.get_endpoint() : lookup(address);
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                result = m_transfer_manager->pull(
+                    *region.value(), segments, data, source, bulkOffset + before, persist);
+                return result.success();
+            });
+        capture.success = result.success();
+        event("Successfully executed write request");
     }
 
     void writeEagerRPC(const tl::request& req,
+                       uint64_t request_id,
                        const RegionID& region_id,
-                       const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+                       Layout layout,
                        const BufferWrapper& buffer,
                        bool persist) {
-        trace("Received write_eager request");
-        Result<bool> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        handleWriteEager<CodedResult<bool>>(req, request_id, region_id, layout, buffer, persist);
+    }
+
+    void writeEagerV2RPC(const tl::request& req,
+                         const RequestHeader& header,
+                         CompactLayout layout,
+                         const BufferWrapper& buffer) {
+        handleWriteEager<CompactResult<bool>>(req, header.request_id, header.region,
+                                              layout.layout, buffer, header.persist());
+    }
+
+    template<typename ResultType>
+    void handleWriteEager(const tl::request& req,
+                          uint64_t request_id,
+                          const RegionID& region_id,
+                          Layout& layout,
+                          const BufferWrapper& buffer,
+                          bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"write_eager"};
+        event("Received write_eager request {}", request_id);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::WriteEager, request_id, persist, layout};
+        capture.region = region_id;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(!receiveLayout(layout, req, result)) return;
+        if(buffer.size() != layout.size()) {
+            fail(result, ErrorCode::InvalidLayout, "Size of the data does not match the layout");
+            return;
+        }
+        RegionMigrations::WriteAccess migration{m_migrations, region_id, &layout};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
             return;
         }
         auto region = m_target->write(region_id, persist);
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::InvalidRegion, region.error());
             return;
         }
-        result = region.value()->write(regionOffsetSizes, buffer.data(), persist);
-        trace("Successfully executed write_eager request");
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        TraceSpan backendSpan{"backend_write", TraceStage::Backend};
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                result = region.value()->write(segments, buffer.data() + before, persist);
+                return result.success();
+            });
+        capture.success = result.success();
+        event("Successfully executed write_eager request");
     }
 
     void persistRPC(const tl::request& req,
+                    uint64_t request_id,
                     const RegionID& region_id,
-                    const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
-        trace("Received persist request");
-        Result<bool> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+                    Layout layout) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"persist"};
+        event("Received persist request {}", request_id);
+        CodedResult<bool> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Persist, request_id, true, layout};
+        capture.region = region_id;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
             return;
         }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        if(!receiveLayout(layout, req, result)) return;
         auto region = m_target->write(region_id, true);
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::InvalidRegion, region.error());
             return;
         }
-        result = region.value()->persist(regionOffsetSizes);
-        trace("Successfully executed persist request");
+        TraceSpan backendSpan{"backend_persist", TraceStage::Persist};
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t) {
+                result = region.value()->persist(segments);
+                return result.success();
+            });
+        capture.success = result.success();
+        event("Successfully executed persist request");
     }
 
     void createWriteRPC(const tl::request& req,
+                        uint64_t request_id,
                         thallium::bulk data,
                         const std::string& address,
                         size_t bulkOffset, size_t size,
                         bool persist) {
-        trace("Received create_write request");
-        Result<RegionID> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"create_write"};
+        event("Received create_write request {}", request_id);
+        CodedResult<RegionID> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::CreateWrite, request_id, persist};
+        capture.size = size;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
             return;
         }
-        auto region = m_target->create(size);
+        auto region = [&]() {
+            TraceSpan backendSpan{"backend_create", TraceStage::Backend};
+            return m_target->create(size);
+        }();
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::Backend, region.error());
             return;
         }
         result = region.value()->getRegionID();
-        auto source = address.empty() ? req.get_endpoint() : m_engine.lookup(address);
+        RegionVersions::WriteGuard versionGuard{m_versions, result.value()};
+        auto source = address.empty() ? req.get_endpoint() : lookup(address);
         Result<bool> writeResult;
         writeResult = m_transfer_manager->pull(
                 *region.value(), {{0, size}}, data, source, bulkOffset, persist);
         if(!writeResult.success()) {
-            result.success() = false;
-            result.error() = writeResult.error();
+            fail(result, ErrorCode::Backend, writeResult.error());
         }
-        trace("Successfully executed create_write request");
+        if(result.success()) capture.region = result.value();
+        capture.success = result.success();
+        event("Successfully executed create_write request");
     }
 
     void createWriteEagerRPC(const tl::request& req,
+                             uint64_t request_id,
                              const BufferWrapper& buffer,
                              bool persist) {
-        trace("Received create_write_eager request");
-        Result<RegionID> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"create_write_eager"};
+        event("Received create_write_eager request {}", request_id);
+        CodedResult<RegionID> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::CreateWriteEager, request_id, persist};
+        capture.size = buffer.size();
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
             return;
         }
-        auto region = m_target->create(buffer.size());
+        auto region = [&]() {
+            TraceSpan backendSpan{"backend_create", TraceStage::Backend};
+            return m_target->create(buffer.size());
+        }();
         if(!region.success()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::Backend, region.error());
             return;
         }
         result = region.value()->getRegionID();
+        RegionVersions::WriteGuard versionGuard{m_versions, result.value()};
+        TraceSpan backendSpan{"backend_write", TraceStage::Backend};
         auto writeResult = region.value()->write(
                 {{0, buffer.size()}}, buffer.data(), persist);
         if(!writeResult.success()) {
-            result.success() = false;
-            result.error() = writeResult.error();
+            fail(result, ErrorCode::Backend, writeResult.error());
+        }
+        if(result.success()) capture.region = result.value();
+        capture.success = result.success();
+        event("Successfully executed create_write_eager request");
+    }
+
+    void appendRPC(const tl::request& req,
+                   uint64_t request_id,
+                   const RegionID& region_id,
+                   thallium::bulk data,
+                   const std::string& address,
+                   size_t bulkOffset, size_t size,
+                   bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"append"};
+        event("Received append request {}", request_id);
+        CodedResult<size_t> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Append, request_id, persist};
+        capture.region = region_id;
+        capture.size = size;
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        RegionMigrations::WriteAccess migration{m_migrations, region_id, nullptr};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        // the range must be reserved before the region is accessed,
+        // since backends may lock the region until it is released
+        result = m_target->reserve(region_id, size);
+        if(!result.success()) return;
+        auto offset = result.value();
+        auto region = m_target->write(region_id, persist);
+        if(!region.success()) {
+            failAppend(result, region_id, offset, size, ErrorCode::InvalidRegion, region.error());
+            return;
+        }
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        auto source = address.empty() ? req.get_endpoint() : lookup(address);
+        auto writeResult = m_transfer_manager->pull(
+                *region.value(), {{offset, size}}, data, source, bulkOffset, persist);
+        if(!writeResult.success()) {
+            failAppend(result, region_id, offset, size, ErrorCode::Backend, writeResult.error());
+        }
+        capture.success = result.success();
+        event("Successfully executed append request");
+    }
+
+    /**
+     * @brief Fail an append whose range was reserved but not written,
+     * giving the range back if no other append reserved a range after
+     * it, and otherwise reporting the hole it leaves in the region.
+     */
+    void failAppend(CodedResult<size_t>& result, const RegionID& region_id,
+                    size_t offset, size_t size, ErrorCode code, const std::string& error) {
+        if(m_target->unreserve(region_id, offset, size))
+            fail(result, code, error);
+        else
+            fail(result, code, fmt::format(
+                "{} (the {} bytes reserved at offset {} of the region are left unwritten)",
+                error, size, offset));
+    }
+
+    void appendEagerRPC(const tl::request& req,
+                        uint64_t request_id,
+                        const RegionID& region_id,
+                        const BufferWrapper& buffer,
+                        bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"append_eager"};
+        event("Received append_eager request {}", request_id);
+        CodedResult<size_t> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::AppendEager, request_id, persist};
+        capture.region = region_id;
+        capture.size = buffer.size();
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        RegionMigrations::WriteAccess migration{m_migrations, region_id, nullptr};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        result = m_target->reserve(region_id, buffer.size());
+        if(!result.success()) return;
+        auto offset = result.value();
+        auto region = m_target->write(region_id, persist);
+        if(!region.success()) {
+            failAppend(result, region_id, offset, buffer.size(), ErrorCode::InvalidRegion, region.error());
+            return;
+        }
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        TraceSpan backendSpan{"backend_write", TraceStage::Backend};
+        auto writeResult = region.value()->write(
+                {{offset, buffer.size()}}, buffer.data(), persist);
+        if(!writeResult.success()) {
+            failAppend(result, region_id, offset, buffer.size(), ErrorCode::Backend, writeResult.error());
         }
-        trace("Successfully executed create_write_eager request");
+        capture.success = result.success();
+        event("Successfully executed append_eager request");
     }
 
     void readRPC(const tl::request& req,
+                 uint64_t request_id,
                  const RegionID& region_id,
-                 const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+                 Layout layout,
                  thallium::bulk data,
                  const std::string& address,
                  size_t bulkOffset) {
-        trace("Received read request");
-        Result<bool> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        handleRead<CodedResult<bool>>(req, request_id, region_id, layout, data, address, bulkOffset);
+    }
+
+    void readV2RPC(const tl::request& req,
+                   const RequestHeader& header,
+                   CompactLayout layout,
+                   const BulkLocation& data) {
+        handleRead<CompactResult<bool>>(req, header.request_id, header.region, layout.layout,
+                                        data.bulk, data.address, data.offset);
+    }
+
+    template<typename ResultType>
+    void handleRead(const tl::request& req,
+                    uint64_t request_id,
+                    const RegionID& region_id,
+                    Layout& layout,
+                    const thallium::bulk& data,
+                    const std::string& address,
+                    size_t bulkOffset) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"read"};
+        event("Received read request {}", request_id);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Read, request_id, false, layout};
+        capture.region = region_id;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
             return;
         }
+        if(!receiveLayout(layout, req, result)) return;
         auto region = m_target->read(region_id);
         if(!region.value()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::InvalidRegion, region.error());
             return;
         }
-        auto source = address.empty() ? req.get_endpoint() : m_engine.lookup(address);
-        result = m_transfer_manager->push(
-                *region.value(), regionOffsetSizes, data, source, bulkOffset);
-        trace("Successfully executed read request");
+        auto source = address.empty() ? req.get_endpoint() : lookup(address);
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                result = m_transfer_manager->push(
+                    *region.value(), segments, data, source, bulkOffset + before);
+                return result.success();
+            });
+        capture.success = result.success();
+        event("Successfully executed read request");
     }
 
     void readEagerRPC(const tl::request& req,
+                      uint64_t request_id,
                       const RegionID& region_id,
-                      const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
-        trace("Received read_eager request");
-        Result<BufferWrapper> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+                      Layout layout) {
+        handleReadEager<CodedResult<BufferWrapper>>(req, request_id, region_id, layout);
+    }
+
+    void readEagerV2RPC(const tl::request& req,
+                        const RequestHeader& header,
+                        CompactLayout layout) {
+        handleReadEager<CompactResult<BufferWrapper>>(req, header.request_id, header.region, layout.layout);
+    }
+
+    template<typename ResultType>
+    void handleReadEager(const tl::request& req,
+                         uint64_t request_id,
+                         const RegionID& region_id,
+                         Layout& layout) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"read_eager"};
+        event("Received read_eager request {}", request_id);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::ReadEager, request_id, false, layout};
+        capture.region = region_id;
         if(!m_target) {
-            result.success() = false;
-            result.error() = "No target found in the provider";
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
             return;
         }
+        if(!receiveLayout(layout, req, result)) return;
         auto region = m_target->read(region_id);
         if(!region.value()) {
-            result.success() = false;
-            result.error() = region.error();
+            fail(result, ErrorCode::InvalidRegion, region.error());
             return;
         }
-        size_t size = std::accumulate(regionOffsetSizes.begin(), regionOffsetSizes.end(), (size_t)0,
-                [](size_t acc, const std::pair<size_t, size_t>& p) { return acc + p.second; });
-        result.value().allocate(size);
-        auto ret = region.value()->read(regionOffsetSizes, result.value().data());
+        result.value().allocate(layout.size());
+        TraceSpan backendSpan{"backend_read", TraceStage::Backend};
+        Result<bool> ret;
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                ret = region.value()->read(segments, result.value().data() + before);
+                return ret.success();
+            });
         if(!ret.success()) {
-            result.success() = false;
-            result.error() = ret.error();
+            fail(result, ErrorCode::Backend, ret.error());
         }
-        trace("Successfully executed read_eager request");
+        capture.success = result.success();
+        event("Successfully executed read_eager request");
     }
 
     void eraseRPC(const tl::request& req,
+                  uint64_t request_id,
                   const RegionID& region_id) {
-        trace("Received erase request");
-        Result<bool> result;
-        tl::auto_respond<decltype(result)> response{req, result};
+        handleErase<CodedResult<bool>>(req, request_id, region_id);
+    }
+
+    void eraseV2RPC(const tl::request& req,
+                    const RequestHeader& header) {
+        handleErase<CompactResult<bool>>(req, header.request_id, header.region);
+    }
+
+    template<typename ResultType>
+    void handleErase(const tl::request& req,
+                     uint64_t request_id,
+                     const RegionID& region_id) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"erase"};
+        event("Received erase request {}", request_id);
+        ResultType result;
+        ResponseOf<ResultType> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Erase, request_id};
+        capture.region = region_id;
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        RegionMigrations::ExclusiveAccess migration{m_migrations, region_id};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        if(migration.migrating()) {
+            fail(result, ErrorCode::InvalidRegion, "Cannot erase a region that is being migrated");
+            return;
+        }
+        TraceSpan backendSpan{"backend_erase", TraceStage::Backend};
+        result = m_target->erase(region_id);
+        m_versions.erased(region_id);
+        capture.success = result.success();
+        event("Successfully executed erase request");
+    }
+
+    void atomicRPC(const tl::request& req,
+                   uint64_t request_id,
+                   const RegionID& region_id,
+                   size_t offset,
+                   uint8_t op,
+                   uint8_t width,
+                   const BufferWrapper& operands,
+                   bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"atomic"};
+        event("Received atomic request {}", request_id);
+        CodedResult<BufferWrapper> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        Layout::Segments segments{{offset, width}};
+        CaptureScope capture{m_capture.get(), CaptureOp::Atomic, request_id, persist, &segments};
+        capture.region = region_id;
+        capture.size = width;
+        auto atomicOp = static_cast<AtomicOp>(op);
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        size_t numOperands = atomicOp == AtomicOp::CompareSwap ? 2 : 1;
+        if(!validAtomic(atomicOp, width) || operands.size() != numOperands * width) {
+            fail(result, ErrorCode::InvalidArgument, "Invalid atomic operation");
+            return;
+        }
+        if(offset % width) {
+            fail(result, ErrorCode::InvalidArgument, fmt::format(
+                "Offset {} is not aligned to the size of the word ({} bytes)", offset, width));
+            return;
+        }
+        auto wordLayout = Layout::contiguous(offset, width);
+        RegionMigrations::WriteAccess migration{m_migrations, region_id, &wordLayout};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        // the word is read and written with separate accesses to the
+        // region, which the lock makes atomic with respect to other
+        // atomic operations on the same word
+        std::lock_guard<tl::mutex> lock{m_atomic_locks.get(region_id, offset)};
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        TraceSpan backendSpan{"backend_atomic", TraceStage::Backend};
+        result.value().allocate(width);
+        char word[16];
+        {
+            auto region = m_target->read(region_id);
+            if(!region.success()) {
+                fail(result, ErrorCode::InvalidRegion, region.error());
+                return;
+            }
+            auto ret = region.value()->read(segments, result.value().data());
+            if(!ret.success()) {
+                fail(result, ErrorCode::Backend, ret.error());
+                return;
+            }
+        }
+        std::memcpy(word, result.value().data(), width);
+        applyAtomic(atomicOp, width, word, operands.data(), operands.data() + width);
+        bool changed = std::memcmp(word, result.value().data(), width) != 0;
+        if(changed || persist) {
+            auto region = m_target->write(region_id, persist);
+            if(!region.success()) {
+                fail(result, ErrorCode::InvalidRegion, region.error());
+                return;
+            }
+            // an unchanged word may still hold data written without persist
+            auto ret = changed ? region.value()->write(segments, word, persist)
+                               : region.value()->persist(segments);
+            if(!ret.success()) {
+                fail(result, ErrorCode::Backend, ret.error());
+                return;
+            }
+        }
+        capture.success = true;
+        event("Successfully executed atomic request");
+    }
+
+    void resizeRPC(const tl::request& req,
+                   uint64_t request_id,
+                   const RegionID& region_id,
+                   size_t size) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"resize"};
+        event("Received resize request {}", request_id);
+        CodedResult<RegionID> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        RegionMigrations::ExclusiveAccess migration{m_migrations, region_id};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        if(migration.migrating()) {
+            fail(result, ErrorCode::InvalidRegion, "Cannot resize a region that is being migrated");
+            return;
+        }
+        RegionVersions::WriteGuard versionGuard{m_versions, region_id};
+        TraceSpan backendSpan{"backend_resize", TraceStage::Backend};
+        result = m_target->resize(region_id, size);
+        // a region that moved is gone from its old RegionID
+        if(result.success() && result.value() != region_id)
+            m_versions.erased(region_id);
+        event("Successfully executed resize request");
+    }
+
+    void copyRPC(const tl::request& req,
+                 uint64_t request_id,
+                 const RegionID& source,
+                 size_t sourceOffset,
+                 const RegionID& dest,
+                 size_t destOffset,
+                 size_t size) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"copy"};
+        event("Received copy request {}", request_id);
+        CodedResult<bool> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(source)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        auto destLayout = Layout::contiguous(destOffset, size);
+        RegionMigrations::WriteAccess migration{m_migrations, dest, &destLayout};
+        if(migration.forwarded()) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        RegionVersions::WriteGuard versionGuard{m_versions, dest};
+        TraceSpan backendSpan{"backend_copy", TraceStage::Backend};
+        result = m_target->copy(source, sourceOffset, dest, destOffset, size);
+        event("Successfully executed copy request");
+    }
+
+    void cloneRPC(const tl::request& req,
+                  uint64_t request_id,
+                  const RegionID& region_id) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"clone"};
+        event("Received clone request {}", request_id);
+        CodedResult<RegionID> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        TraceSpan backendSpan{"backend_clone", TraceStage::Backend};
+        result = m_target->clone(region_id);
+        event("Successfully executed clone request");
+    }
+
+    void readVersionedRPC(const tl::request& req,
+                          uint64_t request_id,
+                          const RegionID& region_id,
+                          Layout layout,
+                          thallium::bulk data,
+                          const std::string& address,
+                          size_t bulkOffset) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"read_versioned"};
+        event("Received read_versioned request {}", request_id);
+        CodedResult<uint64_t> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::Read, request_id, false, layout};
+        capture.region = region_id;
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        if(!receiveLayout(layout, req, result)) return;
+        auto region = m_target->read(region_id);
+        if(!region.success()) {
+            fail(result, ErrorCode::InvalidRegion, region.error());
+            return;
+        }
+        auto versionBefore = m_versions.get(region_id);
+        auto source = address.empty() ? req.get_endpoint() : lookup(address);
+        Result<bool> ret;
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                ret = m_transfer_manager->push(
+                    *region.value(), segments, data, source, bulkOffset + before);
+                return ret.success();
+            });
+        if(!ret.success()) {
+            fail(result, ErrorCode::Backend, ret.error());
+        } else {
+            // the data may be inconsistent if a write happened during the read
+            result.value() = versionBefore == m_versions.get(region_id) ? versionBefore : 0;
+        }
+        capture.success = result.success();
+        event("Successfully executed read_versioned request");
+    }
+
+    void readEagerVersionedRPC(const tl::request& req,
+                               uint64_t request_id,
+                               const RegionID& region_id,
+                               Layout layout) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"read_eager_versioned"};
+        event("Received read_eager_versioned request {}", request_id);
+        CodedResult<VersionedBuffer> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        CaptureScope capture{m_capture.get(), CaptureOp::ReadEager, request_id, false, layout};
+        capture.region = region_id;
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        if(!receiveLayout(layout, req, result)) return;
+        auto region = m_target->read(region_id);
+        if(!region.success()) {
+            fail(result, ErrorCode::InvalidRegion, region.error());
+            return;
+        }
+        auto versionBefore = m_versions.get(region_id);
+        result.value().buffer.allocate(layout.size());
+        TraceSpan backendSpan{"backend_read", TraceStage::Backend};
+        Result<bool> ret;
+        layout.forEachBatch(s_layout_batch,
+            [&](const Layout::Segments& segments, size_t before) {
+                ret = region.value()->read(segments, result.value().buffer.data() + before);
+                return ret.success();
+            });
+        if(!ret.success()) {
+            fail(result, ErrorCode::Backend, ret.error());
+        } else {
+            result.value().version = versionBefore == m_versions.get(region_id) ? versionBefore : 0;
+        }
+        capture.success = result.success();
+        event("Successfully executed read_eager_versioned request");
+    }
+
+    void getVersionsRPC(const tl::request& req,
+                        uint64_t request_id,
+                        const std::vector<RegionID>& region_ids) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"get_versions"};
+        event("Received get_versions request {} for {} regions", request_id, region_ids.size());
+        Result<std::vector<uint64_t>> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
         if(!m_target) {
             result.success() = false;
             result.error() = "No target found in the provider";
             return;
         }
-        result = m_target->erase(region_id);
-        trace("Successfully executed erase request");
+        result.value().reserve(region_ids.size());
+        for(auto& region_id : region_ids)
+            result.value().push_back(m_versions.get(region_id));
+        event("Successfully executed get_versions request");
+    }
+
+    void prefetchRPC(const tl::request& req,
+                     uint64_t request_id,
+                     const std::vector<RegionID>& region_ids,
+                     const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"prefetch"};
+        event("Received prefetch request {} for {} ranges", request_id, region_ids.size());
+        CodedResult<bool> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(region_ids.size() != regionOffsetSizes.size()) {
+            fail(result, ErrorCode::InvalidArgument,
+                 "Invalid prefetch request: mismatching number of regions and ranges");
+            return;
+        }
+        // this is only a hint: ranges of regions that can't be accessed are skipped
+        TraceSpan backendSpan{"backend_prefetch", TraceStage::Backend};
+        for(size_t i = 0; i < region_ids.size(); ++i) {
+            auto region = m_target->read(region_ids[i]);
+            if(!region.value()) continue;
+            region.value()->prefetch({regionOffsetSizes[i]});
+        }
+        event("Successfully executed prefetch request");
+    }
+
+    /**
+     * @brief Return the endpoint corresponding to an address, looking
+     * it up only the first time the address is seen.
+     */
+    tl::endpoint lookup(const std::string& address) {
+        std::lock_guard<tl::mutex> lock{m_endpoints_mtx};
+        auto it = m_endpoints.find(address);
+        if(it != m_endpoints.end()) return it->second;
+        auto endpoint = m_engine.lookup(address);
+        if(m_endpoints.size() >= 1024) m_endpoints.clear();
+        m_endpoints.emplace(address, endpoint);
+        return endpoint;
+    }
+
+    /**
+     * @brief Send extents of a region to a region of another provider.
+     * The extents are read in chunks, each of which is exposed to the
+     * destination provider in a write request that makes it pull the
+     * chunk, while the next chunks are read from the backend.
+     */
+    Result<bool> sendExtents(uint64_t request_id,
+                             const RegionID& region_id,
+                             const RegionMigrations::Extents& extents,
+                             const tl::provider_handle& dest,
+                             const RegionID& dest_region,
+                             bool persist) {
+        Result<bool> result;
+        struct Chunk {
+            std::vector<char>  buffer;
+            tl::bulk           bulk;
+            tl::async_response response;
+        };
+        std::deque<Chunk> inflight;
+        auto complete = [&]() {
+            TimedResult<bool> written = inflight.front().response.wait();
+            inflight.pop_front();
+            if(!written.result.success() && result.success()) result = written.result;
+        };
+        for(auto& extent : extents) {
+            auto end = extent.first + extent.second;
+            for(size_t offset = extent.first; offset < end && result.success(); offset += s_transfer_chunk) {
+                if(inflight.size() == s_transfer_depth) complete();
+                if(!result.success()) break;
+                size_t n = std::min(s_transfer_chunk, end - offset);
+                std::vector<char> buffer(n);
+                {
+                    TraceSpan backendSpan{"backend_read", TraceStage::Backend};
+                    auto region = m_target->read(region_id);
+                    if(!region.success()) {
+                        result.success() = false;
+                        result.error() = region.error();
+                        break;
+                    }
+                    result = region.value()->read({{offset, n}}, buffer.data());
+                    if(!result.success()) break;
+                }
+                auto bulk = m_engine.expose({{buffer.data(), n}}, tl::bulk_mode::read_only);
+                auto async_response = m_write.on(dest).async(
+                    request_id, dest_region, Layout::contiguous(offset, n),
+                    bulk, m_self_address, (size_t)0, persist);
+                inflight.push_back(Chunk{std::move(buffer), std::move(bulk), std::move(async_response)});
+            }
+        }
+        while(!inflight.empty()) complete();
+        return result;
+    }
+
+    /**
+     * @brief Copy a region to the target of another provider.
+     */
+    void transferRPC(const tl::request& req,
+                     uint64_t request_id,
+                     const RegionID& region_id,
+                     size_t size,
+                     const std::string& dest_address,
+                     uint16_t dest_provider_id,
+                     bool persist) {
+        RequestTimer timer{m_report_timings};
+        TraceContextGuard traceContext{m_tracer.get(), timer.stages(), request_id};
+        TraceSpan span{"transfer"};
+        event("Received transfer request {} with size {}", request_id, size);
+        CodedResult<RegionID> result;
+        TimedResponse<decltype(result)> response{req, result, timer};
+        if(!m_target) {
+            fail(result, ErrorCode::NoTarget);
+            return;
+        }
+        if(m_migrations.forwarded(region_id)) {
+            fail(result, ErrorCode::Moved);
+            return;
+        }
+        try {
+            tl::provider_handle dest{lookup(dest_address), dest_provider_id};
+            TimedResult<RegionID> created = m_create.on(dest)(request_id, size);
+            result = std::move(created.result);
+            if(!result.success()) return;
+            auto sent = sendExtents(request_id, region_id, {{0, size}}, dest, result.value(), persist);
+            if(!sent.success()) {
+                // do not leave a partial copy of the region at the destination
+                TimedResult<bool> erased = m_erase.on(dest)(request_id, result.value());
+                (void)erased;
+                fail(result, ErrorCode::Backend, sent.error());
+                return;
+            }
+        } catch(const std::exception& ex) {
+            fail(result, ErrorCode::Backend,
+                 fmt::format("Transfer to {} failed: {}", dest_address, ex.what()));
+            return;
+        }
+        event("Successfully executed transfer request");
+    }
+
+    void getForwardRPC(const tl::request& req,
+                       const RegionID& region_id) {
+        Result<RegionForward> result;
+        tl::auto_respond<decltype(result)> response{req, result};
+        if(!m_migrations.forwarded(region_id, &result.value())) {
+            result.success() = false;
+            result.error() = "Region was not migrated";
+        }
+    }
+
+    /**
+     * @brief Migrate regions to another provider while they are being
+     * written (see Provider::migrateRegions).
+     */
+    std::vector<RegionID> migrateRegions(const std::vector<RegionID>& regions,
+                                         const std::string& dest_address,
+                                         uint16_t dest_provider_id,
+                                         const std::string& options) {
+        if(!m_target) throw Exception{"No target to migrate regions from"};
+        size_t max_rounds = 8;
+        size_t switchover_size = s_transfer_chunk;
+        bool persist = false;
+        if(!options.empty()) {
+            json json_options;
+            try {
+                json_options = json::parse(options);
+            } catch(json::parse_error& e) {
+                throw Exception{fmt::format(
+                    "Could not parse region migration options: {}", e.what())};
+            }
+            static const json schema = R"(
+            {
+                "type": "object",
+                "properties": {
+                    "max_rounds": {"type": "integer", "minimum": 0},
+                    "switchover_size": {"type": "integer", "minimum": 0},
+                    "persist": {"type": "boolean"}
+                }
+            })"_json;
+            json_validator validator;
+            validator.set_root_schema(schema);
+            try {
+                validator.validate(json_options);
+            } catch(const std::exception& ex) {
+                throw Exception{fmt::format("Invalid region migration options: {}", ex.what())};
+            }
+            max_rounds = json_options.value("max_rounds", max_rounds);
+            switchover_size = json_options.value("switchover_size", switchover_size);
+            persist = json_options.value("persist", persist);
+        }
+        tl::provider_handle dest;
+        try {
+            dest = tl::provider_handle{lookup(dest_address), dest_provider_id};
+        } catch(const std::exception& ex) {
+            throw Exception{fmt::format("Failed to lookup destination address: {}", ex.what())};
+        }
+        std::vector<RegionID> result;
+        result.reserve(regions.size());
+        for(auto& region : regions) {
+            result.push_back(migrateRegion(region, dest, dest_address, max_rounds, switchover_size, persist));
+        }
+        return result;
+    }
+
+    RegionID migrateRegion(const RegionID& region_id,
+                           const tl::provider_handle& dest,
+                           const std::string& dest_address,
+                           size_t max_rounds, size_t switchover_size,
+                           bool persist) {
+        // resizes and erasures of the region are refused from now on,
+        // so its size and storage stay valid until it is forwarded
+        if(!m_migrations.start(region_id))
+            throw Exception{"Region is already being migrated or was migrated"};
+        auto regionSize = m_target->size(region_id);
+        if(!regionSize.success()) {
+            m_migrations.abort(region_id);
+            throw Exception{fmt::format("Failed to migrate region: {}", regionSize.error())};
+        }
+        size_t size = regionSize.value();
+        // only used for tracing at the destination
+        static std::atomic<uint64_t> s_request_id{0};
+        uint64_t request_id = s_request_id++;
+        RegionID dest_region;
+        bool created = false;
+        auto cancel = [&](const std::string& error) {
+            m_migrations.abort(region_id);
+            if(created) {
+                try {
+                    TimedResult<bool> erased = m_erase.on(dest)(request_id, dest_region);
+                    (void)erased;
+                } catch(...) {}
+            }
+            throw Exception{fmt::format("Failed to migrate region: {}", error)};
+        };
+        try {
+            TimedResult<RegionID> creation = m_create.on(dest)(request_id, size);
+            if(!creation.result.success()) cancel(creation.result.error());
+            dest_region = creation.result.value();
+            created = true;
+            // pre-copy: the region keeps being written while it is sent,
+            // then the extents written in the meantime are resent
+            RegionMigrations::Extents extents{{0, size}};
+            for(size_t round = 0; ; ++round) {
+                auto sent = sendExtents(request_id, region_id, extents, dest, dest_region, persist);
+                if(!sent.success()) cancel(sent.error());
+                extents = m_migrations.takeDirty(region_id, size);
+                size_t dirty = 0;
+                for(auto& e : extents) dirty += e.second;
+                if(dirty <= switchover_size || round + 1 >= max_rounds) break;
+            }
+            // switchover: writes wait while the last extents are sent
+            m_migrations.freeze(region_id);
+            auto last = m_migrations.takeDirty(region_id, size);
+            extents.insert(extents.end(), last.begin(), last.end());
+            auto sent = sendExtents(request_id, region_id, extents, dest, dest_region, persist);
+            if(!sent.success()) cancel(sent.error());
+        } catch(const Exception&) {
+            throw;
+        } catch(const std::exception& ex) {
+            cancel(ex.what());
+        }
+        m_migrations.forward(region_id, RegionForward{dest_address, dest.provider_id(), dest_region});
+        m_versions.erased(region_id);
+        // the region is migrated even if its storage cannot be reclaimed
+        auto erased = m_target->erase(region_id);
+        if(!erased.success())
+            error("Could not erase migrated region: {}", erased.error());
+        return dest_region;
+    }
+
+    void getProtocolVersionRPC(const tl::request& req) {
+        req.respond(s_wire_protocol_version);
+    }
+
+    /*
+     * RPCs of the clients that predate request ids and layouts, still
+     * served under their original names. Their segments are converted
+     * into a Layout and their requests get the id 0 in traces, captures
+     * and logs. Their responses are those of the version 1 RPCs, whose
+     * trailing timings and error code these clients do not read.
+     */
+
+    void createLegacyRPC(const tl::request& req, size_t size) {
+        createRPC(req, 0, size);
+    }
+
+    void writeLegacyRPC(const tl::request& req,
+                        const RegionID& region_id,
+                        const Layout::Segments& regionOffsetSizes,
+                        thallium::bulk data,
+                        const std::string& address,
+                        size_t bulkOffset,
+                        bool persist) {
+        writeRPC(req, 0, region_id, Layout::fromSegments(regionOffsetSizes),
+                 std::move(data), address, bulkOffset, persist);
+    }
+
+    void writeEagerLegacyRPC(const tl::request& req,
+                             const RegionID& region_id,
+                             const Layout::Segments& regionOffsetSizes,
+                             const BufferWrapper& buffer,
+                             bool persist) {
+        writeEagerRPC(req, 0, region_id, Layout::fromSegments(regionOffsetSizes), buffer, persist);
+    }
+
+    void persistLegacyRPC(const tl::request& req,
+                          const RegionID& region_id,
+                          const Layout::Segments& regionOffsetSizes) {
+        persistRPC(req, 0, region_id, Layout::fromSegments(regionOffsetSizes));
+    }
+
+    void createWriteLegacyRPC(const tl::request& req,
+                              thallium::bulk data,
+                              const std::string& address,
+                              size_t bulkOffset, size_t size,
+                              bool persist) {
+        createWriteRPC(req, 0, std::move(data), address, bulkOffset, size, persist);
+    }
+
+    void createWriteEagerLegacyRPC(const tl::request& req,
+                                   const BufferWrapper& buffer,
+                                   bool persist) {
+        createWriteEagerRPC(req, 0, buffer, persist);
+    }
+
+    void readLegacyRPC(const tl::request& req,
+                       const RegionID& region_id,
+                       const Layout::Segments& regionOffsetSizes,
+                       thallium::bulk data,
+                       const std::string& address,
+                       size_t bulkOffset) {
+        readRPC(req, 0, region_id, Layout::fromSegments(regionOffsetSizes),
+                std::move(data), address, bulkOffset);
+    }
+
+    void readEagerLegacyRPC(const tl::request& req,
+                            const RegionID& region_id,
+                            const Layout::Segments& regionOffsetSizes) {
+        readEagerRPC(req, 0, region_id, Layout::fromSegments(regionOffsetSizes));
+    }
+
+    void eraseLegacyRPC(const tl::request& req,
+                        const RegionID& region_id) {
+        eraseRPC(req, 0, region_id);
     }
 
     void getREMIproviderIdRPC(const tl::request& req) {
-        trace("Received getREMIproviderId request");
+        event("Received getREMIproviderId request");
         Result<uint16_t> result;
         tl::auto_respond<decltype(result)> response{req, result};
 #ifndef WARABI_HAS_REMI
@@ -506,18 +1718,20 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
         }
         result.value() = id;
 #endif
-        trace("Successfully executed getREMIproviderId request");
+        event("Successfully executed getREMIproviderId request");
     }
 
-    void migrateTarget(const std::string& dest_address,
-                       uint16_t dest_provider_id,
-                       const std::string& options) {
-#ifndef WARABI_HAS_REMI
-        throw Exception{"Warabi was not compiled with REMI support"};
-#else
-        // check we have a REMI client we can use
-        if(!m_remi_client) throw Exception{"No REMI client available to send target"};
-
+    /**
+     * @brief Migrate the target to another provider (see
+     * Provider::migrateTarget). The options are checked right away,
+     * then the migration runs in the calling ULT, or in a ULT of the
+     * provider's pool if keepalive is not null, in which case keepalive
+     * keeps the provider alive until the migration completes.
+     */
+    std::shared_ptr<AsyncMigrationImpl> migrateTarget(const std::string& dest_address,
+                                                      uint16_t dest_provider_id,
+                                                      const std::string& options,
+                                                      std::shared_ptr<ProviderImpl> keepalive = nullptr) {
         // check if there is a target to transfer
         if(!m_target) throw Exception{"No target to migration"};
 
@@ -536,7 +1750,12 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
                 "new_root": {"type": "string"},
                 "transfer_size": {"type": "integer", "minimum": 0},
                 "merge_config": {"type": "object"},
-                "remove_source": {"type": "boolean"}
+                "remove_source": {"type": "boolean"},
+                "incremental": {"type": "boolean"},
+                "transport": {"type": "string", "enum": ["remi", "rpc"]},
+                "streams": {"type": "integer", "minimum": 1},
+                "max_bandwidth": {"type": "integer", "minimum": 0},
+                "compression": {"type": "string", "enum": ["none", "sparse"]}
             }
         })"_json;
 
@@ -549,11 +1768,60 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
             throw Exception("Invalid JSON migration options: {}", ex.what());
         }
 
+        // the options controlling the transfer are only
+        // available when the provider streams the files itself
+        bool streamed = json_options.contains("streams")
+                     || json_options.contains("max_bandwidth")
+                     || json_options.contains("compression");
+        if(!json_options.contains("transport"))
+            json_options["transport"] = streamed || !m_remi_client ? "rpc" : "remi";
+        if(json_options["transport"] == "remi") {
+#ifndef WARABI_HAS_REMI
+            throw Exception{"Warabi was not compiled with REMI support"};
+#endif
+            // check we have a REMI client we can use
+            if(!m_remi_client) throw Exception{"No REMI client available to send target"};
+            if(streamed)
+                throw Exception{"Options streams, max_bandwidth, and compression"
+                                " require the \"rpc\" transport"};
+        }
+
+        if(m_migrating_target.exchange(true))
+            throw Exception{"A migration of the target is already in progress"};
+
+        auto migration = std::make_shared<AsyncMigrationImpl>();
+        bool background = static_cast<bool>(keepalive);
+        auto run = [this, migration, dest_address, dest_provider_id, json_options, background]() {
+            std::string failure;
+            try {
+                auto dest_provider = migrationDestination(dest_address, dest_provider_id);
+                if(json_options["transport"] == "rpc")
+                    streamTarget(dest_provider, json_options, *migration);
+                else
+                    sendTargetWithREMI(dest_provider, json_options, *migration);
+            } catch(const std::exception& ex) {
+                failure = ex.what();
+                if(background)
+                    error("Migration of target to provider {} at {} failed: {}",
+                          dest_provider_id, dest_address, failure);
+            }
+            m_migrating_target = false;
+            migration->complete(std::move(failure));
+        };
+        if(keepalive)
+            m_pool.make_thread([run, keepalive]() { run(); }, tl::anonymous());
+        else
+            run();
+        return migration;
+    }
+
+    tl::provider_handle migrationDestination(const std::string& dest_address,
+                                             uint16_t dest_provider_id) {
         // lookup destination address
         tl::provider_handle dest_provider;
         try {
             dest_provider = tl::provider_handle{
-                m_engine.lookup(dest_address),
+                lookup(dest_address),
                 dest_provider_id
             };
             if(dest_provider.get_identity() != "warabi")
@@ -562,6 +1830,19 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
             throw Exception{
                 fmt::format("Failed to lookup destination address: {}", ex.what())};
         }
+        return dest_provider;
+    }
+
+    void sendTargetWithREMI(const tl::provider_handle& dest_provider,
+                            const json& json_options,
+                            AsyncMigrationImpl& progress) {
+#ifndef WARABI_HAS_REMI
+        (void)dest_provider;
+        (void)json_options;
+        (void)progress;
+        throw Exception{"Warabi was not compiled with REMI support"};
+#else
+        uint16_t dest_provider_id = dest_provider.provider_id();
 
         // get the REMI provider ID used by the destination provider
         uint16_t dest_remi_provider_id;
@@ -587,60 +1868,513 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
                           "Failed to create REMI provider handle");
         DEFER(remi_provider_handle_release(remi_ph));
 
+        // get the config to send to by merging the target config with the merge config
+        auto target_config = json::parse(m_target->getConfig());
+        target_config.update(json_options.value("merge_config", json::object()), true);
+
+        // the phases of an incremental migration carry an id unique to the
+        // migration, so that a destination receiving several does not mix them
+        auto migrationId = fmt::format("{}/{}/{}", m_self_address, get_provider_id(), ++m_outgoing_id);
+
+        // send files through REMI; phase is "precopy" or "delta" for the
+        // phases of an incremental migration, and empty otherwise
+        auto sendFiles = [&](const std::string& root,
+                             const std::list<std::string>& files,
+                             const std::string& new_root,
+                             const char* phase) {
+            // REMI does not report its progress, so the files
+            // are accounted for once they have all been sent
+            size_t bytes = 0;
+            auto sizes = stream::listFiles(root, files);
+            if(sizes.success())
+                for(auto& file : sizes.value()) bytes += file.size;
+            progress.m_total += bytes;
+            if(progress.m_cancelled) {
+                if(migrationHandle) migrationHandle->cancel();
+                throw Exception{"Migration was cancelled"};
+            }
+
+            // create REMI fileset
+            remi_fileset_t fileset = REMI_FILESET_NULL;
+            int rret = remi_fileset_create("warabi", root.c_str(), &fileset);
+            HANDLE_REMI_ERROR(remi_fileset_create, rret, "Failed to create REMI fileset");
+            DEFER(remi_fileset_free(fileset));
+
+            // set its destination provider
+            remi_fileset_set_provider_id(fileset, dest_provider_id);
+
+            // fill REMI fileset
+            for(const auto& file : files) {
+                if(!file.empty() && file.back() == '/') {
+                    rret = remi_fileset_register_directory(fileset, file.c_str());
+                    HANDLE_REMI_ERROR(remi_fileset_register_directory, rret,
+                            "Failed to register directory {} in REMI fileset", file);
+                } else {
+                    rret = remi_fileset_register_file(fileset, file.c_str());
+                    HANDLE_REMI_ERROR(remi_fileset_register_file, rret,
+                            "Failed to register file {} in REMI fileset", file);
+                }
+            }
+
+            // register REMI metadata
+            rret = remi_fileset_register_metadata(fileset, "config", target_config.dump().c_str());
+            HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
+            rret = remi_fileset_register_metadata(fileset, "type", m_target->name().c_str());
+            HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
+            if(*phase) {
+                rret = remi_fileset_register_metadata(fileset, "phase", phase);
+                HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
+                rret = remi_fileset_register_metadata(fileset, "migration_id", migrationId.c_str());
+                HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
+            }
+
+            // set block transfer size
+            if(json_options.contains("transfer_size")) {
+                rret = remi_fileset_set_xfer_size(fileset, json_options["transfer_size"].get<size_t>());
+                HANDLE_REMI_ERROR(remi_fileset_set_xfer_size, rret, "Failed to set transfer size for REMI fileset");
+            }
+
+            // issue migration RPC (the files of an incremental migration
+            // are still in use when they are sent)
+            auto keep_source = !*phase && json_options.value("keep_source", false)
+                             ? REMI_REMOVE_SOURCE : REMI_KEEP_SOURCE;
+            int remi_status = 0;
+            rret = remi_fileset_migrate(remi_ph, fileset, new_root.c_str(),
+                                        keep_source, REMI_USE_MMAP, &remi_status);
+            HANDLE_REMI_ERROR(remi_fileset_migrate, rret, "REMI failed to migrate fileset");
+            progress.m_transferred += bytes;
+            progress.m_sent += bytes;
+        };
+
+        // an incremental migration first sends the files while the target
+        // keeps serving requests, tracking the extents they modify
+        std::unique_ptr<DirtyTracker> tracker;
+        if(json_options.value("incremental", false)) {
+            auto tracking = m_target->trackChanges();
+            if(tracking.success()) {
+                tracker = std::move(tracking.value());
+                auto newRoot = json_options.value("new_root", tracker->getRoot());
+                sendFiles(tracker->getRoot(), tracker->getFiles(), newRoot, "precopy");
+            } else {
+                warn("Migrating target at once: {}", tracking.error());
+            }
+        }
+
         // get a MigrationHandle
         bool remove_source = json_options.value("remove_source", true);
         auto startMigration = m_target->startMigration(remove_source);
         migrationHandle = std::move(startMigration.valueOrThrow());
-
-        // create REMI fileset
-        remi_fileset_t fileset = REMI_FILESET_NULL;
-        rret = remi_fileset_create("warabi", migrationHandle->getRoot().c_str(), &fileset);
-        HANDLE_REMI_ERROR(remi_fileset_create, rret, "Failed to create REMI fileset");
-        DEFER(remi_fileset_free(fileset));
-
-        // set its destination provider
-        remi_fileset_set_provider_id(fileset, dest_provider_id);
-
-        // fill REMI fileset
-        for(const auto& file : migrationHandle->getFiles()) {
-            if(!file.empty() && file.back() == '/') {
-                rret = remi_fileset_register_directory(fileset, file.c_str());
-                HANDLE_REMI_ERROR(remi_fileset_register_directory, rret,
-                        "Failed to register directory {} in REMI fileset", file);
-            } else {
-                rret = remi_fileset_register_file(fileset, file.c_str());
-                HANDLE_REMI_ERROR(remi_fileset_register_file, rret,
-                        "Failed to register file {} in REMI fileset", file);
+        auto newRoot = json_options.value("new_root", migrationHandle->getRoot());
+
+        if(tracker) {
+            // then only sends the extents modified in the meantime
+            auto root = migrationHandle->getRoot();
+            auto dirty = tracker->takeDirty();
+            tracker.reset();
+            std::string delta = (root.empty() ? std::string{"."} : root) + "/warabi-delta-XXXXXX";
+            int fd = mkstemp(delta.data());
+            if(fd < 0) {
+                migrationHandle->cancel();
+                throw Exception{fmt::format("Could not create delta file: {}", strerror(errno))};
+            }
+            ::close(fd);
+            DEFER(::unlink(delta.c_str()));
+            auto written = writeMigrationDelta(delta, root, dirty);
+            if(!written.success()) {
+                migrationHandle->cancel();
+                throw Exception{written.error()};
             }
+            auto deltaName = delta.substr(delta.find_last_of('/') + 1);
+            size_t bytes = 0;
+            for(auto& file : dirty)
+                for(auto& extent : file.extents) bytes += extent.second;
+            debug("Sending {} bytes modified during the first phase of the migration", bytes);
+            sendFiles(root.empty() ? std::string{"."} : root, {deltaName}, newRoot, "delta");
+        } else {
+            sendFiles(migrationHandle->getRoot(), migrationHandle->getFiles(), newRoot, "");
         }
 
+        migrationHandle.reset(); // this will cause the target to be destroyed
+        m_target.reset();        // we still need to make it unavailable
+        #undef HANDLE_REMI_ERROR
+#endif
+    }
+
+    /**
+     * @brief Send the files of the target to the destination provider
+     * through the "rpc" transport: the files are created in the
+     * destination, then their extents are sent in chunks of
+     * transfer_size bytes by a number of streams, each of which
+     * exposes a chunk to the destination and waits for it to be
+     * written before sending the next one.
+     */
+    void streamTarget(const tl::provider_handle& dest_provider,
+                      const json& json_options,
+                      AsyncMigrationImpl& progress) {
+        StreamOptions stream_options;
+        stream_options.streams = json_options.value("streams", (size_t)1);
+        stream_options.chunk_size = json_options.value("transfer_size", (size_t)0);
+        if(stream_options.chunk_size == 0) stream_options.chunk_size = s_transfer_chunk;
+        stream_options.sparse = json_options.value("compression", std::string{"none"}) == "sparse";
+        stream::Throttle throttle{json_options.value("max_bandwidth", (size_t)0)};
+
         // get the config to send to by merging the target config with the merge config
         auto target_config = json::parse(m_target->getConfig());
         target_config.update(json_options.value("merge_config", json::object()), true);
 
-        // register REMI metadata
-        rret = remi_fileset_register_metadata(fileset, "config", target_config.dump().c_str());
-        HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
-        rret = remi_fileset_register_metadata(fileset, "type", m_target->name().c_str());
-        HANDLE_REMI_ERROR(remi_fileset_register_metadata, rret, "Failed to register metadata in REMI fileset");
+        std::unique_ptr<MigrationHandle> migrationHandle;
+        uint64_t migration_id = 0;
+        auto abort = [&](const std::string& message) {
+            if(migration_id) {
+                try {
+                    Result<bool> closed = m_migration_close.on(dest_provider)(migration_id, false);
+                    (void)closed;
+                } catch(...) {}
+            }
+            if(migrationHandle) migrationHandle->cancel();
+            throw Exception{message};
+        };
+
+        // an incremental migration first sends the files while the target
+        // keeps serving requests, tracking the extents they modify
+        std::unique_ptr<DirtyTracker> tracker;
+        if(json_options.value("incremental", false)) {
+            auto tracking = m_target->trackChanges();
+            if(tracking.success())
+                tracker = std::move(tracking.value());
+            else
+                warn("Migrating target at once: {}", tracking.error());
+        }
+        bool remove_source = json_options.value("remove_source", true);
+        if(!tracker) {
+            auto startMigration = m_target->startMigration(remove_source);
+            migrationHandle = std::move(startMigration.valueOrThrow());
+        }
+        auto root = tracker ? tracker->getRoot() : migrationHandle->getRoot();
+        auto listed = stream::listFiles(root, tracker ? tracker->getFiles() : migrationHandle->getFiles());
+        if(!listed.success()) abort(listed.error());
+        auto files = std::move(listed.value());
+
+        std::vector<std::string> names;
+        std::vector<size_t>      sizes;
+        for(auto& file : files) {
+            names.push_back(file.file);
+            sizes.push_back(file.size);
+            progress.m_total += file.size;
+        }
+        try {
+            Result<uint64_t> opened = m_migration_open.on(dest_provider)(
+                m_target->name(), target_config.dump(),
+                json_options.value("new_root", root), names);
+            migration_id = opened.valueOrThrow();
+        } catch(const std::exception& ex) {
+            abort(ex.what());
+        }
 
-        // set block transfer size
-        if(json_options.contains("transfer_size")) {
-            rret = remi_fileset_set_xfer_size(fileset, json_options["transfer_size"].get<size_t>());
-            HANDLE_REMI_ERROR(remi_fileset_set_xfer_size, rret, "Failed to set transfer size for REMI fileset");
+        auto send = [&](const std::vector<FileExtents>& extents) {
+            try {
+                Result<bool> resized = m_migration_resize.on(dest_provider)(migration_id, sizes);
+                resized.check();
+            } catch(const std::exception& ex) {
+                abort(ex.what());
+            }
+            auto sent = streamExtents(dest_provider, migration_id, root, names, extents,
+                                      stream_options, throttle, progress);
+            if(!sent.success()) abort(sent.error());
+        };
+        send(files);
+
+        if(tracker) {
+            // then lock the target and send the extents modified in the meantime
+            if(progress.m_cancelled) abort("Migration was cancelled");
+            auto startMigration = m_target->startMigration(remove_source);
+            if(!startMigration.success()) abort(startMigration.error());
+            migrationHandle = std::move(startMigration.value());
+            auto dirty = tracker->takeDirty();
+            tracker.reset();
+            for(auto& file : dirty) {
+                auto it = std::find(names.begin(), names.end(), file.file);
+                if(it == names.end()) abort(fmt::format("File {} was not part of the migration", file.file));
+                sizes[it - names.begin()] = file.size;
+                for(auto& extent : file.extents) progress.m_total += extent.second;
+            }
+            debug("Sending {} bytes modified during the first phase of the migration",
+                  progress.m_total - progress.m_transferred);
+            send(dirty);
         }
 
-        // issue migration RPC
-        auto newRoot     = json_options.value("new_root", migrationHandle->getRoot());
-        auto keep_source = json_options.value("keep_source", false) ? REMI_REMOVE_SOURCE : REMI_KEEP_SOURCE;
-        int remi_status = 0;
-        rret = remi_fileset_migrate(remi_ph, fileset, newRoot.c_str(),
-                                    keep_source, REMI_USE_MMAP, &remi_status);
-        HANDLE_REMI_ERROR(remi_fileset_migrate, rret, "REMI failed to migrate fileset");
+        if(progress.m_cancelled) abort("Migration was cancelled");
+        try {
+            Result<bool> closed = m_migration_close.on(dest_provider)(migration_id, true);
+            migration_id = 0; // the destination dropped the migration either way
+            closed.check();
+        } catch(const std::exception& ex) {
+            abort(ex.what());
+        }
 
         migrationHandle.reset(); // this will cause the target to be destroyed
         m_target.reset();        // we still need to make it unavailable
-#endif
+    }
+
+    struct StreamOptions {
+        size_t streams    = 1;
+        size_t chunk_size = s_transfer_chunk;
+        bool   sparse     = false;
+    };
+
+    Result<bool> streamExtents(const tl::provider_handle& dest_provider,
+                               uint64_t migration_id,
+                               const std::string& root,
+                               const std::vector<std::string>& names,
+                               const std::vector<FileExtents>& files,
+                               const StreamOptions& options,
+                               stream::Throttle& throttle,
+                               AsyncMigrationImpl& progress) {
+        Result<bool> result;
+        tl::mutex    result_mtx;
+        auto fail = [&](const std::string& message) {
+            std::lock_guard<tl::mutex> lock{result_mtx};
+            if(!result.success()) return;
+            result.success() = false;
+            result.error() = message;
+        };
+
+        struct Chunk {
+            size_t   source; // index in files
+            uint64_t file;   // index in the files of the destination
+            size_t   offset;
+            size_t   size;
+        };
+        std::vector<Chunk> chunks;
+        std::vector<int>   fds(files.size(), -1);
+        DEFER(for(auto fd : fds) if(fd >= 0) ::close(fd));
+        for(size_t i = 0; i < files.size(); ++i) {
+            if(files[i].extents.empty()) continue;
+            uint64_t index = std::find(names.begin(), names.end(), files[i].file) - names.begin();
+            for(auto& extent : files[i].extents) {
+                auto end = extent.first + extent.second;
+                for(size_t offset = extent.first; offset < end; offset += options.chunk_size)
+                    chunks.push_back(Chunk{i, index, offset, std::min(options.chunk_size, end - offset)});
+            }
+            auto path = root.empty() ? files[i].file : root + "/" + files[i].file;
+            fds[i] = ::open(path.c_str(), O_RDONLY);
+            if(fds[i] < 0) {
+                fail(fmt::format("Could not open {}: {}", path, strerror(errno)));
+                return result;
+            }
+        }
+
+        std::atomic<size_t> next{0};
+        auto run = [&]() {
+            std::vector<char>     buffer;
+            std::vector<uint64_t> mask;
+            while(true) {
+                auto c = next++;
+                if(c >= chunks.size()) break;
+                {
+                    std::lock_guard<tl::mutex> lock{result_mtx};
+                    if(!result.success()) break;
+                }
+                if(progress.m_cancelled) {
+                    fail("Migration was cancelled");
+                    break;
+                }
+                auto& chunk = chunks[c];
+                buffer.resize(chunk.size);
+                int err = stream::preadAll(fds[chunk.source], buffer.data(), chunk.size, chunk.offset);
+                if(err) {
+                    fail(fmt::format("Could not read {}: {}", files[chunk.source].file, strerror(err)));
+                    break;
+                }
+                size_t wire = chunk.size;
+                mask.clear();
+                if(options.sparse) wire = stream::compressSparse(buffer.data(), chunk.size, mask);
+                throttle.acquire(m_engine, wire);
+                try {
+                    tl::bulk bulk;
+                    if(wire) bulk = m_engine.expose({{buffer.data(), wire}}, tl::bulk_mode::read_only);
+                    Result<bool> written = m_migration_write.on(dest_provider)(
+                        migration_id, chunk.file, chunk.offset, chunk.size, mask, bulk, wire);
+                    if(!written.success()) {
+                        fail(written.error());
+                        break;
+                    }
+                } catch(const std::exception& ex) {
+                    fail(ex.what());
+                    break;
+                }
+                progress.m_transferred += chunk.size;
+                progress.m_sent += wire;
+            }
+        };
+        std::vector<tl::managed<tl::thread>> streams;
+        for(size_t i = 1; i < std::min(options.streams, chunks.size()); ++i)
+            streams.push_back(m_pool.make_thread(run));
+        run();
+        for(auto& t : streams) t->join();
+        return result;
+    }
+
+    /**
+     * @brief Return the target being received through the "rpc"
+     * transport, if its migration has the given id.
+     */
+    std::shared_ptr<stream::IncomingTarget> incomingTarget(uint64_t migration_id) {
+        std::lock_guard<tl::mutex> lock{m_incoming_mtx};
+        if(!m_incoming || m_incoming->id != migration_id) return nullptr;
+        return m_incoming;
+    }
+
+    void migrationOpenRPC(const tl::request& req,
+                          const std::string& type,
+                          const std::string& config,
+                          const std::string& root,
+                          const std::vector<std::string>& files) {
+        event("Received migration_open request for {} files", files.size());
+        Result<uint64_t> result;
+        tl::auto_respond<decltype(result)> response{req, result};
+        if(m_target) {
+            result.success() = false;
+            result.error() = "Cannot accept migration: target already attached to provider";
+            return;
+        }
+        json config_json;
+        try {
+            config_json = json::parse(config);
+        } catch(const std::exception& ex) {
+            result.success() = false;
+            result.error() = fmt::format("Cannot accept migration: {}", ex.what());
+            return;
+        }
+        auto validation = TargetFactory::validateConfig(type, config_json);
+        if(!validation.success()) {
+            result.success() = false;
+            result.error() = validation.error();
+            return;
+        }
+        auto incoming = std::make_shared<stream::IncomingTarget>();
+        incoming->type = type;
+        incoming->config = config;
+        auto opened = incoming->open(root, files);
+        if(!opened.success()) {
+            incoming->finish(false);
+            result.success() = false;
+            result.error() = opened.error();
+            return;
+        }
+        std::lock_guard<tl::mutex> lock{m_incoming_mtx};
+        if(m_incoming) {
+            // the source of that migration went away or gave up
+            warn("Dropping a migration that did not complete");
+            m_incoming->finish(false);
+        }
+        incoming->id = ++m_incoming_id;
+        result.value() = incoming->id;
+        m_incoming = std::move(incoming);
+    }
+
+    void migrationResizeRPC(const tl::request& req,
+                            uint64_t migration_id,
+                            const std::vector<size_t>& sizes) {
+        Result<bool> result;
+        tl::auto_respond<decltype(result)> response{req, result};
+        auto incoming = incomingTarget(migration_id);
+        if(!incoming) {
+            result.success() = false;
+            result.error() = "No migration with this id in progress";
+            return;
+        }
+        if(sizes.size() != incoming->fds.size()) {
+            result.success() = false;
+            result.error() = "Invalid number of files in migration";
+            return;
+        }
+        for(size_t i = 0; i < sizes.size(); ++i) {
+            if(::ftruncate(incoming->fds[i], sizes[i]) < 0) {
+                result.success() = false;
+                result.error() = fmt::format("Could not resize {}: {}",
+                                             incoming->files[i], strerror(errno));
+                return;
+            }
+            incoming->sizes[i] = sizes[i];
+        }
+    }
+
+    void migrationWriteRPC(const tl::request& req,
+                           uint64_t migration_id,
+                           uint64_t file,
+                           size_t offset,
+                           size_t size,
+                           const std::vector<uint64_t>& mask,
+                           tl::bulk bulk,
+                           size_t bulk_size) {
+        Result<bool> result;
+        tl::auto_respond<decltype(result)> response{req, result};
+        auto incoming = incomingTarget(migration_id);
+        if(!incoming) {
+            result.success() = false;
+            result.error() = "No migration with this id in progress";
+            return;
+        }
+        // chunks must fit in the files as last resized by the source
+        if(file >= incoming->fds.size() || bulk_size > size
+        || offset > incoming->sizes[file] || size > incoming->sizes[file] - offset
+        || (mask.empty() && bulk_size != size)) {
+            result.success() = false;
+            result.error() = "Invalid chunk in migration";
+            return;
+        }
+        std::vector<char> buffer(bulk_size);
+        try {
+            if(bulk_size) {
+                auto local = m_engine.expose({{buffer.data(), bulk_size}}, tl::bulk_mode::write_only);
+                local << bulk.on(req.get_endpoint());
+            }
+        } catch(const std::exception& ex) {
+            result.success() = false;
+            result.error() = fmt::format("Could not pull chunk of migration: {}", ex.what());
+            return;
+        }
+        int err = stream::writeChunk(incoming->fds[file], buffer.data(), bulk_size,
+                                     size, offset, mask);
+        if(err) {
+            result.success() = false;
+            result.error() = fmt::format("Could not write {}: {}", incoming->files[file], strerror(err));
+        }
+    }
+
+    void migrationCloseRPC(const tl::request& req,
+                           uint64_t migration_id,
+                           bool commit) {
+        event("Received migration_close request");
+        Result<bool> result;
+        tl::auto_respond<decltype(result)> response{req, result};
+        std::shared_ptr<stream::IncomingTarget> incoming;
+        {
+            std::lock_guard<tl::mutex> lock{m_incoming_mtx};
+            if(m_incoming && m_incoming->id == migration_id)
+                incoming = std::move(m_incoming);
+        }
+        if(!incoming) {
+            result.success() = false;
+            result.error() = "No migration with this id in progress";
+            return;
+        }
+        result = incoming->finish(commit && !m_target);
+        if(!commit || !result.success()) return;
+        if(m_target) {
+            result.success() = false;
+            result.error() = "Cannot accept migration: target already attached to provider";
+            return;
+        }
+        auto target = TargetFactory::recoverTarget(
+            incoming->type, m_engine, json::parse(incoming->config), incoming->files);
+        if(!target.success()) {
+            result.success() = false;
+            result.error() = target.error();
+            return;
+        }
+        m_target = std::move(target.value());
     }
 
 #ifdef WARABI_HAS_REMI
@@ -653,6 +2387,20 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
         return provider->beforeMigrationCallback(fileset);
     }
 
+    static std::string migrationPhase(remi_fileset_t fileset) {
+        const char* phase = nullptr;
+        if(remi_fileset_get_metadata(fileset, "phase", &phase) != REMI_SUCCESS || !phase)
+            return "";
+        return phase;
+    }
+
+    static std::string migrationId(remi_fileset_t fileset) {
+        const char* id = nullptr;
+        if(remi_fileset_get_metadata(fileset, "migration_id", &id) != REMI_SUCCESS || !id)
+            return "";
+        return id;
+    }
+
     int32_t beforeMigrationCallback(remi_fileset_t fileset) {
 
         const char* type = nullptr;
@@ -672,6 +2420,14 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
             error("Cannot accept migration: target already attached to provider");
             return 2;
         }
+        if(migrationPhase(fileset) == "delta") {
+            std::lock_guard<tl::mutex> lock{m_pending_mtx};
+            if(!m_pending_migrations.count(migrationId(fileset))) {
+                error("Cannot accept migration delta: no target was received before it");
+                return 8;
+            }
+            return 0;
+        }
         auto validation = TargetFactory::validateConfig(type, config_json);
         if(!validation.success()) {
             error(validation.error());
@@ -721,6 +2477,34 @@ class ProviderImpl : public tl::provider<ProviderImpl> {
             filename = root_str + filename;
         }
 
+        auto phase = migrationPhase(fileset);
+        if(phase == "precopy") {
+            // wait for the delta before opening the target
+            std::lock_guard<tl::mutex> lock{m_pending_mtx};
+            m_pending_migrations.insert_or_assign(migrationId(fileset),
+                PendingMigration{type, std::move(config_json), root_str, std::move(files)});
+            return 0;
+        }
+        if(phase == "delta") {
+            PendingMigration pending;
+            {
+                std::lock_guard<tl::mutex> lock{m_pending_mtx};
+                auto it = m_pending_migrations.find(migrationId(fileset));
+                if(it == m_pending_migrations.end()) return 8;
+                pending = std::move(it->second);
+                m_pending_migrations.erase(it);
+            }
+            for(auto& delta : files) {
+                auto applied = applyMigrationDelta(delta, pending.root, pending.files);
+                std::remove(delta.c_str());
+                if(!applied.success()) {
+                    error("{}", applied.error());
+                    return 9;
+                }
+            }
+            files = std::move(pending.files);
+        }
+
         auto target = TargetFactory::recoverTarget(type, m_engine, config_json, files);
         if(!target.success()) {
             error("{}", target.error());
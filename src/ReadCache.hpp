@@ -0,0 +1,219 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_READ_CACHE_IMPL_HPP
+#define __WARABI_READ_CACHE_IMPL_HPP
+
+#include "warabi/ReadCache.hpp"
+#include "warabi/RegionID.hpp"
+#include <thallium.hpp>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief LRU cache of byte ranges of regions, shared by the TargetHandles
+ * of a client. Each range is stored with the version of its region (see
+ * RegionVersions in the provider) at the time it was read. A range is
+ * served without contacting the provider during the lease that follows
+ * its last validation; after that, its version must be validated with
+ * a warabi_get_versions RPC before it is served again.
+ *
+ * Ranges are identified by the name of their target (address and provider
+ * id) and their region. The cache is disabled when its capacity is 0.
+ */
+class ReadCache {
+
+    public:
+
+    using Clock = std::chrono::steady_clock;
+    using Data  = std::shared_ptr<const std::vector<char>>;
+
+    /**
+     * @brief Result of a lookup. data is null if no cached range covers
+     * the requested one. fresh indicates that the range is within its
+     * lease and can be served without validation.
+     */
+    struct Lookup {
+        Data     data;
+        size_t   offset  = 0; // offset of the requested range in data
+        uint64_t version = 0;
+        bool     fresh   = false;
+    };
+
+    private:
+
+    struct Entry {
+        std::string       key;
+        size_t            offset;
+        Data              data;
+        uint64_t          version;
+        Clock::time_point validated;
+    };
+
+    using Iterator = std::list<Entry>::iterator;
+
+    mutable tl::mutex                                    m_mtx;
+    std::list<Entry>                                     m_lru; // most recent first
+    std::unordered_map<std::string, std::vector<Iterator>> m_index;
+    std::atomic<size_t>                                  m_capacity{0};
+    size_t                                               m_max_entry_size = 0;
+    Clock::duration                                      m_lease{0};
+    ReadCacheStats                                       m_stats;
+
+    static std::string makeKey(const std::string& target, const RegionID& region) {
+        std::string key = target;
+        key.append(reinterpret_cast<const char*>(region.data()), region.size());
+        return key;
+    }
+
+    void remove(Iterator it) {
+        auto& ranges = m_index[it->key];
+        for(auto& r : ranges) {
+            if(r != it) continue;
+            r = ranges.back();
+            ranges.pop_back();
+            break;
+        }
+        if(ranges.empty()) m_index.erase(it->key);
+        m_stats.bytes -= it->data->size();
+        m_stats.entries -= 1;
+        m_lru.erase(it);
+    }
+
+    void evict(size_t capacity) {
+        while(m_stats.bytes > capacity && !m_lru.empty()) {
+            remove(std::prev(m_lru.end()));
+            m_stats.evictions += 1;
+        }
+    }
+
+    public:
+
+    bool enabled() const {
+        return m_capacity.load(std::memory_order_relaxed) != 0;
+    }
+
+    void configure(const ReadCacheOptions& options) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        m_max_entry_size = options.maxEntrySize;
+        m_lease = std::chrono::milliseconds(options.leaseMs);
+        m_capacity.store(options.capacity, std::memory_order_relaxed);
+        evict(options.capacity);
+    }
+
+    ReadCacheStats stats() const {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        return m_stats;
+    }
+
+    size_t maxEntrySize() const {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        return m_max_entry_size;
+    }
+
+    Lookup lookup(const std::string& target, const RegionID& region,
+                  size_t offset, size_t size) {
+        Lookup result;
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        auto it = m_index.find(makeKey(target, region));
+        if(it != m_index.end()) {
+            for(auto& entry : it->second) {
+                if(entry->offset > offset
+                || entry->offset + entry->data->size() < offset + size)
+                    continue;
+                m_lru.splice(m_lru.begin(), m_lru, entry);
+                result.data    = entry->data;
+                result.offset  = offset - entry->offset;
+                result.version = entry->version;
+                result.fresh   = Clock::now() - entry->validated < m_lease;
+                if(result.fresh) m_stats.hits += 1;
+                return result;
+            }
+        }
+        m_stats.misses += 1;
+        return result;
+    }
+
+    /**
+     * @brief Record that the ranges of the region still have the
+     * specified version, starting a new lease for them.
+     */
+    void validated(const std::string& target, const RegionID& region, uint64_t version) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        m_stats.validatedHits += 1;
+        auto it = m_index.find(makeKey(target, region));
+        if(it == m_index.end()) return;
+        auto now = Clock::now();
+        for(auto& entry : it->second)
+            if(entry->version == version) entry->validated = now;
+    }
+
+    /**
+     * @brief Drop all the cached ranges of a region.
+     * If miss is true, the read that triggered the invalidation
+     * is counted as a miss.
+     */
+    void invalidate(const std::string& target, const RegionID& region, bool miss = false) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(miss) m_stats.misses += 1;
+        auto it = m_index.find(makeKey(target, region));
+        if(it == m_index.end()) return;
+        auto ranges = it->second;
+        for(auto& entry : ranges) {
+            remove(entry);
+            m_stats.invalidations += 1;
+        }
+    }
+
+    /**
+     * @brief Cache a range read with the specified version
+     * (nothing is cached if the version is 0).
+     */
+    void insert(const std::string& target, const RegionID& region,
+                size_t offset, const char* data, size_t size, uint64_t version) {
+        if(version == 0 || size == 0) return;
+        auto copy = std::make_shared<const std::vector<char>>(data, data + size);
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        auto capacity = m_capacity.load(std::memory_order_relaxed);
+        if(size > m_max_entry_size || size > capacity) return;
+        auto key = makeKey(target, region);
+        auto& ranges = m_index[key];
+        // drop the ranges of the region that the new one covers
+        // or that are from another version
+        for(size_t i = 0; i < ranges.size();) {
+            auto entry = ranges[i];
+            bool covered = entry->offset >= offset
+                        && entry->offset + entry->data->size() <= offset + size;
+            if(covered || entry->version != version) {
+                ranges[i] = ranges.back();
+                ranges.pop_back();
+                m_stats.bytes -= entry->data->size();
+                m_stats.entries -= 1;
+                m_lru.erase(entry);
+            } else {
+                ++i;
+            }
+        }
+        m_lru.push_front(Entry{key, offset, std::move(copy), version, Clock::now()});
+        ranges.push_back(m_lru.begin());
+        m_stats.bytes += size;
+        m_stats.entries += 1;
+        evict(capacity);
+    }
+};
+
+}
+
+#endif
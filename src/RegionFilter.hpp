@@ -0,0 +1,53 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REGION_FILTER_HPP
+#define __WARABI_REGION_FILTER_HPP
+
+#include "warabi/RegionID.hpp"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+namespace warabi {
+
+/**
+ * @brief Counting filter over RegionIDs, used to skip the lookup of a
+ * region in a map protected by a lock when the map has no entry for it.
+ * mayContain() never returns false for a region in the map, and returns
+ * true for other regions only if they share a slot with one that is.
+ * add() and remove() are called with the lock of the map held.
+ */
+template<size_t Slots>
+class RegionFilter {
+
+    std::array<std::atomic<uint32_t>, Slots> m_slots = {};
+
+    static size_t slot(const RegionID& region) {
+        uint64_t h[2];
+        std::memcpy(h, region.data(), sizeof(h));
+        uint64_t key = h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull);
+        return (key ^ (key >> 29)) % Slots;
+    }
+
+    public:
+
+    void add(const RegionID& region) {
+        m_slots[slot(region)].fetch_add(1, std::memory_order_release);
+    }
+
+    void remove(const RegionID& region) {
+        m_slots[slot(region)].fetch_sub(1, std::memory_order_release);
+    }
+
+    bool mayContain(const RegionID& region) const {
+        return m_slots[slot(region)].load(std::memory_order_acquire) != 0;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REGION_LOCKS_HPP
+#define __WARABI_REGION_LOCKS_HPP
+
+#include "warabi/RegionID.hpp"
+#include <thallium.hpp>
+#include <array>
+#include <cstring>
+#include <utility>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Locks protecting the storage of regions against operations
+ * that move or free it. The region objects handed out by a backend
+ * hold the lock of their region shared, and resizing or erasing a
+ * region takes it exclusively. A region is mapped to one of a fixed
+ * number of locks by its RegionID, so these locks must be taken after
+ * the migration lock of the backend, and a ULT holding a region object
+ * must not resize or erase another region.
+ */
+class RegionLocks {
+
+    std::array<tl::rwlock, 64> m_locks;
+
+    public:
+
+    tl::rwlock& get(const RegionID& region) {
+        uint64_t h[2];
+        std::memcpy(h, region.data(), sizeof(h));
+        uint64_t key = h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull);
+        return m_locks[(key ^ (key >> 29)) % m_locks.size()];
+    }
+
+    /**
+     * @brief Holds the locks of two regions (e.g. the source and the
+     * destination of a copy) shared. The locks are taken in a fixed
+     * order, and once if both regions map to the same lock, so that
+     * such operations cannot deadlock with each other or with a
+     * resize waiting for one of the locks.
+     */
+    class SharedPair {
+
+        tl::rwlock* m_first;
+        tl::rwlock* m_second;
+
+        public:
+
+        SharedPair(RegionLocks& locks, const RegionID& a, const RegionID& b)
+        : m_first(&locks.get(a))
+        , m_second(&locks.get(b)) {
+            if(m_second < m_first) std::swap(m_first, m_second);
+            m_first->rdlock();
+            if(m_second != m_first) m_second->rdlock();
+        }
+
+        ~SharedPair() {
+            if(m_second != m_first) m_second->unlock();
+            m_first->unlock();
+        }
+
+        SharedPair(const SharedPair&) = delete;
+        SharedPair& operator=(const SharedPair&) = delete;
+    };
+};
+
+}
+
+#endif
@@ -0,0 +1,325 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REGION_MIGRATIONS_HPP
+#define __WARABI_REGION_MIGRATIONS_HPP
+
+#include "warabi/RegionID.hpp"
+#include "warabi/Layout.hpp"
+#include "RegionFilter.hpp"
+#include <thallium.hpp>
+#include <thallium/serialization/stl/string.hpp>
+#include <thallium/serialization/stl/array.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Location of a region that was migrated to another provider.
+ */
+struct RegionForward {
+
+    std::string address;
+    uint16_t    provider_id = 0;
+    RegionID    region;
+
+    template<typename Archive>
+    void serialize(Archive& a) {
+        a & address;
+        a & provider_id;
+        a & region;
+    }
+};
+
+/**
+ * @brief Regions of a provider that are being migrated to another
+ * provider while they keep being written, and regions that were migrated.
+ *
+ * While a region is copied, the extents written by the requests are
+ * recorded, so that the migration then only resends them. The final
+ * round is done with the region frozen: new writes wait for the
+ * switchover, after which they find the region forwarded to its new
+ * location. Requests that move or free a region (resize, erase) take
+ * an ExclusiveAccess instead: they are refused while the region is
+ * migrating, and a migration only starts once they complete. Forwards are kept in memory for the lifetime of the provider;
+ * requests for the other regions skip the lock thanks to a RegionFilter.
+ */
+class RegionMigrations {
+
+    public:
+
+    using Extents = std::vector<std::pair<size_t, size_t>>;
+
+    // size of the extent marking a whole region as dirty
+    static constexpr size_t s_whole = std::numeric_limits<size_t>::max();
+
+    private:
+
+    struct Hash {
+        size_t operator()(const RegionID& region) const {
+            uint64_t h[2];
+            std::memcpy(h, region.data(), sizeof(h));
+            return h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    struct Entry {
+        bool     frozen  = false;
+        uint32_t writers = 0;
+        Extents  dirty;
+    };
+
+    tl::mutex                                          m_mtx;
+    tl::condition_variable                             m_cv;
+    std::unordered_map<RegionID, Entry, Hash>          m_migrating;
+    std::unordered_map<RegionID, RegionForward, Hash>  m_forwards;
+    std::unordered_map<RegionID, uint32_t, Hash>       m_exclusive; // ExclusiveAccess holders
+    // regions in either map, so requests for other regions skip the lock
+    RegionFilter<1024>                                 m_filter;
+
+    public:
+
+    /**
+     * @brief Access of a write request to a region. If the region is
+     * being migrated, the access records the extent written when the
+     * request completes (or waits for the switchover if the region is
+     * frozen). If the region was migrated, forwarded() returns true and
+     * the request must fail.
+     */
+    class WriteAccess {
+
+        RegionMigrations*         m_owner = nullptr;
+        RegionID                  m_region;
+        std::pair<size_t, size_t> m_extent;
+        bool                      m_forwarded = false;
+
+        public:
+
+        /**
+         * @param layout Data written, or nullptr if the request may
+         * write anywhere in the region.
+         */
+        WriteAccess(RegionMigrations& owner, const RegionID& region, const Layout* layout) {
+            if(!owner.m_filter.mayContain(region)) return;
+            std::unique_lock<tl::mutex> lock{owner.m_mtx};
+            while(true) {
+                if(owner.m_forwards.count(region)) {
+                    m_forwarded = true;
+                    return;
+                }
+                auto it = owner.m_migrating.find(region);
+                if(it == owner.m_migrating.end()) return;
+                if(it->second.frozen) {
+                    owner.m_cv.wait(lock);
+                    continue;
+                }
+                it->second.writers += 1;
+                m_extent = layout ? extentOf(*layout) : std::make_pair((size_t)0, s_whole);
+                m_owner = &owner;
+                m_region = region;
+                return;
+            }
+        }
+
+        ~WriteAccess() {
+            if(!m_owner) return;
+            std::lock_guard<tl::mutex> lock{m_owner->m_mtx};
+            auto it = m_owner->m_migrating.find(m_region);
+            if(it == m_owner->m_migrating.end()) return;
+            // recorded once written, so the data is sent in a later round
+            it->second.dirty.push_back(m_extent);
+            if(--it->second.writers == 0) m_owner->m_cv.notify_all();
+        }
+
+        bool forwarded() const {
+            return m_forwarded;
+        }
+
+        WriteAccess(const WriteAccess&) = delete;
+        WriteAccess& operator=(const WriteAccess&) = delete;
+    };
+
+    /**
+     * @brief Access of a request that moves or frees a region (resize,
+     * erase). The request must fail if forwarded() or migrating()
+     * returns true; otherwise migrations of the region wait for the
+     * access to be released before they start.
+     */
+    class ExclusiveAccess {
+
+        RegionMigrations* m_owner = nullptr;
+        RegionID          m_region;
+        bool              m_forwarded = false;
+        bool              m_migrating = false;
+
+        public:
+
+        ExclusiveAccess(RegionMigrations& owner, const RegionID& region) {
+            // taken even if the filter does not contain the region,
+            // since a migration may start right after the check
+            std::lock_guard<tl::mutex> lock{owner.m_mtx};
+            if(owner.m_forwards.count(region)) {
+                m_forwarded = true;
+                return;
+            }
+            if(owner.m_migrating.count(region)) {
+                m_migrating = true;
+                return;
+            }
+            owner.m_exclusive[region] += 1;
+            m_owner = &owner;
+            m_region = region;
+        }
+
+        ~ExclusiveAccess() {
+            if(!m_owner) return;
+            std::lock_guard<tl::mutex> lock{m_owner->m_mtx};
+            auto it = m_owner->m_exclusive.find(m_region);
+            if(--it->second != 0) return;
+            m_owner->m_exclusive.erase(it);
+            m_owner->m_cv.notify_all();
+        }
+
+        bool forwarded() const {
+            return m_forwarded;
+        }
+
+        bool migrating() const {
+            return m_migrating;
+        }
+
+        ExclusiveAccess(const ExclusiveAccess&) = delete;
+        ExclusiveAccess& operator=(const ExclusiveAccess&) = delete;
+    };
+
+    /**
+     * @brief Smallest extent covering all the segments of a layout.
+     */
+    static std::pair<size_t, size_t> extentOf(const Layout& layout) {
+        size_t begin = s_whole, end = 0;
+        layout.forEach([&](size_t offset, size_t size) {
+            begin = std::min(begin, offset);
+            end = std::max(end, offset + size);
+        });
+        if(begin >= end) return {0, 0};
+        return {begin, end - begin};
+    }
+
+    /**
+     * @brief Whether a region was migrated, and where to.
+     */
+    bool forwarded(const RegionID& region, RegionForward* forward = nullptr) {
+        if(!m_filter.mayContain(region)) return false;
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        auto it = m_forwards.find(region);
+        if(it == m_forwards.end()) return false;
+        if(forward) *forward = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Whether a region is being migrated.
+     */
+    bool migrating(const RegionID& region) {
+        if(!m_filter.mayContain(region)) return false;
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        return m_migrating.count(region) != 0;
+    }
+
+    /**
+     * @brief Start tracking the writes to a region, once the resizes and
+     * erasures in progress on it complete. Returns false if the region
+     * is already being migrated or was migrated.
+     */
+    bool start(const RegionID& region) {
+        std::unique_lock<tl::mutex> lock{m_mtx};
+        while(m_exclusive.count(region)) m_cv.wait(lock);
+        if(m_migrating.count(region) || m_forwards.count(region)) return false;
+        m_migrating.emplace(region, Entry{});
+        m_filter.add(region);
+        return true;
+    }
+
+    /**
+     * @brief Return the extents written since the previous call (or since
+     * start()), merged and clamped to size bytes, and forget them.
+     */
+    Extents takeDirty(const RegionID& region, size_t size) {
+        Extents dirty;
+        {
+            std::lock_guard<tl::mutex> lock{m_mtx};
+            auto it = m_migrating.find(region);
+            if(it == m_migrating.end()) return dirty;
+            dirty.swap(it->second.dirty);
+        }
+        Extents merged;
+        for(auto& e : dirty) {
+            if(e.first >= size) continue;
+            e.second = std::min(e.second, size - e.first);
+            if(e.second) merged.push_back(e);
+        }
+        std::sort(merged.begin(), merged.end());
+        size_t n = 0;
+        for(size_t i = 0; i < merged.size(); ++i) {
+            if(n && merged[n-1].first + merged[n-1].second >= merged[i].first) {
+                auto end = std::max(merged[n-1].first + merged[n-1].second,
+                                    merged[i].first + merged[i].second);
+                merged[n-1].second = end - merged[n-1].first;
+            } else {
+                merged[n++] = merged[i];
+            }
+        }
+        merged.resize(n);
+        return merged;
+    }
+
+    /**
+     * @brief Make new writes to the region wait, and wait for the
+     * writes in progress to complete.
+     */
+    void freeze(const RegionID& region) {
+        std::unique_lock<tl::mutex> lock{m_mtx};
+        auto it = m_migrating.find(region);
+        if(it == m_migrating.end()) return;
+        it->second.frozen = true;
+        while(it->second.writers != 0) {
+            m_cv.wait(lock);
+            it = m_migrating.find(region);
+        }
+    }
+
+    /**
+     * @brief Complete the migration of a region: requests that were
+     * waiting for it, and subsequent ones, find it forwarded.
+     */
+    void forward(const RegionID& region, RegionForward forward) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(m_migrating.erase(region)) m_filter.remove(region);
+        if(m_forwards.emplace(region, std::move(forward)).second)
+            m_filter.add(region);
+        m_cv.notify_all();
+    }
+
+    /**
+     * @brief Abandon the migration of a region, which stays where it is.
+     */
+    void abort(const RegionID& region) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        if(m_migrating.erase(region)) m_filter.remove(region);
+        m_cv.notify_all();
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,184 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REGION_TAILS_HPP
+#define __WARABI_REGION_TAILS_HPP
+
+#include "warabi/RegionID.hpp"
+#include "warabi/Result.hpp"
+#include <thallium.hpp>
+#include <fmt/format.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Tails of the regions of a backend that are used as logs: the
+ * tail of a region is the offset right after the data appended to it.
+ * Appends reserve their range with an atomic operation on the tail of
+ * the region, so concurrent appends never wait for one another; the
+ * lock is only taken exclusively to add or remove an entry.
+ *
+ * Tails are kept in memory only. A target opened over existing data
+ * calls setUnknown(), after which appends to the regions that were
+ * already there fail instead of overwriting them from offset 0.
+ */
+class RegionTails {
+
+    struct Hash {
+        size_t operator()(const RegionID& region) const {
+            uint64_t h[2];
+            std::memcpy(h, region.data(), sizeof(h));
+            return h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    tl::rwlock                                              m_lock;
+    std::unordered_map<RegionID, std::atomic<size_t>, Hash> m_tails;
+    std::atomic<size_t>                                     m_size{0};
+    // regions without an entry have an unknown tail (instead of 0)
+    bool                                                    m_unknown = false;
+
+    void setTail(const RegionID& region, size_t tail) {
+        m_tails[region].store(tail, std::memory_order_relaxed);
+        m_size.store(m_tails.size(), std::memory_order_relaxed);
+    }
+
+    void removeTail(const RegionID& region) {
+        m_tails.erase(region);
+        m_size.store(m_tails.size(), std::memory_order_relaxed);
+    }
+
+    public:
+
+    /**
+     * @brief Mark the tails of the regions already in the target as
+     * unknown. Must be called before the target is used.
+     */
+    void setUnknown() {
+        m_unknown = true;
+    }
+
+    /**
+     * @brief Reserve size bytes at the tail of the region, without
+     * exceeding capacity bytes. Returns the offset of the reserved range.
+     */
+    Result<size_t> reserve(const RegionID& region, size_t size,
+                           size_t capacity = std::numeric_limits<size_t>::max()) {
+        Result<size_t> result;
+        bool inserted = false;
+        m_lock.rdlock();
+        auto it = m_tails.find(region);
+        if(it == m_tails.end()) {
+            m_lock.unlock();
+            if(m_unknown) {
+                result.success() = false;
+                result.error() = "Cannot append to a region created before its target was"
+                                 " opened: the end of the data appended to it is unknown";
+                return result;
+            }
+            m_lock.wrlock();
+            it = m_tails.find(region);
+            if(it == m_tails.end()) {
+                it = m_tails.try_emplace(region, 0).first;
+                m_size.store(m_tails.size(), std::memory_order_relaxed);
+                inserted = true;
+            }
+        }
+        auto& t = it->second;
+        size_t offset = t.load(std::memory_order_relaxed);
+        do {
+            if(size > capacity || offset > capacity - size) {
+                result.success() = false;
+                result.error() = fmt::format(
+                    "Cannot append {} bytes to region: {} of its {} bytes are used",
+                    size, offset, capacity);
+                if(inserted) removeTail(region);
+                m_lock.unlock();
+                return result;
+            }
+        } while(!t.compare_exchange_weak(offset, offset + size, std::memory_order_relaxed));
+        m_lock.unlock();
+        result.value() = offset;
+        return result;
+    }
+
+    /**
+     * @brief Give back the range reserved at the given offset, if no
+     * range was reserved after it. Returns whether the range was released.
+     */
+    bool release(const RegionID& region, size_t offset, size_t size) {
+        m_lock.rdlock();
+        auto it = m_tails.find(region);
+        size_t expected = offset + size;
+        bool released = it != m_tails.end()
+                     && it->second.compare_exchange_strong(expected, offset);
+        m_lock.unlock();
+        if(released && offset == 0 && !m_unknown) {
+            m_lock.wrlock();
+            it = m_tails.find(region);
+            if(it != m_tails.end() && it->second.load() == 0) removeTail(region);
+            m_lock.unlock();
+        }
+        return released;
+    }
+
+    /**
+     * @brief End of the data appended to a region (0 if unknown).
+     */
+    size_t end(const RegionID& region) {
+        if(m_size.load(std::memory_order_relaxed) == 0) return 0;
+        m_lock.rdlock();
+        auto it = m_tails.find(region);
+        size_t t = it != m_tails.end() ? it->second.load(std::memory_order_relaxed) : 0;
+        m_lock.unlock();
+        return t;
+    }
+
+    /**
+     * @brief Record the tail of a region created by the backend.
+     */
+    void created(const RegionID& region) {
+        if(!m_unknown) return;
+        m_lock.wrlock();
+        setTail(region, 0);
+        m_lock.unlock();
+    }
+
+    /**
+     * @brief Update the tail of a region that was resized to size bytes,
+     * and moved from a RegionID to another (which may be the same).
+     */
+    void resized(const RegionID& from, const RegionID& to, size_t size) {
+        m_lock.wrlock();
+        auto it = m_tails.find(from);
+        bool known = it != m_tails.end();
+        size_t t = known ? it->second.load(std::memory_order_relaxed) : 0;
+        if(known) removeTail(from);
+        removeTail(to);
+        if(known && (t || m_unknown)) setTail(to, std::min(t, size));
+        m_lock.unlock();
+    }
+
+    /**
+     * @brief Reset the tail of an erased region.
+     */
+    void erased(const RegionID& region) {
+        m_lock.wrlock();
+        if(m_unknown) setTail(region, 0);
+        else removeTail(region);
+        m_lock.unlock();
+    }
+};
+
+}
+
+#endif
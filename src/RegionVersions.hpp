@@ -0,0 +1,137 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REGION_VERSIONS_HPP
+#define __WARABI_REGION_VERSIONS_HPP
+
+#include "warabi/RegionID.hpp"
+#include <thallium.hpp>
+#include <cstring>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Versions of the regions of a provider, used by clients to
+ * validate the data they cache. A region's version changes whenever
+ * a write to it starts or completes, or when it is erased. Regions that
+ * have not been modified since the provider started share a random base
+ * version, so versions obtained from a previous instance of the provider
+ * do not match.
+ *
+ * Version 0 is never a valid version: it is returned for regions that
+ * are being written, whose content must not be cached.
+ *
+ * The versions of at most s_max_entries regions are tracked. Beyond
+ * that, the regions that are not being written are folded into a new
+ * base version, which invalidates the copies cached by clients for
+ * all of them, but never lets a region go back to an older version.
+ */
+class RegionVersions {
+
+    struct Entry {
+        uint64_t version = 0;
+        uint32_t writers = 0;
+    };
+
+    struct Hash {
+        size_t operator()(const RegionID& region) const {
+            uint64_t h[2];
+            std::memcpy(h, region.data(), sizeof(h));
+            return h[0] ^ (h[1] * 0x9e3779b97f4a7c15ull);
+        }
+    };
+
+    static constexpr size_t s_max_entries = 65536;
+
+    mutable tl::mutex                           m_mtx;
+    std::unordered_map<RegionID, Entry, Hash>   m_entries;
+    uint64_t                                    m_base;
+    uint64_t                                    m_next;
+
+    uint64_t next() {
+        if(++m_next == 0) ++m_next;
+        return m_next;
+    }
+
+    // called with m_mtx held after inserting an entry
+    void shrink() {
+        if(m_entries.size() <= s_max_entries) return;
+        for(auto it = m_entries.begin(); it != m_entries.end();) {
+            if(it->second.writers == 0) it = m_entries.erase(it);
+            else ++it;
+        }
+        m_base = next();
+    }
+
+    public:
+
+    RegionVersions() {
+        std::random_device rd;
+        m_base = ((uint64_t)rd() << 32) | rd();
+        if(m_base == 0) m_base = 1;
+        m_next = m_base;
+    }
+
+    /**
+     * @brief Current version of the region (0 if it is being written).
+     */
+    uint64_t get(const RegionID& region) const {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        auto it = m_entries.find(region);
+        if(it == m_entries.end()) return m_base;
+        return it->second.writers ? 0 : it->second.version;
+    }
+
+    /**
+     * @brief Changes the version of a region for the duration of a write.
+     */
+    class WriteGuard {
+
+        RegionVersions* m_versions;
+        RegionID        m_region;
+
+        public:
+
+        WriteGuard(RegionVersions& versions, const RegionID& region)
+        : m_versions(&versions), m_region(region) {
+            std::lock_guard<tl::mutex> lock{m_versions->m_mtx};
+            auto& entry = m_versions->m_entries[m_region];
+            entry.writers += 1;
+            entry.version = m_versions->next();
+            m_versions->shrink();
+        }
+
+        ~WriteGuard() {
+            std::lock_guard<tl::mutex> lock{m_versions->m_mtx};
+            auto& entry = m_versions->m_entries[m_region];
+            entry.writers -= 1;
+            entry.version = m_versions->next();
+        }
+
+        WriteGuard(const WriteGuard&) = delete;
+        WriteGuard& operator=(const WriteGuard&) = delete;
+    };
+
+    /**
+     * @brief Record that a region was erased. The entry is kept (with
+     * a new version) so that the region does not go back to the base
+     * version, which copies cached before the erasure may still carry,
+     * until the entries are folded into a new base version.
+     */
+    void erased(const RegionID& region) {
+        std::lock_guard<tl::mutex> lock{m_mtx};
+        m_entries[region].version = next();
+        shrink();
+    }
+};
+
+}
+
+#endif
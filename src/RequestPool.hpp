@@ -0,0 +1,109 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_REQUEST_POOL_HPP
+#define __WARABI_REQUEST_POOL_HPP
+
+#include <thallium.hpp>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace warabi {
+
+/**
+ * @brief Free list of memory blocks used to allocate the objects
+ * backing AsyncRequests (the AsyncRequestImpl and the control block
+ * of its shared_ptr, in a single block). Blocks are recycled instead
+ * of going back to the heap, up to a given number of free blocks.
+ * All the blocks have the size of the first block released to the
+ * pool; requests of another size are served by the heap.
+ */
+class RequestPool {
+
+    thallium::mutex    m_mtx;
+    std::vector<void*> m_free;
+    size_t             m_block_size = 0;
+    size_t             m_max_free;
+
+    public:
+
+    RequestPool(size_t max_free = 4096)
+    : m_max_free(max_free) {}
+
+    ~RequestPool() {
+        for(auto p : m_free) ::operator delete(p);
+    }
+
+    RequestPool(const RequestPool&) = delete;
+    RequestPool& operator=(const RequestPool&) = delete;
+
+    void* allocate(size_t size) {
+        {
+            std::lock_guard<thallium::mutex> lock{m_mtx};
+            if(size == m_block_size && !m_free.empty()) {
+                auto p = m_free.back();
+                m_free.pop_back();
+                return p;
+            }
+        }
+        return ::operator new(size);
+    }
+
+    void deallocate(void* p, size_t size) {
+        {
+            std::lock_guard<thallium::mutex> lock{m_mtx};
+            if(m_block_size == 0) m_block_size = size;
+            if(size == m_block_size && m_free.size() < m_max_free) {
+                m_free.push_back(p);
+                return;
+            }
+        }
+        ::operator delete(p);
+    }
+};
+
+/**
+ * @brief Allocator drawing from a RequestPool, to be used with
+ * std::allocate_shared. Each allocated object keeps the pool alive.
+ */
+template<typename T>
+struct PoolAllocator {
+
+    using value_type = T;
+
+    std::shared_ptr<RequestPool> m_pool;
+
+    PoolAllocator(std::shared_ptr<RequestPool> pool)
+    : m_pool(std::move(pool)) {}
+
+    template<typename U>
+    PoolAllocator(const PoolAllocator<U>& other)
+    : m_pool(other.m_pool) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(m_pool->allocate(n*sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) {
+        m_pool->deallocate(p, n*sizeof(T));
+    }
+
+    template<typename U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return m_pool == other.m_pool;
+    }
+
+    template<typename U>
+    bool operator!=(const PoolAllocator<U>& other) const {
+        return m_pool != other.m_pool;
+    }
+};
+
+}
+
+#endif
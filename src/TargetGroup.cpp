@@ -0,0 +1,461 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "warabi/TargetGroup.hpp"
+#include "warabi/Client.hpp"
+#include "warabi/Exception.hpp"
+
+#include "ClientImpl.hpp"
+#include "TargetGroupImpl.hpp"
+
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <limits>
+
+namespace warabi {
+
+TargetGroupImpl::TargetGroupImpl(
+        std::vector<TargetHandle>&& targets,
+        const std::vector<std::string>& names,
+        Placement placement,
+        size_t virtual_nodes)
+: m_targets(std::move(targets))
+, m_placement(placement)
+, m_placed_bytes(new std::atomic<uint64_t>[m_targets.size()]) {
+    for(size_t i = 0; i < m_targets.size(); ++i)
+        m_placed_bytes[i].store(0);
+    if(m_placement != Placement::ConsistentHashing) return;
+    virtual_nodes = std::max<size_t>(virtual_nodes, 1);
+    m_ring.reserve(m_targets.size()*virtual_nodes);
+    for(uint32_t i = 0; i < m_targets.size(); ++i) {
+        for(size_t v = 0; v < virtual_nodes; ++v) {
+            auto point = fmt::format("{}#{}", names[i], v);
+            m_ring.emplace_back(hash(point.data(), point.size()), i);
+        }
+    }
+    std::sort(m_ring.begin(), m_ring.end());
+}
+
+size_t TargetGroupImpl::choose(const std::string& key) {
+    if(m_placement == Placement::LeastLoaded) {
+        size_t index = 0;
+        auto min = m_placed_bytes[0].load();
+        for(size_t i = 1; i < m_targets.size(); ++i) {
+            auto bytes = m_placed_bytes[i].load();
+            if(bytes < min) {
+                min = bytes;
+                index = i;
+            }
+        }
+        return index;
+    }
+    uint64_t h;
+    if(key.empty()) {
+        auto k = m_next_key.fetch_add(1);
+        h = hash(&k, sizeof(k));
+    } else {
+        h = hash(key.data(), key.size());
+    }
+    auto it = std::lower_bound(m_ring.begin(), m_ring.end(),
+                               std::make_pair(h, (uint32_t)0));
+    if(it == m_ring.end()) it = m_ring.begin();
+    return it->second;
+}
+
+size_t TargetGroupImpl::place(const std::string& key, size_t size) {
+    auto index = choose(key);
+    m_placed_bytes[index] += size;
+    return index;
+}
+
+const TargetHandle& TargetGroupImpl::target(const GroupRegionID& region) const {
+    if(region.target >= m_targets.size())
+        throw Exception(fmt::format(
+            "Invalid GroupRegionID (target {} in a group of {} targets)",
+            region.target, m_targets.size()));
+    return m_targets[region.target];
+}
+
+/**
+ * @brief Issue count asynchronous requests with issue(i, AsyncRequest*)
+ * and wait for all of them. If some of them failed, the first error
+ * is thrown once all the requests have completed. If succeeded is
+ * provided, it is set to whether each request succeeded.
+ */
+template<typename F>
+static void runBatch(size_t count, F&& issue, std::vector<bool>* succeeded = nullptr) {
+    std::vector<AsyncRequest> requests(count);
+    std::vector<bool> ok(count, false);
+    std::exception_ptr error;
+    for(size_t i = 0; i < count; ++i) {
+        try {
+            issue(i, &requests[i]);
+            ok[i] = true;
+        } catch(...) {
+            if(!error) error = std::current_exception();
+        }
+    }
+    for(size_t i = 0; i < count; ++i) {
+        if(!requests[i]) continue;
+        try {
+            requests[i].wait();
+        } catch(...) {
+            ok[i] = false;
+            if(!error) error = std::current_exception();
+        }
+    }
+    if(succeeded) *succeeded = std::move(ok);
+    if(error) std::rethrow_exception(error);
+}
+
+/*
+ * Manifest of a striped object (native endianness):
+ * - magic (8 bytes): "WRBSTRP1"
+ * - size of the object (uint64_t)
+ * - size of the stripes (uint64_t)
+ * - number of stripes (uint32_t)
+ * - then for each stripe, the index of its target (uint32_t)
+ *   and its region id (16 bytes)
+ */
+static constexpr char StripedMagic[8] = {'W','R','B','S','T','R','P','1'};
+static constexpr size_t StripedHeaderSize = sizeof(StripedMagic) + 2*sizeof(uint64_t) + sizeof(uint32_t);
+static constexpr size_t StripedEntrySize = sizeof(uint32_t) + sizeof(RegionID);
+
+/**
+ * @brief Part of a range of a striped object held by a stripe.
+ */
+struct StripePiece {
+    size_t stripe;       // index of the stripe
+    size_t stripeOffset; // offset in the stripe
+    size_t dataOffset;   // offset in the user buffer
+    size_t size;         // size of the piece
+};
+
+static std::vector<StripePiece> splitRange(
+        const StripedObject& object, size_t offset, size_t size) {
+    if(offset > object.size || size > object.size - offset)
+        throw Exception(fmt::format(
+            "Range [{}, {}) is out of bounds of striped object of size {}",
+            offset, offset + size, object.size));
+    std::vector<StripePiece> pieces;
+    size_t done = 0;
+    while(done < size) {
+        size_t pos = offset + done;
+        size_t stripe = pos / object.stripeSize;
+        size_t stripeOffset = pos % object.stripeSize;
+        size_t length = std::min(size - done, object.stripeSize - stripeOffset);
+        if(stripe >= object.stripes.size())
+            throw Exception("Invalid StripedObject (missing stripes)");
+        pieces.push_back({stripe, stripeOffset, done, length});
+        done += length;
+    }
+    return pieces;
+}
+
+template<typename T>
+static void appendValue(std::vector<char>& buffer, const T& value) {
+    auto p = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(value));
+}
+
+template<typename T>
+static const char* readValue(const char* p, T& value) {
+    std::memcpy(&value, p, sizeof(value));
+    return p + sizeof(value);
+}
+
+TargetGroup Client::makeTargetGroup(
+        const std::vector<std::pair<std::string, uint16_t>>& targets) const {
+    return makeTargetGroup(targets, Placement::ConsistentHashing);
+}
+
+TargetGroup Client::makeTargetGroup(
+        const std::vector<std::pair<std::string, uint16_t>>& targets,
+        Placement placement, size_t virtual_nodes) const {
+    if(not self) throw Exception("Invalid warabi::Client object");
+    if(targets.empty()) throw Exception("Cannot create a TargetGroup without targets");
+    std::vector<TargetHandle> handles;
+    std::vector<std::string>  names;
+    for(auto& t : targets) {
+        handles.push_back(makeTargetHandle(t.first, t.second));
+        names.push_back(fmt::format("{}/{}", t.first, t.second));
+    }
+    return std::make_shared<TargetGroupImpl>(
+        std::move(handles), names, placement, virtual_nodes);
+}
+
+TargetGroup::TargetGroup() = default;
+
+TargetGroup::TargetGroup(const std::shared_ptr<TargetGroupImpl>& impl)
+: self(impl) {}
+
+TargetGroup::TargetGroup(const TargetGroup&) = default;
+
+TargetGroup::TargetGroup(TargetGroup&&) = default;
+
+TargetGroup& TargetGroup::operator=(const TargetGroup&) = default;
+
+TargetGroup& TargetGroup::operator=(TargetGroup&&) = default;
+
+TargetGroup::~TargetGroup() = default;
+
+TargetGroup::operator bool() const {
+    return static_cast<bool>(self);
+}
+
+size_t TargetGroup::size() const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    return self->m_targets.size();
+}
+
+const TargetHandle& TargetGroup::target(size_t index) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    if(index >= self->m_targets.size())
+        throw Exception(fmt::format("Invalid target index {}", index));
+    return self->m_targets[index];
+}
+
+Placement TargetGroup::placement() const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    return self->m_placement;
+}
+
+size_t TargetGroup::place(const std::string& key) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    return self->choose(key);
+}
+
+void TargetGroup::create(GroupRegionID* region, size_t size,
+                         const std::string& key,
+                         AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    auto index = self->place(key, size);
+    region->target = static_cast<uint32_t>(index);
+    self->m_targets[index].create(&region->region, size, req);
+}
+
+void TargetGroup::write(const GroupRegionID& region,
+                        size_t regionOffset,
+                        const char* data, size_t size,
+                        bool persist,
+                        AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).write(region.region, regionOffset, data, size, persist, req);
+}
+
+void TargetGroup::write(const GroupRegionID& region,
+                        const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+                        const char* data,
+                        bool persist,
+                        AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).write(region.region, regionOffsetSizes, data, persist, req);
+}
+
+void TargetGroup::persist(const GroupRegionID& region,
+                          size_t offset, size_t size,
+                          AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).persist(region.region, offset, size, req);
+}
+
+void TargetGroup::createAndWrite(GroupRegionID* region,
+                                 const char* data, size_t size,
+                                 bool persist,
+                                 const std::string& key,
+                                 AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    auto index = self->place(key, size);
+    region->target = static_cast<uint32_t>(index);
+    self->m_targets[index].createAndWrite(&region->region, data, size, persist, req);
+}
+
+void TargetGroup::read(const GroupRegionID& region,
+                       size_t regionOffset,
+                       char* data, size_t size,
+                       AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).read(region.region, regionOffset, data, size, req);
+}
+
+void TargetGroup::read(const GroupRegionID& region,
+                       const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
+                       char* data,
+                       AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).read(region.region, regionOffsetSizes, data, req);
+}
+
+void TargetGroup::erase(const GroupRegionID& region,
+                        AsyncRequest* req) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    self->target(region).erase(region.region, req);
+}
+
+void TargetGroup::createAndWriteBatch(
+        std::vector<GroupRegionID>* regions,
+        const std::vector<std::pair<const char*, size_t>>& buffers,
+        bool persist) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    regions->resize(buffers.size());
+    runBatch(buffers.size(), [&](size_t i, AsyncRequest* req) {
+        createAndWrite(&(*regions)[i], buffers[i].first, buffers[i].second, persist, "", req);
+    });
+}
+
+void TargetGroup::readBatch(
+        const std::vector<GroupRegionID>& regions,
+        const std::vector<std::pair<char*, size_t>>& buffers) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    if(regions.size() != buffers.size())
+        throw Exception("readBatch expects as many buffers as regions");
+    runBatch(regions.size(), [&](size_t i, AsyncRequest* req) {
+        read(regions[i], 0, buffers[i].first, buffers[i].second, req);
+    });
+}
+
+void TargetGroup::eraseBatch(const std::vector<GroupRegionID>& regions) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    runBatch(regions.size(), [&](size_t i, AsyncRequest* req) {
+        erase(regions[i], req);
+    });
+}
+
+void TargetGroup::createStriped(StripedObject* object,
+                                const char* data, size_t size,
+                                size_t stripeSize,
+                                bool persist,
+                                const std::string& key) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    if(stripeSize == 0) throw Exception("Stripe size of a striped object cannot be 0");
+    size_t count = (size + stripeSize - 1) / stripeSize;
+    if(count > std::numeric_limits<uint32_t>::max())
+        throw Exception("Too many stripes in striped object");
+    auto numTargets = self->m_targets.size();
+    auto first = self->choose(key);
+
+    StripedObject result;
+    result.size       = size;
+    result.stripeSize = stripeSize;
+    result.stripes.resize(count);
+    for(size_t i = 0; i < count; ++i) {
+        auto index = (first + i) % numTargets;
+        auto length = std::min(stripeSize, size - i*stripeSize);
+        result.stripes[i].target = static_cast<uint32_t>(index);
+        self->m_placed_bytes[index] += length;
+    }
+
+    // on failure, best-effort cleanup of the stripes that were written,
+    // and the bytes placed for the object are given back
+    std::vector<bool> written;
+    auto rollback = [&](size_t manifestSize) {
+        for(size_t i = 0; i < count; ++i) {
+            auto length = std::min(stripeSize, size - i*stripeSize);
+            self->m_placed_bytes[result.stripes[i].target] -= length;
+            if(i >= written.size() || !written[i]) continue;
+            try { erase(result.stripes[i]); } catch(...) {}
+        }
+        self->m_placed_bytes[first] -= manifestSize;
+    };
+    try {
+        runBatch(count, [&](size_t i, AsyncRequest* req) {
+            auto& stripe = result.stripes[i];
+            auto length = std::min(stripeSize, size - i*stripeSize);
+            self->m_targets[stripe.target].createAndWrite(
+                &stripe.region, data + i*stripeSize, length, persist, req);
+        }, &written);
+    } catch(...) {
+        rollback(0);
+        throw;
+    }
+
+    std::vector<char> manifest;
+    manifest.reserve(StripedHeaderSize + count*StripedEntrySize);
+    manifest.insert(manifest.end(), StripedMagic, StripedMagic + sizeof(StripedMagic));
+    appendValue(manifest, static_cast<uint64_t>(size));
+    appendValue(manifest, static_cast<uint64_t>(stripeSize));
+    appendValue(manifest, static_cast<uint32_t>(count));
+    for(auto& stripe : result.stripes) {
+        appendValue(manifest, stripe.target);
+        manifest.insert(manifest.end(), stripe.region.begin(), stripe.region.end());
+    }
+    result.manifest.target = static_cast<uint32_t>(first);
+    self->m_placed_bytes[first] += manifest.size();
+    try {
+        self->m_targets[first].createAndWrite(
+            &result.manifest.region, manifest.data(), manifest.size(), persist);
+    } catch(...) {
+        rollback(manifest.size());
+        throw;
+    }
+
+    *object = std::move(result);
+}
+
+void TargetGroup::openStriped(StripedObject* object, const GroupRegionID& manifest) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    auto& target = self->target(manifest);
+    char header[StripedHeaderSize];
+    target.read(manifest.region, 0, header, sizeof(header));
+    if(std::memcmp(header, StripedMagic, sizeof(StripedMagic)) != 0)
+        throw Exception("Region is not the manifest of a striped object");
+    StripedObject result;
+    uint32_t count;
+    const char* p = header + sizeof(StripedMagic);
+    p = readValue(p, result.size);
+    p = readValue(p, result.stripeSize);
+    readValue(p, count);
+    if(result.stripeSize == 0
+    || count != (result.size + result.stripeSize - 1) / result.stripeSize)
+        throw Exception("Invalid striped object manifest");
+    std::vector<char> entries(count*StripedEntrySize);
+    if(count) target.read(manifest.region, sizeof(header), entries.data(), entries.size());
+    result.manifest = manifest;
+    result.stripes.resize(count);
+    p = entries.data();
+    for(auto& stripe : result.stripes) {
+        p = readValue(p, stripe.target);
+        p = readValue(p, stripe.region);
+        self->target(stripe); // validates the target index
+    }
+    *object = std::move(result);
+}
+
+void TargetGroup::writeStriped(const StripedObject& object,
+                               size_t offset,
+                               const char* data, size_t size,
+                               bool persist) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    auto pieces = splitRange(object, offset, size);
+    runBatch(pieces.size(), [&](size_t i, AsyncRequest* req) {
+        auto& piece = pieces[i];
+        write(object.stripes[piece.stripe], piece.stripeOffset,
+              data + piece.dataOffset, piece.size, persist, req);
+    });
+}
+
+void TargetGroup::readStriped(const StripedObject& object,
+                              size_t offset,
+                              char* data, size_t size) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    auto pieces = splitRange(object, offset, size);
+    runBatch(pieces.size(), [&](size_t i, AsyncRequest* req) {
+        auto& piece = pieces[i];
+        read(object.stripes[piece.stripe], piece.stripeOffset,
+             data + piece.dataOffset, piece.size, req);
+    });
+}
+
+void TargetGroup::eraseStriped(const StripedObject& object) const {
+    if(not self) throw Exception("Invalid warabi::TargetGroup object");
+    // the manifest is erased first so the object cannot be
+    // opened while some of its stripes are missing
+    erase(object.manifest);
+    eraseBatch(object.stripes);
+}
+
+}
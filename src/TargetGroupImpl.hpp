@@ -0,0 +1,70 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_TARGET_GROUP_IMPL_H
+#define __WARABI_TARGET_GROUP_IMPL_H
+
+#include "warabi/TargetGroup.hpp"
+#include "warabi/TargetHandle.hpp"
+#include <atomic>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace warabi {
+
+class TargetGroupImpl {
+
+    public:
+
+    std::vector<TargetHandle> m_targets;
+    Placement                 m_placement;
+
+    // consistent hashing: sorted (hash, target index) pairs,
+    // with virtual_nodes points per target
+    std::vector<std::pair<uint64_t, uint32_t>> m_ring;
+    // counter used as key when none is provided
+    std::atomic<uint64_t>                      m_next_key{0};
+
+    // least-loaded: bytes placed on each target by this group
+    std::unique_ptr<std::atomic<uint64_t>[]>   m_placed_bytes;
+
+    TargetGroupImpl(std::vector<TargetHandle>&& targets,
+                    const std::vector<std::string>& names,
+                    Placement placement,
+                    size_t virtual_nodes);
+
+    // index of the target on which to place a region with this key
+    size_t choose(const std::string& key);
+
+    // choose a target and account for the size of the new region
+    size_t place(const std::string& key, size_t size);
+
+    const TargetHandle& target(const GroupRegionID& region) const;
+
+    /**
+     * @brief 64-bit FNV-1a hash. Placement must not depend on the
+     * standard library's implementation of std::hash, since clients
+     * built differently must place keys identically.
+     */
+    static uint64_t hash(const void* data, size_t size) {
+        uint64_t h = 14695981039346656037ull;
+        auto p = static_cast<const unsigned char*>(data);
+        for(size_t i = 0; i < size; ++i) {
+            h ^= p[i];
+            h *= 1099511628211ull;
+        }
+        // finalizer (from splitmix64) to spread short keys over the ring
+        h ^= h >> 30; h *= 0xbf58476d1ce4e5b9ull;
+        h ^= h >> 27; h *= 0x94d049bb133111ebull;
+        h ^= h >> 31;
+        return h;
+    }
+};
+
+}
+
+#endif
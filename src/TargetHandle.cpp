@@ -11,14 +11,424 @@
 #include "ClientImpl.hpp"
 #include "TargetHandleImpl.hpp"
 #include "BufferWrapper.hpp"
+#include "TimedResult.hpp"
+#include "RegionMigrations.hpp"
 
 #include <thallium/serialization/stl/string.hpp>
 #include <thallium/serialization/stl/vector.hpp>
 #include <thallium/serialization/stl/pair.hpp>
 #include <thallium/serialization/stl/array.hpp>
 
+#include <algorithm>
+#include <limits>
+
 namespace warabi {
 
+/**
+ * @brief Whether a read of this size goes through the client's read cache.
+ */
+static bool useReadCache(const TargetHandleImpl& th, size_t size, AsyncRequest* req) {
+    auto& cache = th.m_client->m_read_cache;
+    return req == nullptr && cache.enabled() && size <= cache.maxEntrySize();
+}
+
+/**
+ * @brief Whether to use version 2 of the wire protocol with the provider,
+ * negotiating the version on first use. Synchronous calls (wait is true)
+ * wait for the provider's answer, while asynchronous calls only send the
+ * question and use version 1 until the answer has arrived. Providers that
+ * do not define warabi_get_protocol_version predate both versions and only
+ * serve the original RPCs, which clients no longer use: this throws. If the
+ * question fails for another reason, the version is negotiated again.
+ */
+static bool useCompactProtocol(TargetHandleImpl& th, bool wait) {
+    auto version = th.m_protocol.load(std::memory_order_acquire);
+    if(version != 0) return version >= 2;
+    std::unique_lock<tl::mutex> lock{th.m_protocol_mtx, std::defer_lock};
+    if(wait) lock.lock();
+    else if(!lock.try_lock()) return false;
+    version = th.m_protocol.load(std::memory_order_relaxed);
+    if(version != 0) return version >= 2;
+    if(!th.m_handshake)
+        th.m_handshake = th.m_client->m_get_protocol_version.on(th.m_ph).async();
+    if(!wait && !th.m_handshake->received()) return false;
+    bool unsupported = false;
+    try {
+        uint16_t provided = th.m_handshake->wait();
+        version = std::min(provided, s_wire_protocol_version);
+    } catch(const tl::margo_exception& ex) {
+        unsupported = ex.error() == HG_NO_MATCH;
+    } catch(const std::exception&) {}
+    th.m_handshake.reset();
+    if(unsupported)
+        throw Exception("Provider predates the wire protocol of this client, "
+                        "it needs to be upgraded");
+    th.m_protocol.store(version, std::memory_order_release);
+    return version >= 2;
+}
+
+/**
+ * @brief If the client learned that a region was migrated to another
+ * provider, return the target to which its requests must be sent and
+ * set forwarded to the RegionID of the region in that target.
+ */
+static std::shared_ptr<TargetHandleImpl> findForward(TargetHandleImpl& th,
+                                                     const RegionID& region,
+                                                     RegionID& forwarded) {
+    if(!th.m_forwards_filter.mayContain(region)) return nullptr;
+    std::lock_guard<tl::mutex> lock{th.m_forwards_mtx};
+    auto it = th.m_forwards.find(region);
+    if(it == th.m_forwards.end()) return nullptr;
+    forwarded = it->second.region;
+    return it->second.target;
+}
+
+/**
+ * @brief Same as findForward, but follows the forwards of the targets
+ * the region was migrated to, if it was migrated again from there.
+ */
+static std::shared_ptr<TargetHandleImpl> resolveForward(TargetHandleImpl& th,
+                                                        const RegionID& region,
+                                                        RegionID& forwarded) {
+    auto target = findForward(th, region, forwarded);
+    if(!target) return nullptr;
+    RegionID next;
+    while(auto further = findForward(*target, forwarded, next)) {
+        target    = std::move(further);
+        forwarded = next;
+    }
+    return target;
+}
+
+/**
+ * @brief Ask the provider where a migrated region went and remember it,
+ * so that findForward redirects the requests for the region from now on.
+ * Returns whether the location of the region was obtained.
+ */
+static bool learnForward(TargetHandleImpl& th, const RegionID& region) {
+    auto& client = *th.m_client;
+    Result<RegionForward> forward = client.m_get_forward.on(th.m_ph)(region);
+    if(!forward.success()) return false;
+    auto& location = forward.value();
+    auto target = std::make_shared<TargetHandleImpl>(
+        th.m_client, tl::provider_handle(client.m_engine.lookup(location.address),
+                                         location.provider_id));
+    target->m_eager_write_threshold = th.m_eager_write_threshold;
+    target->m_eager_read_threshold  = th.m_eager_read_threshold;
+    th.addForward(region, std::move(target), location.region);
+    return true;
+}
+
+/**
+ * @brief If a request failed because its region was migrated, learn where
+ * the region went. Returns whether the request should be sent again.
+ */
+template<typename T>
+static bool learnForward(TargetHandleImpl& th, const RegionID& region,
+                         const CodedResult<T>& response) {
+    if(response.code != ErrorCode::Moved) return false;
+    return learnForward(th, region);
+}
+
+/**
+ * @brief Layout to send with an RPC: the layout itself, or for large
+ * indexed layouts, a copy whose segments are exposed for the provider
+ * to pull. The copy is held by exposed, which must be kept alive until
+ * the RPC completes.
+ */
+static const Layout& sendableLayout(ClientImpl& client, const Layout& layout,
+                                    std::shared_ptr<Layout>& exposed) {
+    if(!layout.needsBulk()) return layout;
+    exposed = std::make_shared<Layout>(layout);
+    exposed->expose(client.m_engine);
+    return *exposed;
+}
+
+/**
+ * @brief Stop tracking a prefetched range that will not be read. Ranges
+ * still in flight are kept until their transfer completes, since their
+ * buffer is being written to. Must be called with m_prefetch_mtx held.
+ */
+static void retirePrefetch(TargetHandleImpl& th, std::shared_ptr<PrefetchedRange> range) {
+    if(range->request && !range->request->received())
+        th.m_prefetch_retired.push_back(std::move(range));
+}
+
+/**
+ * @brief Release the retired ranges whose transfer has completed.
+ * Must be called with m_prefetch_mtx held.
+ */
+static void reapPrefetches(TargetHandleImpl& th) {
+    auto& retired = th.m_prefetch_retired;
+    retired.erase(std::remove_if(retired.begin(), retired.end(),
+        [](const std::shared_ptr<PrefetchedRange>& range) {
+            return range->request->received();
+        }), retired.end());
+}
+
+/**
+ * @brief Issue the read of a range. Ranges of regions known to have moved
+ * are read from their new location, but stay with this TargetHandleImpl.
+ */
+static void issueRange(TargetHandleImpl& th, PrefetchedRange& range) {
+    auto& client = *th.m_client;
+    range.buffer = std::make_shared<RegisteredBufferImpl>(
+        client.m_buffer_pool, client.m_buffer_pool->acquire(range.size), range.size);
+    auto layout = Layout::contiguous(range.offset, range.size);
+    RegionID region = range.region;
+    auto forward = findForward(th, range.region, region);
+    auto& ph = forward ? forward->m_ph : th.m_ph;
+    range.forwarded = static_cast<bool>(forward);
+    auto start = traceClock();
+    if(range.size < th.m_eager_read_threshold) {
+        auto async_response = client.m_read_eager.on(ph).async(
+            client.nextRequestID(), region, layout);
+        range.request = AsyncRequestImpl::make(
+            std::move(async_response), th.m_client, start,
+            AsyncRequestImpl::Completion::EagerRead);
+        range.request->m_data = range.buffer->m_block.memory.get();
+        range.request->m_size = range.size;
+    } else {
+        auto async_response = client.m_read.on(ph).async(
+            client.nextRequestID(), region, layout,
+            range.buffer->m_block.bulk, std::string{}, (size_t)0);
+        range.request = AsyncRequestImpl::make(
+            std::move(async_response), th.m_client, start,
+            AsyncRequestImpl::Completion::Check);
+    }
+}
+
+/**
+ * @brief Issue the queued ranges until m_prefetch_depth ranges are in
+ * flight or waiting to be read. Must be called with m_prefetch_mtx held.
+ */
+static void issuePrefetches(TargetHandleImpl& th) {
+    while(th.m_prefetched.size() < th.m_prefetch_depth && !th.m_prefetch_queue.empty()) {
+        auto range = std::move(th.m_prefetch_queue.front());
+        th.m_prefetch_queue.pop_front();
+        issueRange(th, *range);
+        th.m_prefetched.push_back(std::move(range));
+    }
+}
+
+/**
+ * @brief Queue ranges to prefetch, issue as many as the depth allows,
+ * and hint the provider about the others so that its backend can start
+ * loading them.
+ */
+static void prefetchRanges(TargetHandleImpl& th,
+                           const std::vector<RegionID>& regions,
+                           const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes) {
+    std::lock_guard<tl::mutex> lock{th.m_prefetch_mtx};
+    th.m_prefetch_active = true;
+    reapPrefetches(th);
+    for(size_t i = 0; i < regions.size(); ++i) {
+        if(regionOffsetSizes[i].second == 0) continue;
+        auto range = std::make_shared<PrefetchedRange>();
+        range->region = regions[i];
+        range->offset = regionOffsetSizes[i].first;
+        range->size   = regionOffsetSizes[i].second;
+        th.m_prefetch_queue.push_back(std::move(range));
+    }
+    issuePrefetches(th);
+    if(th.m_prefetch_queue.empty()) return;
+    std::vector<RegionID> queuedRegions;
+    std::vector<std::pair<size_t, size_t>> queuedRanges;
+    for(auto& range : th.m_prefetch_queue) {
+        queuedRegions.push_back(range->region);
+        queuedRanges.emplace_back(range->offset, range->size);
+    }
+    auto& client = *th.m_client;
+    auto start = traceClock();
+    auto async_response = client.m_prefetch.on(th.m_ph).async(
+        client.nextRequestID(), queuedRegions, queuedRanges);
+    // the hint is not waited on: it is retired right away
+    auto hint = std::make_shared<PrefetchedRange>();
+    hint->request = AsyncRequestImpl::make(
+        std::move(async_response), th.m_client, start,
+        AsyncRequestImpl::Completion::Check);
+    th.m_prefetch_retired.push_back(std::move(hint));
+}
+
+/**
+ * @brief Serve the beginning of a blocking read from the prefetched
+ * ranges, waiting for them if needed, and schedule sequential readahead.
+ * Prefetched ranges are expected to be read in the order they were
+ * requested: those issued before the one serving the read are dropped.
+ *
+ * Ranges that fail because the region was migrated are issued again to
+ * its new location.
+ *
+ * @return the number of bytes copied into data; the rest of the read
+ * must be done by the caller.
+ */
+static size_t prefetchedRead(TargetHandleImpl& th, const RegionID& region,
+                             size_t regionOffset, char* data, size_t size) {
+    std::unique_lock<tl::mutex> lock{th.m_prefetch_mtx};
+    reapPrefetches(th);
+    auto end = regionOffset + size;
+    // reads that do not go past the end of the previous
+    // one (e.g. its remainder) do not affect readahead
+    if(th.m_readahead_size && (region != th.m_last_region || end > th.m_last_end)) {
+        bool sequential = region == th.m_last_region && regionOffset == th.m_last_end;
+        if(region != th.m_last_region)
+            th.m_readahead_limit = std::numeric_limits<size_t>::max();
+        th.m_last_region = region;
+        th.m_last_end    = end;
+        if(!sequential) {
+            th.m_readahead_end = 0;
+        } else {
+            auto window = std::min(end + th.m_prefetch_depth * th.m_readahead_size,
+                                   th.m_readahead_limit);
+            auto next = std::max(th.m_readahead_end, end);
+            for(; next < window; next += th.m_readahead_size) {
+                auto range = std::make_shared<PrefetchedRange>();
+                range->region    = region;
+                range->offset    = next;
+                range->size      = th.m_readahead_size;
+                range->readahead = true;
+                th.m_prefetch_queue.push_back(std::move(range));
+            }
+            th.m_readahead_end = next;
+        }
+    }
+    auto& prefetched = th.m_prefetched;
+    size_t served = 0;
+    while(served < size) {
+        auto offset = regionOffset + served;
+        auto it = std::find_if(prefetched.begin(), prefetched.end(),
+            [&](const std::shared_ptr<PrefetchedRange>& r) {
+                return r->region == region && r->offset <= offset && offset < r->offset + r->size;
+            });
+        if(it == prefetched.end()) break;
+        for(auto skipped = prefetched.begin(); skipped != it; ++skipped)
+            retirePrefetch(th, *skipped);
+        prefetched.erase(prefetched.begin(), it);
+        auto range = prefetched.front();
+        size_t n = std::min(size - served, range->offset + range->size - offset);
+        lock.unlock();
+        bool ok = range->wait();
+        if(ok) std::memcpy(data + served, range->data() + (offset - range->offset), n);
+        // ranges sent to the new location of a region that moved again are
+        // left to the caller, whose read follows the forwards from there
+        bool moved = range->status == PrefetchedRange::Status::Moved;
+        if(moved && !range->forwarded) {
+            RegionID forwarded;
+            moved = findForward(th, region, forwarded) || learnForward(th, region);
+        } else {
+            moved = false;
+        }
+        lock.lock();
+        if(moved) {
+            auto pos = std::find(prefetched.begin(), prefetched.end(), range);
+            if(pos == prefetched.end()) continue;
+            auto retry = std::make_shared<PrefetchedRange>();
+            retry->region    = range->region;
+            retry->offset    = range->offset;
+            retry->size      = range->size;
+            retry->readahead = range->readahead;
+            issueRange(th, *retry);
+            *pos = std::move(retry);
+            continue;
+        }
+        if(!ok || offset + n == range->offset + range->size) {
+            auto pos = std::find(prefetched.begin(), prefetched.end(), range);
+            if(pos != prefetched.end()) prefetched.erase(pos);
+        }
+        if(!ok) {
+            // most likely read past the end of the region: stop reading ahead there
+            if(range->readahead && region == th.m_last_region
+            && range->status == PrefetchedRange::Status::Failed) {
+                th.m_readahead_limit = std::min(th.m_readahead_limit, range->offset);
+                auto& queue = th.m_prefetch_queue;
+                queue.erase(std::remove_if(queue.begin(), queue.end(),
+                    [&](const std::shared_ptr<PrefetchedRange>& r) {
+                        return r->readahead && r->region == region && r->offset >= range->offset;
+                    }), queue.end());
+            }
+            break;
+        }
+        served += n;
+    }
+    issuePrefetches(th);
+    return served;
+}
+
+/**
+ * @brief Drop the cached and prefetched ranges of a region that is
+ * being modified.
+ */
+static void invalidateCached(TargetHandleImpl& th, const RegionID& region) {
+    auto& cache = th.m_client->m_read_cache;
+    if(cache.enabled()) cache.invalidate(th.m_name, region);
+    if(!th.m_prefetch_active.load(std::memory_order_relaxed)) return;
+    std::lock_guard<tl::mutex> lock{th.m_prefetch_mtx};
+    auto& prefetched = th.m_prefetched;
+    for(auto it = prefetched.begin(); it != prefetched.end();) {
+        if((*it)->region != region) { ++it; continue; }
+        retirePrefetch(th, *it);
+        it = prefetched.erase(it);
+    }
+    auto& queue = th.m_prefetch_queue;
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+        [&](const std::shared_ptr<PrefetchedRange>& r) { return r->region == region; }),
+        queue.end());
+    if(th.m_last_region == region) th.m_readahead_end = 0;
+    issuePrefetches(th);
+}
+
+/**
+ * @brief Blocking read through the client's read cache. A cached range
+ * is served directly within its lease, or after validating its version
+ * with the provider. Otherwise the data is read along with the version
+ * of the region, and cached. Returns false if the region was found to
+ * have moved, in which case the read must be sent again.
+ */
+static bool cachedRead(TargetHandleImpl& th, const RegionID& region,
+                       size_t regionOffset, char* data, size_t size) {
+    auto& client = *th.m_client;
+    auto& cache  = client.m_read_cache;
+    auto lookup  = cache.lookup(th.m_name, region, regionOffset, size);
+    if(lookup.data && !lookup.fresh) {
+        auto start = traceClock();
+        auto async_response = client.m_get_versions.on(th.m_ph).async(
+            client.nextRequestID(), std::vector<RegionID>{region});
+        auto response = waitForResult<std::vector<uint64_t>>(async_response, client, start);
+        if(response.success() && response.value().size() == 1
+        && response.value()[0] == lookup.version) {
+            cache.validated(th.m_name, region, lookup.version);
+            lookup.fresh = true;
+        } else {
+            cache.invalidate(th.m_name, region, true);
+        }
+    }
+    if(lookup.data && lookup.fresh) {
+        std::memcpy(data, lookup.data->data() + lookup.offset, size);
+        return true;
+    }
+    auto layout = Layout::contiguous(regionOffset, size);
+    uint64_t version = 0;
+    auto start = traceClock();
+    if(size < th.m_eager_read_threshold) {
+        auto async_response = client.m_read_eager_versioned.on(th.m_ph).async(
+            client.nextRequestID(), region, layout);
+        auto response = waitForResult<VersionedBuffer>(async_response, client, start);
+        if(learnForward(th, region, response)) return false;
+        response.check();
+        std::memcpy(data, response.value().buffer.data(), size);
+        version = response.value().version;
+    } else {
+        auto bulk = client.m_engine.expose({{data, size}}, tl::bulk_mode::write_only);
+        auto async_response = client.m_read_versioned.on(th.m_ph).async(
+            client.nextRequestID(), region, layout, bulk, std::string{}, (size_t)0);
+        auto response = waitForResult<uint64_t>(async_response, client, start);
+        if(learnForward(th, region, response)) return false;
+        version = response.valueOrThrow();
+    }
+    cache.insert(th.m_name, region, regionOffset, data, size, version);
+    return true;
+}
+
 TargetHandle::TargetHandle() = default;
 
 TargetHandle::TargetHandle(const std::shared_ptr<TargetHandleImpl>& impl)
@@ -52,24 +462,63 @@ void TargetHandle::setEagerReadThreshold(size_t size) {
     self->m_eager_read_threshold = size;
 }
 
+void TargetHandle::setReadahead(size_t depth, size_t chunkSize) {
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(depth == 0) throw Exception("Readahead depth must be greater than 0");
+    std::lock_guard<tl::mutex> lock{self->m_prefetch_mtx};
+    self->m_prefetch_depth  = depth;
+    self->m_readahead_size  = chunkSize;
+    self->m_readahead_end   = 0;
+    self->m_last_end        = 0;
+    self->m_readahead_limit = std::numeric_limits<size_t>::max();
+    if(chunkSize) self->m_prefetch_active = true;
+    issuePrefetches(*self);
+}
+
+uint16_t TargetHandle::protocolVersion() const {
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    return self->m_protocol.load(std::memory_order_relaxed);
+}
+
+void TargetHandle::setProtocolVersion(uint16_t version) {
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(version > s_wire_protocol_version)
+        throw Exception("Unsupported wire protocol version " + std::to_string(version));
+    self->m_protocol.store(version, std::memory_order_relaxed);
+}
+
+void TargetHandle::prefetch(const RegionID& region,
+                            size_t regionOffset, size_t size) const {
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    prefetchRanges(*self, {region}, {{regionOffset, size}});
+}
+
+void TargetHandle::prefetch(const std::vector<RegionID>& regions, size_t size) const {
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    prefetchRanges(*self, regions,
+        std::vector<std::pair<size_t, size_t>>(regions.size(), {0, size}));
+}
+
 void TargetHandle::create(RegionID* region, size_t size,
                           AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    auto& rpc = self->m_client->m_create;
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(size);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_create_v2.on(ph).async(RequestHeader{client.nextRequestID()}, Varint{size})
+        : client.m_create.on(ph).async(client.nextRequestID(), size);
     if(req == nullptr) { // synchronous call
-        Result<RegionID> response = async_response.wait();
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, client, start, nullptr, compact);
         if(region) *region = std::move(response).valueOrThrow();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [region](AsyncRequestImpl& async_request_impl) {
-                Result<RegionID> response = async_request_impl.m_async_response.wait();
-                if(region) *region = std::move(response).value();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Region);
+        async_request_impl->m_region = region;
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -89,35 +538,52 @@ void TargetHandle::write(const RegionID& region,
                          const char* data,
                          bool persist,
                          AsyncRequest* req) const
+{
+    write(region, Layout::fromSegments(regionOffsetSizes), data, persist, req);
+}
+
+void TargetHandle::write(const RegionID& region,
+                         const Layout& layout,
+                         const char* data,
+                         bool persist,
+                         AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    size_t size = std::accumulate(regionOffsetSizes.begin(),
-                                  regionOffsetSizes.end(), (size_t)0,
-        [](size_t s, const std::pair<size_t, size_t>& segment) {
-            return s + segment.second;
-        });
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).write(forwarded, layout, data, persist, req);
+    size_t size = layout.size();
     if(size >= self->m_eager_write_threshold) {
         auto bulk = self->m_client->m_engine.expose(
                 {{const_cast<char*>(data), size}}, tl::bulk_mode::read_only);
-        write(region, regionOffsetSizes, std::move(bulk), "", 0, persist, req);
+        write(region, layout, std::move(bulk), "", 0, persist, req);
         return;
     }
     // eager path
-    auto& rpc = self->m_client->m_write_eager;
+    invalidateCached(*self, region);
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
     auto buffer = BufferWrapper::Ref(data, size);
-    auto async_response = rpc.on(ph).async(region, regionOffsetSizes, buffer, persist);
+    std::shared_ptr<Layout> exposed;
+    auto& sent = sendableLayout(client, layout, exposed);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_write_eager_v2.on(ph).async(
+            RequestHeader{client.nextRequestID(), region, persist}, CompactLayout{sent}, buffer)
+        : client.m_write_eager.on(ph).async(
+            client.nextRequestID(), region, sent, buffer, persist);
     if(req == nullptr) { // synchronous call
-        Result<bool> response = async_response.wait();
+        CodedResult<bool> response = waitForResult<bool>(async_response, client, start, nullptr, compact);
+        if(learnForward(*self, region, response))
+            return write(region, layout, data, persist, req);
         response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [](AsyncRequestImpl& async_request_impl) {
-                Result<bool> response = async_request_impl.m_async_response.wait();
-                response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        async_request_impl->m_keepalive = std::move(exposed);
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -141,22 +607,47 @@ void TargetHandle::write(const RegionID& region,
                          size_t bulkOffset,
                          bool persist,
                          AsyncRequest* req) const
+{
+    write(region, Layout::fromSegments(regionOffsetSizes),
+          std::move(data), address, bulkOffset, persist, req);
+}
+
+void TargetHandle::write(const RegionID& region,
+                         const Layout& layout,
+                         thallium::bulk data,
+                         const std::string& address,
+                         size_t bulkOffset,
+                         bool persist,
+                         AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    auto& rpc = self->m_client->m_write;
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).write(forwarded, layout, std::move(data), address, bulkOffset, persist, req);
+    invalidateCached(*self, region);
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(region, regionOffsetSizes, data, address, bulkOffset, persist);
+    std::shared_ptr<Layout> exposed;
+    auto& sent = sendableLayout(client, layout, exposed);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_write_v2.on(ph).async(
+            RequestHeader{client.nextRequestID(), region, persist}, CompactLayout{sent},
+            BulkLocation{data, address, bulkOffset})
+        : client.m_write.on(ph).async(
+            client.nextRequestID(), region, sent, data, address, bulkOffset, persist);
     if(req == nullptr) { // synchronous call
-        Result<bool> response = async_response.wait();
+        CodedResult<bool> response = waitForResult<bool>(async_response, client, start, nullptr, compact);
+        if(learnForward(*self, region, response))
+            return write(region, layout, std::move(data), address, bulkOffset, persist, req);
         response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [](AsyncRequestImpl& async_request_impl) {
-                Result<bool> response = async_request_impl.m_async_response.wait();
-                response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        async_request_impl->m_keepalive = std::move(exposed);
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -171,22 +662,34 @@ void TargetHandle::persist(const RegionID& region,
 void TargetHandle::persist(const RegionID& region,
                            const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
                            AsyncRequest* req) const
+{
+    persist(region, Layout::fromSegments(regionOffsetSizes), req);
+}
+
+void TargetHandle::persist(const RegionID& region,
+                           const Layout& layout,
+                           AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).persist(forwarded, layout, req);
     auto& rpc = self->m_client->m_persist;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(region, regionOffsetSizes);
+    std::shared_ptr<Layout> exposed;
+    auto& sent = sendableLayout(*self->m_client, layout, exposed);
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(self->m_client->nextRequestID(), region, sent);
     if(req == nullptr) { // synchronous call
-        Result<bool> response = async_response.wait();
+        CodedResult<bool> response = waitForResult<bool>(async_response, *self->m_client, start);
+        if(learnForward(*self, region, response))
+            return persist(region, layout, req);
         response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [](AsyncRequestImpl& async_request_impl) {
-                Result<bool> response = async_request_impl.m_async_response.wait();
-                response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        async_request_impl->m_keepalive = std::move(exposed);
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -206,21 +709,19 @@ void TargetHandle::createAndWrite(RegionID* region,
     // eager path
     auto& rpc = self->m_client->m_create_write_eager;
     auto& ph  = self->m_ph;
+    auto start = traceClock();
     auto async_response = rpc.on(ph).async(
+        self->m_client->nextRequestID(),
         BufferWrapper::Ref(data, size), persist);
     if(req == nullptr) { // synchronous call
-        Result<RegionID> response = async_response.wait();
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, *self->m_client, start);
         if(region) *region = std::move(response).valueOrThrow();
         else response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [region](AsyncRequestImpl& async_request_impl) {
-                Result<RegionID> response = async_request_impl.m_async_response.wait();
-                if(region) *region = std::move(response).valueOrThrow();
-                else response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Region);
+        async_request_impl->m_region = region;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -236,20 +737,282 @@ void TargetHandle::createAndWrite(
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
     auto& rpc = self->m_client->m_create_write;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(data, address, bulkOffset, size, persist);
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(self->m_client->nextRequestID(), data, address, bulkOffset, size, persist);
     if(req == nullptr) { // synchronous call
-        Result<RegionID> response = async_response.wait();
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, *self->m_client, start);
         if(region) *region = std::move(response).valueOrThrow();
         else response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [region](AsyncRequestImpl& async_request_impl) {
-                Result<RegionID> response = async_request_impl.m_async_response.wait();
-                if(region) *region = std::move(response).valueOrThrow();
-                else response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Region);
+        async_request_impl->m_region = region;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::append(const RegionID& region,
+                          const char* data, size_t size,
+                          size_t* offset,
+                          bool persist,
+                          AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).append(forwarded, data, size, offset, persist, req);
+    if(size >= self->m_eager_write_threshold) {
+        auto bulk = self->m_client->m_engine.expose(
+                {{const_cast<char*>(data), size}}, tl::bulk_mode::read_only);
+        append(region, std::move(bulk), "", 0, size, offset, persist, req);
+        return;
+    }
+    // eager path
+    invalidateCached(*self, region);
+    auto& rpc = self->m_client->m_append_eager;
+    auto& ph  = self->m_ph;
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(
+        self->m_client->nextRequestID(), region,
+        BufferWrapper::Ref(data, size), persist);
+    if(req == nullptr) { // synchronous call
+        CodedResult<size_t> response = waitForResult<size_t>(async_response, *self->m_client, start);
+        if(learnForward(*self, region, response))
+            return append(region, data, size, offset, persist, req);
+        if(offset) *offset = std::move(response).valueOrThrow();
+        else response.check();
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Offset);
+        async_request_impl->m_offset = offset;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::append(const RegionID& region,
+                          thallium::bulk data,
+                          const std::string& address,
+                          size_t bulkOffset, size_t size,
+                          size_t* offset,
+                          bool persist,
+                          AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).append(forwarded, std::move(data), address, bulkOffset, size, offset, persist, req);
+    invalidateCached(*self, region);
+    auto& rpc = self->m_client->m_append;
+    auto& ph  = self->m_ph;
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(
+        self->m_client->nextRequestID(), region, data, address, bulkOffset, size, persist);
+    if(req == nullptr) { // synchronous call
+        CodedResult<size_t> response = waitForResult<size_t>(async_response, *self->m_client, start);
+        if(learnForward(*self, region, response))
+            return append(region, std::move(data), address, bulkOffset, size, offset, persist, req);
+        if(offset) *offset = std::move(response).valueOrThrow();
+        else response.check();
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Offset);
+        async_request_impl->m_offset = offset;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::atomic(const RegionID& region, size_t offset,
+                          AtomicOp op, size_t width,
+                          const void* operand, const void* compare,
+                          void* previous,
+                          bool persist,
+                          AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(width != 8 && width != 16)
+        throw Exception("Atomic operations apply to words of 8 or 16 bytes");
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).atomic(forwarded, offset, op, width, operand, compare, previous, persist, req);
+    invalidateCached(*self, region);
+    char operands[32];
+    size_t numOperands = op == AtomicOp::CompareSwap ? 2 : 1;
+    std::memcpy(operands, operand, width);
+    if(numOperands == 2) std::memcpy(operands + width, compare, width);
+    auto& rpc = self->m_client->m_atomic;
+    auto& ph  = self->m_ph;
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(
+        self->m_client->nextRequestID(), region, offset,
+        static_cast<uint8_t>(op), static_cast<uint8_t>(width),
+        BufferWrapper::Ref(operands, numOperands * width), persist);
+    if(req == nullptr) { // synchronous call
+        CodedResult<BufferWrapper> response = waitForResult<BufferWrapper>(
+            async_response, *self->m_client, start);
+        if(learnForward(*self, region, response))
+            return atomic(region, offset, op, width, operand, compare, previous, persist, req);
+        response.check();
+        if(previous) std::memcpy(previous, response.value().data(), width);
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::EagerRead);
+        async_request_impl->m_data = static_cast<char*>(previous);
+        async_request_impl->m_size = previous ? width : 0;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+uint64_t TargetHandle::atomic(const RegionID& region, size_t offset,
+                              AtomicOp op, uint64_t operand,
+                              uint64_t compare,
+                              bool persist) const
+{
+    uint64_t previous = 0;
+    atomic(region, offset, op, sizeof(operand), &operand, &compare, &previous, persist);
+    return previous;
+}
+
+void TargetHandle::resize(RegionID* region, size_t size,
+                          AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(!region) throw Exception("Invalid RegionID pointer passed to resize");
+    // a migrated region keeps its RegionID in this handle, only its forward changes
+    RegionID forwarded;
+    auto target = resolveForward(*self, *region, forwarded);
+    auto& th = target ? *target : *self;
+    const RegionID& sent = target ? forwarded : *region;
+    invalidateCached(th, sent);
+    auto& rpc = self->m_client->m_resize;
+    auto start = traceClock();
+    auto async_response = rpc.on(th.m_ph).async(
+        self->m_client->nextRequestID(), sent, size);
+    if(req == nullptr) { // synchronous call
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, *self->m_client, start);
+        if(learnForward(th, sent, response))
+            return resize(region, size, req);
+        auto& resized = response.valueOrThrow();
+        if(target) self->addForward(*region, target, resized);
+        else *region = resized;
+    } else if(target) { // asynchronous call on a migrated region
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Forward);
+        async_request_impl->m_keepalive = std::make_shared<ForwardedRegion>(
+            ForwardedRegion{self, target, *region});
+        *req = AsyncRequest(std::move(async_request_impl));
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Region);
+        async_request_impl->m_region = region;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::copy(const RegionID& source, size_t sourceOffset,
+                        const RegionID& dest, size_t destOffset,
+                        size_t size,
+                        AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    RegionID forwardedSource, forwardedDest;
+    auto sourceTarget = resolveForward(*self, source, forwardedSource);
+    auto destTarget   = resolveForward(*self, dest, forwardedDest);
+    auto& th = sourceTarget ? *sourceTarget : *self;
+    if(th.m_name != (destTarget ? *destTarget : *self).m_name)
+        throw Exception("Cannot copy between regions that were migrated to different providers");
+    const RegionID& sentSource = sourceTarget ? forwardedSource : source;
+    const RegionID& sentDest   = destTarget ? forwardedDest : dest;
+    invalidateCached(th, sentDest);
+    auto& rpc = self->m_client->m_copy;
+    auto start = traceClock();
+    auto async_response = rpc.on(th.m_ph).async(
+        self->m_client->nextRequestID(), sentSource, sourceOffset, sentDest, destOffset, size);
+    if(req == nullptr) { // synchronous call
+        CodedResult<bool> response = waitForResult<bool>(async_response, *self->m_client, start);
+        if(response.code == ErrorCode::Moved) {
+            // either region may be the one that moved
+            bool sourceMoved = learnForward(th, sentSource);
+            bool destMoved   = learnForward(th, sentDest);
+            if(sourceMoved || destMoved)
+                return copy(source, sourceOffset, dest, destOffset, size, req);
+        }
+        response.check();
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::clone(const RegionID& region, RegionID* clone,
+                         AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    // the clone of a migrated region is created in the target it was
+    // migrated to, and this handle forwards the requests for it there
+    RegionID forwarded;
+    auto target = resolveForward(*self, region, forwarded);
+    auto& th = target ? *target : *self;
+    const RegionID& sent = target ? forwarded : region;
+    auto& rpc = self->m_client->m_clone;
+    auto start = traceClock();
+    auto async_response = rpc.on(th.m_ph).async(
+        self->m_client->nextRequestID(), sent);
+    if(req == nullptr) { // synchronous call
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, *self->m_client, start);
+        if(learnForward(th, sent, response))
+            return this->clone(region, clone, req);
+        auto& cloned = response.valueOrThrow();
+        if(target) self->addForward(cloned, target, cloned);
+        if(clone) *clone = cloned;
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            target ? AsyncRequestImpl::Completion::Forward
+                   : AsyncRequestImpl::Completion::Region);
+        if(target)
+            async_request_impl->m_keepalive = std::make_shared<ForwardedRegion>(
+                ForwardedRegion{self, target, std::nullopt});
+        async_request_impl->m_region = clone;
+        *req = AsyncRequest(std::move(async_request_impl));
+    }
+}
+
+void TargetHandle::transfer(const RegionID& region, size_t size,
+                            const TargetHandle& dest, RegionID* destRegion,
+                            bool persist,
+                            AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(not dest.self) throw Exception("Invalid destination warabi::TargetHandle object");
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).transfer(forwarded, size, dest, destRegion, persist, req);
+    auto& rpc = self->m_client->m_transfer;
+    auto& ph  = self->m_ph;
+    auto start = traceClock();
+    auto async_response = rpc.on(ph).async(
+        self->m_client->nextRequestID(), region, size,
+        static_cast<std::string>(dest.self->m_ph),
+        dest.self->m_ph.provider_id(), persist);
+    if(req == nullptr) { // synchronous call
+        CodedResult<RegionID> response = waitForResult<RegionID>(async_response, *self->m_client, start);
+        if(learnForward(*self, region, response))
+            return transfer(region, size, dest, destRegion, persist, req);
+        if(destRegion) *destRegion = std::move(response).valueOrThrow();
+        else response.check();
+    } else { // asynchronous call
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Region);
+        async_request_impl->m_region = destRegion;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -268,38 +1031,71 @@ void TargetHandle::read(
         const std::vector<std::pair<size_t, size_t>>& regionOffsetSizes,
         char* data,
         AsyncRequest* req) const
+{
+    read(region, Layout::fromSegments(regionOffsetSizes), data, req);
+}
+
+void TargetHandle::read(
+        const RegionID& region,
+        const Layout& layout,
+        char* data,
+        AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    size_t size = std::accumulate(regionOffsetSizes.begin(),
-                                  regionOffsetSizes.end(), (size_t)0,
-        [](size_t s, const std::pair<size_t, size_t>& segment) {
-            return s + segment.second;
-        });
+    size_t size = layout.size();
+    bool contiguous = layout.kind() == Layout::Kind::Contiguous;
+    // prefetched ranges stay with this handle when their region moves
+    if(contiguous && req == nullptr
+    && self->m_prefetch_active.load(std::memory_order_relaxed)) {
+        auto offset = layout.offset();
+        auto served = prefetchedRead(*self, region, offset, data, size);
+        if(served == size) return;
+        if(served != 0) {
+            read(region, offset + served, data + served, size - served);
+            return;
+        }
+    }
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).read(forwarded, layout, data, req);
+    if(contiguous && useReadCache(*self, size, req)) {
+        if(!cachedRead(*self, region, layout.offset(), data, size))
+            return read(region, layout, data, req);
+        return;
+    }
     if(size >= self->m_eager_read_threshold) {
         auto bulk = self->m_client->m_engine.expose({{data, size}}, tl::bulk_mode::write_only);
-        read(region, regionOffsetSizes, std::move(bulk), "", 0, req);
+        read(region, layout, std::move(bulk), "", 0, req);
         return;
     }
     // eager path
-    auto& rpc = self->m_client->m_read_eager;
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(region, regionOffsetSizes);
+    std::shared_ptr<Layout> exposed;
+    auto& sent = sendableLayout(client, layout, exposed);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_read_eager_v2.on(ph).async(
+            RequestHeader{client.nextRequestID(), region}, CompactLayout{sent})
+        : client.m_read_eager.on(ph).async(client.nextRequestID(), region, sent);
     if(req == nullptr) { // synchronous call
-        Result<BufferWrapper> response = async_response.wait();
+        CodedResult<BufferWrapper> response = waitForResult<BufferWrapper>(
+            async_response, client, start, nullptr, compact);
+        if(learnForward(*self, region, response))
+            return read(region, layout, data, req);
         response.check();
         // TODO we are forced to do a copy here, ideally thallium's packed_data
         // should give us a way to deserialize directly into an existing BufferWrapper
         std::memcpy(data, response.value().data(), size);
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [data, size](AsyncRequestImpl& async_request_impl) {
-                Result<BufferWrapper> response = async_request_impl.m_async_response.wait();
-                response.check();
-                // TODO same as above
-                std::memcpy(data, response.value().data(), size);
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::EagerRead);
+        async_request_impl->m_data = data;
+        async_request_impl->m_size = size;
+        async_request_impl->m_keepalive = std::move(exposed);
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
@@ -322,46 +1118,206 @@ void TargetHandle::read(
         const std::string& address,
         size_t bulkOffset,
         AsyncRequest* req) const
+{
+    read(region, Layout::fromSegments(regionOffsetSizes),
+         std::move(data), address, bulkOffset, req);
+}
+
+void TargetHandle::read(
+        const RegionID& region,
+        const Layout& layout,
+        thallium::bulk data,
+        const std::string& address,
+        size_t bulkOffset,
+        AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    auto& rpc = self->m_client->m_read;
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).read(forwarded, layout, std::move(data), address, bulkOffset, req);
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(region, regionOffsetSizes, data, address, bulkOffset);
+    std::shared_ptr<Layout> exposed;
+    auto& sent = sendableLayout(client, layout, exposed);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_read_v2.on(ph).async(
+            RequestHeader{client.nextRequestID(), region}, CompactLayout{sent},
+            BulkLocation{data, address, bulkOffset})
+        : client.m_read.on(ph).async(
+            client.nextRequestID(), region, sent, data, address, bulkOffset);
     if(req == nullptr) { // synchronous call
-        Result<bool> response = async_response.wait();
+        CodedResult<bool> response = waitForResult<bool>(async_response, client, start, nullptr, compact);
+        if(learnForward(*self, region, response))
+            return read(region, layout, std::move(data), address, bulkOffset, req);
         response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [](AsyncRequestImpl& async_request_impl) {
-                Result<bool> response = async_request_impl.m_async_response.wait();
-                response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        async_request_impl->m_keepalive = std::move(exposed);
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
 
+void TargetHandle::write(const RegionID& region,
+                         size_t regionOffset,
+                         const RegisteredBuffer& data,
+                         bool persist,
+                         AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(data.size() < self->m_eager_write_threshold) {
+        write(region, regionOffset, data.data(), data.size(), persist, req);
+        return;
+    }
+    write(region, regionOffset, data.bulk(), "", 0, data.size(), persist, req);
+}
+
+void TargetHandle::read(const RegionID& region,
+                        size_t regionOffset,
+                        const RegisteredBuffer& data,
+                        AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    bool prefetching = req == nullptr && self->m_prefetch_active.load(std::memory_order_relaxed);
+    if(data.size() < self->m_eager_read_threshold || prefetching
+    || useReadCache(*self, data.size(), req)) {
+        read(region, regionOffset, data.data(), data.size(), req);
+        return;
+    }
+    read(region, regionOffset, data.bulk(), "", 0, data.size(), req);
+}
+
+void TargetHandle::writeGather(const RegionID& region,
+                               size_t regionOffset,
+                               const std::vector<std::pair<const char*, size_t>>& segments,
+                               bool persist,
+                               AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(segments.size() == 1) {
+        write(region, regionOffset, segments[0].first, segments[0].second, persist, req);
+        return;
+    }
+    size_t size = 0;
+    for(auto& segment : segments) size += segment.second;
+    if(size < self->m_eager_write_threshold) {
+        // the eager path copies the data into the RPC anyway,
+        // and serializes the arguments when the RPC is issued
+        std::vector<char> buffer;
+        buffer.reserve(size);
+        for(auto& segment : segments)
+            buffer.insert(buffer.end(), segment.first, segment.first + segment.second);
+        write(region, regionOffset, buffer.data(), size, persist, req);
+        return;
+    }
+    std::vector<std::pair<void*, size_t>> bulkSegments;
+    bulkSegments.reserve(segments.size());
+    for(auto& segment : segments)
+        bulkSegments.emplace_back(const_cast<char*>(segment.first), segment.second);
+    auto bulk = self->m_client->m_engine.expose(bulkSegments, tl::bulk_mode::read_only);
+    write(region, regionOffset, std::move(bulk), "", 0, size, persist, req);
+}
+
+void TargetHandle::readScatter(const RegionID& region,
+                               size_t regionOffset,
+                               const std::vector<std::pair<char*, size_t>>& segments,
+                               AsyncRequest* req) const
+{
+    if(not self) throw Exception("Invalid warabi::TargetHandle object");
+    if(segments.empty()) {
+        read(region, regionOffset, nullptr, 0, req);
+        return;
+    }
+    if(segments.size() == 1) {
+        read(region, regionOffset, segments[0].first, segments[0].second, req);
+        return;
+    }
+    size_t size = 0;
+    std::vector<std::pair<void*, size_t>> bulkSegments;
+    bulkSegments.reserve(segments.size());
+    for(auto& segment : segments) {
+        bulkSegments.emplace_back(segment.first, segment.second);
+        size += segment.second;
+    }
+    auto bulk = self->m_client->m_engine.expose(bulkSegments, tl::bulk_mode::write_only);
+    read(region, regionOffset, std::move(bulk), "", 0, size, req);
+}
+
 void TargetHandle::erase(const RegionID& region,
                          AsyncRequest* req) const
 {
     if(not self) throw Exception("Invalid warabi::TargetHandle object");
-    auto& rpc = self->m_client->m_erase;
+    RegionID forwarded;
+    if(auto target = findForward(*self, region, forwarded))
+        return TargetHandle(target).erase(forwarded, req);
+    invalidateCached(*self, region);
+    auto& client = *self->m_client;
     auto& ph  = self->m_ph;
-    auto async_response = rpc.on(ph).async(region);
+    bool compact = useCompactProtocol(*self, req == nullptr);
+    auto start = traceClock();
+    auto async_response = compact
+        ? client.m_erase_v2.on(ph).async(RequestHeader{client.nextRequestID(), region})
+        : client.m_erase.on(ph).async(client.nextRequestID(), region);
     if(req == nullptr) { // synchronous call
-        Result<bool> response = async_response.wait();
+        CodedResult<bool> response = waitForResult<bool>(async_response, client, start, nullptr, compact);
+        if(learnForward(*self, region, response))
+            return erase(region, req);
         response.check();
     } else { // asynchronous call
-        auto async_request_impl =
-            std::make_shared<AsyncRequestImpl>(std::move(async_response));
-        async_request_impl->m_wait_callback =
-            [](AsyncRequestImpl& async_request_impl) {
-                Result<bool> response = async_request_impl.m_async_response.wait();
-                response.check();
-            };
+        auto async_request_impl = AsyncRequestImpl::make(
+            std::move(async_response), self->m_client, start,
+            AsyncRequestImpl::Completion::Check);
+        async_request_impl->m_compact = compact;
         *req = AsyncRequest(std::move(async_request_impl));
     }
 }
 
+AsyncRequest TargetHandle::createAsync(RegionID* region, size_t size) const {
+    AsyncRequest req;
+    create(region, size, &req);
+    return req;
+}
+
+AsyncRequest TargetHandle::writeAsync(const RegionID& region,
+                                      size_t regionOffset,
+                                      const char* data, size_t size,
+                                      bool persist) const {
+    AsyncRequest req;
+    write(region, regionOffset, data, size, persist, &req);
+    return req;
+}
+
+AsyncRequest TargetHandle::persistAsync(const RegionID& region,
+                                        size_t offset, size_t size) const {
+    AsyncRequest req;
+    persist(region, offset, size, &req);
+    return req;
+}
+
+AsyncRequest TargetHandle::createAndWriteAsync(RegionID* region,
+                                               const char* data, size_t size,
+                                               bool persist) const {
+    AsyncRequest req;
+    createAndWrite(region, data, size, persist, &req);
+    return req;
+}
+
+AsyncRequest TargetHandle::readAsync(const RegionID& region,
+                                     size_t regionOffset,
+                                     char* data, size_t size) const {
+    AsyncRequest req;
+    read(region, regionOffset, data, size, &req);
+    return req;
+}
+
+AsyncRequest TargetHandle::eraseAsync(const RegionID& region) const {
+    AsyncRequest req;
+    erase(region, &req);
+    return req;
+}
+
 }
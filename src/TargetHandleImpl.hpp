@@ -8,27 +8,147 @@
 
 #include <thallium.hpp>
 #include "ClientImpl.hpp"
+#include "AsyncRequestImpl.hpp"
+#include "BufferPoolImpl.hpp"
+#include "RegionFilter.hpp"
+#include <atomic>
+#include <deque>
+#include <limits>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
 
 namespace tl = thallium;
 
 namespace warabi {
 
+/**
+ * @brief Range of a region read ahead of the application into a buffer
+ * of the client's pool (see TargetHandle::prefetch).
+ */
+struct PrefetchedRange {
+
+    enum class Status { Pending, Ready, Failed, Moved };
+
+    RegionID                              region;
+    size_t                                offset = 0;
+    size_t                                size   = 0;
+    bool                                  readahead = false;
+    bool                                  forwarded = false; // sent to the new location of the region
+    std::shared_ptr<RegisteredBufferImpl> buffer;  // null until issued
+    std::shared_ptr<AsyncRequestImpl>     request; // null until issued
+    tl::mutex                             mtx;
+    Status                                status = Status::Pending;
+
+    const char* data() const {
+        return buffer->m_block.memory.get();
+    }
+
+    /**
+     * @brief Wait for the range to be transferred.
+     * Returns whether the transfer succeeded.
+     */
+    bool wait() {
+        std::lock_guard<tl::mutex> lock{mtx};
+        if(status == Status::Pending) {
+            try {
+                request->complete();
+                status = Status::Ready;
+            } catch(const std::exception&) {
+                status = request->m_code == ErrorCode::Moved
+                       ? Status::Moved : Status::Failed;
+            }
+        }
+        return status == Status::Ready;
+    }
+};
+
 class TargetHandleImpl {
 
     public:
 
     std::shared_ptr<ClientImpl> m_client;
     tl::provider_handle         m_ph;
+    std::string                 m_name; // identifies the target in the read cache
 
     size_t m_eager_write_threshold = 2048;
     size_t m_eager_read_threshold = 2048;
 
+    // version of the wire protocol used with the provider, 0 until negotiated
+    std::atomic<uint16_t>             m_protocol{0};
+    tl::mutex                         m_protocol_mtx;
+    std::optional<tl::async_response> m_handshake; // warabi_get_protocol_version in flight
+
+    // prefetching and sequential readahead (protected by m_prefetch_mtx)
+    tl::mutex                                     m_prefetch_mtx;
+    std::atomic<bool>                             m_prefetch_active{false};
+    std::deque<std::shared_ptr<PrefetchedRange>>  m_prefetched;       // issued, in order
+    std::deque<std::shared_ptr<PrefetchedRange>>  m_prefetch_queue;   // not issued yet
+    std::vector<std::shared_ptr<PrefetchedRange>> m_prefetch_retired; // dropped while in flight
+    size_t   m_prefetch_depth = 4;
+    size_t   m_readahead_size = 0; // 0 disables sequential readahead
+    RegionID m_last_region = {};
+    size_t   m_last_end = 0;
+    size_t   m_readahead_end = 0;
+    size_t   m_readahead_limit = std::numeric_limits<size_t>::max();
+
+    // regions that the client learned were migrated to another provider
+    struct Forward {
+        std::shared_ptr<TargetHandleImpl> target;
+        RegionID                          region;
+    };
+    tl::mutex                   m_forwards_mtx;
+    RegionFilter<64>            m_forwards_filter; // requests for other regions skip the lock
+    std::map<RegionID, Forward> m_forwards;
+
     TargetHandleImpl() = default;
 
+    /**
+     * @brief Redirect the requests for region to the specified
+     * region of the target it was migrated to.
+     */
+    void addForward(const RegionID& region,
+                    std::shared_ptr<TargetHandleImpl> target,
+                    const RegionID& forwarded) {
+        std::lock_guard<tl::mutex> lock{m_forwards_mtx};
+        auto inserted = m_forwards.insert_or_assign(
+            region, Forward{std::move(target), forwarded});
+        if(inserted.second) m_forwards_filter.add(region);
+    }
+
     TargetHandleImpl(const std::shared_ptr<ClientImpl>& client,
                        tl::provider_handle&& ph)
     : m_client(client)
-    , m_ph(std::move(ph)) {}
+    , m_ph(std::move(ph))
+    , m_name(static_cast<std::string>(m_ph) + "#" + std::to_string(m_ph.provider_id())) {}
+
+    ~TargetHandleImpl() {
+        // the buffers of ranges still in flight are being written to
+        for(auto& range : m_prefetched)
+            if(range->request) range->wait();
+        for(auto& range : m_prefetch_retired)
+            range->wait();
+        if(m_handshake) {
+            try { m_handshake->wait(); } catch(const std::exception&) {}
+        }
+    }
+};
+
+/**
+ * @brief Forward to record when a request sent to the target a region
+ * was migrated to returns the RegionID of the region in that target
+ * (AsyncRequestImpl::Completion::Forward). Held by the m_keepalive
+ * of the request.
+ */
+struct ForwardedRegion {
+    std::shared_ptr<TargetHandleImpl> owner;  // handle the request was made on
+    std::shared_ptr<TargetHandleImpl> target; // target the region was migrated to
+    std::optional<RegionID>           region; // region to forward, the response itself if empty
+
+    void apply(const RegionID& forwarded) const {
+        owner->addForward(region ? *region : forwarded, target, forwarded);
+    }
 };
 
 }
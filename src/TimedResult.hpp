@@ -0,0 +1,86 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_TIMED_RESULT_HPP
+#define __WARABI_TIMED_RESULT_HPP
+
+#include "warabi/Result.hpp"
+#include "warabi/RequestTimings.hpp"
+#include "ErrorCode.hpp"
+#include "Tracing.hpp"
+#include <thallium.hpp>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Response of the RPCs that operate on regions: a Result
+ * followed by the (optional) server-side timings of the request
+ * and the ErrorCode of the result. This is the type clients
+ * deserialize responses into.
+ */
+template<typename T>
+struct TimedResult {
+
+    Result<T>      result;
+    RequestTimings timings;
+    ErrorCode      code = ErrorCode::Success;
+
+    template<typename Archive>
+    void serialize(Archive& a) {
+        a & result;
+        a & timings;
+        auto byte = static_cast<uint8_t>(code);
+        a & byte;
+        code = static_cast<ErrorCode>(byte);
+    }
+};
+
+/**
+ * @brief Equivalent of tl::auto_respond for handlers that respond
+ * with a TimedResult: sends the result along with the timings of
+ * the RequestTimer and its ErrorCode (see CodedResult) when the
+ * handler returns.
+ */
+template<typename ResultType>
+class TimedResponse {
+
+    struct Ref {
+
+        ResultType&    result;
+        RequestTimings timings;
+
+        template<typename Archive>
+        void serialize(Archive& a) {
+            auto code = static_cast<uint8_t>(errorCode(result));
+            a & result;
+            a & timings;
+            a & code;
+        }
+    };
+
+    const tl::request&  m_req;
+    ResultType&         m_result;
+    const RequestTimer& m_timer;
+
+    public:
+
+    TimedResponse(const tl::request& req, ResultType& result, const RequestTimer& timer)
+    : m_req(req)
+    , m_result(result)
+    , m_timer(timer) {}
+
+    ~TimedResponse() {
+        m_req.respond(Ref{m_result, m_timer.timings()});
+    }
+
+    TimedResponse(const TimedResponse&) = delete;
+    TimedResponse& operator=(const TimedResponse&) = delete;
+};
+
+}
+
+#endif
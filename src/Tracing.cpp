@@ -0,0 +1,121 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "Tracing.hpp"
+#include "warabi/Exception.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+
+namespace warabi {
+
+static ABT_key traceContextKey() {
+    static ABT_key key = ABT_KEY_NULL;
+    static std::once_flag flag;
+    std::call_once(flag, []() { ABT_key_create(nullptr, &key); });
+    return key;
+}
+
+static TraceContext* currentTraceContextPtr() {
+    void* value = nullptr;
+    if(ABT_key_get(traceContextKey(), &value) != ABT_SUCCESS)
+        return nullptr;
+    return static_cast<TraceContext*>(value);
+}
+
+TraceContext currentTraceContext() {
+    auto context = currentTraceContextPtr();
+    return context ? *context : TraceContext{};
+}
+
+TraceContextGuard::TraceContextGuard(const TraceContext& context)
+: m_context(context) {
+    // staged spans of the parent ULT are not nested in those of this ULT
+    m_context.stage_span = nullptr;
+    if(!m_context.tracer && !m_context.stages) return;
+    void* previous = nullptr;
+    if(ABT_key_get(traceContextKey(), &previous) != ABT_SUCCESS) return;
+    m_previous = static_cast<TraceContext*>(previous);
+    m_active = ABT_key_set(traceContextKey(), &m_context) == ABT_SUCCESS;
+}
+
+TraceContextGuard::~TraceContextGuard() {
+    if(m_active) ABT_key_set(traceContextKey(), m_previous);
+}
+
+Tracer::Tracer(uint16_t provider_id, size_t events_per_xstream, size_t max_xstreams)
+: m_provider_id(provider_id)
+, m_events(events_per_xstream, max_xstreams)
+, m_epoch(traceClock()) {}
+
+void Tracer::record(const char* name, uint64_t request_id, uint64_t start, uint64_t end) {
+    m_events.record([&](TraceEvent& event, int32_t xstream) {
+        event.name       = name;
+        event.request_id = request_id;
+        event.start      = start - m_epoch;
+        event.duration   = end - start;
+        event.xstream    = xstream;
+    });
+}
+
+TraceSpan::TraceSpan(const char* name, TraceStage stage)
+: m_context(currentTraceContextPtr())
+, m_name(name)
+, m_stage(stage) {
+    if(!m_context) return;
+    if(!m_context->tracer && !m_context->stages) {
+        m_context = nullptr;
+        return;
+    }
+    m_start = traceClock();
+    if(m_stage != TraceStage::None && m_context->stages) {
+        m_parent = m_context->stage_span;
+        m_context->stage_span = this;
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if(!m_context) return;
+    auto end = traceClock();
+    if(m_context->tracer)
+        m_context->tracer->record(m_name, m_context->request_id, m_start, end);
+    if(m_stage != TraceStage::None && m_context->stages) {
+        auto duration = end - m_start;
+        m_context->stages->add(m_stage, duration - std::min(m_child_ns, duration));
+        if(m_parent) m_parent->m_child_ns += duration;
+        m_context->stage_span = m_parent;
+    }
+}
+
+std::string Tracer::toChromeTrace() const {
+    fmt::memory_buffer out;
+    auto it = std::back_inserter(out);
+    fmt::format_to(it, "{{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    fmt::format_to(it,
+        "{{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":{},"
+        "\"args\":{{\"name\":\"warabi provider {}\"}}}}",
+        m_provider_id, m_provider_id);
+    m_events.forEach([&](const TraceEvent& e) {
+        if(!e.name) return;
+        fmt::format_to(it,
+            ",{{\"name\":\"{}\",\"cat\":\"warabi\",\"ph\":\"X\","
+            "\"ts\":{:.3f},\"dur\":{:.3f},\"pid\":{},\"tid\":{},"
+            "\"args\":{{\"request_id\":{}}}}}",
+            e.name, e.start/1000.0, e.duration/1000.0,
+            m_provider_id, e.xstream, e.request_id);
+    });
+    fmt::format_to(it, "]}}");
+    return fmt::to_string(out);
+}
+
+void Tracer::dump(const std::string& filename) const {
+    std::ofstream file(filename, std::ios::out | std::ios::trunc);
+    if(!file.good())
+        throw Exception{fmt::format("Could not open {} to write trace", filename)};
+    file << toChromeTrace();
+}
+
+}
@@ -0,0 +1,225 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_TRACING_HPP
+#define __WARABI_TRACING_HPP
+
+#include "warabi/RequestTimings.hpp"
+#include "XstreamRings.hpp"
+#include <abt.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace warabi {
+
+/**
+ * @brief Returns a monotonic timestamp in nanoseconds.
+ */
+inline uint64_t traceClock() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Stage of a request a span accounts for in RequestTimings.
+ */
+enum class TraceStage : uint8_t {
+    None,     // span is only recorded in the trace
+    Transfer, // RDMA transfers and waits for transfer buffers
+    Backend,  // calls into the backend
+    Persist   // flushes to durable storage
+};
+
+/**
+ * @brief Time spent by a request in each stage. The time of a span
+ * is exclusive of the time of the staged spans nested in it on the
+ * same ULT, so that a backend call that persists its data does not
+ * count its persist time twice. Spans of different ULTs working on
+ * the same request (e.g. in the pipeline transfer manager) add up,
+ * hence these values are cumulative and may exceed the duration of
+ * the request.
+ */
+struct StageTimes {
+    std::atomic<uint64_t> transfer_ns{0};
+    std::atomic<uint64_t> backend_ns{0};
+    std::atomic<uint64_t> persist_ns{0};
+
+    void add(TraceStage stage, uint64_t ns) {
+        switch(stage) {
+            case TraceStage::Transfer: transfer_ns.fetch_add(ns, std::memory_order_relaxed); break;
+            case TraceStage::Backend:  backend_ns.fetch_add(ns, std::memory_order_relaxed); break;
+            case TraceStage::Persist:  persist_ns.fetch_add(ns, std::memory_order_relaxed); break;
+            default: break;
+        }
+    }
+};
+
+/**
+ * @brief A single completed span, recorded when the span ends.
+ * The name must point to a string with static storage duration.
+ */
+struct TraceEvent {
+    const char* name       = nullptr;
+    uint64_t    request_id = 0;
+    uint64_t    start      = 0; // ns since the Tracer's creation
+    uint64_t    duration   = 0; // ns
+    int32_t     xstream    = 0;
+};
+
+/**
+ * @brief The Tracer records TraceEvents into one ring buffer per
+ * execution stream (see XstreamRings). The content of the rings
+ * can be converted into the Chrome trace JSON format (also understood
+ * by Perfetto).
+ */
+class Tracer {
+
+    uint16_t                 m_provider_id;
+    XstreamRings<TraceEvent> m_events;
+    uint64_t                 m_epoch;
+
+    public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param provider_id Provider id (used as the "pid" in the trace).
+     * @param events_per_xstream Capacity of each ring buffer.
+     * @param max_xstreams Number of ring buffers (execution streams
+     * with a rank greater than this share rings).
+     */
+    Tracer(uint16_t provider_id, size_t events_per_xstream, size_t max_xstreams);
+
+    /**
+     * @brief Record a completed span (start and end are traceClock() values).
+     */
+    void record(const char* name, uint64_t request_id, uint64_t start, uint64_t end);
+
+    /**
+     * @brief Convert the recorded events into a Chrome trace JSON string.
+     */
+    std::string toChromeTrace() const;
+
+    /**
+     * @brief Write the Chrome trace JSON into the specified file.
+     * Throws an Exception if the file cannot be written.
+     */
+    void dump(const std::string& filename) const;
+};
+
+/**
+ * @brief Tracing context of the calling ULT. The context is stored
+ * in an Argobots key so that it follows the ULT (thread_local would
+ * follow the execution stream, which is shared by many requests).
+ */
+class TraceSpan;
+struct TraceContext {
+    Tracer*     tracer     = nullptr;
+    StageTimes* stages     = nullptr;
+    uint64_t    request_id = 0;
+    TraceSpan*  stage_span = nullptr; // innermost staged span of the ULT
+};
+
+/**
+ * @brief Returns the TraceContext of the calling ULT (an empty
+ * context if tracing is not active for this ULT).
+ */
+TraceContext currentTraceContext();
+
+/**
+ * @brief RAII object installing a TraceContext for the calling ULT
+ * and restoring the previous one when destroyed. ULTs spawned to
+ * process part of a request (e.g. by a TransferManager) should
+ * install the context of their parent using this class.
+ * Does nothing if the context has neither a tracer nor stage times.
+ */
+class TraceContextGuard {
+
+    TraceContext  m_context;
+    TraceContext* m_previous = nullptr;
+    bool          m_active   = false;
+
+    public:
+
+    TraceContextGuard(Tracer* tracer, StageTimes* stages, uint64_t request_id)
+    : TraceContextGuard(TraceContext{tracer, stages, request_id, nullptr}) {}
+
+    explicit TraceContextGuard(const TraceContext& context);
+
+    ~TraceContextGuard();
+
+    TraceContextGuard(const TraceContextGuard&) = delete;
+    TraceContextGuard& operator=(const TraceContextGuard&) = delete;
+};
+
+/**
+ * @brief RAII object recording a span covering its lifetime
+ * in the tracer of the calling ULT's context, if any, and
+ * accounting for its duration in the context's stage times
+ * if a stage is provided.
+ */
+class TraceSpan {
+
+    TraceContext* m_context;
+    const char*   m_name;
+    TraceStage    m_stage;
+    uint64_t      m_start    = 0;
+    uint64_t      m_child_ns = 0;
+    TraceSpan*    m_parent   = nullptr;
+
+    public:
+
+    explicit TraceSpan(const char* name, TraceStage stage = TraceStage::None);
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+};
+
+/**
+ * @brief Measures the server-side timings of a request.
+ * Does nothing if constructed with enabled = false.
+ */
+class RequestTimer {
+
+    uint64_t   m_start;
+    StageTimes m_stages;
+    bool       m_enabled;
+
+    public:
+
+    explicit RequestTimer(bool enabled)
+    : m_start(enabled ? traceClock() : 0)
+    , m_enabled(enabled) {}
+
+    /**
+     * @brief StageTimes to install in the request's TraceContext.
+     */
+    StageTimes* stages() {
+        return m_enabled ? &m_stages : nullptr;
+    }
+
+    /**
+     * @brief Timings of the request so far (not valid if disabled).
+     */
+    RequestTimings timings() const {
+        RequestTimings t;
+        if(!m_enabled) return t;
+        t.valid       = true;
+        t.handler_ns  = traceClock() - m_start;
+        t.transfer_ns = m_stages.transfer_ns.load(std::memory_order_relaxed);
+        t.backend_ns  = m_stages.backend_ns.load(std::memory_order_relaxed);
+        t.persist_ns  = m_stages.persist_ns.load(std::memory_order_relaxed);
+        return t;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,431 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_WIRE_PROTOCOL_HPP
+#define __WARABI_WIRE_PROTOCOL_HPP
+
+#include "warabi/Result.hpp"
+#include "warabi/RegionID.hpp"
+#include "warabi/Layout.hpp"
+#include "warabi/RequestTimings.hpp"
+#include "BufferWrapper.hpp"
+#include "TimedResult.hpp"
+#include <thallium.hpp>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+/*
+ * Version 2 of the wire protocol, used by the RPCs on the hot path
+ * (create, write, read, erase) when both sides support it. Compared
+ * with version 1, in which each argument and Result is serialized
+ * field by field:
+ * - requests start with a fixed-size binary RequestHeader;
+ * - layouts encode their parameters as varints, and the segments of
+ *   indexed layouts as deltas from the end of the previous segment;
+ * - bulk handles are sent with their (usually absent) address and a
+ *   varint offset in a BulkLocation;
+ * - responses carry a numeric ErrorCode, and a message only when the
+ *   error is not fully described by its code; a successful write is
+ *   acknowledged with a single byte.
+ *
+ * Clients ask providers for their version with warabi_get_protocol_version,
+ * which providers define since version 1. Providers keep serving the
+ * version 1 RPCs (named warabi_v1_*), so older clients keep working.
+ * Clients that predate request ids and layouts use the original names
+ * of these RPCs (warabi_create, warabi_write, ...), which providers serve
+ * with the original signatures. Clients do not fall back to these names:
+ * they need providers that are at least as recent as version 1.
+ */
+
+namespace warabi {
+
+namespace tl = thallium;
+
+constexpr uint16_t s_wire_protocol_version = 2;
+
+namespace varint {
+
+constexpr size_t s_max_size = 10;
+
+inline size_t encode(uint64_t value, uint8_t* out) {
+    size_t n = 0;
+    while(value >= 0x80) {
+        out[n++] = static_cast<uint8_t>(value) | 0x80;
+        value >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(value);
+    return n;
+}
+
+template<typename Archive>
+void write(Archive& ar, uint64_t value) {
+    uint8_t buf[s_max_size];
+    ar.write(reinterpret_cast<const char*>(buf), encode(value, buf));
+}
+
+template<typename Archive>
+uint64_t read(Archive& ar) {
+    uint64_t value = 0;
+    for(unsigned shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = 0;
+        ar.read(reinterpret_cast<char*>(&byte), 1);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) return value;
+    }
+    throw Exception("Invalid varint");
+}
+
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+}
+
+/**
+ * @brief Unsigned integer serialized as a varint.
+ */
+struct Varint {
+
+    uint64_t value = 0;
+
+    template<typename Archive>
+    void save(Archive& ar) const {
+        varint::write(ar, value);
+    }
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        value = varint::read(ar);
+    }
+};
+
+/**
+ * @brief Fixed-size header of the version 2 requests
+ * (9 bytes, 25 with a region).
+ */
+struct RequestHeader {
+
+    enum Flags : uint8_t {
+        HasRegion = 1,
+        Persist   = 2
+    };
+
+    uint8_t  flags      = 0;
+    uint64_t request_id = 0;
+    RegionID region{};
+
+    RequestHeader() = default;
+
+    explicit RequestHeader(uint64_t id)
+    : request_id(id) {}
+
+    RequestHeader(uint64_t id, const RegionID& r, bool persist = false)
+    : flags(HasRegion | (persist ? Persist : 0))
+    , request_id(id)
+    , region(r) {}
+
+    bool persist() const {
+        return flags & Persist;
+    }
+
+    template<typename Archive>
+    void save(Archive& ar) const {
+        char buf[1 + sizeof(request_id) + sizeof(region)];
+        size_t n = 1 + sizeof(request_id);
+        buf[0] = static_cast<char>(flags);
+        std::memcpy(buf + 1, &request_id, sizeof(request_id));
+        if(flags & HasRegion) {
+            std::memcpy(buf + n, region.data(), region.size());
+            n += region.size();
+        }
+        ar.write(buf, n);
+    }
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        char buf[1 + sizeof(request_id)];
+        ar.read(buf, sizeof(buf));
+        flags = static_cast<uint8_t>(buf[0]);
+        std::memcpy(&request_id, buf + 1, sizeof(request_id));
+        if(flags & HasRegion)
+            ar.read(reinterpret_cast<char*>(region.data()), region.size());
+    }
+};
+
+/**
+ * @brief Layout serialized with the encoding of the version 2 protocol.
+ * Senders wrap a reference to their Layout, receivers get their own.
+ */
+struct CompactLayout {
+
+    const Layout* ref = nullptr;
+    Layout        layout;
+
+    CompactLayout() = default;
+
+    explicit CompactLayout(const Layout& l)
+    : ref(&l) {}
+
+    template<typename Archive>
+    void save(Archive& ar) const {
+        const Layout& l = ref ? *ref : layout;
+        uint8_t kind = static_cast<uint8_t>(l.m_kind);
+        if(l.m_kind == Layout::Kind::Indexed) {
+            bool inlined = l.m_bulk.is_null();
+            // the low bit of the first byte tells whether segments follow
+            uint8_t head = static_cast<uint8_t>(kind << 1) | (inlined ? 1 : 0);
+            ar.write(reinterpret_cast<const char*>(&head), 1);
+            varint::write(ar, l.m_count);
+            if(!inlined) {
+                ar & l.m_bulk;
+                return;
+            }
+            size_t end = 0;
+            for(auto& s : l.m_segments) {
+                varint::write(ar, varint::zigzag(
+                    static_cast<int64_t>(s.first) - static_cast<int64_t>(end)));
+                varint::write(ar, s.second);
+                end = s.first + s.second;
+            }
+            return;
+        }
+        uint8_t head = static_cast<uint8_t>(kind << 1);
+        ar.write(reinterpret_cast<const char*>(&head), 1);
+        varint::write(ar, l.m_offset);
+        varint::write(ar, l.m_params.size());
+        for(auto p : l.m_params) varint::write(ar, p);
+    }
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        uint8_t head = 0;
+        ar.read(reinterpret_cast<char*>(&head), 1);
+        uint8_t kind = head >> 1;
+        if(kind > static_cast<uint8_t>(Layout::Kind::Indexed))
+            throw Exception("Invalid layout kind");
+        layout = Layout{};
+        layout.m_kind = static_cast<Layout::Kind>(kind);
+        if(layout.m_kind == Layout::Kind::Indexed) {
+            layout.m_count = varint::read(ar);
+            if(!(head & 1)) {
+                ar & layout.m_bulk;
+                return;
+            }
+            // a bogus count fails at the end of the message
+            // instead of allocating memory for it
+            layout.m_segments.reserve(std::min<size_t>(layout.m_count, Layout::s_inline_segments));
+            size_t end = 0;
+            for(size_t i = 0; i < layout.m_count; ++i) {
+                auto offset = end + varint::unzigzag(varint::read(ar));
+                auto size   = varint::read(ar);
+                layout.m_segments.emplace_back(offset, size);
+                end = offset + size;
+            }
+            return;
+        }
+        layout.m_offset = varint::read(ar);
+        auto numParams = varint::read(ar);
+        if(numParams == 0 || numParams > 256)
+            throw Exception("Invalid layout parameters");
+        layout.m_params.resize(numParams);
+        for(auto& p : layout.m_params) p = varint::read(ar);
+    }
+};
+
+/**
+ * @brief Bulk handle with the address of the process that exposed it
+ * (empty for the sender of the request) and an offset in the handle.
+ */
+struct BulkLocation {
+
+    tl::bulk    bulk;
+    std::string address;
+    uint64_t    offset = 0;
+
+    template<typename Archive>
+    void save(Archive& ar) const {
+        uint8_t hasAddress = address.empty() ? 0 : 1;
+        ar.write(reinterpret_cast<const char*>(&hasAddress), 1);
+        ar & bulk;
+        varint::write(ar, offset);
+        if(hasAddress) ar & address;
+    }
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        uint8_t hasAddress = 0;
+        ar.read(reinterpret_cast<char*>(&hasAddress), 1);
+        ar & bulk;
+        offset = varint::read(ar);
+        address.clear();
+        if(hasAddress) ar & address;
+    }
+};
+
+/**
+ * @brief Result of a version 2 handler, which selects CompactResponse
+ * as the response of the handler (see ResponseFor).
+ */
+template<typename T>
+class CompactResult : public CodedResult<T> {
+
+    public:
+
+    using CodedResult<T>::operator=;
+};
+
+namespace compact {
+
+template<typename Archive>
+void saveValue(Archive&, const bool&) {}
+
+template<typename Archive>
+void loadValue(Archive&, bool& value) { value = true; }
+
+template<typename Archive>
+void saveValue(Archive& ar, const RegionID& region) {
+    ar.write(reinterpret_cast<const char*>(region.data()), region.size());
+}
+
+template<typename Archive>
+void loadValue(Archive& ar, RegionID& region) {
+    ar.read(reinterpret_cast<char*>(region.data()), region.size());
+}
+
+template<typename Archive>
+void saveValue(Archive& ar, const BufferWrapper& buffer) {
+    varint::write(ar, buffer.size());
+    ar.write(buffer.data(), buffer.size());
+}
+
+template<typename Archive>
+void loadValue(Archive& ar, BufferWrapper& buffer) {
+    buffer.allocate(varint::read(ar));
+    if(buffer.size()) ar.read(buffer.data(), buffer.size());
+}
+
+enum ResponseFlags : uint8_t {
+    HasMessage = 1,
+    HasTimings = 2
+};
+
+}
+
+/**
+ * @brief Equivalent of TimedResponse for the version 2 handlers. The
+ * response starts with a byte holding the error code and 2 flags,
+ * followed by the error message and timings if present, and the value
+ * on success.
+ */
+template<typename ResultType>
+class CompactResponse {
+
+    struct Ref {
+
+        const ResultType&     result;
+        const RequestTimings& timings;
+
+        template<typename Archive>
+        void save(Archive& ar) const {
+            auto code = errorCode(result);
+            bool hasMessage = !result.success()
+                           && result.error() != errorMessage(code);
+            uint8_t head = static_cast<uint8_t>(static_cast<uint8_t>(code) << 2)
+                         | (hasMessage ? compact::HasMessage : 0)
+                         | (timings.valid ? compact::HasTimings : 0);
+            ar.write(reinterpret_cast<const char*>(&head), 1);
+            if(hasMessage) {
+                varint::write(ar, result.error().size());
+                ar.write(result.error().data(), result.error().size());
+            }
+            if(timings.valid) {
+                varint::write(ar, timings.handler_ns);
+                varint::write(ar, timings.transfer_ns);
+                varint::write(ar, timings.backend_ns);
+                varint::write(ar, timings.persist_ns);
+            }
+            if(result.success()) compact::saveValue(ar, result.value());
+        }
+    };
+
+    const tl::request&  m_req;
+    ResultType&         m_result;
+    const RequestTimer& m_timer;
+
+    public:
+
+    CompactResponse(const tl::request& req, ResultType& result, const RequestTimer& timer)
+    : m_req(req)
+    , m_result(result)
+    , m_timer(timer) {}
+
+    ~CompactResponse() {
+        auto timings = m_timer.timings();
+        m_req.respond(Ref{m_result, timings});
+    }
+
+    CompactResponse(const CompactResponse&) = delete;
+    CompactResponse& operator=(const CompactResponse&) = delete;
+};
+
+/**
+ * @brief Client-side counterpart of CompactResponse, deserializing
+ * a version 2 response into a TimedResult.
+ */
+template<typename T>
+struct CompactTimedResult {
+
+    TimedResult<T> timed;
+
+    template<typename Archive>
+    void load(Archive& ar) {
+        uint8_t flags = 0;
+        ar.read(reinterpret_cast<char*>(&flags), 1);
+        auto code = static_cast<ErrorCode>(flags >> 2);
+        auto& result = timed.result;
+        timed.code = code;
+        result.success() = code == ErrorCode::Success;
+        if(flags & compact::HasMessage) {
+            result.error().resize(varint::read(ar));
+            ar.read(&result.error()[0], result.error().size());
+        } else if(!result.success()) {
+            result.error() = errorMessage(code);
+        }
+        if(flags & compact::HasTimings) {
+            timed.timings.valid       = true;
+            timed.timings.handler_ns  = varint::read(ar);
+            timed.timings.transfer_ns = varint::read(ar);
+            timed.timings.backend_ns  = varint::read(ar);
+            timed.timings.persist_ns  = varint::read(ar);
+        }
+        if(result.success()) compact::loadValue(ar, result.value());
+    }
+};
+
+/**
+ * @brief Response type of a handler, depending on the type of its result.
+ */
+template<typename ResultType>
+struct ResponseFor {
+    using type = TimedResponse<ResultType>;
+};
+
+template<typename T>
+struct ResponseFor<CompactResult<T>> {
+    using type = CompactResponse<CompactResult<T>>;
+};
+
+template<typename ResultType>
+using ResponseOf = typename ResponseFor<ResultType>::type;
+
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include "WorkloadCapture.hpp"
+#include "warabi/Exception.hpp"
+#include <fmt/format.h>
+#include <algorithm>
+#include <cstring>
+#include <istream>
+#include <mutex>
+
+namespace warabi {
+
+/*
+ * Binary format (native endianness):
+ * - magic (8 bytes): "WRBCAPT1"
+ * - provider id (uint16_t)
+ * - records until the end of the file, each made of:
+ *   timestamp (uint64_t), duration (uint64_t), client (uint32_t),
+ *   operation (uint8_t), flags (uint8_t, 1 = persist, 2 = success),
+ *   region id (16 bytes), size (uint64_t), number of segments (uint32_t),
+ *   then offset and size (uint64_t each) of each segment
+ */
+static constexpr char CaptureMagic[8] = {'W','R','B','C','A','P','T','1'};
+
+enum CaptureFlags : uint8_t {
+    CapturePersist = 1,
+    CaptureSuccess = 2
+};
+
+template<typename T>
+static void appendValue(std::vector<char>& buffer, const T& value) {
+    auto p = reinterpret_cast<const char*>(&value);
+    buffer.insert(buffer.end(), p, p + sizeof(value));
+}
+
+template<typename T>
+static bool readValue(std::istream& in, T& value) {
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return static_cast<bool>(in);
+}
+
+const char* captureOpName(CaptureOp op) {
+    switch(op) {
+        case CaptureOp::Create:           return "create";
+        case CaptureOp::Write:            return "write";
+        case CaptureOp::WriteEager:       return "write_eager";
+        case CaptureOp::Persist:          return "persist";
+        case CaptureOp::CreateWrite:      return "create_write";
+        case CaptureOp::CreateWriteEager: return "create_write_eager";
+        case CaptureOp::Read:             return "read";
+        case CaptureOp::ReadEager:        return "read_eager";
+        case CaptureOp::Erase:            return "erase";
+        case CaptureOp::Append:           return "append";
+        case CaptureOp::AppendEager:      return "append_eager";
+        case CaptureOp::Atomic:           return "atomic";
+    }
+    return "unknown";
+}
+
+WorkloadCapture::WorkloadCapture(
+        uint16_t provider_id, const std::string& filename, size_t buffer_size)
+: m_buffer_size(std::max<size_t>(buffer_size, 1))
+, m_file(filename, std::ios::out | std::ios::trunc | std::ios::binary)
+, m_filename(filename)
+, m_epoch(0) {
+    if(!m_file.good())
+        throw Exception{fmt::format("Could not open {} to write workload capture", filename)};
+    m_file.write(CaptureMagic, sizeof(CaptureMagic));
+    m_file.write(reinterpret_cast<const char*>(&provider_id), sizeof(provider_id));
+    m_buffer.reserve(m_buffer_size);
+    m_epoch = now();
+    m_writer_xstream = tl::xstream::create();
+    m_writer = (*m_writer_xstream)->make_thread([this]() { writeBuffers(); });
+}
+
+WorkloadCapture::~WorkloadCapture() {
+    {
+        std::lock_guard<tl::mutex> lock{m_buffer_mtx};
+        flush();
+        m_stop = true;
+    }
+    m_buffer_cv.notify_one();
+    (*m_writer)->join();
+    (*m_writer_xstream)->join();
+}
+
+void WorkloadCapture::writeBuffers() {
+    std::unique_lock<tl::mutex> lock{m_buffer_mtx};
+    while(true) {
+        m_buffer_cv.wait(lock, [this]() { return m_stop || !m_full.empty(); });
+        if(m_full.empty()) break; // stopped, and everything was written
+        auto full = std::move(m_full);
+        m_full.clear();
+        lock.unlock();
+        for(auto& buffer : full)
+            m_file.write(buffer.data(), buffer.size());
+        m_file.flush();
+        lock.lock();
+    }
+}
+
+void WorkloadCapture::record(
+        CaptureOp op, uint64_t timestamp, uint64_t duration,
+        uint64_t request_id, bool persist, bool success,
+        const RegionID& region, uint64_t size,
+        const std::vector<std::pair<size_t, size_t>>* segments) {
+    uint32_t numSegments = segments ? static_cast<uint32_t>(segments->size()) : 0;
+    if(size == 0 && segments)
+        for(auto& s : *segments) size += s.second;
+    uint8_t flags = (persist ? CapturePersist : 0) | (success ? CaptureSuccess : 0);
+    {
+        std::lock_guard<tl::mutex> lock{m_buffer_mtx};
+        appendValue(m_buffer, timestamp);
+        appendValue(m_buffer, duration);
+        appendValue(m_buffer, static_cast<uint32_t>(request_id >> 40));
+        appendValue(m_buffer, static_cast<uint8_t>(op));
+        appendValue(m_buffer, flags);
+        m_buffer.insert(m_buffer.end(), region.begin(), region.end());
+        appendValue(m_buffer, size);
+        appendValue(m_buffer, numSegments);
+        for(uint32_t i = 0; i < numSegments; ++i) {
+            appendValue(m_buffer, static_cast<uint64_t>((*segments)[i].first));
+            appendValue(m_buffer, static_cast<uint64_t>((*segments)[i].second));
+        }
+        if(m_buffer.size() < m_buffer_size) return;
+        flush();
+    }
+    m_buffer_cv.notify_one();
+}
+
+void WorkloadCapture::flush() {
+    if(m_buffer.empty()) return;
+    m_full.push_back(std::move(m_buffer));
+    m_buffer = std::vector<char>{};
+    m_buffer.reserve(m_buffer_size);
+}
+
+std::vector<CaptureRecord> WorkloadCapture::load(std::istream& in, uint16_t& provider_id) {
+    char magic[sizeof(CaptureMagic)];
+    in.read(magic, sizeof(magic));
+    if(!in || std::memcmp(magic, CaptureMagic, sizeof(magic)) != 0)
+        throw Exception{"Invalid workload capture (wrong magic number)"};
+    if(!readValue(in, provider_id))
+        throw Exception{"Invalid or truncated workload capture"};
+    std::vector<CaptureRecord> records;
+    while(in.peek() != std::char_traits<char>::eof()) {
+        CaptureRecord r;
+        uint8_t  op, flags;
+        uint32_t numSegments;
+        bool ok = readValue(in, r.timestamp)
+               && readValue(in, r.duration)
+               && readValue(in, r.client)
+               && readValue(in, op)
+               && readValue(in, flags)
+               && readValue(in, r.region)
+               && readValue(in, r.size)
+               && readValue(in, numSegments);
+        if(!ok || op > static_cast<uint8_t>(CaptureOp::Atomic))
+            throw Exception{"Invalid or truncated workload capture"};
+        r.op      = static_cast<CaptureOp>(op);
+        r.persist = flags & CapturePersist;
+        r.success = flags & CaptureSuccess;
+        r.segments.resize(numSegments);
+        for(auto& s : r.segments) {
+            uint64_t offset, size;
+            if(!readValue(in, offset) || !readValue(in, size))
+                throw Exception{"Invalid or truncated workload capture"};
+            s = {offset, size};
+        }
+        records.push_back(std::move(r));
+    }
+    return records;
+}
+
+}
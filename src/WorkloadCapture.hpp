@@ -0,0 +1,195 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_WORKLOAD_CAPTURE_HPP
+#define __WARABI_WORKLOAD_CAPTURE_HPP
+
+#include "warabi/RegionID.hpp"
+#include "warabi/Layout.hpp"
+#include <thallium.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace warabi {
+
+namespace tl = thallium;
+
+/**
+ * @brief Type of operation recorded in a workload capture
+ * (one per RPC of the provider).
+ */
+enum class CaptureOp : uint8_t {
+    Create           = 0,
+    Write            = 1,
+    WriteEager       = 2,
+    Persist          = 3,
+    CreateWrite      = 4,
+    CreateWriteEager = 5,
+    Read             = 6,
+    ReadEager        = 7,
+    Erase            = 8,
+    Append           = 9,
+    AppendEager      = 10,
+    Atomic           = 11
+};
+
+/**
+ * @brief Name of a CaptureOp.
+ */
+const char* captureOpName(CaptureOp op);
+
+/**
+ * @brief Operation recorded in a workload capture.
+ */
+struct CaptureRecord {
+    uint64_t  timestamp = 0; // arrival, in ns since the capture started
+    uint64_t  duration  = 0; // time spent in the handler, in ns
+    uint32_t  client    = 0; // client tag (upper 24 bits of the request id)
+    CaptureOp op        = CaptureOp::Create;
+    bool      persist   = false;
+    bool      success   = false;
+    RegionID  region    = {}; // region accessed (or created)
+    uint64_t  size      = 0;  // size of the created region or bytes accessed
+    std::vector<std::pair<size_t, size_t>> segments; // offset/size in the region
+};
+
+/**
+ * @brief The WorkloadCapture writes a compact binary trace of every
+ * operation executed by a provider, to be replayed by warabi-replay.
+ * Unlike the Tracer and the EventLog, it does not drop records:
+ * records are appended to a buffer that is handed to a writer ULT
+ * when it exceeds a given size. The writer runs in its own execution
+ * stream, so that writing to the file does not block the handlers.
+ */
+class WorkloadCapture {
+
+    tl::mutex                     m_buffer_mtx;
+    tl::condition_variable        m_buffer_cv;
+    std::vector<char>             m_buffer;
+    std::deque<std::vector<char>> m_full; // buffers to write, in order
+    bool                          m_stop = false;
+    size_t                        m_buffer_size;
+    std::ofstream                 m_file;
+    std::string                   m_filename;
+    uint64_t                      m_epoch;
+
+    std::optional<tl::managed<tl::xstream>> m_writer_xstream;
+    std::optional<tl::managed<tl::thread>>  m_writer;
+
+    void writeBuffers();
+
+    public:
+
+    /**
+     * @brief Constructor. Throws an Exception if the file cannot be created.
+     *
+     * @param provider_id Provider id (written in the file header).
+     * @param filename File to write the capture into.
+     * @param buffer_size Size of the buffer at which records are written.
+     */
+    WorkloadCapture(uint16_t provider_id, const std::string& filename, size_t buffer_size);
+
+    /**
+     * @brief Destructor (writes the remaining records and stops the writer).
+     */
+    ~WorkloadCapture();
+
+    WorkloadCapture(const WorkloadCapture&) = delete;
+    WorkloadCapture& operator=(const WorkloadCapture&) = delete;
+
+    /**
+     * @brief Record an operation.
+     */
+    void record(CaptureOp op, uint64_t timestamp, uint64_t duration,
+                uint64_t request_id, bool persist, bool success,
+                const RegionID& region, uint64_t size,
+                const std::vector<std::pair<size_t, size_t>>* segments);
+
+    /**
+     * @brief Hand the buffered records to the writer.
+     * Must be called with m_buffer_mtx held.
+     */
+    void flush();
+
+    /**
+     * @brief Current time, in ns since the capture started.
+     */
+    uint64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count() - m_epoch;
+    }
+
+    /**
+     * @brief Read the records of a capture file, in the order they were
+     * recorded. Throws an Exception if the stream is not a valid capture.
+     *
+     * @param in Input stream.
+     * @param provider_id Set to the id of the provider that wrote it.
+     */
+    static std::vector<CaptureRecord> load(std::istream& in, uint16_t& provider_id);
+};
+
+/**
+ * @brief Records an operation in a WorkloadCapture (if any) when the
+ * handler returns. Handlers set the outcome of the operation as it
+ * becomes known.
+ */
+class CaptureScope {
+
+    WorkloadCapture*                              m_capture;
+    CaptureOp                                     m_op;
+    uint64_t                                      m_request_id;
+    uint64_t                                      m_start;
+    bool                                          m_persist;
+    const std::vector<std::pair<size_t, size_t>>* m_segments;
+    const Layout*                                 m_layout = nullptr;
+
+    public:
+
+    RegionID region  = {};
+    uint64_t size    = 0;
+    bool     success = false;
+
+    CaptureScope(WorkloadCapture* capture, CaptureOp op, uint64_t request_id, bool persist = false,
+                 const std::vector<std::pair<size_t, size_t>>* segments = nullptr)
+    : m_capture(capture)
+    , m_op(op)
+    , m_request_id(request_id)
+    , m_start(capture ? capture->now() : 0)
+    , m_persist(persist)
+    , m_segments(segments) {}
+
+    CaptureScope(WorkloadCapture* capture, CaptureOp op, uint64_t request_id, bool persist,
+                 const Layout& layout)
+    : CaptureScope(capture, op, request_id, persist) {
+        m_layout = &layout;
+    }
+
+    ~CaptureScope() {
+        if(!m_capture) return;
+        // layouts are only expanded when the workload is being captured
+        std::vector<std::pair<size_t, size_t>> segments;
+        if(m_layout && m_layout->valid()) {
+            segments   = m_layout->expand();
+            m_segments = &segments;
+        }
+        m_capture->record(m_op, m_start, m_capture->now() - m_start, m_request_id,
+                          m_persist, success, region, size, m_segments);
+    }
+
+    CaptureScope(const CaptureScope&) = delete;
+    CaptureScope& operator=(const CaptureScope&) = delete;
+};
+
+}
+
+#endif
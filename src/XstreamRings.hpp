@@ -0,0 +1,148 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#ifndef __WARABI_XSTREAM_RINGS_HPP
+#define __WARABI_XSTREAM_RINGS_HPP
+
+#include <abt.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace warabi {
+
+/**
+ * @brief Set of fixed-size ring buffers, one per execution stream,
+ * into which ULTs can record items without locking: recording an
+ * item consists of an atomic increment of the ring's head followed
+ * by the copy of the item into its slot. When a ring is full, the
+ * oldest items are overwritten. Rings are allocated lazily, the
+ * first time an execution stream records an item.
+ *
+ * Items are stored as atomic words guarded by a sequence number per
+ * slot (odd while the slot is written), so that reading the rings
+ * while items are being recorded gives a consistent snapshot, which
+ * skips the items being written. An item is dropped if its slot is
+ * still being written by a ULT that the ring lapped.
+ *
+ * @tparam T Type of item (must be default-constructible and
+ * trivially copyable).
+ */
+template<typename T>
+class XstreamRings {
+
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "XstreamRings items must be trivially copyable");
+
+    static constexpr size_t s_words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct Slot {
+        std::atomic<uint64_t>                      seq{0}; // 2*(index+1) once written
+        std::array<std::atomic<uint64_t>, s_words> words = {};
+    };
+
+    struct Ring {
+        std::atomic<uint64_t>   head{0};
+        std::unique_ptr<Slot[]> slots;
+    };
+
+    size_t                          m_capacity;
+    std::vector<std::atomic<Ring*>> m_rings;
+
+    Ring* ring(int32_t xstream) {
+        auto& slot = m_rings[static_cast<size_t>(xstream) % m_rings.size()];
+        auto r = slot.load(std::memory_order_acquire);
+        if(r) return r;
+        auto newRing = new Ring;
+        newRing->slots.reset(new Slot[m_capacity]);
+        if(slot.compare_exchange_strong(r, newRing, std::memory_order_acq_rel))
+            return newRing;
+        delete newRing; // another ULT installed the ring first
+        return r;
+    }
+
+    public:
+
+    /**
+     * @brief Constructor.
+     *
+     * @param items_per_xstream Capacity of each ring buffer.
+     * @param max_xstreams Number of ring buffers (execution streams
+     * with a rank greater than this share rings).
+     */
+    XstreamRings(size_t items_per_xstream, size_t max_xstreams)
+    : m_capacity(std::max<size_t>(items_per_xstream, 1))
+    , m_rings(std::max<size_t>(max_xstreams, 1)) {
+        for(auto& r : m_rings) r.store(nullptr);
+    }
+
+    ~XstreamRings() {
+        for(auto& r : m_rings) delete r.load();
+    }
+
+    XstreamRings(const XstreamRings&) = delete;
+    XstreamRings& operator=(const XstreamRings&) = delete;
+
+    /**
+     * @brief Claim a slot in the ring of the calling execution stream
+     * and call fill(T& item, int32_t xstream) on it. Threads that are
+     * not Argobots execution streams share the last ring.
+     */
+    template<typename F>
+    void record(F&& fill) {
+        int rank = 0;
+        if(ABT_self_get_xstream_rank(&rank) != ABT_SUCCESS)
+            rank = static_cast<int>(m_rings.size()) - 1;
+        T item{};
+        fill(item, static_cast<int32_t>(rank));
+        uint64_t words[s_words] = {};
+        std::memcpy(words, &item, sizeof(T));
+        auto r = ring(rank);
+        auto index = r->head.fetch_add(1, std::memory_order_relaxed);
+        auto& slot = r->slots[index % m_capacity];
+        auto seq = slot.seq.load(std::memory_order_relaxed);
+        if((seq & 1) || !slot.seq.compare_exchange_strong(
+                seq, 2*index + 1, std::memory_order_relaxed))
+            return;
+        std::atomic_thread_fence(std::memory_order_release);
+        for(size_t i = 0; i < s_words; ++i)
+            slot.words[i].store(words[i], std::memory_order_relaxed);
+        slot.seq.store(2*index + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Call f(const T&) on the items of each ring, oldest first.
+     */
+    template<typename F>
+    void forEach(F&& f) const {
+        for(auto& slot : m_rings) {
+            auto r = slot.load(std::memory_order_acquire);
+            if(!r) continue;
+            auto head  = r->head.load(std::memory_order_acquire);
+            auto first = head > m_capacity ? head - m_capacity : 0;
+            for(auto i = first; i < head; ++i) {
+                auto& slot = r->slots[i % m_capacity];
+                auto seq = slot.seq.load(std::memory_order_acquire);
+                if(seq != 2*i + 2) continue; // being written or overwritten
+                uint64_t words[s_words];
+                for(size_t w = 0; w < s_words; ++w)
+                    words[w] = slot.words[w].load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if(slot.seq.load(std::memory_order_relaxed) != seq) continue;
+                T item;
+                std::memcpy(&item, words, sizeof(T));
+                f(item);
+            }
+        }
+    }
+};
+
+}
+
+#endif
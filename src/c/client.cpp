@@ -8,6 +8,9 @@
 #include <warabi/Client.hpp>
 #include <warabi/TargetHandle.hpp>
 #include <warabi/AsyncRequest.hpp>
+#include <warabi/TargetGroup.hpp>
+#include <cstring>
+#include <memory>
 
 struct warabi_client : public warabi::Client {
     template<typename... Args>
@@ -21,6 +24,17 @@ struct warabi_target_handle : public warabi::TargetHandle {
     :  warabi::TargetHandle(std::forward<Args>(args)...) {}
 };
 
+struct warabi_target_group : public warabi::TargetGroup {
+    template<typename... Args>
+    warabi_target_group(Args&&... args)
+    :  warabi::TargetGroup(std::forward<Args>(args)...) {}
+};
+
+struct warabi_striped_object : public warabi::StripedObject {};
+
+static_assert(sizeof(warabi_group_region_t) == sizeof(warabi::GroupRegionID),
+              "warabi_group_region_t and warabi::GroupRegionID should have the same layout");
+
 struct warabi_async_request : public warabi::AsyncRequest {
     template<typename... Args>
     warabi_async_request(Args&&... args)
@@ -230,6 +244,150 @@ extern "C" warabi_err_t warabi_create_write_bulk(
     } HANDLE_WARABI_ERROR;
 }
 
+extern "C" warabi_err_t warabi_append(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        const char* data, size_t size,
+        bool persist,
+        size_t* offset,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->append(*region_id, data, size, offset, persist, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->append(*region_id, data, size, offset, persist);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_append_bulk(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        hg_bulk_t bulk, const char* address,
+        size_t bulkOffset, size_t size,
+        bool persist,
+        size_t* offset,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        auto engine = th->client().engine();
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->append(*region_id, engine.wrap(bulk, false), address, bulkOffset, size,
+                       offset, persist, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->append(*region_id, engine.wrap(bulk, false), address, bulkOffset, size,
+                       offset, persist);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_atomic(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t offset,
+        warabi_atomic_op_t op,
+        size_t width,
+        const void* operand,
+        const void* compare,
+        void* previous,
+        bool persist,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        auto atomic_op = static_cast<warabi::AtomicOp>(op);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->atomic(*region_id, offset, atomic_op, width, operand, compare, previous,
+                       persist, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->atomic(*region_id, offset, atomic_op, width, operand, compare, previous, persist);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_resize(
+        warabi_target_handle_t th,
+        warabi_region_t* region,
+        size_t size,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->resize(region_id, size, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->resize(region_id, size);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_copy(
+        warabi_target_handle_t th,
+        warabi_region_t source,
+        size_t sourceOffset,
+        warabi_region_t dest,
+        size_t destOffset,
+        size_t size,
+        warabi_async_request_t* req) {
+    try {
+        auto source_id = reinterpret_cast<warabi::RegionID*>(&source);
+        auto dest_id = reinterpret_cast<warabi::RegionID*>(&dest);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->copy(*source_id, sourceOffset, *dest_id, destOffset, size, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->copy(*source_id, sourceOffset, *dest_id, destOffset, size);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_clone(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        warabi_region_t* clone,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        auto clone_id = reinterpret_cast<warabi::RegionID*>(clone);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->clone(*region_id, clone_id, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->clone(*region_id, clone_id);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_transfer(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t size,
+        warabi_target_handle_t dest,
+        bool persist,
+        warabi_region_t* dest_region,
+        warabi_async_request_t* req) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        auto dest_region_id = reinterpret_cast<warabi::RegionID*>(dest_region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            th->transfer(*region_id, size, *dest, dest_region_id, persist, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            th->transfer(*region_id, size, *dest, dest_region_id, persist);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
 extern "C" warabi_err_t warabi_read(
         warabi_target_handle_t th,
         warabi_region_t region,
@@ -353,6 +511,30 @@ extern "C" warabi_err_t warabi_test(warabi_async_request_t req, bool* flag) {
     } HANDLE_WARABI_ERROR;
 }
 
+extern "C" warabi_err_t warabi_wait_any(size_t count, warabi_async_request_t* reqs, size_t* index) {
+    try {
+        std::vector<warabi::AsyncRequest> requests(count);
+        for(size_t i = 0; i < count; ++i)
+            if(reqs[i]) requests[i] = *reqs[i];
+        *index = warabi::AsyncRequest::waitAny(requests.data(), count);
+    } catch(const std::exception& ex) {
+        return static_cast<warabi_err*>(new warabi::Exception{ex.what()});
+    }
+    if(*index == count) return nullptr;
+    auto req = reqs[*index];
+    reqs[*index] = WARABI_ASYNC_REQUEST_NULL;
+    return warabi_wait(req);
+}
+
+extern "C" warabi_err_t warabi_test_all(size_t count, const warabi_async_request_t* reqs, bool* flag) {
+    try {
+        std::vector<warabi::AsyncRequest> requests(count);
+        for(size_t i = 0; i < count; ++i)
+            if(reqs[i]) requests[i] = *reqs[i];
+        *flag = warabi::AsyncRequest::testAll(requests.data(), count);
+    } HANDLE_WARABI_ERROR;
+}
+
 extern "C" warabi_err_t warabi_set_eager_write_threshold(
         warabi_target_handle_t th,
         size_t size) {
@@ -368,3 +550,279 @@ extern "C" warabi_err_t warabi_set_eager_read_threshold(
         th->setEagerReadThreshold(size);
     } HANDLE_WARABI_ERROR;
 }
+
+extern "C" warabi_err_t warabi_set_readahead(
+        warabi_target_handle_t th,
+        size_t depth,
+        size_t chunk_size) {
+    try {
+        th->setReadahead(depth, chunk_size);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_prefetch(
+        warabi_target_handle_t th,
+        warabi_region_t region,
+        size_t regionOffset,
+        size_t size) {
+    try {
+        auto region_id = reinterpret_cast<warabi::RegionID*>(&region);
+        th->prefetch(*region_id, regionOffset, size);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_client_make_target_group(
+        warabi_client_t client,
+        size_t count,
+        const char* const* addresses,
+        const uint16_t* provider_ids,
+        warabi_placement_t placement,
+        warabi_target_group_t* group) {
+    try {
+        std::vector<std::pair<std::string, uint16_t>> targets;
+        for(size_t i = 0; i < count; ++i)
+            targets.emplace_back(addresses[i], provider_ids[i]);
+        auto g = client->makeTargetGroup(targets,
+            placement == WARABI_PLACEMENT_LEAST_LOADED ?
+                warabi::Placement::LeastLoaded : warabi::Placement::ConsistentHashing);
+        *group = new warabi_target_group{std::move(g)};
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_target_group_free(warabi_target_group_t group) {
+    delete group;
+    return nullptr;
+}
+
+extern "C" warabi_err_t warabi_target_group_size(
+        warabi_target_group_t group,
+        size_t* count) {
+    try {
+        *count = group->size();
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_create(
+        warabi_target_group_t group,
+        size_t size,
+        const char* key,
+        warabi_group_region_t* region,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->create(rid, size, key ? key : "", &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->create(rid, size, key ? key : "");
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_write(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        const char* data, size_t size,
+        bool persist,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(&region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->write(*rid, regionOffset, data, size, persist, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->write(*rid, regionOffset, data, size, persist);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_persist(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        size_t size,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(&region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->persist(*rid, regionOffset, size, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->persist(*rid, regionOffset, size);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_create_write(
+        warabi_target_group_t group,
+        const char* key,
+        const char* data, size_t size,
+        bool persist,
+        warabi_group_region_t* region,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->createAndWrite(rid, data, size, persist, key ? key : "", &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->createAndWrite(rid, data, size, persist, key ? key : "");
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_read(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        size_t regionOffset,
+        char* data, size_t size,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(&region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->read(*rid, regionOffset, data, size, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->read(*rid, regionOffset, data, size);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_erase(
+        warabi_target_group_t group,
+        warabi_group_region_t region,
+        warabi_async_request_t* req) {
+    try {
+        auto rid = reinterpret_cast<warabi::GroupRegionID*>(&region);
+        if(req) {
+            warabi::AsyncRequest async_req;
+            group->erase(*rid, &async_req);
+            *req = new warabi_async_request{std::move(async_req)};
+        } else {
+            group->erase(*rid);
+        }
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_create_write_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const char* const* data,
+        const size_t* sizes,
+        bool persist,
+        warabi_group_region_t* regions) {
+    try {
+        std::vector<std::pair<const char*, size_t>> buffers(count);
+        for(size_t i = 0; i < count; ++i)
+            buffers[i] = {data[i], sizes[i]};
+        std::vector<warabi::GroupRegionID> rids;
+        group->createAndWriteBatch(&rids, buffers, persist);
+        std::memcpy(regions, rids.data(), count*sizeof(*regions));
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_read_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const warabi_group_region_t* regions,
+        char* const* data,
+        const size_t* sizes) {
+    try {
+        auto first = reinterpret_cast<const warabi::GroupRegionID*>(regions);
+        std::vector<warabi::GroupRegionID> rids(first, first + count);
+        std::vector<std::pair<char*, size_t>> buffers(count);
+        for(size_t i = 0; i < count; ++i)
+            buffers[i] = {data[i], sizes[i]};
+        group->readBatch(rids, buffers);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_erase_batch(
+        warabi_target_group_t group,
+        size_t count,
+        const warabi_group_region_t* regions) {
+    try {
+        auto first = reinterpret_cast<const warabi::GroupRegionID*>(regions);
+        std::vector<warabi::GroupRegionID> rids(first, first + count);
+        group->eraseBatch(rids);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_create_striped(
+        warabi_target_group_t group,
+        const char* key,
+        const char* data, size_t size,
+        size_t stripe_size,
+        bool persist,
+        warabi_striped_object_t* object) {
+    try {
+        auto obj = std::make_unique<warabi_striped_object>();
+        group->createStriped(obj.get(), data, size, stripe_size, persist, key ? key : "");
+        *object = obj.release();
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_open_striped(
+        warabi_target_group_t group,
+        warabi_group_region_t manifest,
+        warabi_striped_object_t* object) {
+    try {
+        auto obj = std::make_unique<warabi_striped_object>();
+        group->openStriped(obj.get(), *reinterpret_cast<warabi::GroupRegionID*>(&manifest));
+        *object = obj.release();
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_striped_object_free(warabi_striped_object_t object) {
+    delete object;
+    return nullptr;
+}
+
+extern "C" warabi_err_t warabi_striped_object_size(
+        warabi_striped_object_t object,
+        size_t* size) {
+    *size = object->size;
+    return nullptr;
+}
+
+extern "C" warabi_err_t warabi_striped_object_manifest(
+        warabi_striped_object_t object,
+        warabi_group_region_t* manifest) {
+    std::memcpy(manifest, &object->manifest, sizeof(*manifest));
+    return nullptr;
+}
+
+extern "C" warabi_err_t warabi_group_write_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object,
+        size_t offset,
+        const char* data, size_t size,
+        bool persist) {
+    try {
+        group->writeStriped(*object, offset, data, size, persist);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_read_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object,
+        size_t offset,
+        char* data, size_t size) {
+    try {
+        group->readStriped(*object, offset, data, size);
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_group_erase_striped(
+        warabi_target_group_t group,
+        warabi_striped_object_t object) {
+    try {
+        group->eraseStriped(*object);
+    } HANDLE_WARABI_ERROR;
+}
@@ -13,6 +13,12 @@ struct warabi_provider : public warabi::Provider {
     : warabi::Provider(std::forward<Args>(args)...) {}
 };
 
+struct warabi_migration : public warabi::AsyncMigration {
+    template<typename... Args>
+    warabi_migration(Args&&... args)
+    :  warabi::AsyncMigration(std::forward<Args>(args)...) {}
+};
+
 extern "C" warabi_err_t warabi_provider_register(
     warabi_provider_t* provider,
     margo_instance_id mid,
@@ -50,3 +56,51 @@ extern "C" warabi_err_t warabi_provider_migrate(warabi_provider_t provider,
             dest_addr, dest_provider_id, migration_config ? migration_config : "");
     } HANDLE_WARABI_ERROR;
 }
+
+extern "C" warabi_err_t warabi_provider_migrate_async(warabi_provider_t provider,
+                                                      const char* dest_addr,
+                                                      uint16_t dest_provider_id,
+                                                      const char* migration_config,
+                                                      warabi_migration_t* migration) {
+    try {
+        warabi::AsyncMigration async_migration;
+        provider->migrateTarget(
+            dest_addr, dest_provider_id, migration_config ? migration_config : "",
+            &async_migration);
+        *migration = new warabi_migration{std::move(async_migration)};
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_migration_wait(warabi_migration_t migration) {
+    warabi_err_t err = nullptr;
+    try {
+        migration->wait();
+    } catch(const std::exception& ex) {
+        err = static_cast<warabi_err*>(new warabi::Exception{ex.what()});
+    }
+    delete migration;
+    return err;
+}
+
+extern "C" warabi_err_t warabi_migration_test(warabi_migration_t migration, bool* flag) {
+    try {
+        *flag = migration->completed();
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_migration_cancel(warabi_migration_t migration) {
+    try {
+        migration->cancel();
+    } HANDLE_WARABI_ERROR;
+}
+
+extern "C" warabi_err_t warabi_migration_get_progress(warabi_migration_t migration,
+                                                      warabi_migration_progress_t* progress) {
+    try {
+        progress->bytes_total       = migration->bytesTotal();
+        progress->bytes_transferred = migration->bytesTransferred();
+        progress->bytes_sent        = migration->bytesSent();
+        progress->elapsed           = migration->elapsed();
+        progress->throughput        = migration->throughput();
+    } HANDLE_WARABI_ERROR;
+}
@@ -0,0 +1,137 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <algorithm>
+
+TEST_CASE("Append test", "[append]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    CAPTURE(target_type);
+
+    auto pr_config = makeConfigForProvider(target_type, "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // testing both eager and bulk paths
+    auto record_size = GENERATE(64, 4096);
+    CAPTURE(record_size);
+    th.setEagerWriteThreshold(1024);
+
+    const size_t num_records = 16;
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, num_records * record_size));
+
+    SECTION("Concurrent appends") {
+        std::vector<std::string> records;
+        for(size_t i = 0; i < num_records; ++i)
+            records.emplace_back(record_size, 'a' + i);
+        std::vector<size_t> offsets(num_records);
+        std::vector<warabi::AsyncRequest> reqs(num_records);
+        for(size_t i = 0; i < num_records; ++i)
+            REQUIRE_NOTHROW(th.append(region, records[i].data(), record_size,
+                                      &offsets[i], false, &reqs[i]));
+        for(auto& req : reqs) REQUIRE_NOTHROW(req.wait());
+        // each record got its own slot in the region
+        auto sorted = offsets;
+        std::sort(sorted.begin(), sorted.end());
+        for(size_t i = 0; i < num_records; ++i)
+            REQUIRE(sorted[i] == i * record_size);
+        for(size_t i = 0; i < num_records; ++i) {
+            std::string out(record_size, '\0');
+            REQUIRE_NOTHROW(th.read(region, offsets[i], out.data(), out.size()));
+            REQUIRE(out == records[i]);
+        }
+    }
+
+    SECTION("Appending past the end of the region") {
+        std::string record(record_size, 'x');
+        size_t offset = 0;
+        for(size_t i = 0; i < num_records; ++i)
+            REQUIRE_NOTHROW(th.append(region, record.data(), record.size(), &offset));
+        REQUIRE(offset == (num_records - 1) * record_size);
+        std::string big(1024 * 1024 * 16, 'y');
+        if(target_type == "memory") {
+            // memory regions grow
+            REQUIRE_NOTHROW(th.append(region, big.data(), big.size(), &offset));
+            REQUIRE(offset == num_records * record_size);
+            std::string out(record_size, '\0');
+            REQUIRE_NOTHROW(th.read(region, offset, out.data(), out.size()));
+            REQUIRE(out == big.substr(0, record_size));
+        } else {
+            REQUIRE_THROWS_AS(th.append(region, big.data(), big.size()), warabi::Exception);
+        }
+    }
+
+    SECTION("Erasing resets the region") {
+        std::string record(record_size, 'z');
+        size_t offset = 0;
+        REQUIRE_NOTHROW(th.append(region, record.data(), record.size(), &offset));
+        REQUIRE_NOTHROW(th.append(region, record.data(), record.size(), &offset));
+        REQUIRE(offset == (size_t)record_size);
+        REQUIRE_NOTHROW(th.erase(region));
+        if(target_type != "pmdk") { // pmdk regions cannot be reused after erasure
+            REQUIRE_NOTHROW(th.append(region, record.data(), record.size(), &offset));
+            REQUIRE(offset == 0);
+        }
+    }
+}
+
+TEST_CASE("Append to a reopened target", "[append]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "pmdk", "abtio");
+    CAPTURE(target_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+
+    const std::string record = "first record";
+    warabi::RegionID region;
+    {
+        warabi::Provider provider(engine, 42, makeConfigForProvider(target_type, "__default__"));
+        warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+        REQUIRE_NOTHROW(th.create(&region, 1024));
+        REQUIRE_NOTHROW(th.append(region, record.data(), record.size()));
+    }
+
+    // open the same file again, without overriding it
+    auto config = makeConfigForProvider(target_type, "__default__");
+    auto pos = config.find(R"("override_if_exists": true)");
+    REQUIRE(pos != std::string::npos);
+    config.replace(pos, 26, R"("override_if_exists": false)");
+    warabi::Provider provider(engine, 42, config);
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // the end of the data appended before is unknown,
+    // appending must not overwrite it from offset 0
+    REQUIRE_THROWS_AS(th.append(region, record.data(), record.size()), warabi::Exception);
+    std::string out(record.size(), '\0');
+    REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+    REQUIRE(out == record);
+
+    // regions created since then can be appended to
+    warabi::RegionID other;
+    size_t offset = 1;
+    REQUIRE_NOTHROW(th.create(&other, 1024));
+    REQUIRE_NOTHROW(th.append(other, record.data(), record.size(), &offset));
+    REQUIRE(offset == 0);
+}
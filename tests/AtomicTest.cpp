@@ -0,0 +1,115 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <algorithm>
+#include <cstring>
+
+TEST_CASE("Atomic operations test", "[atomic]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    CAPTURE(target_type);
+
+    auto pr_config = makeConfigForProvider(target_type, "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, 64));
+    std::string zeros(64, '\0');
+    REQUIRE_NOTHROW(th.write(region, 0, zeros.data(), zeros.size()));
+
+    SECTION("64-bit operations") {
+        using warabi::AtomicOp;
+        REQUIRE(th.atomic(region, 8, AtomicOp::FetchAdd, 10) == 0);
+        REQUIRE(th.atomic(region, 8, AtomicOp::FetchAdd, 5) == 10);
+        // failed and successful compare-and-swap
+        REQUIRE(th.atomic(region, 8, AtomicOp::CompareSwap, 100, 14) == 15);
+        REQUIRE(th.atomic(region, 8, AtomicOp::CompareSwap, 100, 15) == 15);
+        REQUIRE(th.atomic(region, 8, AtomicOp::FetchOr, 0x3) == 100);
+        REQUIRE(th.atomic(region, 8, AtomicOp::FetchAnd, 0x6) == 103);
+        REQUIRE(th.atomic(region, 8, AtomicOp::FetchXor, 0xF) == 6);
+        REQUIRE(th.atomic(region, 8, AtomicOp::Swap, 7) == 9);
+        uint64_t value = 0;
+        REQUIRE_NOTHROW(th.read(region, 8, reinterpret_cast<char*>(&value), sizeof(value)));
+        REQUIRE(value == 7);
+        // the neighbouring words are untouched
+        std::string out(64, 'x');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out.substr(0, 8) == zeros.substr(0, 8));
+        REQUIRE(out.substr(16) == zeros.substr(16));
+    }
+
+    SECTION("Persistent operations") {
+        using warabi::AtomicOp;
+        REQUIRE(th.atomic(region, 0, AtomicOp::FetchAdd, 3, 0, true) == 0);
+        // an operation leaving the word unchanged still persists it
+        REQUIRE(th.atomic(region, 0, AtomicOp::FetchAdd, 0, 0, true) == 3);
+        REQUIRE(th.atomic(region, 0, AtomicOp::FetchAdd, 0) == 3);
+    }
+
+    SECTION("128-bit operations") {
+        // halves of a 16-byte word in native byte order
+        uint16_t probe = 1;
+        uint8_t first = 0;
+        std::memcpy(&first, &probe, 1);
+        const size_t lo = first == 1 ? 0 : 1, hi = 1 - lo;
+        uint64_t word[2], one[2], previous[2], result[2];
+        word[lo] = ~0ull; word[hi] = 0;
+        one[lo]  = 1;     one[hi]  = 0;
+        REQUIRE_NOTHROW(th.atomic(region, 16, warabi::AtomicOp::Swap, 16, word, nullptr, previous));
+        REQUIRE(previous[0] == 0);
+        REQUIRE(previous[1] == 0);
+        // adding 1 carries into the high half
+        REQUIRE_NOTHROW(th.atomic(region, 16, warabi::AtomicOp::FetchAdd, 16, one, nullptr, previous));
+        REQUIRE(std::memcmp(previous, word, 16) == 0);
+        REQUIRE_NOTHROW(th.read(region, 16, reinterpret_cast<char*>(result), sizeof(result)));
+        REQUIRE(result[lo] == 0);
+        REQUIRE(result[hi] == 1);
+        // compare-and-swap of the whole word
+        REQUIRE_NOTHROW(th.atomic(region, 16, warabi::AtomicOp::CompareSwap, 16, word, result, previous));
+        REQUIRE_NOTHROW(th.read(region, 16, reinterpret_cast<char*>(result), sizeof(result)));
+        REQUIRE(std::memcmp(result, word, 16) == 0);
+    }
+
+    SECTION("Concurrent operations") {
+        const size_t count = 64;
+        std::vector<uint64_t> previous(count);
+        std::vector<warabi::AsyncRequest> reqs(count);
+        const uint64_t one = 1;
+        for(size_t i = 0; i < count; ++i)
+            REQUIRE_NOTHROW(th.atomic(region, 32, warabi::AtomicOp::FetchAdd, 8,
+                                      &one, nullptr, &previous[i], false, &reqs[i]));
+        for(auto& req : reqs) REQUIRE_NOTHROW(req.wait());
+        std::sort(previous.begin(), previous.end());
+        for(size_t i = 0; i < count; ++i) REQUIRE(previous[i] == i);
+        REQUIRE(th.atomic(region, 32, warabi::AtomicOp::FetchAdd, 0) == count);
+    }
+
+    SECTION("Errors") {
+        // misaligned word and invalid width
+        REQUIRE_THROWS_AS(th.atomic(region, 4, warabi::AtomicOp::FetchAdd, 1), warabi::Exception);
+        uint32_t small = 1;
+        REQUIRE_THROWS_AS(th.atomic(region, 0, warabi::AtomicOp::FetchAdd, 4,
+                                    &small, nullptr, nullptr), warabi::Exception);
+        // the abtio backend does not check the bounds of regions
+        if(target_type != "abtio")
+            REQUIRE_THROWS_AS(th.atomic(region, 64, warabi::AtomicOp::FetchAdd, 1), warabi::Exception);
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/BufferPool.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <cstring>
+
+TEST_CASE("BufferPool test", "[buffer-pool]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+    th.setEagerReadThreshold(128);
+    th.setEagerWriteThreshold(128);
+
+    SECTION("Pooling") {
+        warabi::BufferPool pool{engine, 16*1024};
+        REQUIRE(pool.cachedBytes() == 0);
+        char* first = nullptr;
+        {
+            auto buffer = pool.get(5000);
+            REQUIRE(static_cast<bool>(buffer));
+            REQUIRE(buffer.size() == 5000);
+            REQUIRE(buffer.capacity() == 8192);
+            REQUIRE(buffer.bulk().size() == 8192);
+            first = buffer.data();
+        }
+        REQUIRE(pool.cachedBytes() == 8192);
+        {
+            // same size class: the block is reused
+            auto buffer = pool.get(8000);
+            REQUIRE(buffer.data() == first);
+            REQUIRE(pool.cachedBytes() == 0);
+            // another size class: a new block is allocated
+            auto other = pool.get(100);
+            REQUIRE(other.capacity() == 4096);
+            // blocks beyond the limit are not kept
+            auto large = pool.get(32*1024);
+        }
+        REQUIRE(pool.cachedBytes() == 8192 + 4096);
+        REQUIRE_THROWS_AS(warabi::RegisteredBuffer{}.data(), warabi::Exception);
+    }
+
+    SECTION("Read and write RegisteredBuffers") {
+        // testing both eager and bulk paths
+        auto data_size = GENERATE(64, 4096);
+        CAPTURE(data_size);
+
+        auto pool = client.bufferPool();
+        auto in = pool.get(data_size);
+        for(size_t i = 0; i < in.size(); ++i) in.data()[i] = 'A' + (i % 26);
+
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th.create(&region, data_size + 16));
+        REQUIRE_NOTHROW(th.write(region, 16, in, true));
+
+        auto out = pool.get(data_size);
+        REQUIRE_NOTHROW(th.read(region, 16, out));
+        REQUIRE(std::memcmp(in.data(), out.data(), data_size) == 0);
+
+        auto out2 = pool.get(data_size);
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.read(region, 16, out2, &req));
+        REQUIRE_NOTHROW(req.wait());
+        REQUIRE(std::memcmp(in.data(), out2.data(), data_size) == 0);
+
+        REQUIRE_NOTHROW(th.erase(region));
+    }
+
+    SECTION("Scatter/gather") {
+        // testing both eager and bulk paths
+        auto segment_size = GENERATE(8, 256);
+        CAPTURE(segment_size);
+
+        // every other segment of a buffer
+        std::string in(segment_size * 8, '\0');
+        for(size_t i = 0; i < in.size(); ++i) in[i] = 'a' + (i % 26);
+        std::vector<std::pair<const char*, size_t>> gather;
+        std::string expected;
+        for(size_t i = 0; i < 8; i += 2) {
+            gather.emplace_back(in.data() + i * segment_size, segment_size);
+            expected.append(in.data() + i * segment_size, segment_size);
+        }
+
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th.create(&region, expected.size()));
+        REQUIRE_NOTHROW(th.writeGather(region, 0, gather));
+
+        std::string contiguous(expected.size(), '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, contiguous.data(), contiguous.size()));
+        REQUIRE(contiguous == expected);
+
+        std::string out(in.size(), '.');
+        std::vector<std::pair<char*, size_t>> scatter;
+        for(size_t i = 1; i < 8; i += 2)
+            scatter.emplace_back(out.data() + i * segment_size, segment_size);
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.readScatter(region, 0, scatter, &req));
+        REQUIRE_NOTHROW(req.wait());
+        for(size_t i = 0; i < 8; ++i) {
+            auto segment = out.substr(i * segment_size, segment_size);
+            if(i % 2 == 0)
+                REQUIRE(segment == std::string(segment_size, '.'));
+            else
+                REQUIRE(segment == expected.substr((i/2) * segment_size, segment_size));
+        }
+    }
+}
@@ -0,0 +1,118 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/CompletionQueue.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <algorithm>
+
+TEST_CASE("CompletionQueue test", "[completion-queue]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // testing both eager and bulk paths
+    auto data_size = GENERATE(64, 4096);
+    CAPTURE(data_size);
+
+    const size_t count = 64;
+    std::vector<std::string> contents;
+    for(size_t i = 0; i < count; ++i)
+        contents.push_back(std::string(data_size, 'a' + (i % 26)));
+    std::vector<warabi::RegionID> regions(count);
+
+    warabi::CompletionQueue queue;
+    REQUIRE(static_cast<bool>(queue));
+    REQUIRE(queue.pending() == 0);
+
+    SECTION("waitAny and waitSome") {
+        size_t callbacks = 0;
+        for(size_t i = 0; i < count; ++i) {
+            warabi::AsyncRequest req;
+            th.createAndWrite(&regions[i], contents[i].data(), contents[i].size(), false, &req);
+            queue.push(std::move(req), i, [&callbacks](const warabi::Completion& c) {
+                REQUIRE(c.success());
+                callbacks += 1;
+            });
+        }
+        REQUIRE(queue.pending() + queue.ready() == count);
+
+        warabi::Completion completion;
+        REQUIRE(queue.waitAny(&completion));
+        REQUIRE(completion.success());
+        REQUIRE(completion.tag < count);
+
+        std::vector<warabi::Completion> completions;
+        size_t n = queue.waitSome(&completions, count - 1);
+        REQUIRE(n == count - 1);
+        REQUIRE(callbacks == count);
+        completions.push_back(std::move(completion));
+
+        std::vector<uint64_t> tags;
+        for(auto& c : completions) tags.push_back(c.tag);
+        std::sort(tags.begin(), tags.end());
+        for(size_t i = 0; i < count; ++i) REQUIRE(tags[i] == i);
+
+        REQUIRE(queue.testAll());
+        REQUIRE(!queue.waitAny(&completion));
+
+        // read the regions back through the queue
+        std::vector<std::string> results(count, std::string(data_size, '\0'));
+        for(size_t i = 0; i < count; ++i) {
+            warabi::AsyncRequest req;
+            th.read(regions[i], 0, results[i].data(), results[i].size(), &req);
+            queue.push(std::move(req), i);
+        }
+        completions.clear();
+        REQUIRE(queue.waitSome(&completions, count) == count);
+        for(auto& c : completions) REQUIRE_NOTHROW(c.check());
+        REQUIRE(results == contents);
+    }
+
+    SECTION("Errors and polling") {
+        warabi::RegionID invalid;
+        std::fill(invalid.begin(), invalid.end(), 234);
+
+        warabi::AsyncRequest req;
+        th.erase(invalid, &req);
+        queue.push(std::move(req), 42);
+
+        std::vector<warabi::Completion> completions;
+        while(queue.waitSome(&completions, 0) == 0) {}
+        REQUIRE(completions.size() == 1);
+        REQUIRE(completions[0].tag == 42);
+        REQUIRE(!completions[0].success());
+        REQUIRE_THROWS_AS(completions[0].check(), warabi::Exception);
+
+        REQUIRE_THROWS_AS(queue.push(warabi::AsyncRequest{}), warabi::Exception);
+    }
+
+    SECTION("AsyncRequest::waitAny and testAll") {
+        std::vector<warabi::AsyncRequest> reqs(count);
+        for(size_t i = 0; i < count; ++i)
+            th.createAndWrite(&regions[i], contents[i].data(), contents[i].size(), false, &reqs[i]);
+        for(size_t i = 0; i < count; ++i) {
+            auto index = warabi::AsyncRequest::waitAny(reqs.data(), reqs.size());
+            REQUIRE(index < count);
+            REQUIRE_NOTHROW(reqs[index].wait());
+        }
+        REQUIRE(warabi::AsyncRequest::waitAny(reqs.data(), reqs.size()) == count);
+        REQUIRE(warabi::AsyncRequest::testAll(reqs.data(), reqs.size()));
+    }
+}
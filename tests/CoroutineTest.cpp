@@ -0,0 +1,81 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Coroutines.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <algorithm>
+
+using warabi::coro::Task;
+
+static Task<std::string> writeThenRead(const warabi::TargetHandle& th, std::string data) {
+    warabi::RegionID region;
+    co_await th.createAsync(&region, data.size());
+    co_await th.writeAsync(region, 0, data.data(), data.size(), true);
+    co_await th.persistAsync(region, 0, data.size());
+    std::string result(data.size(), '\0');
+    co_await th.readAsync(region, 0, result.data(), result.size());
+    co_await th.eraseAsync(region);
+    co_return result;
+}
+
+static Task<> check(const warabi::TargetHandle& th, std::string data, size_t* matches) {
+    auto result = co_await writeThenRead(th, data);
+    if(result == data) *matches += 1;
+}
+
+static Task<> eraseInvalid(const warabi::TargetHandle& th) {
+    warabi::RegionID invalid;
+    std::fill(invalid.begin(), invalid.end(), 234);
+    co_await th.eraseAsync(invalid);
+}
+
+TEST_CASE("Coroutine test", "[coroutines]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // testing both eager and bulk paths
+    auto data_size = GENERATE(64, 4096);
+    CAPTURE(data_size);
+
+    warabi::coro::Scheduler scheduler;
+
+    SECTION("Run a task") {
+        std::string data(data_size, 'a');
+        auto result = scheduler.run(writeThenRead(th, data));
+        REQUIRE(result == data);
+    }
+
+    SECTION("Spawn many tasks") {
+        size_t matches = 0;
+        for(int i = 0; i < 128; ++i)
+            scheduler.spawn(check(th, std::string(data_size, 'a' + (i % 26)), &matches));
+        REQUIRE_NOTHROW(scheduler.run());
+        REQUIRE(matches == 128);
+        REQUIRE(scheduler.inFlight() == 0);
+    }
+
+    SECTION("Errors") {
+        REQUIRE_THROWS_AS(scheduler.run(eraseInvalid(th)), warabi::Exception);
+        scheduler.spawn(eraseInvalid(th));
+        REQUIRE_THROWS_AS(scheduler.run(), warabi::Exception);
+        REQUIRE_NOTHROW(scheduler.run());
+    }
+}
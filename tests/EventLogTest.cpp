@@ -0,0 +1,60 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <nlohmann/json.hpp>
+#include <fstream>
+#include <iterator>
+#include "defer.hpp"
+#include "configs.hpp"
+
+using json = nlohmann::json;
+
+TEST_CASE("Event log test", "[event-log]") {
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    const auto filename = std::string{"/tmp/warabi-event-log-test.bin"};
+
+    SECTION("Event log disabled") {
+        auto pr_config = makeConfigForProvider("memory", "__default__");
+        warabi::Provider provider(engine, 42, pr_config);
+        REQUIRE_THROWS_AS(provider.dumpEventLog(filename), warabi::Exception);
+    }
+
+    SECTION("Event log enabled") {
+        auto pr_config = json::parse(makeConfigForProvider("memory", "__default__"));
+        pr_config["event_log"] = json{{"enabled", true}, {"events_per_xstream", 128}};
+        warabi::Provider provider(engine, 42, pr_config.dump());
+
+        auto config = json::parse(provider.getConfig());
+        REQUIRE(config["event_log"]["enabled"].get<bool>());
+
+        warabi::Client client(engine);
+        warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+        std::string in(64, 'A');
+        warabi::RegionID regionID;
+        REQUIRE_NOTHROW(th.createAndWrite(&regionID, in.data(), in.size()));
+        std::string out(in.size(), '\0');
+        REQUIRE_NOTHROW(th.read(regionID, 0, out.data(), out.size()));
+        REQUIRE(in == out);
+
+        REQUIRE_NOTHROW(provider.dumpEventLog(filename));
+        std::ifstream file(filename, std::ios::binary);
+        REQUIRE(file.good());
+        std::string content{std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>()};
+        REQUIRE(content.substr(0, 8) == "WRBEVLG1");
+        // format strings are stored once, in the header
+        REQUIRE(content.find("Received read_eager request {}") != std::string::npos);
+        REQUIRE(content.find("Successfully executed create_write_eager request") != std::string::npos);
+    }
+}
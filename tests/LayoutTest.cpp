@@ -0,0 +1,250 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Layout.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+static std::string gather(const std::string& in, const warabi::Layout& layout) {
+    std::string out;
+    layout.forEach([&](size_t offset, size_t size) { out += in.substr(offset, size); });
+    return out;
+}
+
+TEST_CASE("Layout expansion test", "[layout]") {
+
+    SECTION("Vector") {
+        auto layout = warabi::Layout::vector(8, 3, 4, 10);
+        REQUIRE(layout.size() == 12);
+        REQUIRE(layout.numSegments() == 3);
+        REQUIRE(layout.expand() == warabi::Layout::Segments{{8, 4}, {18, 4}, {28, 4}});
+        REQUIRE_THROWS_AS(warabi::Layout::vector(0, 2, 8, 4), warabi::Exception);
+    }
+
+    SECTION("Subarray") {
+        // 2x2x3 block at (1,0,1) of a 3x4x5 array of 2-byte elements
+        auto layout = warabi::Layout::subarray(100, {3, 4, 5}, {2, 2, 3}, {1, 0, 1}, 2);
+        REQUIRE(layout.size() == 24);
+        REQUIRE(layout.expand() == warabi::Layout::Segments{
+                {142, 6}, {152, 6}, {182, 6}, {192, 6}});
+        // full rows are merged into a single segment per outer index
+        auto rows = warabi::Layout::subarray(0, {4, 8}, {2, 8}, {1, 0}, 1);
+        REQUIRE(rows.expand() == warabi::Layout::Segments{{8, 16}});
+        REQUIRE_THROWS_AS(warabi::Layout::subarray(0, {4, 4}, {2, 2}, {3, 0}, 1),
+                          warabi::Exception);
+        REQUIRE_THROWS_AS(warabi::Layout::subarray(0, {4, 4}, {2}, {0, 0}, 1),
+                          warabi::Exception);
+    }
+
+    SECTION("Batches") {
+        auto layout = warabi::Layout::vector(0, 10, 1, 2);
+        std::vector<size_t> befores;
+        layout.forEachBatch(4, [&](const warabi::Layout::Segments& segments, size_t before) {
+            REQUIRE(segments.size() <= 4);
+            befores.push_back(before);
+            return true;
+        });
+        REQUIRE(befores == std::vector<size_t>{0, 4, 8});
+    }
+}
+
+/**
+ * @brief Minimal archive used to craft the serialized form of layouts
+ * that the factory functions refuse to build.
+ */
+struct TestArchive {
+
+    std::string data;
+    size_t      pos = 0;
+
+    template<typename T>
+    TestArchive& operator&(T& value) {
+        if constexpr(std::is_arithmetic_v<T>) {
+            read(reinterpret_cast<char*>(&value), sizeof(value));
+            return *this;
+        }
+        throw std::runtime_error("Unsupported type");
+    }
+
+    void read(char* out, size_t size) {
+        if(size > data.size() - pos) throw std::runtime_error("End of archive");
+        std::memcpy(out, data.data() + pos, size);
+        pos += size;
+    }
+
+    template<typename T>
+    void append(T value) {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+};
+
+static warabi::Layout loadLayout(uint8_t kind, const std::vector<uint64_t>& params) {
+    TestArchive ar;
+    ar.append(kind);
+    ar.append(uint64_t{0});
+    ar.append(static_cast<uint8_t>(params.size()));
+    for(auto p : params) ar.append(p);
+    warabi::Layout layout;
+    layout.load(ar);
+    return layout;
+}
+
+TEST_CASE("Layout validation test", "[layout]") {
+
+    SECTION("Valid layouts") {
+        REQUIRE_NOTHROW(warabi::Layout::contiguous(8, 16).validate());
+        REQUIRE_NOTHROW(warabi::Layout::vector(8, 3, 4, 10).validate());
+        REQUIRE_NOTHROW(warabi::Layout::subarray(0, {3, 4}, {2, 2}, {1, 1}, 8).validate());
+        REQUIRE_NOTHROW(warabi::Layout::indexed({{10, 4}, {0, 2}}).validate());
+        REQUIRE(loadLayout(1, {3, 4, 10}).valid());
+    }
+
+    SECTION("Wrong number of parameters") {
+        REQUIRE_THROWS_AS(loadLayout(0, {}).validate(), warabi::Exception);
+        REQUIRE_THROWS_AS(loadLayout(1, {3, 4}).validate(), warabi::Exception);
+        REQUIRE_THROWS_AS(loadLayout(2, {8, 4, 4, 2, 2}).validate(), warabi::Exception);
+        REQUIRE_THROWS_AS(loadLayout(2, {8}).validate(), warabi::Exception);
+    }
+
+    SECTION("Inconsistent parameters") {
+        REQUIRE_FALSE(loadLayout(1, {3, 8, 4}).valid());
+        REQUIRE_FALSE(loadLayout(2, {1, 4, 2, 3}).valid());
+    }
+
+    SECTION("Overflows") {
+        const size_t max = std::numeric_limits<size_t>::max();
+        REQUIRE_FALSE(warabi::Layout::contiguous(max - 2, 4).valid());
+        REQUIRE_FALSE(warabi::Layout::vector(0, max / 2, 4, 4).valid());
+        REQUIRE_FALSE(warabi::Layout::subarray(0, {max / 2, 4}, {1, 1}, {0, 0}, 1).valid());
+        REQUIRE_FALSE(warabi::Layout::indexed({{max - 2, 4}, {0, 2}}).valid());
+    }
+
+    SECTION("Bogus segment count") {
+        TestArchive ar;
+        ar.append(uint8_t{3});
+        ar.append(uint64_t{1} << 60);
+        ar.append(true);
+        ar.append(uint64_t{0});
+        ar.append(uint64_t{8});
+        warabi::Layout layout;
+        REQUIRE_THROWS(layout.load(ar));
+    }
+}
+
+TEST_CASE("Layout transfer test", "[layout]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // testing both eager and bulk paths
+    auto threshold = GENERATE(0, 1024*1024);
+    CAPTURE(threshold);
+    th.setEagerReadThreshold(threshold);
+    th.setEagerWriteThreshold(threshold);
+
+    const size_t region_size = 64*1024;
+    std::string in(region_size, '\0');
+    for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, region_size));
+    REQUIRE_NOTHROW(th.write(region, 0, in.data(), in.size()));
+
+    auto layout = GENERATE(
+        warabi::Layout::contiguous(100, 1000),
+        warabi::Layout::vector(3, 100, 7, 50),
+        warabi::Layout::subarray(16, {16, 32, 8}, {4, 8, 3}, {2, 5, 1}, 8),
+        warabi::Layout::indexed({{5000, 10}, {10, 20}, {60000, 100}}));
+
+    SECTION("Read") {
+        std::string out(layout.size(), '\0');
+        REQUIRE_NOTHROW(th.read(region, layout, out.data()));
+        REQUIRE(out == gather(in, layout));
+    }
+
+    SECTION("Write, persist, and asynchronous read") {
+        std::string data(layout.size(), '\0');
+        for(size_t i = 0; i < data.size(); ++i) data[i] = 'a' + (i % 26);
+        REQUIRE_NOTHROW(th.write(region, layout, data.data()));
+        REQUIRE_NOTHROW(th.persist(region, layout));
+        std::string out(layout.size(), '\0');
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.read(region, layout, out.data(), &req));
+        REQUIRE_NOTHROW(req.wait());
+        REQUIRE(out == data);
+        // bytes outside of the layout are untouched
+        std::string all(region_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, all.data(), all.size()));
+        std::string expected = in;
+        size_t pos = 0;
+        layout.forEach([&](size_t offset, size_t size) {
+            expected.replace(offset, size, data, pos, size);
+            pos += size;
+        });
+        REQUIRE(all == expected);
+    }
+
+    SECTION("Out of bounds") {
+        auto bad = warabi::Layout::vector(region_size - 10, 2, 4, 8);
+        std::string out(bad.size(), '\0');
+        REQUIRE_THROWS_AS(th.read(region, bad, out.data()), warabi::Exception);
+        auto overflow = warabi::Layout::vector(std::numeric_limits<size_t>::max() - 2, 1, 4, 4);
+        REQUIRE_THROWS_AS(th.read(region, overflow, out.data()), warabi::Exception);
+    }
+}
+
+TEST_CASE("Large indexed layout test", "[layout]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    // more segments than can be sent inline, and than a backend batch
+    const size_t count = 3 * 4096 + 5;
+    warabi::Layout::Segments segments;
+    for(size_t i = 0; i < count; ++i) segments.emplace_back((count - 1 - i) * 3, 2);
+    auto layout = warabi::Layout::indexed(segments);
+    REQUIRE(layout.needsBulk());
+
+    std::string in(count * 3, '\0');
+    for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.createAndWrite(&region, in.data(), in.size()));
+
+    std::string out(layout.size(), '\0');
+    warabi::AsyncRequest req;
+    REQUIRE_NOTHROW(th.read(region, layout, out.data(), &req));
+    REQUIRE_NOTHROW(req.wait());
+    REQUIRE(out == gather(in, layout));
+
+    std::string data(layout.size(), 'z');
+    REQUIRE_NOTHROW(th.write(region, layout, data.data()));
+    REQUIRE_NOTHROW(th.read(region, layout, out.data()));
+    REQUIRE(out == data);
+}
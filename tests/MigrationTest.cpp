@@ -11,10 +11,11 @@
 #include <remi/remi-client.h>
 #include "defer.hpp"
 #include "configs.hpp"
+#include <atomic>
 
 TEST_CASE("Target migration test", "[migration]") {
 
-    auto target_type = GENERATE(as<std::string>{}, "pmdk", "abtio");
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
     auto tm_type = std::string{"__default__"};
 
     CAPTURE(target_type);
@@ -82,4 +83,50 @@ TEST_CASE("Target migration test", "[migration]") {
         REQUIRE_THROWS_AS(th1.createAndWrite(&rid, "abcd", 4),
                           warabi::Exception);
     }
+    SECTION("Incremental migration with concurrent writes") {
+        warabi::Client client(engine);
+        auto th1 = client.makeTargetHandle(addr, 1);
+        auto th2 = client.makeTargetHandle(addr, 2);
+
+        const size_t size = 1024*1024, chunk = 4096;
+        std::string expected(size, '\0');
+        for(size_t i = 0; i < size; ++i) expected[i] = 'a' + (i % 26);
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th1.createAndWrite(&region, expected.data(), size, true));
+
+        // keep writing until the target is locked and migrated,
+        // the writes that succeed must be found in the destination
+        std::atomic<bool> done{false};
+        auto es = thallium::xstream::create();
+        auto writer = es->make_thread([&]() {
+            for(size_t writes = 0; !done; ++writes) {
+                size_t offset = (writes * 7 % (size / chunk)) * chunk;
+                std::string data(chunk, 'A' + (writes % 26));
+                try {
+                    th1.write(region, offset, data.data(), chunk, true);
+                } catch(const warabi::Exception&) {
+                    break;
+                }
+                expected.replace(offset, chunk, data);
+            }
+        });
+
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "incremental": true
+        })";
+        REQUIRE_NOTHROW(provider1.migrateTarget(addr, 2, migrationOptions));
+        done = true;
+        writer->join();
+        es->join();
+
+        std::string out(size, 'x');
+        REQUIRE_NOTHROW(th2.read(region, 0, out.data(), size));
+        REQUIRE(out == expected);
+    }
+
+    SECTION("Invalid migration options") {
+        REQUIRE_THROWS_AS(provider1.migrateTarget(addr, 2, R"({"transport":"remi","streams":2})"),
+                          warabi::Exception);
+    }
 }
@@ -15,7 +15,7 @@
 
 TEST_CASE("Target migration test in C", "[migration]") {
 
-    auto target_type = GENERATE(as<std::string>{}, "pmdk", "abtio");
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
     auto tm_type = std::string{"__default__"};
 
     CAPTURE(target_type);
@@ -0,0 +1,128 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+TEST_CASE("Prefetch test", "[prefetch]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+    th.setEagerReadThreshold(128);
+    th.setEagerWriteThreshold(128);
+
+    // another client, whose writes are not seen by th's prefetched ranges
+    warabi::Client other_client(engine);
+    auto other_th = other_client.makeTargetHandle(addr, 42);
+
+    // testing both eager and bulk paths
+    auto chunk_size = GENERATE(64, 256);
+    CAPTURE(chunk_size);
+
+    const size_t region_size = 16 * chunk_size;
+    std::string in(region_size, '\0');
+    for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, region_size));
+    REQUIRE_NOTHROW(th.write(region, 0, in.data(), in.size()));
+
+    const std::string overwrite(chunk_size, 'x');
+
+    SECTION("Prefetched ranges are served locally") {
+        REQUIRE_NOTHROW(th.prefetch(region, 0, chunk_size));
+        std::string out(chunk_size, '\0');
+        // the first half waits for the prefetched range
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), chunk_size/2));
+        REQUIRE(out.substr(0, chunk_size/2) == in.substr(0, chunk_size/2));
+        REQUIRE_NOTHROW(other_th.write(region, 0, overwrite.data(), chunk_size));
+        // the second half comes from the range prefetched before the write
+        REQUIRE_NOTHROW(th.read(region, chunk_size/2, out.data(), chunk_size/2));
+        REQUIRE(out.substr(0, chunk_size/2) == in.substr(chunk_size/2, chunk_size/2));
+        // the range was consumed: the next read goes to the provider
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), chunk_size));
+        REQUIRE(out == overwrite);
+    }
+
+    SECTION("Local writes drop prefetched ranges") {
+        REQUIRE_NOTHROW(th.prefetch(region, 0, chunk_size));
+        REQUIRE_NOTHROW(th.write(region, 0, overwrite.data(), chunk_size));
+        std::string out(chunk_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), chunk_size));
+        REQUIRE(out == overwrite);
+    }
+
+    SECTION("Reads spanning several prefetched ranges") {
+        for(size_t i = 0; i < 8; ++i)
+            REQUIRE_NOTHROW(th.prefetch(region, i * chunk_size, chunk_size));
+        std::string out(region_size, '\0');
+        // covers ranges 1 to 3 and part of what was not prefetched
+        REQUIRE_NOTHROW(th.read(region, chunk_size + 1, out.data(), 8 * chunk_size));
+        REQUIRE(out.substr(0, 8 * chunk_size) == in.substr(chunk_size + 1, 8 * chunk_size));
+        // range 0 was dropped when range 1 was read
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), region_size));
+        REQUIRE(out == in);
+    }
+
+    SECTION("Prefetching the beginning of several regions") {
+        std::vector<warabi::RegionID> regions(4);
+        for(size_t i = 0; i < regions.size(); ++i) {
+            std::string content(chunk_size, 'a' + i);
+            REQUIRE_NOTHROW(th.createAndWrite(&regions[i], content.data(), content.size()));
+        }
+        // more regions than the depth: the last ones are hinted to the provider
+        th.setReadahead(2);
+        REQUIRE_NOTHROW(th.prefetch(regions, chunk_size));
+        for(size_t i = 0; i < regions.size(); ++i) {
+            std::string out(chunk_size, '\0');
+            REQUIRE_NOTHROW(th.read(regions[i], 0, out.data(), out.size()));
+            REQUIRE(out == std::string(chunk_size, 'a' + i));
+        }
+    }
+
+    SECTION("Sequential readahead") {
+        REQUIRE_THROWS_AS(th.setReadahead(0, chunk_size), warabi::Exception);
+        th.setReadahead(2, chunk_size);
+        std::string out(chunk_size, '\0');
+        // the second sequential read triggers readahead of the next 2 chunks
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), chunk_size));
+        REQUIRE_NOTHROW(th.read(region, chunk_size, out.data(), chunk_size));
+        REQUIRE(out == in.substr(chunk_size, chunk_size));
+        // waits for the chunk read ahead
+        REQUIRE_NOTHROW(th.read(region, 2 * chunk_size, out.data(), chunk_size/2));
+        REQUIRE_NOTHROW(other_th.write(region, 2 * chunk_size, overwrite.data(), chunk_size));
+        REQUIRE_NOTHROW(th.read(region, 2 * chunk_size + chunk_size/2, out.data(), chunk_size/2));
+        REQUIRE(out.substr(0, chunk_size/2) == in.substr(2 * chunk_size + chunk_size/2, chunk_size/2));
+        // scan the rest of the region: readahead past its end is harmless
+        for(size_t offset = 3 * chunk_size; offset < region_size; offset += chunk_size) {
+            REQUIRE_NOTHROW(th.read(region, offset, out.data(), chunk_size));
+            REQUIRE(out == in.substr(offset, chunk_size));
+        }
+        REQUIRE_THROWS_AS(th.read(region, region_size, out.data(), chunk_size), warabi::Exception);
+    }
+
+    SECTION("Asynchronous reads bypass prefetched ranges") {
+        REQUIRE_NOTHROW(th.prefetch(region, 0, chunk_size));
+        std::string out(chunk_size/2, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE_NOTHROW(other_th.write(region, 0, overwrite.data(), chunk_size));
+        auto req = th.readAsync(region, 0, out.data(), out.size());
+        REQUIRE_NOTHROW(req.wait());
+        REQUIRE(out == overwrite.substr(0, chunk_size/2));
+    }
+}
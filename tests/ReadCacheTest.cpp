@@ -0,0 +1,140 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+TEST_CASE("Read cache test", "[read-cache]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+    th.setEagerReadThreshold(128);
+    th.setEagerWriteThreshold(128);
+
+    // testing both eager and bulk paths
+    auto data_size = GENERATE(64, 4096);
+    CAPTURE(data_size);
+
+    std::string in(data_size, '\0');
+    for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, data_size));
+    REQUIRE_NOTHROW(th.write(region, 0, in.data(), in.size()));
+
+    SECTION("Disabled by default") {
+        std::string out(data_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == in);
+        auto stats = client.getReadCacheStats();
+        REQUIRE(stats.misses == 0);
+        REQUIRE(stats.entries == 0);
+        REQUIRE_THROWS_AS(client.enableReadCache(warabi::ReadCacheOptions{0}), warabi::Exception);
+    }
+
+    SECTION("Hits within the lease") {
+        warabi::ReadCacheOptions options;
+        options.leaseMs = 60*1000;
+        client.enableReadCache(options);
+        std::string out(data_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == in);
+        // a sub-range of the cached range
+        std::string part(data_size/2, '\0');
+        REQUIRE_NOTHROW(th.read(region, data_size/4, part.data(), part.size()));
+        REQUIRE(part == in.substr(data_size/4, data_size/2));
+        auto stats = client.getReadCacheStats();
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.hits == 1);
+        REQUIRE(stats.entries == 1);
+        REQUIRE(stats.bytes == (size_t)data_size);
+    }
+
+    SECTION("Validated hits and local invalidation") {
+        client.enableReadCache();
+        std::string out(data_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == in);
+        auto stats = client.getReadCacheStats();
+        REQUIRE(stats.misses == 1);
+        REQUIRE(stats.validatedHits == 1);
+        REQUIRE(stats.hits == 0);
+
+        REQUIRE_NOTHROW(th.write(region, 0, "abc", 3));
+        stats = client.getReadCacheStats();
+        REQUIRE(stats.invalidations == 1);
+        REQUIRE(stats.entries == 0);
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out.substr(0, 3) == "abc");
+        REQUIRE(out.substr(3) == in.substr(3));
+    }
+
+    SECTION("Writes from another client are detected") {
+        client.enableReadCache();
+        std::string out(data_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+
+        warabi::Client other_client(engine);
+        auto other_th = other_client.makeTargetHandle(addr, 42);
+        REQUIRE_NOTHROW(other_th.write(region, 0, "xyz", 3));
+
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out.substr(0, 3) == "xyz");
+        auto stats = client.getReadCacheStats();
+        REQUIRE(stats.misses == 2);
+        REQUIRE(stats.validatedHits == 0);
+    }
+
+    SECTION("Eviction and size limits") {
+        warabi::ReadCacheOptions options;
+        options.capacity     = data_size;
+        options.maxEntrySize = data_size;
+        client.enableReadCache(options);
+        warabi::RegionID other;
+        REQUIRE_NOTHROW(th.create(&other, 2*data_size));
+        std::string out(2*data_size, '\0');
+        // too large to be cached
+        REQUIRE_NOTHROW(th.read(other, 0, out.data(), out.size()));
+        REQUIRE(client.getReadCacheStats().entries == 0);
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), data_size));
+        REQUIRE_NOTHROW(th.read(other, 0, out.data(), data_size));
+        auto stats = client.getReadCacheStats();
+        REQUIRE(stats.entries == 1);
+        REQUIRE(stats.evictions == 1);
+    }
+
+    SECTION("Asynchronous reads bypass the cache") {
+        client.enableReadCache();
+        std::string out(data_size, '\0');
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size(), &req));
+        REQUIRE_NOTHROW(req.wait());
+        REQUIRE(out == in);
+        REQUIRE(client.getReadCacheStats().misses == 0);
+    }
+
+    SECTION("Erased regions are invalidated") {
+        client.enableReadCache();
+        std::string out(data_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE_NOTHROW(th.erase(region));
+        REQUIRE(client.getReadCacheStats().entries == 0);
+        REQUIRE_THROWS_AS(th.read(region, 0, out.data(), out.size()), warabi::Exception);
+    }
+}
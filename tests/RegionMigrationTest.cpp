@@ -0,0 +1,99 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <atomic>
+#include <cstring>
+#include <string>
+
+TEST_CASE("Live region migration test", "[region-migration]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    CAPTURE(target_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider source_provider(engine, 42, makeConfigForProvider(target_type, "__default__"));
+    warabi::Provider dest_provider(engine, 43, makeConfigForProvider("memory", "__default__"));
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle source = client.makeTargetHandle(addr, 42);
+    warabi::TargetHandle dest = client.makeTargetHandle(addr, 43);
+
+    SECTION("Idle regions") {
+        const std::string data = "Migrated from provider to provider";
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(source.createAndWrite(&region, data.data(), data.size()));
+        std::vector<warabi::RegionID> moved;
+        REQUIRE_NOTHROW(moved = source_provider.migrateRegions({region}, addr, 43));
+        REQUIRE(moved.size() == 1);
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(dest.read(moved[0], 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        // requests sent with the old handle and RegionID are redirected
+        out.assign(data.size(), 'x');
+        REQUIRE_NOTHROW(source.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        REQUIRE_NOTHROW(source.write(region, 0, "M", 1));
+        REQUIRE_NOTHROW(dest.read(moved[0], 0, out.data(), 1));
+        REQUIRE(out[0] == 'M');
+        // a region cannot be migrated twice
+        REQUIRE_THROWS_AS(source_provider.migrateRegions({region}, addr, 43), warabi::Exception);
+    }
+
+    SECTION("Regions written during the migration") {
+        // larger than the chunks in which regions are sent
+        const size_t size = 8*1024*1024, chunk = 64*1024;
+        std::string expected(size, '\0');
+        for(size_t i = 0; i < size; ++i) expected[i] = 'a' + (i % 26);
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(source.create(&region, size));
+        REQUIRE_NOTHROW(source.write(region, 0, expected.data(), size));
+
+        std::atomic<bool> done{false};
+        size_t writes = 0;
+        auto es = thallium::xstream::create();
+        auto writer = es->make_thread([&]() {
+            while(!done || writes < 16) {
+                size_t offset = (writes * 7 % (size / chunk)) * chunk;
+                std::memset(&expected[offset], 'A' + (writes % 26), chunk);
+                source.write(region, offset, &expected[offset], chunk);
+                writes += 1;
+            }
+        });
+        std::vector<warabi::RegionID> moved;
+        REQUIRE_NOTHROW(moved = source_provider.migrateRegions(
+            {region}, addr, 43, R"({"max_rounds":4,"switchover_size":262144})"));
+        done = true;
+        writer->join();
+        es->join();
+
+        std::string out(size, 'x');
+        REQUIRE_NOTHROW(dest.read(moved[0], 0, out.data(), size));
+        REQUIRE(out == expected);
+        out.assign(size, 'x');
+        REQUIRE_NOTHROW(source.read(region, 0, out.data(), size));
+        REQUIRE(out == expected);
+    }
+
+    SECTION("Invalid migrations") {
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(source.create(&region, 16));
+        REQUIRE_THROWS_AS(source_provider.migrateRegions(
+            {region}, addr, 43, R"({"max_rounds":"a lot"})"), warabi::Exception);
+        REQUIRE_THROWS_AS(source_provider.migrateRegions({region}, addr, 44), warabi::Exception);
+        // a failed migration leaves the region in place
+        REQUIRE_NOTHROW(source.write(region, 0, "still here", 10));
+    }
+}
@@ -0,0 +1,89 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <string>
+
+TEST_CASE("Region resize, copy and clone test", "[region-ops]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    CAPTURE(target_type);
+
+    auto pr_config = makeConfigForProvider(target_type, "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    const std::string data = "0123456789abcdefghijklmnopqrstuv";
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, data.size()));
+    REQUIRE_NOTHROW(th.write(region, 0, data.data(), data.size()));
+
+    SECTION("Resize") {
+        // growing keeps the content and zero-fills the new bytes
+        REQUIRE_NOTHROW(th.resize(&region, 2*data.size()));
+        std::string out(2*data.size(), 'x');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data + std::string(data.size(), '\0'));
+        // shrinking keeps the beginning of the region
+        REQUIRE_NOTHROW(th.resize(&region, 16));
+        out.resize(16);
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data.substr(0, 16));
+        // asynchronous resize
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.resize(&region, 64, &req));
+        REQUIRE_NOTHROW(req.wait());
+        out.resize(64);
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out.substr(0, 16) == data.substr(0, 16));
+    }
+
+    SECTION("Copy") {
+        warabi::RegionID other;
+        REQUIRE_NOTHROW(th.create(&other, data.size()));
+        REQUIRE_NOTHROW(th.copy(region, 8, other, 0, 16));
+        std::string out(16, 'x');
+        REQUIRE_NOTHROW(th.read(other, 0, out.data(), out.size()));
+        REQUIRE(out == data.substr(8, 16));
+        // overlapping ranges of the same region
+        REQUIRE_NOTHROW(th.copy(region, 0, region, 8, 24));
+        out.resize(data.size());
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data.substr(0, 8) + data.substr(0, 24));
+        // out of bounds
+        REQUIRE_THROWS_AS(th.copy(region, 0, other, 0, 1024*1024), warabi::Exception);
+    }
+
+    SECTION("Clone") {
+        warabi::RegionID clone;
+        REQUIRE_NOTHROW(th.clone(region, &clone));
+        REQUIRE(clone != region);
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(th.read(clone, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        // the clone and the region are independent
+        const std::string update = "ZZZZ";
+        REQUIRE_NOTHROW(th.write(region, 0, update.data(), update.size()));
+        REQUIRE_NOTHROW(th.read(clone, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        REQUIRE_NOTHROW(th.write(clone, 4, update.data(), update.size()));
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == update + data.substr(4));
+    }
+}
@@ -0,0 +1,112 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <nlohmann/json.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+using json = nlohmann::json;
+
+TEST_CASE("Request timings test", "[timings]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    auto tm_type = GENERATE(as<std::string>{}, "__default__", "pipeline");
+
+    CAPTURE(target_type);
+    CAPTURE(tm_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    std::string in(8192, 'A');
+    std::string out(in.size(), '\0');
+
+    SECTION("Timings not reported") {
+        auto pr_config = makeConfigForProvider(target_type, tm_type);
+        warabi::Provider provider(engine, 42, pr_config);
+        warabi::Client client(engine);
+        warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+        warabi::RegionID regionID;
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.create(&regionID, in.size()));
+        REQUIRE_NOTHROW(th.write(regionID, 0, in.data(), in.size(), false, &req));
+        auto timings = req.timings();
+        REQUIRE(!timings.valid);
+        REQUIRE(timings.total_ns > 0);
+
+        // only the requests with server timings are aggregated
+        auto stats = client.getTimingStats();
+        REQUIRE(stats.total.count == 0);
+    }
+
+    SECTION("Timings reported") {
+        auto pr_config = json::parse(makeConfigForProvider(target_type, tm_type));
+        pr_config["report_timings"] = true;
+        warabi::Provider provider(engine, 42, pr_config.dump());
+        warabi::Client client(engine);
+        warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+        warabi::RegionID regionID;
+        REQUIRE_NOTHROW(th.create(&regionID, in.size()));
+
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.write(regionID, 0, in.data(), in.size(), true, &req));
+        auto timings = req.timings();
+        REQUIRE(timings.valid);
+        REQUIRE(timings.handler_ns > 0);
+        REQUIRE(timings.transfer_ns > 0);
+        REQUIRE(timings.total_ns >= timings.handler_ns);
+        REQUIRE(timings.queueAndNetworkNs() == timings.total_ns - timings.handler_ns);
+
+        REQUIRE_NOTHROW(th.read(regionID, 0, out.data(), out.size(), &req));
+        timings = req.timings();
+        REQUIRE(timings.valid);
+        REQUIRE(timings.transfer_ns > 0);
+        REQUIRE(in == out);
+
+        // eager requests do not involve RDMA
+        REQUIRE_NOTHROW(th.read(regionID, 0, out.data(), 16, &req));
+        timings = req.timings();
+        REQUIRE(timings.valid);
+        REQUIRE(timings.transfer_ns == 0);
+        REQUIRE(timings.backend_ns > 0);
+
+        auto stats = client.getTimingStats();
+        REQUIRE(stats.total.count == 4);
+        REQUIRE(stats.handler.count == 4);
+        REQUIRE(stats.transfer.max_ns > 0);
+        REQUIRE(stats.total.meanNs() >= stats.handler.meanNs());
+
+        client.resetTimingStats();
+        stats = client.getTimingStats();
+        REQUIRE(stats.total.count == 0);
+    }
+
+    SECTION("Latency measured on completion") {
+        auto pr_config = json::parse(makeConfigForProvider(target_type, tm_type));
+        pr_config["report_timings"] = true;
+        warabi::Provider provider(engine, 42, pr_config.dump());
+        warabi::Client client(engine);
+        warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+        warabi::RegionID regionID;
+        REQUIRE_NOTHROW(th.create(&regionID, in.size()));
+
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.write(regionID, 0, in.data(), in.size(), false, &req));
+        while(!req.completed()) thallium::thread::yield();
+        // waiting later does not add to the latency of the request
+        thallium::thread::sleep(engine, 500);
+        auto timings = req.timings();
+        REQUIRE(timings.valid);
+        REQUIRE(timings.total_ns < 500000000);
+    }
+}
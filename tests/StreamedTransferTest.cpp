@@ -0,0 +1,113 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+// migrations using the "rpc" transport, which does not need REMI
+TEST_CASE("Streamed target transfer test", "[migration]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    auto tm_type = std::string{"__default__"};
+
+    CAPTURE(target_type);
+
+    auto pr_config = makeConfigForProvider(target_type, tm_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider1(engine, 1, pr_config);
+    warabi::Provider provider2(engine, 2, "{}");
+    std::string addr = engine.self();
+
+    SECTION("Streamed migration with progress") {
+        warabi::Client client(engine);
+        auto th1 = client.makeTargetHandle(addr, 1);
+        auto th2 = client.makeTargetHandle(addr, 2);
+
+        const std::string data = "Streamed to another provider";
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th1.createAndWrite(&region, data.data(), data.size(), true));
+
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "transfer_size": 65536,
+            "streams": 4,
+            "compression": "sparse",
+            "max_bandwidth": 1073741824
+        })";
+        warabi::AsyncMigration migration;
+        REQUIRE_NOTHROW(provider1.migrateTarget(addr, 2, migrationOptions, &migration));
+        REQUIRE(static_cast<bool>(migration));
+        REQUIRE_NOTHROW(migration.wait());
+        REQUIRE(migration.completed());
+        REQUIRE(migration.bytesTotal() > 0);
+        REQUIRE(migration.bytesTransferred() == migration.bytesTotal());
+        REQUIRE(migration.bytesSent() <= migration.bytesTransferred());
+        REQUIRE(migration.throughput() > 0);
+
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(th2.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        REQUIRE_THROWS_AS(th1.read(region, 0, out.data(), out.size()), warabi::Exception);
+    }
+
+    SECTION("Incremental streamed migration") {
+        warabi::Client client(engine);
+        auto th1 = client.makeTargetHandle(addr, 1);
+        auto th2 = client.makeTargetHandle(addr, 2);
+
+        const std::string data = "Streamed in two phases";
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th1.createAndWrite(&region, data.data(), data.size(), true));
+
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "transport": "rpc",
+            "incremental": true
+        })";
+        REQUIRE_NOTHROW(provider1.migrateTarget(addr, 2, migrationOptions));
+
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(th2.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+    }
+
+    SECTION("Cancelled migration") {
+        warabi::Client client(engine);
+        auto th1 = client.makeTargetHandle(addr, 1);
+
+        const std::string data = "Still in the source provider";
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th1.createAndWrite(&region, data.data(), data.size(), true));
+
+        // a throttled migration gives the time to cancel it
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "transfer_size": 4096,
+            "max_bandwidth": 4096
+        })";
+        warabi::AsyncMigration migration;
+        REQUIRE_NOTHROW(provider1.migrateTarget(addr, 2, migrationOptions, &migration));
+        REQUIRE_NOTHROW(migration.cancel());
+        REQUIRE_THROWS_AS(migration.wait(), warabi::Exception);
+
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(th1.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+    }
+
+    SECTION("Invalid migration options") {
+        REQUIRE_THROWS_AS(provider1.migrateTarget(addr, 2, R"({"streams":0})"),
+                          warabi::Exception);
+        REQUIRE_THROWS_AS(provider1.migrateTarget(addr, 2, R"({"compression":"zip"})"),
+                          warabi::Exception);
+    }
+}
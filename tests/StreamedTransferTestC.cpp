@@ -0,0 +1,126 @@
+/*
+ * (C) 2020 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/client.h>
+#include <warabi/server.h>
+#include <thallium.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+TEST_CASE("Streamed target transfer test in C", "[migration]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    auto tm_type = std::string{"__default__"};
+
+    CAPTURE(target_type);
+
+    auto pr_config = makeConfigForProvider(target_type, tm_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi_err_t err = WARABI_SUCCESS;
+    DEFER(warabi_err_free(err));
+
+    warabi_provider_t provider1, provider2;
+    err = warabi_provider_register(&provider1, engine.get_margo_instance(), 1, pr_config.c_str(), nullptr);
+    REQUIRE(err == WARABI_SUCCESS);
+    DEFER(warabi_provider_deregister(provider1));
+    err = warabi_provider_register(&provider2, engine.get_margo_instance(), 2, "{}", nullptr);
+    REQUIRE(err == WARABI_SUCCESS);
+    DEFER(warabi_provider_deregister(provider2));
+
+    std::string addr = engine.self();
+
+    warabi_client_t client;
+    err = warabi_client_create(engine.get_margo_instance(), &client);
+    REQUIRE(err == WARABI_SUCCESS);
+    DEFER(warabi_client_free(client));
+
+    warabi_target_handle_t th1, th2;
+    err = warabi_client_make_target_handle(client, addr.c_str(), 1, &th1);
+    REQUIRE(err == WARABI_SUCCESS);
+    DEFER(warabi_target_handle_free(th1));
+    err = warabi_client_make_target_handle(client, addr.c_str(), 2, &th2);
+    REQUIRE(err == WARABI_SUCCESS);
+    DEFER(warabi_target_handle_free(th2));
+
+    const std::string data = "Streamed to another provider";
+    warabi_region_t region;
+    err = warabi_create_write(th1, data.data(), data.size(), true, &region, nullptr);
+    REQUIRE(err == WARABI_SUCCESS);
+
+    SECTION("Migrate synchronously") {
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "transport": "rpc"
+        })";
+        err = warabi_provider_migrate(provider1, addr.c_str(), 2, migrationOptions);
+        REQUIRE(err == WARABI_SUCCESS);
+
+        std::string out(data.size(), 'x');
+        err = warabi_read(th2, region, 0, out.data(), out.size(), nullptr);
+        REQUIRE(err == WARABI_SUCCESS);
+        REQUIRE(out == data);
+    }
+
+    SECTION("Migrate asynchronously with progress") {
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "streams": 2,
+            "compression": "sparse"
+        })";
+        warabi_migration_t migration = WARABI_MIGRATION_NULL;
+        err = warabi_provider_migrate_async(provider1, addr.c_str(), 2, migrationOptions, &migration);
+        REQUIRE(err == WARABI_SUCCESS);
+        REQUIRE(migration != WARABI_MIGRATION_NULL);
+
+        bool flag = false;
+        while(!flag) {
+            err = warabi_migration_test(migration, &flag);
+            REQUIRE(err == WARABI_SUCCESS);
+            if(!flag) thallium::thread::sleep(engine, 10);
+        }
+        warabi_migration_progress_t progress;
+        err = warabi_migration_get_progress(migration, &progress);
+        REQUIRE(err == WARABI_SUCCESS);
+        REQUIRE(progress.bytes_total > 0);
+        REQUIRE(progress.bytes_transferred == progress.bytes_total);
+        REQUIRE(progress.bytes_sent <= progress.bytes_transferred);
+        REQUIRE(progress.elapsed > 0);
+
+        err = warabi_migration_wait(migration);
+        REQUIRE(err == WARABI_SUCCESS);
+
+        std::string out(data.size(), 'x');
+        err = warabi_read(th2, region, 0, out.data(), out.size(), nullptr);
+        REQUIRE(err == WARABI_SUCCESS);
+        REQUIRE(out == data);
+    }
+
+    SECTION("Cancel an asynchronous migration") {
+        // a throttled migration gives the time to cancel it
+        auto migrationOptions = R"({
+            "new_root": "/tmp/warabi-migrated-targets",
+            "transfer_size": 4096,
+            "max_bandwidth": 4096
+        })";
+        warabi_migration_t migration = WARABI_MIGRATION_NULL;
+        err = warabi_provider_migrate_async(provider1, addr.c_str(), 2, migrationOptions, &migration);
+        REQUIRE(err == WARABI_SUCCESS);
+        err = warabi_migration_cancel(migration);
+        REQUIRE(err == WARABI_SUCCESS);
+        err = warabi_migration_wait(migration);
+        REQUIRE(err != WARABI_SUCCESS);
+        warabi_err_free(err); err = WARABI_SUCCESS;
+
+        std::string out(data.size(), 'x');
+        err = warabi_read(th1, region, 0, out.data(), out.size(), nullptr);
+        REQUIRE(err == WARABI_SUCCESS);
+        REQUIRE(out == data);
+    }
+}
@@ -0,0 +1,152 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetGroup.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <algorithm>
+#include <numeric>
+
+TEST_CASE("TargetGroup test", "[target-group]") {
+
+    auto placement = GENERATE(warabi::Placement::ConsistentHashing,
+                              warabi::Placement::LeastLoaded);
+    CAPTURE(placement);
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider1(engine, 1, pr_config);
+    warabi::Provider provider2(engine, 2, pr_config);
+    warabi::Provider provider3(engine, 3, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    std::vector<std::pair<std::string, uint16_t>> targets = {
+        {addr, 1}, {addr, 2}, {addr, 3}
+    };
+
+    warabi::TargetGroup group = client.makeTargetGroup(targets, placement);
+    REQUIRE(static_cast<bool>(group));
+    REQUIRE(group.size() == 3);
+    REQUIRE(group.placement() == placement);
+
+    SECTION("Placement") {
+        if(placement == warabi::Placement::ConsistentHashing) {
+            warabi::TargetGroup other = client.makeTargetGroup(targets, placement);
+            for(int i = 0; i < 32; ++i) {
+                auto key = std::to_string(i);
+                REQUIRE(group.place(key) == other.place(key));
+            }
+        } else {
+            warabi::GroupRegionID region;
+            group.create(&region, 1024);
+            REQUIRE(group.place() != region.target);
+        }
+    }
+
+    SECTION("Create, write, read, erase") {
+        std::vector<char> data(1024);
+        std::iota(data.begin(), data.end(), 0);
+        warabi::GroupRegionID region;
+        REQUIRE_NOTHROW(group.create(&region, data.size(), "my-key"));
+        REQUIRE(region.target < group.size());
+        REQUIRE_NOTHROW(group.write(region, 0, data.data(), data.size(), true));
+
+        std::vector<char> out(data.size());
+        REQUIRE_NOTHROW(group.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+
+        // the region is only in the target it was placed on
+        std::vector<char> tmp(data.size());
+        auto& owner = group.target(region.target);
+        REQUIRE_NOTHROW(owner.read(region.region, 0, tmp.data(), tmp.size()));
+        auto& other = group.target((region.target + 1) % group.size());
+        REQUIRE_THROWS_AS(other.read(region.region, 0, tmp.data(), tmp.size()),
+                          warabi::Exception);
+
+        REQUIRE_NOTHROW(group.erase(region));
+    }
+
+    SECTION("Batch operations") {
+        std::vector<std::string> contents;
+        for(int i = 0; i < 16; ++i)
+            contents.push_back(std::string(64 + i, 'a' + i));
+        std::vector<std::pair<const char*, size_t>> in;
+        for(auto& c : contents) in.emplace_back(c.data(), c.size());
+
+        std::vector<warabi::GroupRegionID> regions;
+        REQUIRE_NOTHROW(group.createAndWriteBatch(&regions, in, true));
+        REQUIRE(regions.size() == contents.size());
+
+        std::vector<bool> used(group.size(), false);
+        for(auto& r : regions) used[r.target] = true;
+        REQUIRE(std::count(used.begin(), used.end(), true) > 1);
+
+        std::vector<std::string> results;
+        for(auto& c : contents) results.push_back(std::string(c.size(), '\0'));
+        std::vector<std::pair<char*, size_t>> out;
+        for(auto& r : results) out.emplace_back(r.data(), r.size());
+        REQUIRE_NOTHROW(group.readBatch(regions, out));
+        REQUIRE(results == contents);
+
+        REQUIRE_NOTHROW(group.eraseBatch(regions));
+    }
+
+    SECTION("Striped objects") {
+        std::vector<char> data(10*1000 + 17);
+        std::iota(data.begin(), data.end(), 0);
+        warabi::StripedObject object;
+        REQUIRE_NOTHROW(group.createStriped(&object, data.data(), data.size(), 1000, true, "object"));
+        REQUIRE(object.size == data.size());
+        REQUIRE(object.stripes.size() == 11);
+        for(size_t i = 1; i < object.stripes.size(); ++i)
+            REQUIRE(object.stripes[i].target == (object.stripes[0].target + i) % group.size());
+
+        std::vector<char> out(data.size());
+        REQUIRE_NOTHROW(group.readStriped(object, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+
+        // range across three stripes
+        std::vector<char> update(2500, 'x');
+        REQUIRE_NOTHROW(group.writeStriped(object, 1500, update.data(), update.size()));
+        std::copy(update.begin(), update.end(), data.begin() + 1500);
+
+        warabi::StripedObject opened;
+        REQUIRE_NOTHROW(group.openStriped(&opened, object.manifest));
+        REQUIRE(opened.size == object.size);
+        REQUIRE(opened.stripeSize == object.stripeSize);
+        REQUIRE(opened.stripes.size() == object.stripes.size());
+        std::vector<char> part(3000);
+        REQUIRE_NOTHROW(group.readStriped(opened, 1000, part.data(), part.size()));
+        REQUIRE(std::equal(part.begin(), part.end(), data.begin() + 1000));
+
+        REQUIRE_THROWS_AS(group.readStriped(opened, data.size() - 10, part.data(), 20),
+                          warabi::Exception);
+        REQUIRE_THROWS_AS(group.openStriped(&opened, object.stripes[0]),
+                          warabi::Exception);
+        REQUIRE_THROWS_AS(group.createStriped(&opened, data.data(), data.size(), 0),
+                          warabi::Exception);
+
+        REQUIRE_NOTHROW(group.eraseStriped(object));
+    }
+
+    SECTION("Invalid regions") {
+        warabi::GroupRegionID region;
+        region.target = 3;
+        char buffer[8];
+        REQUIRE_THROWS_AS(group.read(region, 0, buffer, sizeof(buffer)),
+                          warabi::Exception);
+        REQUIRE_THROWS_AS(group.target(3), warabi::Exception);
+        REQUIRE_THROWS_AS(client.makeTargetGroup({}), warabi::Exception);
+    }
+}
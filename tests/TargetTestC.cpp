@@ -211,5 +211,57 @@ TEST_CASE("Target tests in C", "[c/target]") {
             REQUIRE(err != WARABI_SUCCESS);
             warabi_err_free(err); err = WARABI_SUCCESS;
         }
+
+        SECTION("With multiple non-blocking requests") {
+            std::vector<char> in(196);
+            for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+
+            /* create regions in parallel */
+            const size_t count = 4;
+            std::vector<warabi_region_t> regions(count);
+            std::vector<warabi_async_request_t> reqs(count, WARABI_ASYNC_REQUEST_NULL);
+            for(size_t i = 0; i < count; ++i) {
+                err = warabi_create_write(th, in.data(), in.size(), false, &regions[i], &reqs[i]);
+                REQUIRE(err == WARABI_SUCCESS);
+            }
+
+            bool flag = false;
+            err = warabi_test_all(count, reqs.data(), &flag);
+            REQUIRE(err == WARABI_SUCCESS);
+
+            /* wait for all of them, in any order */
+            std::vector<bool> done(count, false);
+            for(size_t i = 0; i < count; ++i) {
+                size_t index = count;
+                err = warabi_wait_any(count, reqs.data(), &index);
+                REQUIRE(err == WARABI_SUCCESS);
+                REQUIRE(index < count);
+                REQUIRE(!done[index]);
+                REQUIRE(reqs[index] == WARABI_ASYNC_REQUEST_NULL);
+                done[index] = true;
+            }
+
+            /* no request left */
+            size_t index = 0;
+            err = warabi_wait_any(count, reqs.data(), &index);
+            REQUIRE(err == WARABI_SUCCESS);
+            REQUIRE(index == count);
+            err = warabi_test_all(count, reqs.data(), &flag);
+            REQUIRE(err == WARABI_SUCCESS);
+            REQUIRE(flag);
+
+            /* a failed request is reported by warabi_wait_any */
+            err = warabi_erase(th, invalid_region, &reqs[2]);
+            REQUIRE(err == WARABI_SUCCESS);
+            err = warabi_wait_any(count, reqs.data(), &index);
+            REQUIRE(err != WARABI_SUCCESS);
+            REQUIRE(index == 2);
+            warabi_err_free(err); err = WARABI_SUCCESS;
+
+            for(auto& region : regions) {
+                err = warabi_erase(th, region, nullptr);
+                REQUIRE(err == WARABI_SUCCESS);
+            }
+        }
     }
 }
@@ -0,0 +1,88 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <unistd.h>
+#include "defer.hpp"
+#include "configs.hpp"
+
+using json = nlohmann::json;
+
+TEST_CASE("Tracing test", "[tracing]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "abtio");
+    auto tm_type = GENERATE(as<std::string>{}, "__default__", "pipeline");
+
+    CAPTURE(target_type);
+    CAPTURE(tm_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    // unique per process, since tests may run in parallel
+    const auto filename = (std::filesystem::temp_directory_path()
+        / ("warabi-trace-test-" + std::to_string(::getpid()) + ".json")).string();
+
+    SECTION("Tracing disabled") {
+        auto pr_config = makeConfigForProvider(target_type, tm_type);
+        warabi::Provider provider(engine, 42, pr_config);
+        REQUIRE_THROWS_AS(provider.dumpTrace(filename),
+                          warabi::Exception);
+    }
+
+    SECTION("Tracing enabled") {
+        auto pr_config = json::parse(makeConfigForProvider(target_type, tm_type));
+        pr_config["tracing"] = json{{"enabled", true}};
+        warabi::Provider provider(engine, 42, pr_config.dump());
+
+        auto config = json::parse(provider.getConfig());
+        REQUIRE(config["tracing"]["enabled"].get<bool>());
+
+        warabi::Client client(engine);
+        warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+        std::string in(8192, 'A');
+        warabi::RegionID regionID;
+        REQUIRE_NOTHROW(th.create(&regionID, in.size()));
+        REQUIRE_NOTHROW(th.write(regionID, 0, in.data(), in.size(), true));
+        std::string out(in.size(), '\0');
+        REQUIRE_NOTHROW(th.read(regionID, 0, out.data(), out.size()));
+        REQUIRE(in == out);
+
+        REQUIRE_NOTHROW(provider.dumpTrace(filename));
+        DEFER(std::filesystem::remove(filename));
+
+        std::ifstream file(filename);
+        REQUIRE(file.good());
+        json trace;
+        REQUIRE_NOTHROW(trace = json::parse(file));
+        REQUIRE(trace.contains("traceEvents"));
+        REQUIRE(trace["traceEvents"].is_array());
+
+        std::set<std::string> names;
+        std::set<uint64_t> request_ids;
+        for(auto& event : trace["traceEvents"]) {
+            if(event["ph"] != "X") continue;
+            REQUIRE(event["pid"].get<int>() == 42);
+            REQUIRE(event["dur"].get<double>() >= 0.0);
+            names.insert(event["name"].get<std::string>());
+            request_ids.insert(event["args"]["request_id"].get<uint64_t>());
+        }
+        REQUIRE(names.count("create") == 1);
+        REQUIRE(names.count("write") == 1);
+        REQUIRE(names.count("read") == 1);
+        REQUIRE(names.count("rdma") == 1);
+        // one request id per RPC, shared by all the spans of a request
+        REQUIRE(request_ids.size() == 3);
+    }
+}
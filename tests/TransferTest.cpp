@@ -0,0 +1,69 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+#include <string>
+
+TEST_CASE("Third-party region transfer test", "[transfer]") {
+
+    auto target_type = GENERATE(as<std::string>{}, "memory", "pmdk", "abtio");
+    auto tm_type = GENERATE(as<std::string>{}, "__default__", "pipeline");
+    CAPTURE(target_type);
+    CAPTURE(tm_type);
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider source_provider(engine, 42, makeConfigForProvider(target_type, "__default__"));
+    warabi::Provider dest_provider(engine, 43, makeConfigForProvider("memory", tm_type));
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle source = client.makeTargetHandle(addr, 42);
+    warabi::TargetHandle dest = client.makeTargetHandle(addr, 43);
+
+    SECTION("Small region") {
+        const std::string data = "Transferred from provider to provider";
+        warabi::RegionID region, copy;
+        REQUIRE_NOTHROW(source.createAndWrite(&region, data.data(), data.size()));
+        REQUIRE_NOTHROW(source.transfer(region, data.size(), dest, &copy));
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(dest.read(copy, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+        // the source region is left untouched
+        REQUIRE_NOTHROW(source.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+    }
+
+    SECTION("Large region, asynchronous") {
+        // larger than the chunks in which regions are sent
+        std::string data(6*1024*1024, '\0');
+        for(size_t i = 0; i < data.size(); ++i) data[i] = 'a' + (i % 26);
+        warabi::RegionID region, copy;
+        REQUIRE_NOTHROW(source.create(&region, data.size()));
+        REQUIRE_NOTHROW(source.write(region, 0, data.data(), data.size()));
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(source.transfer(region, data.size(), dest, &copy, false, &req));
+        REQUIRE_NOTHROW(req.wait());
+        std::string out(data.size(), 'x');
+        REQUIRE_NOTHROW(dest.read(copy, 0, out.data(), out.size()));
+        REQUIRE(out == data);
+    }
+
+    SECTION("Invalid destination") {
+        const std::string data = "data";
+        warabi::RegionID region, copy;
+        REQUIRE_NOTHROW(source.createAndWrite(&region, data.data(), data.size()));
+        warabi::TargetHandle invalid = client.makeTargetHandle(addr, 44);
+        REQUIRE_THROWS_AS(source.transfer(region, data.size(), invalid, &copy), warabi::Exception);
+    }
+}
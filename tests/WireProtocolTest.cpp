@@ -0,0 +1,106 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <warabi/Layout.hpp>
+#include <warabi/Exception.hpp>
+#include "defer.hpp"
+#include "configs.hpp"
+
+TEST_CASE("Wire protocol test", "[protocol]") {
+
+    auto pr_config = makeConfigForProvider("memory", "__default__");
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    warabi::Provider provider(engine, 42, pr_config);
+
+    warabi::Client client(engine);
+    std::string addr = engine.self();
+    warabi::TargetHandle th = client.makeTargetHandle(addr, 42);
+
+    SECTION("Negotiation") {
+        REQUIRE(th.protocolVersion() == 0);
+        warabi::RegionID region;
+        REQUIRE_NOTHROW(th.create(&region, 16));
+        REQUIRE(th.protocolVersion() == 2);
+        REQUIRE_THROWS_AS(th.setProtocolVersion(3), warabi::Exception);
+        REQUIRE(th.protocolVersion() == 2);
+    }
+
+    SECTION("Negotiation does not block asynchronous calls") {
+        warabi::RegionID region;
+        warabi::AsyncRequest req;
+        REQUIRE_NOTHROW(th.create(&region, 16, &req));
+        REQUIRE_NOTHROW(req.wait());
+        // the answer is picked up by a later call
+        for(int i = 0; i < 100 && th.protocolVersion() == 0; ++i) {
+            REQUIRE_NOTHROW(th.erase(region, &req));
+            REQUIRE_NOTHROW(req.wait());
+            REQUIRE_NOTHROW(th.create(&region, 16, &req));
+            REQUIRE_NOTHROW(req.wait());
+        }
+        REQUIRE(th.protocolVersion() == 2);
+    }
+
+    // both versions, with the eager and bulk paths
+    auto version = GENERATE(1, 2);
+    auto threshold = GENERATE(0, 1024*1024);
+    CAPTURE(version, threshold);
+    th.setProtocolVersion(version);
+    th.setEagerReadThreshold(threshold);
+    th.setEagerWriteThreshold(threshold);
+
+    const size_t region_size = 8*1024;
+    std::string in(region_size, '\0');
+    for(size_t i = 0; i < in.size(); ++i) in[i] = 'A' + (i % 26);
+    warabi::RegionID region;
+    REQUIRE_NOTHROW(th.create(&region, region_size));
+    REQUIRE(th.protocolVersion() == version);
+
+    SECTION("Write, read, and erase") {
+        REQUIRE_NOTHROW(th.write(region, 0, in.data(), in.size()));
+        std::string out(region_size, '\0');
+        REQUIRE_NOTHROW(th.read(region, 0, out.data(), out.size()));
+        REQUIRE(out == in);
+
+        warabi::AsyncRequest req;
+        std::string part(100, '\0');
+        REQUIRE_NOTHROW(th.read(region, 1000, part.data(), part.size(), &req));
+        REQUIRE_NOTHROW(req.wait());
+        REQUIRE(part == in.substr(1000, 100));
+
+        REQUIRE_NOTHROW(th.erase(region));
+        REQUIRE_THROWS_AS(th.read(region, 0, out.data(), out.size()), warabi::Exception);
+    }
+
+    SECTION("Layouts") {
+        REQUIRE_NOTHROW(th.write(region, 0, in.data(), in.size()));
+        auto layout = GENERATE(
+            warabi::Layout::vector(3, 100, 7, 50),
+            warabi::Layout::subarray(16, {16, 32, 8}, {4, 8, 3}, {2, 5, 1}, 2),
+            warabi::Layout::indexed({{5000, 10}, {10, 20}, {8000, 100}}));
+        std::string data(layout.size(), 'z');
+        REQUIRE_NOTHROW(th.write(region, layout, data.data()));
+        std::string out(layout.size(), '\0');
+        REQUIRE_NOTHROW(th.read(region, layout, out.data()));
+        REQUIRE(out == data);
+    }
+
+    SECTION("Errors") {
+        std::string out(16, '\0');
+        try {
+            th.read(region, region_size - 8, out.data(), out.size());
+            FAIL("Reading past the end of the region did not throw");
+        } catch(const warabi::Exception& ex) {
+            REQUIRE(std::string{ex.what()}.size() != 0);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+/*
+ * (C) 2023 The University of Chicago
+ *
+ * See COPYRIGHT in top-level directory.
+ */
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/catch_all.hpp>
+#include <warabi/Client.hpp>
+#include <warabi/Provider.hpp>
+#include <warabi/TargetHandle.hpp>
+#include <nlohmann/json.hpp>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include "WorkloadCapture.hpp"
+#include "defer.hpp"
+#include "configs.hpp"
+
+using json = nlohmann::json;
+
+TEST_CASE("Workload capture test", "[capture]") {
+
+    auto engine = thallium::engine("na+sm", THALLIUM_SERVER_MODE);
+    DEFER(engine.finalize());
+
+    // unique per process, since tests may run in parallel
+    const auto filename = (std::filesystem::temp_directory_path()
+        / ("warabi-capture-test-" + std::to_string(::getpid()) + ".bin")).string();
+    DEFER(std::filesystem::remove(filename));
+
+    SECTION("Capture without output") {
+        auto pr_config = json::parse(makeConfigForProvider("memory", "__default__"));
+        pr_config["capture"] = json{{"enabled", true}};
+        REQUIRE_THROWS_AS(warabi::Provider(engine, 42, pr_config.dump()), warabi::Exception);
+    }
+
+    SECTION("Capture enabled") {
+        warabi::RegionID regionID;
+        {
+            auto pr_config = json::parse(makeConfigForProvider("memory", "__default__"));
+            pr_config["capture"] = json{{"enabled", true}, {"output", filename}, {"buffer_size", 64}};
+            warabi::Provider provider(engine, 42, pr_config.dump());
+
+            auto config = json::parse(provider.getConfig());
+            REQUIRE(config["capture"]["output"].get<std::string>() == filename);
+
+            warabi::Client client(engine);
+            warabi::TargetHandle th = client.makeTargetHandle(engine.self(), 42);
+
+            std::string in(64, 'A');
+            REQUIRE_NOTHROW(th.createAndWrite(&regionID, in.data(), in.size()));
+            std::string out(in.size(), '\0');
+            REQUIRE_NOTHROW(th.read(regionID, {{0, 16}, {32, 16}}, out.data()));
+            REQUIRE_NOTHROW(th.erase(regionID));
+        }
+        // the remaining records are written when the provider is destroyed
+        std::ifstream file(filename, std::ios::binary);
+        REQUIRE(file.good());
+        std::string content{std::istreambuf_iterator<char>(file),
+                            std::istreambuf_iterator<char>()};
+        REQUIRE(content.substr(0, 8) == "WRBCAPT1");
+        // header, 3 records of 50 bytes, and 2 segments of 16 bytes
+        REQUIRE(content.size() == 10 + 3*50 + 2*16);
+        std::string region(reinterpret_cast<const char*>(regionID.data()), regionID.size());
+        REQUIRE(content.find(region) != std::string::npos);
+    }
+
+    SECTION("Load and replay a capture") {
+        auto capture = [&](const std::string& output, auto&& run) {
+            auto pr_config = json::parse(makeConfigForProvider("memory", "__default__"));
+            pr_config["capture"] = json{{"enabled", true}, {"output", output}, {"buffer_size", 64}};
+            warabi::Provider provider(engine, 42, pr_config.dump());
+            warabi::Client client(engine);
+            run(client.makeTargetHandle(engine.self(), 42));
+        };
+        auto load = [](const std::string& input) {
+            std::ifstream file(input, std::ios::binary);
+            REQUIRE(file.good());
+            uint16_t provider_id = 0;
+            auto records = warabi::WorkloadCapture::load(file, provider_id);
+            REQUIRE(provider_id == 42);
+            return records;
+        };
+
+        warabi::RegionID regionID;
+        capture(filename, [&](const warabi::TargetHandle& th) {
+            std::string in(64, 'A');
+            REQUIRE_NOTHROW(th.createAndWrite(&regionID, in.data(), in.size()));
+            std::string out(in.size(), '\0');
+            REQUIRE_NOTHROW(th.read(regionID, {{0, 16}, {32, 16}}, out.data()));
+            REQUIRE_NOTHROW(th.erase(regionID));
+        });
+        auto records = load(filename);
+        REQUIRE(records.size() == 3);
+        REQUIRE(records[0].op == warabi::CaptureOp::CreateWriteEager);
+        REQUIRE(records[0].size == 64);
+        REQUIRE(records[1].op == warabi::CaptureOp::ReadEager);
+        REQUIRE(records[1].size == 32);
+        const std::vector<std::pair<size_t, size_t>> segments = {{0, 16}, {32, 16}};
+        REQUIRE(records[1].segments == segments);
+        REQUIRE(records[2].op == warabi::CaptureOp::Erase);
+        for(auto& r : records) {
+            REQUIRE(r.success);
+            REQUIRE(r.region == regionID);
+        }
+        REQUIRE(records[0].timestamp <= records[1].timestamp);
+        REQUIRE(records[1].timestamp <= records[2].timestamp);
+
+        // replaying the records produces the same capture
+        const auto replayed = filename + ".replayed";
+        DEFER(std::filesystem::remove(replayed));
+        capture(replayed, [&](const warabi::TargetHandle& th) {
+            warabi::RegionID replayedID;
+            std::vector<char> buffer(64, 'r');
+            for(auto& r : records) {
+                switch(r.op) {
+                case warabi::CaptureOp::CreateWriteEager:
+                    th.createAndWrite(&replayedID, buffer.data(), r.size, r.persist);
+                    break;
+                case warabi::CaptureOp::ReadEager:
+                    th.read(replayedID, r.segments, buffer.data());
+                    break;
+                case warabi::CaptureOp::Erase:
+                    th.erase(replayedID);
+                    break;
+                default:
+                    FAIL("unexpected operation " << warabi::captureOpName(r.op));
+                }
+            }
+        });
+        auto replayedRecords = load(replayed);
+        REQUIRE(replayedRecords.size() == records.size());
+        for(size_t i = 0; i < records.size(); ++i) {
+            REQUIRE(replayedRecords[i].op == records[i].op);
+            REQUIRE(replayedRecords[i].size == records[i].size);
+            REQUIRE(replayedRecords[i].segments == records[i].segments);
+            REQUIRE(replayedRecords[i].success);
+        }
+    }
+}